@@ -0,0 +1,567 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   bench.cpp
+ * @date   Mon Oct 19 20:14:37 2026
+ *
+ * @brief  Micro- and macro-benchmarks for CCB
+ *
+ * Times coiled-coil generation, domain updates, pdb output and
+ * whole ccb commands through the Tcl interface, and writes the
+ * results as JSON so they can be compared between releases.
+ *
+ * bench [-o file.json] [-t seconds] [-filter substring]
+ *       [-baseline file.json] [-threshold fraction]
+ *
+ * With -baseline the run fails if any benchmark's fastest sample
+ * is more than threshold (default 0.25) slower than in the
+ * baseline file.
+ *
+ * Every benchmark is calibrated so one sample takes at least
+ * 1/SAMPLES of the requested time, SAMPLES samples are taken
+ * and the median is reported. Allocations are counted by
+ * wrapping malloc, so they include everything new, smalloc and
+ * Tcl allocate.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+#include <tcl.h>
+
+#include "ccb.h"
+#include "error.h"
+#include "domain.h"
+#include "ccbio.h"
+#include "backbonehandler.h"
+#include "backbone.h"
+#include "backbone_coiledcoil.h"
+
+using namespace CCB_NS;
+
+/**
+ * @def SAMPLES
+ * @brief Number of timed samples per benchmark, the median is reported
+ */
+
+#define SAMPLES 7
+
+/**
+ * @def MAXBENCH
+ * @brief Most benchmarks in one run
+ */
+
+#define MAXBENCH 64
+
+extern "C" int Ccb_Init(Tcl_Interp *interp);
+
+/* ----------------------------------------------------------------------
+   Allocation counting, glibc lets malloc be wrapped
+------------------------------------------------------------------------- */
+
+static long long nalloc = 0;
+
+#if defined(__GLIBC__)
+
+extern "C" {
+    void *__libc_malloc(size_t);
+    void *__libc_calloc(size_t, size_t);
+    void *__libc_realloc(void *, size_t);
+
+    void *malloc(size_t n) {
+        nalloc++;
+        return __libc_malloc(n);
+    }
+
+    void *calloc(size_t n, size_t size) {
+        nalloc++;
+        return __libc_calloc(n, size);
+    }
+
+    void *realloc(void *p, size_t n) {
+        nalloc++;
+        return __libc_realloc(p, n);
+    }
+}
+
+static const bool count_alloc = true;
+
+#else
+
+static const bool count_alloc = false;
+
+#endif
+
+/* ----------------------------------------------------------------------
+   Timing
+------------------------------------------------------------------------- */
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+/**
+ * One benchmark. run() does a single operation, setup() if set
+ * prepares the next one outside of the timed region.
+ */
+
+class Bench {
+  public:
+    const char *name;
+    bigint natom;         /**< atoms produced or touched by one operation */
+
+    Bench(const char *n) : name(n), natom(0) {}
+    virtual ~Bench() {}
+
+    virtual bool has_setup() { return false; }
+    virtual void setup() {}
+    virtual int run() = 0;
+};
+
+struct Result {
+    char name[64];
+    long long iterations;  /**< operations per sample */
+    double ns;             /**< median ns per operation */
+    double ns_min;         /**< fastest sample, ns per operation */
+    double allocs;         /**< allocations per operation */
+    bigint natom;
+};
+
+/**
+ * Time n operations, excluding setup() when the benchmark has one
+ */
+
+static double sample(Bench *b, long long n, long long &allocs) {
+
+    double elapsed = 0.0;
+    long long a0 = nalloc, asetup = 0;
+
+    if (b->has_setup()) {
+        for (long long i = 0; i < n; i++) {
+            long long s0 = nalloc;
+            b->setup();
+            asetup += nalloc - s0;
+
+            double t0 = now();
+            b->run();
+            elapsed += now() - t0;
+        }
+    } else {
+        double t0 = now();
+        for (long long i = 0; i < n; i++)
+            b->run();
+        elapsed = now() - t0;
+    }
+
+    allocs = nalloc - a0 - asetup;
+    return elapsed;
+}
+
+static int compare(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static int measure(Bench *b, double seconds, Result &r) {
+
+    // One warm-up operation also checks that the benchmark works
+    if (b->has_setup()) b->setup();
+    if (b->run() != CCB_OK) {
+        fprintf(stderr, "bench: %s failed\n", b->name);
+        return CCB_ERROR;
+    }
+
+    // Calibrate the number of operations per sample
+    double target = seconds / SAMPLES;
+    long long n = 1, allocs = 0;
+    double t = sample(b, n, allocs);
+    while (t < target && n < (1LL << 40)) {
+        n = t > 0.0 ? (long long) (n * 1.5 * target / t) + 1 : n * 10;
+        t = sample(b, n, allocs);
+    }
+
+    double ns[SAMPLES];
+    for (int i = 0; i < SAMPLES; i++)
+        ns[i] = 1.0e9 * sample(b, n, allocs) / n;
+
+    qsort(ns, SAMPLES, sizeof(double), compare);
+
+    snprintf(r.name, 64, "%s", b->name);
+    r.iterations = n;
+    r.ns = ns[SAMPLES / 2];
+    r.ns_min = ns[0];
+    r.allocs = (double) allocs / n;
+    r.natom = b->natom;
+
+    return CCB_OK;
+}
+
+/* ----------------------------------------------------------------------
+   Benchmarks on a CCB instance
+------------------------------------------------------------------------- */
+
+/**
+ * A CCB instance with one coiled-coil backbone built from a
+ * whitespace separated parameter string
+ */
+
+class CoilBench : public Bench {
+  public:
+    CCB *ccb;
+    BackboneCoiledCoil *bb;
+
+    CoilBench(const char *n, const char *params) : Bench(n), ccb(NULL), bb(NULL) {
+
+        ccb = new CCB(0, NULL);
+        ccb->error->verbosity_level = 0;
+
+        const char *add[] = { "backbone", "add", "coiledcoil", "bb1" };
+        ccb->backbone->add_backbone(4, add);
+        ccb->backbone->init_backbone("bb1");
+
+        // Split params into arguments
+        char *buf = strdup(params);
+        const char *argv[128];
+        int argc = 0;
+        for (char *p = strtok(buf, " "); p && argc < 128; p = strtok(NULL, " "))
+            argv[argc++] = p;
+
+        ccb->backbone->update_backbone("bb1", argc, argv, 0);
+        ccb->backbone->generate_backbone("bb1");
+        free(buf);
+
+        // The handler only holds coiled-coil styles here
+        bb = static_cast<BackboneCoiledCoil *> (ccb->backbone->backbone[0]);
+        natom = 4 * ccb->domain->nsite;
+    }
+
+    ~CoilBench() {
+        delete ccb;
+    }
+};
+
+class GenerateBench : public CoilBench {
+  public:
+    bool asym;
+    GenerateBench(const char *n, const char *params, bool a) :
+        CoilBench(n, params), asym(a) {}
+    int run() { return asym ? bb->generate_asymmetric() : bb->generate(); }
+};
+
+class UpdateDomainBench : public CoilBench {
+  public:
+    UpdateDomainBench(const char *n, const char *params) : CoilBench(n, params) {}
+    int run() { return bb->update_domain(); }
+};
+
+class ResetBench : public CoilBench {
+  public:
+    ResetBench(const char *n, const char *params) : CoilBench(n, params) {}
+    bool has_setup() { return true; }
+    void setup() { bb->update_domain(); }
+    int run() { ccb->domain->reset(); return CCB_OK; }
+};
+
+class OutputBench : public CoilBench {
+  public:
+    OutputBench(const char *n, const char *params, const char *fname) : CoilBench(n, params) {
+        const char *add[] = { "output", "pdb", "pdb1", fname, "all" };
+        ccb->ccbio->add_output(5, add);
+        ccb->ccbio->init_output("pdb1");
+    }
+    int run() { return ccb->ccbio->write_output("pdb1"); }
+};
+
+/* ----------------------------------------------------------------------
+   Benchmarks through the Tcl interface
+------------------------------------------------------------------------- */
+
+class TclBench : public Bench {
+  public:
+    Tcl_Interp *interp;
+    Tcl_Obj *script;
+
+    TclBench(const char *n, Tcl_Interp *in, const char *s, bigint na) :
+        Bench(n), interp(in) {
+        natom = na;
+        script = Tcl_NewStringObj(s, -1);
+        Tcl_IncrRefCount(script);
+    }
+
+    ~TclBench() {
+        Tcl_DecrRefCount(script);
+    }
+
+    int run() {
+        if (Tcl_EvalObjEx(interp, script, 0) != TCL_OK) {
+            fprintf(stderr, "bench: %s\n", Tcl_GetStringResult(interp));
+            return CCB_ERROR;
+        }
+        return CCB_OK;
+    }
+};
+
+/* ----------------------------------------------------------------------
+   Output
+------------------------------------------------------------------------- */
+
+static int write_json(const char *fname, Result *r, int n, double seconds) {
+
+    FILE *fp = fopen(fname, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "bench: can't open %s\n", fname);
+        return CCB_ERROR;
+    }
+
+    struct utsname u;
+    uname(&u);
+
+    char date[64];
+    time_t t = time(NULL);
+    strftime(date, 64, "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"ccb_version\": \"%s\",\n", PACKAGE_VERSION);
+    fprintf(fp, "  \"date\": \"%s\",\n", date);
+    fprintf(fp, "  \"host\": \"%s\",\n", u.nodename);
+    fprintf(fp, "  \"machine\": \"%s %s\",\n", u.sysname, u.machine);
+    fprintf(fp, "  \"seconds\": %g,\n", seconds);
+    fprintf(fp, "  \"samples\": %d,\n", SAMPLES);
+    fprintf(fp, "  \"benchmarks\": [\n");
+
+    for (int i = 0; i < n; i++) {
+        double atoms_per_s = r[i].ns > 0.0 ? r[i].natom * 1.0e9 / r[i].ns : 0.0;
+        fprintf(fp, "    {\"name\": \"%s\", \"iterations\": %lld, \"ns_per_op\": %.1f, "
+                "\"ns_per_op_min\": %.1f, \"atoms\": " BIGINT_FORMAT ", \"atoms_per_s\": %.4g, ",
+                r[i].name, r[i].iterations, r[i].ns, r[i].ns_min, r[i].natom, atoms_per_s);
+        if (count_alloc)
+            fprintf(fp, "\"allocs_per_op\": %.2f}", r[i].allocs);
+        else
+            fprintf(fp, "\"allocs_per_op\": null}");
+        fprintf(fp, "%s\n", i < n - 1 ? "," : "");
+    }
+
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+
+    return CCB_OK;
+}
+
+/**
+ * Compare against a json file written by an earlier run. A
+ * benchmark fails when its fastest sample is more than threshold
+ * (a fraction) slower than the baseline's, the minimum is less
+ * sensitive to a busy machine than the median. Benchmarks missing
+ * from either side are skipped.
+ *
+ * @return number of regressions, -1 if the baseline can't be read
+ */
+
+static int compare_baseline(const char *fname, Result *r, int n, double threshold) {
+
+    FILE *fp = fopen(fname, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "bench: can't open baseline %s\n", fname);
+        return -1;
+    }
+
+    // One benchmark per line, as written by write_json
+    char line[1024], name[256];
+    int nregress = 0, ncompare = 0;
+
+    while (fgets(line, 1024, fp)) {
+        const char *pn = strstr(line, "\"name\": \"");
+        const char *pt = strstr(line, "\"ns_per_op_min\": ");
+        if (pn == NULL || pt == NULL) continue;
+
+        pn += 9;
+        const char *end = strchr(pn, '"');
+        if (end == NULL || end - pn >= 256) continue;
+        memcpy(name, pn, end - pn);
+        name[end - pn] = '\0';
+
+        double base = atof(pt + 17);
+
+        for (int i = 0; i < n; i++) {
+            if (strcmp(r[i].name, name) != 0 || base <= 0.0) continue;
+
+            double ratio = r[i].ns_min / base;
+            bool slow = ratio > 1.0 + threshold;
+            printf("%-44s %12.0f ns/op baseline %12.0f %+7.1f%%%s\n", name, r[i].ns_min,
+                   base, 100.0 * (ratio - 1.0), slow ? " REGRESSION" : "");
+
+            ncompare++;
+            if (slow) nregress++;
+        }
+    }
+
+    fclose(fp);
+
+    printf("%d of %d benchmarks within %.0f%% of %s\n", ncompare - nregress,
+           ncompare, 100.0 * threshold, fname);
+
+    return nregress;
+}
+
+int main(int argc, char **argv) {
+
+    const char *outfile = "bench.json";
+    const char *filter = NULL;
+    const char *baseline = NULL;
+    double seconds = 1.0;
+    double threshold = 0.25;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            outfile = argv[++i];
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "-filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "-baseline") == 0 && i + 1 < argc)
+            baseline = argv[++i];
+        else if (strcmp(argv[i], "-threshold") == 0 && i + 1 < argc)
+            threshold = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: bench [-o file.json] [-t seconds] [-filter substring]"
+                    " [-baseline file.json] [-threshold fraction]\n");
+            return 1;
+        }
+    }
+
+    // Scratch directory for pdb output
+    char tmpdir[] = "/tmp/ccb_bench_XXXXXX";
+    if (mkdtemp(tmpdir) == NULL) {
+        fprintf(stderr, "bench: can't create a scratch directory\n");
+        return 1;
+    }
+
+    char pdbfile[256];
+    snprintf(pdbfile, 256, "%s/out.pdb", tmpdir);
+
+    // Tcl interpreter with the ccb command
+    Tcl_FindExecutable(argv[0]);
+    Tcl_Interp *interp = Tcl_CreateInterp();
+    if (Tcl_Init(interp) != TCL_OK || Ccb_Init(interp) != TCL_OK) {
+        fprintf(stderr, "bench: can't initialize Tcl: %s\n", Tcl_GetStringResult(interp));
+        return 1;
+    }
+
+    char script[1024];
+    Bench *bench[MAXBENCH];
+    int nbench = 0;
+
+    // Kernels across sizes
+    bench[nbench++] = new GenerateBench("generate/nhelix2_nres28", "-nhelix 2 -nres 28", false);
+    bench[nbench++] = new GenerateBench("generate/nhelix4_nres28", "-nhelix 4 -nres 28", false);
+    bench[nbench++] = new GenerateBench("generate/nhelix7_nres100", "-nhelix 7 -nres 100", false);
+    bench[nbench++] = new GenerateBench("generate/nhelix4_nres1000", "-nhelix 4 -nres 1000", false);
+    bench[nbench++] = new GenerateBench("generate/nhelix60_nres40", "-nhelix 60 -nres 40 -radius 40", false);
+    bench[nbench++] = new GenerateBench("generate/anti_nhelix4_nres28", "-nhelix 4 -nres 28 -antiparallel", false);
+    bench[nbench++] = new GenerateBench("generate/fm_rpt_nhelix4_nres28",
+                                        "-nhelix 4 -nres 28 -radius 6 8 1 28 -frasermacrae rpt", false);
+    bench[nbench++] = new GenerateBench("generate/single_nhelix60_nres40",
+                                        "-nhelix 60 -nres 40 -radius 40 -precision single", false);
+    bench[nbench++] = new GenerateBench("generate_asymmetric/nhelix4_nres28",
+                                        "-nhelix 4 -nres 28 -asymmetric -rotation 0 10 20 30", true);
+    bench[nbench++] = new GenerateBench("generate_asymmetric/anti_nhelix4_nres100",
+                                        "-nhelix 4 -nres 100 -asymmetric -antiparallel", true);
+    bench[nbench++] = new GenerateBench("generate_asymmetric/nhelix30_nres40",
+                                        "-nhelix 30 -nres 40 -radius 20 -asymmetric", true);
+
+    // Domain and output
+    bench[nbench++] = new UpdateDomainBench("update_domain/nhelix4_nres28", "-nhelix 4 -nres 28");
+    bench[nbench++] = new UpdateDomainBench("update_domain/nhelix60_nres40", "-nhelix 60 -nres 40 -radius 40");
+    bench[nbench++] = new ResetBench("domain_reset/nhelix4_nres28", "-nhelix 4 -nres 28");
+    bench[nbench++] = new ResetBench("domain_reset/nhelix60_nres40", "-nhelix 60 -nres 40 -radius 40");
+    bench[nbench++] = new OutputBench("output_pdb/nhelix4_nres28", "-nhelix 4 -nres 28", pdbfile);
+    bench[nbench++] = new OutputBench("output_pdb/nhelix60_nres40", "-nhelix 60 -nres 40 -radius 40", pdbfile);
+
+    // Whole commands as a script would issue them
+    bench[nbench++] = new TclBench("tcl_ccb/nhelix4_nres28", interp,
+                                   "ccb -nhelix 4 -nres 28", 4 * 28 * 4);
+    bench[nbench++] = new TclBench("tcl_ccb/xyz_nhelix4_nres28", interp,
+                                   "ccb -nhelix 4 -nres 28 -xyz", 4 * 28 * 4);
+    snprintf(script, 1024, "ccb -nhelix 4 -nres 28 -pdb %s", pdbfile);
+    bench[nbench++] = new TclBench("tcl_ccb/pdb_nhelix4_nres28", interp, script, 4 * 28 * 4);
+
+    // The sweep in tcl/examples/ensemble_example.tcl, one operation is all 100 structures
+    snprintf(script, 1024,
+             "for {set i 0} {$i < 10} {incr i} {\n"
+             "  for {set j 0} {$j < 10} {incr j} {\n"
+             "    ccb -pdb %s/pdb_[expr {$i * 10 + $j}].pdb"
+             " -pitch [expr {300 + $i * -20}] -radius [expr {7.0 + $j * 0.2}]"
+             " -nhelix 4 -nres 28 -antiparallel\n"
+             "  }\n"
+             "}", tmpdir);
+    bench[nbench++] = new TclBench("ensemble_example/100x_nhelix4_nres28", interp, script, 100 * 4 * 28 * 4);
+
+    Result result[MAXBENCH];
+    int nresult = 0, code = 0;
+
+    for (int i = 0; i < nbench; i++) {
+        if (filter && strstr(bench[i]->name, filter) == NULL)
+            continue;
+
+        if (measure(bench[i], seconds, result[nresult]) != CCB_OK) {
+            code = 1;
+            continue;
+        }
+
+        Result &r = result[nresult++];
+        printf("%-44s %12.0f ns/op %12.4g atoms/s %10.1f allocs/op\n", r.name, r.ns,
+               r.ns > 0.0 ? r.natom * 1.0e9 / r.ns : 0.0, count_alloc ? r.allocs : -1.0);
+        fflush(stdout);
+    }
+
+    for (int i = 0; i < nbench; i++)
+        delete bench[i];
+
+    Tcl_DeleteInterp(interp);
+
+    // Remove the scratch output
+    char cmd[300];
+    snprintf(cmd, 300, "rm -rf %s", tmpdir);
+    if (system(cmd) != 0)
+        fprintf(stderr, "bench: can't remove %s\n", tmpdir);
+
+    if (write_json(outfile, result, nresult, seconds) != CCB_OK)
+        return 1;
+
+    printf("Wrote %d benchmarks to %s\n", nresult, outfile);
+
+    // Timing regression gate
+    if (baseline && compare_baseline(baseline, result, nresult, threshold) != 0)
+        code = 1;
+
+    return code;
+}
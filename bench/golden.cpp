@@ -0,0 +1,486 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   golden.cpp
+ * @date   Mon Oct 19 21:02:16 2026
+ *
+ * @brief  Golden-coordinate regression checks
+ *
+ * Builds a fixed matrix of coiled-coils and compares every atom
+ * against reference coordinates stored in golden/, so changes to
+ * the generation math that move atoms are caught.
+ *
+ * golden [-dir golden] [-update] [-filter substring]
+ *
+ * -update rewrites the references from the current build, only do
+ * that after a change that is meant to move the coordinates (and
+ * bump GEOMETRY_VERSION along with it).
+ *
+ * The repeat cases build again on a warm C interface handle, once
+ * with nothing changed and once after a pitch-only update, and
+ * must match a fresh build exactly.
+ *
+ * clash_edge puts a chain exactly on the upper bound of the clash
+ * grid, where round off once binned it past the last bin.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ccb.h"
+#include "error.h"
+#include "domain.h"
+#include "site.h"
+#include "group.h"
+#include "atom.h"
+#include "backbonehandler.h"
+#include "clash.h"
+#include "library.h"
+
+using namespace CCB_NS;
+
+/**
+ * @def MAXARG
+ * @brief Most arguments in a parameter set
+ */
+
+#define MAXARG 128
+
+/**
+ * One parameter set. Cases that share a reference with another
+ * build (e.g. single precision) name it in ref.
+ */
+
+struct Case {
+    const char *name;
+    const char *params;
+    double maxdev;        /**< largest allowed deviation of any atom */
+    double rmsd;          /**< largest allowed RMSD over all atoms */
+    const char *ref;      /**< reference to compare against, NULL for name */
+};
+
+static const Case cases[] = {
+    { "sym_dimer", "-nhelix 2 -nres 28", 1.0e-4, 1.0e-5, NULL },
+    { "sym_trimer", "-nhelix 3 -nres 28 -rotation 20", 1.0e-4, 1.0e-5, NULL },
+    { "sym_tetramer", "-nhelix 4 -nres 28 -pitch 150 -radius 7.0", 1.0e-4, 1.0e-5, NULL },
+    { "sym_square", "-nhelix 4 -nres 21 -square 10 -rpt 3.6", 1.0e-4, 1.0e-5, NULL },
+    { "sym_octamer", "-nhelix 8 -nres 14 -radius 12", 1.0e-4, 1.0e-5, NULL },
+    { "asym_rotation", "-nhelix 3 -nres 20 -asymmetric -rotation 0 40 80 -zoff 0 1 2", 1.0e-4, 1.0e-5, NULL },
+    { "asym_nres", "-nhelix 3 -asymmetric -nres 20 24 18 -rpt 3.6 3.62 3.58", 1.0e-4, 1.0e-5, NULL },
+    { "asym_z", "-nhelix 4 -nres 16 -asymmetric -Z 0 1.5 0 -1.5 -square 0 5 0 5", 1.0e-4, 1.0e-5, NULL },
+    { "anti_tetramer", "-nhelix 4 -nres 30 -antiparallel", 1.0e-4, 1.0e-5, NULL },
+    { "anti_order", "-nhelix 4 -nres 30 -antiparallel 0 1 1 0 -order 0 2 3 1", 1.0e-4, 1.0e-5, NULL },
+    { "anti_asym", "-nhelix 4 -nres 24 -asymmetric -antiparallel -rotation 0 30 0 30", 1.0e-4, 1.0e-5, NULL },
+    { "fm_pitch", "-nhelix 2 -nres 25 -frasermacrae -rpt 3.60", 1.0e-4, 1.0e-5, NULL },
+    { "fm_pitch_modulated", "-nhelix 4 -nres 30 -asymmetric -rpt 3.60 3.62 3.60 3.62 -radius 6.0 7.5 5 25 -frasermacrae",
+      1.0e-4, 1.0e-5, NULL },
+    { "fm_rpt", "-nhelix 2 -nres 30 -pitch 150 -radius 4.5 6.0 1 30 -frasermacrae rpt", 1.0e-4, 1.0e-5, NULL },
+    { "radius_modulated", "-nhelix 4 -nres 30 -radius 6.0 7.0 5 20", 1.0e-4, 1.0e-5, NULL },
+    { "radius_anti", "-nhelix 4 -nres 30 -antiparallel -radius 6.0 7.0 5 20", 1.0e-4, 1.0e-5, NULL },
+    { "single_tetramer", "-nhelix 4 -nres 28 -pitch 150 -radius 7.0 -precision single", 1.0e-3, 1.0e-4, "sym_tetramer" },
+    { "single_anti", "-nhelix 4 -nres 30 -antiparallel -precision single", 1.0e-3, 1.0e-4, "anti_tetramer" },
+    { "single_asym", "-nhelix 3 -nres 20 -asymmetric -rotation 0 40 80 -zoff 0 1 2 -precision single",
+      1.0e-3, 1.0e-4, "asym_rotation" }
+};
+
+static const int ncase = sizeof(cases) / sizeof(Case);
+
+/**
+ * Parameter sets rebuilt on one handle, the pitch is changed to
+ * repitch on the second round
+ */
+
+struct Repeat {
+    const char *name;
+    const char *params;
+    double repitch;
+};
+
+static const Repeat repeats[] = {
+    { "repeat_square", "-nhelix 4 -nres 21 -square 10 -rpt 3.6", 150.0 },
+    { "repeat_square_anti", "-nhelix 4 -nres 30 -antiparallel -square 10", 150.0 },
+    { "repeat_square_single", "-nhelix 5 -nres 21 -square 10 -precision single", 150.0 }
+};
+
+static const int nrepeat = sizeof(repeats) / sizeof(Repeat);
+
+/**
+ * Build the coiled-coil for params and copy out the coordinates
+ * in domain order.
+ *
+ * @return number of atoms, -1 on error. x is allocated with malloc.
+ */
+
+static int build(const char *params, double **x) {
+
+    CCB *ccb = new CCB(0, NULL);
+    ccb->error->verbosity_level = 0;
+
+    const char *add[] = { "backbone", "add", "coiledcoil", "bb1" };
+
+    char *buf = strdup(params);
+    const char *argv[MAXARG];
+    int argc = 0;
+    for (char *p = strtok(buf, " "); p && argc < MAXARG; p = strtok(NULL, " "))
+        argv[argc++] = p;
+
+    int natom = -1;
+
+    if (ccb->backbone->add_backbone(4, add) == CCB_OK &&
+        ccb->backbone->init_backbone("bb1") == CCB_OK &&
+        ccb->backbone->update_backbone("bb1", argc, argv, 0) == CCB_OK &&
+        ccb->backbone->generate_backbone("bb1") == CCB_OK) {
+
+        natom = 0;
+        for (int i = 0; i < ccb->domain->nsite; i++)
+            natom += ccb->domain->site[i]->fixed_atoms->natom;
+
+        *x = (double *) malloc(3 * natom * sizeof(double) + 1);
+
+        for (int i = 0, n = 0; i < ccb->domain->nsite; i++) {
+            Group *g = ccb->domain->site[i]->fixed_atoms;
+            for (int j = 0; j < g->natom; j++, n += 3)
+                g->atom[j]->get_xyz(*x + n);
+        }
+    }
+
+    free(buf);
+    delete ccb;
+
+    return natom;
+}
+
+/**
+ * Build on a C interface handle, fresh if h is NULL, after
+ * applying params and then, if repitch > 0, a pitch-only update.
+ *
+ * @return number of atoms, -1 on error. x is allocated with malloc.
+ */
+
+static int build_handle(void *h, const char *params, double repitch, double **x) {
+
+    void *fresh = NULL;
+    if (h == NULL) {
+        if (ccb_open(&fresh) != 0) return -1;
+        ccb_set_verbosity(fresh, 0);
+        h = fresh;
+    }
+
+    char *buf = strdup(params);
+    const char *argv[MAXARG];
+    int argc = 0;
+    for (char *p = strtok(buf, " "); p && argc < MAXARG; p = strtok(NULL, " "))
+        argv[argc++] = p;
+
+    ccb_params_t p;
+    ccb_params_init(&p);
+    p.set = CCB_PARAM_PITCH;
+    p.pitch = repitch;
+
+    int natom = -1;
+
+    if ((params[0] == '\0' || ccb_set_options(h, argc, argv) == 0) &&
+        (repitch <= 0.0 || ccb_set_params(h, &p) == 0) &&
+        ccb_generate(h) == 0) {
+
+        natom = ccb_natoms(h);
+        *x = (double *) malloc(3 * natom * sizeof(double) + 1);
+        memcpy(*x, ccb_coords(h), 3 * natom * sizeof(double));
+    }
+
+    free(buf);
+    if (fresh) ccb_close(fresh);
+
+    return natom;
+}
+
+/**
+ * Rebuild k on one handle and compare every round, bit for bit,
+ * with a fresh build of the same parameters.
+ *
+ * @return number of rounds that failed
+ */
+
+static int check_repeat(const Repeat &k) {
+
+    void *h = NULL;
+    if (ccb_open(&h) != 0) {
+        printf("%-24s FAIL could not open a handle\n", k.name);
+        return 1;
+    }
+    ccb_set_verbosity(h, 0);
+
+    int nfail = 0;
+
+    // Twice unchanged, then after the pitch update
+    for (int round = 0; round < 3; round++) {
+
+        double repitch = round == 2 ? k.repitch : 0.0;
+        double *x = NULL, *ref = NULL;
+
+        int natom = build_handle(h, round ? "" : k.params, repitch, &x);
+        int nref = natom < 0 ? -1 : build_handle(NULL, k.params, repitch, &ref);
+
+        if (natom < 0 || nref < 0) {
+            printf("%-24s FAIL could not build: %s\n", k.name, k.params);
+            nfail++;
+        } else {
+            int ndiff = 0;
+            for (int i = 0; i < 3 * natom && nref == natom; i++)
+                if (x[i] != ref[i]) ndiff++;
+            bool ok = nref == natom && ndiff == 0;
+
+            printf("%-24s %s %5d atoms round %d, %d coordinates differ\n", k.name,
+                   ok ? "ok  " : "FAIL", natom, round + 1, ndiff);
+
+            if (!ok) nfail++;
+        }
+
+        free(x);
+        free(ref);
+    }
+
+    ccb_close(h);
+
+    return nfail;
+}
+
+/**
+ * Flatten a dimer onto the x axis: the first chain at 6.5 but for
+ * one atom at 0, the second on the upper bound just short of 7.5,
+ * which is 3 bins of 2.5 when divided but 3.0 when multiplied by
+ * the inverse. Every atom of the second chain clashes with every
+ * atom at 6.5 of the first.
+ *
+ * @return 1 if the count is wrong, 0 otherwise
+ */
+
+static int check_clash_edge() {
+
+    const char *name = "clash_edge";
+    const char *params[] = { "-nhelix", "2", "-nres", "7" };
+    const char *add[] = { "backbone", "add", "coiledcoil", "bb1" };
+
+    CCB *ccb = new CCB(0, NULL);
+    ccb->error->verbosity_level = 0;
+
+    if (ccb->backbone->add_backbone(4, add) != CCB_OK ||
+        ccb->backbone->init_backbone("bb1") != CCB_OK ||
+        ccb->backbone->update_backbone("bb1", 4, params, 0) != CCB_OK ||
+        ccb->backbone->generate_backbone("bb1") != CCB_OK) {
+        printf("%-24s FAIL could not build the dimer\n", name);
+        delete ccb;
+        return 1;
+    }
+
+    const char *first = ccb->domain->site[0]->chain;
+    int na = 0, nb = 0;
+
+    for (int i = 0; i < ccb->domain->nsite; i++) {
+        Site *s = ccb->domain->site[i];
+        bool a = strcmp(s->chain, first) == 0;
+        for (int j = 0; j < s->fixed_atoms->natom; j++) {
+            Atom *atom = s->fixed_atoms->atom[j];
+            atom->x = !a ? 7.499999999999999 : na ? 6.5 : 0.0;
+            atom->y = atom->z = 0.0;
+            if (a) na++; else nb++;
+        }
+    }
+
+    Clash *clash = new Clash(ccb);
+    clash->cutoff = 2.5;
+
+    int expect = (na - 1) * nb;
+    bool ok = clash->check(0) == CCB_OK && clash->npair == expect;
+
+    printf("%-24s %s %5d atoms %d clashing pairs, expected %d\n", name,
+           ok ? "ok  " : "FAIL", na + nb, clash->npair, expect);
+
+    delete clash;
+    delete ccb;
+
+    return ok ? 0 : 1;
+}
+
+/**
+ * References are plain text: the parameters, the number of atoms,
+ * then x y z per line to 1e-6, well inside the tolerances.
+ */
+
+static int write_ref(const char *fname, const char *params, const double *x, int natom) {
+
+    FILE *fp = fopen(fname, "w");
+    if (fp == NULL) return -1;
+
+    fprintf(fp, "# ccb %s\n%d\n", params, natom);
+    for (int i = 0; i < natom; i++)
+        fprintf(fp, "%.6f %.6f %.6f\n", x[3 * i], x[3 * i + 1], x[3 * i + 2]);
+
+    fclose(fp);
+    return 0;
+}
+
+static int read_ref(const char *fname, double **x) {
+
+    FILE *fp = fopen(fname, "r");
+    if (fp == NULL) return -1;
+
+    char line[1024];
+    int natom = -1;
+
+    if (fgets(line, 1024, fp) == NULL || fscanf(fp, "%d", &natom) != 1 || natom < 0) {
+        fclose(fp);
+        return -1;
+    }
+
+    *x = (double *) malloc(3 * natom * sizeof(double) + 1);
+    for (int i = 0; i < 3 * natom; i++)
+        if (fscanf(fp, "%lf", *x + i) != 1) {
+            natom = -1;
+            break;
+        }
+
+    fclose(fp);
+    return natom;
+}
+
+int main(int argc, char **argv) {
+
+    const char *dir = "golden";
+    const char *filter = NULL;
+    bool update = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-dir") == 0 && i + 1 < argc)
+            dir = argv[++i];
+        else if (strcmp(argv[i], "-filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "-update") == 0)
+            update = true;
+        else {
+            fprintf(stderr, "usage: golden [-dir golden] [-update] [-filter substring]\n");
+            return 1;
+        }
+    }
+
+    int nfail = 0, nrun = 0, nwrite = 0;
+    char fname[512];
+
+    for (int c = 0; c < ncase; c++) {
+
+        const Case &k = cases[c];
+        if (filter && strstr(k.name, filter) == NULL)
+            continue;
+
+        double *x = NULL, *ref = NULL;
+        int natom = build(k.params, &x);
+
+        if (natom < 0) {
+            printf("%-24s FAIL could not build: %s\n", k.name, k.params);
+            nfail++;
+            continue;
+        }
+
+        nrun++;
+        snprintf(fname, 512, "%s/%s.xyz", dir, k.ref ? k.ref : k.name);
+
+        // Cases checked against another case's reference are never written
+        if (update) {
+            if (k.ref == NULL) {
+                if (write_ref(fname, k.params, x, natom) != 0) {
+                    printf("%-24s FAIL can't write %s\n", k.name, fname);
+                    nfail++;
+                } else {
+                    printf("%-24s wrote %d atoms to %s\n", k.name, natom, fname);
+                    nwrite++;
+                }
+            }
+            free(x);
+            continue;
+        }
+
+        int nref = read_ref(fname, &ref);
+
+        if (nref < 0) {
+            printf("%-24s FAIL can't read %s\n", k.name, fname);
+            nfail++;
+        } else if (nref != natom) {
+            printf("%-24s FAIL %d atoms, reference has %d\n", k.name, natom, nref);
+            nfail++;
+        } else {
+            double dmax = 0.0, msd = 0.0;
+            int imax = 0;
+
+            for (int i = 0; i < natom; i++) {
+                double dx = x[3 * i] - ref[3 * i];
+                double dy = x[3 * i + 1] - ref[3 * i + 1];
+                double dz = x[3 * i + 2] - ref[3 * i + 2];
+                double dsq = dx * dx + dy * dy + dz * dz;
+                msd += dsq;
+                if (dsq > dmax) {
+                    dmax = dsq;
+                    imax = i;
+                }
+            }
+
+            dmax = sqrt(dmax);
+            double rmsd = natom ? sqrt(msd / natom) : 0.0;
+            bool ok = dmax <= k.maxdev && rmsd <= k.rmsd;
+
+            printf("%-24s %s %5d atoms max %.3e (atom %d) rmsd %.3e\n", k.name,
+                   ok ? "ok  " : "FAIL", natom, dmax, imax + 1, rmsd);
+
+            if (!ok) nfail++;
+        }
+
+        free(x);
+        free(ref);
+    }
+
+    // Nothing to write for the repeats, they compare against a fresh build
+    for (int c = 0; c < nrepeat && !update; c++) {
+        if (filter && strstr(repeats[c].name, filter) == NULL)
+            continue;
+        nrun++;
+        if (check_repeat(repeats[c]) != 0)
+            nfail++;
+    }
+
+    if (!update && (filter == NULL || strstr("clash_edge", filter))) {
+        nrun++;
+        nfail += check_clash_edge();
+    }
+
+    if (update)
+        printf("Updated %d references in %s\n", nwrite, dir);
+    else
+        printf("%d of %d cases within tolerance\n", nrun - nfail, nrun);
+
+    return nfail ? 1 : 0;
+}
@@ -0,0 +1,1025 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   ccbmodule.cpp
+ * @date   Mon Oct 19 16:40:05 2026
+ *
+ * @brief  Python extension module built on the C interface
+ *
+ *     import ccb, numpy
+ *     b = ccb.Builder(nhelix=4, nres=28)
+ *     b.generate()
+ *     x = numpy.asarray(b)          # (natom, 3), no copy
+ *     b.set(pitch=150.0)
+ *     b.generate()                  # x now holds the new coil
+ *     f = b.generate_batch([[120.0, 4.6], [140.0, 4.8]],
+ *                          ("pitch", "radius"), threads=2)
+ *
+ * A Builder exports the coordinates of its last coil through the
+ * buffer protocol, so memoryview(b) and numpy.asarray(b) are views
+ * of the buffer the library fills. Views follow the builder from
+ * coil to coil, which is why generate() refuses to change the
+ * number of atoms while one is alive.
+ *
+ * generate_batch() runs rows of parameters on top of the current
+ * ones, one column per name, a name repeated gives a per-helix
+ * list. The frames are split over threads, each with its own
+ * instance, without the GIL, and written straight into the result.
+ * set_cache() gives the builder and every batch instance a cache
+ * of the coils they built.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <string.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+#include "library.h"
+
+/**
+ * @def BATCH_MAXTHREAD
+ * @brief most threads a batch is split over
+ */
+
+#define BATCH_MAXTHREAD 64
+
+/**
+ * @def MAXOWNED
+ * @brief most lists a single set() call can convert
+ */
+
+#define MAXOWNED 16
+
+typedef struct {
+    PyObject_HEAD
+    void *ccb;                  /**< the builder's instance */
+    const double *x;            /**< coordinates of the last coil, NULL if there is none */
+    int natom;                  /**< atoms in the last coil */
+    Py_ssize_t shape[2];        /**< natom, 3 */
+    Py_ssize_t strides[2];
+    int exports;                /**< buffers handed out over x */
+    int busy;                   /**< a call is running without the GIL */
+
+    PyObject *history;          /**< keywords given to set() since the last reset */
+    int version;                /**< bumped by set() and reset() */
+    void **pool;                /**< instances for generate_batch */
+    int *pool_version;          /**< version each pool instance was brought to */
+    int npool;
+    int cache;                  /**< coils each instance keeps, 0 for none */
+    double cacheres;            /**< their resolution, 0 for the default */
+} Builder;
+
+/// Lists converted from Python, freed after the call
+struct Owned {
+    void *p[MAXOWNED];
+    int n;
+};
+
+static void release(Owned &o) {
+    for (int i = 0; i < o.n; i++)
+        PyMem_Free(o.p[i]);
+    o.n = 0;
+}
+
+/* ----------------------------------------------------------------------
+   conversion of keyword arguments to ccb_params_t
+------------------------------------------------------------------------- */
+
+/**
+ * @brief a number or a sequence of numbers as doubles
+ */
+
+static int to_doubles(PyObject *v, const char *name, double **out, int *n, Owned &o) {
+
+    if (o.n == MAXOWNED) {
+        PyErr_SetString(PyExc_ValueError, "too many list parameters");
+        return -1;
+    }
+
+    PyObject *seq = PyNumber_Check(v) ? PyTuple_Pack(1, v) : PySequence_Fast(v, "");
+    if (seq == NULL) {
+        PyErr_Format(PyExc_TypeError, "%s must be a number or a sequence of numbers", name);
+        return -1;
+    }
+
+    Py_ssize_t len = PySequence_Fast_GET_SIZE(seq);
+    double *d = (double *) PyMem_Malloc((len ? len : 1) * sizeof(double));
+    if (d == NULL) {
+        Py_DECREF(seq);
+        PyErr_NoMemory();
+        return -1;
+    }
+    o.p[o.n++] = d;
+
+    for (Py_ssize_t i = 0; i < len; i++) {
+        d[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, i));
+        if (d[i] == -1.0 && PyErr_Occurred()) {
+            Py_DECREF(seq);
+            return -1;
+        }
+    }
+
+    Py_DECREF(seq);
+    *out = d;
+    *n = (int) len;
+    return 0;
+}
+
+static int to_ints(PyObject *v, const char *name, int **out, int *n, Owned &o) {
+
+    double *d;
+    if (to_doubles(v, name, &d, n, o) < 0)
+        return -1;
+
+    // Converted in place, an int fits where the double was
+    int *iv = (int *) d;
+    for (int i = 0; i < *n; i++)
+        iv[i] = (int) d[i];
+
+    *out = iv;
+    return 0;
+}
+
+/**
+ * @brief fill p from the keywords of set(), lists are kept in o
+ */
+
+static int parse_params(PyObject *kw, ccb_params_t *p, Owned &o) {
+
+    ccb_params_init(p);
+    if (kw == NULL)
+        return 0;
+
+    PyObject *key, *v;
+    Py_ssize_t pos = 0;
+    int check = -1;
+
+    while (PyDict_Next(kw, &pos, &key, &v)) {
+
+        const char *name = PyUnicode_AsUTF8(key);
+        if (name == NULL)
+            return -1;
+
+        int *iv = NULL;
+        double *d = NULL;
+        int n = 0;
+
+        if (strcmp(name, "nhelix") == 0) {
+            p->set |= CCB_PARAM_NHELIX;
+            p->nhelix = (int) PyLong_AsLong(v);
+        } else if (strcmp(name, "pitch") == 0) {
+            p->set |= CCB_PARAM_PITCH;
+            p->pitch = PyFloat_AsDouble(v);
+        } else if (strcmp(name, "rpr") == 0) {
+            p->set |= CCB_PARAM_RPR;
+            p->rpr = PyFloat_AsDouble(v);
+        } else if (strcmp(name, "radius") == 0) {
+            if (to_doubles(v, name, &d, &n, o) < 0) return -1;
+            if (n < 1 || n > 4) {
+                PyErr_SetString(PyExc_ValueError, "radius takes 1 to 4 values");
+                return -1;
+            }
+            p->set |= CCB_PARAM_RADIUS;
+            memcpy(p->radius, d, n * sizeof(double));
+            p->nradius = n;
+        } else if (strcmp(name, "nres") == 0) {
+            if (to_ints(v, name, &iv, &n, o) < 0) return -1;
+            p->set |= CCB_PARAM_NRES;
+            p->nres = iv;
+            p->nnres = n;
+        } else if (strcmp(name, "order") == 0) {
+            if (to_ints(v, name, &iv, &n, o) < 0) return -1;
+            p->set |= CCB_PARAM_ORDER;
+            p->order = iv;
+            p->norder = n;
+        } else if (strcmp(name, "rotation") == 0) {
+            if (to_doubles(v, name, &d, &n, o) < 0) return -1;
+            p->set |= CCB_PARAM_ROTATION;
+            p->rotation = d;
+            p->nrotation = n;
+        } else if (strcmp(name, "square") == 0) {
+            if (to_doubles(v, name, &d, &n, o) < 0) return -1;
+            p->set |= CCB_PARAM_SQUARE;
+            p->square = d;
+            p->nsquare = n;
+        } else if (strcmp(name, "rpt") == 0) {
+            if (to_doubles(v, name, &d, &n, o) < 0) return -1;
+            p->set |= CCB_PARAM_RPT;
+            p->rpt = d;
+            p->nrpt = n;
+        } else if (strcmp(name, "zoff") == 0) {
+            if (to_doubles(v, name, &d, &n, o) < 0) return -1;
+            p->set |= CCB_PARAM_ZOFF;
+            p->zoff = d;
+            p->nzoff = n;
+        } else if (strcmp(name, "z") == 0) {
+            if (to_doubles(v, name, &d, &n, o) < 0) return -1;
+            p->set |= CCB_PARAM_Z;
+            p->z = d;
+            p->nz = n;
+        } else if (strcmp(name, "antiparallel") == 0) {
+            // True for the up-down default, or the orientation of each helix
+            p->set |= CCB_PARAM_ANTIPARALLEL;
+            if (PySequence_Check(v)) {
+                if (to_ints(v, name, &iv, &n, o) < 0) return -1;
+                p->antiparallel = 1;
+                p->ap_order = iv;
+                p->nap_order = n;
+            } else {
+                p->antiparallel = PyObject_IsTrue(v);
+            }
+        } else if (strcmp(name, "asymmetric") == 0) {
+            p->set |= CCB_PARAM_ASYMMETRIC;
+            p->asymmetric = PyObject_IsTrue(v);
+        } else if (strcmp(name, "frasermacrae") == 0) {
+            // True, False, or what to solve for, "pitch" or "rpt"
+            p->set |= CCB_PARAM_FRASERMACRAE;
+            if (PyUnicode_Check(v)) {
+                const char *s = PyUnicode_AsUTF8(v);
+                if (strcmp(s, "rpt") != 0 && strcmp(s, "pitch") != 0) {
+                    PyErr_SetString(PyExc_ValueError, "frasermacrae must be a bool, 'pitch' or 'rpt'");
+                    return -1;
+                }
+                p->set |= CCB_PARAM_FM_RPT;
+                p->frasermacrae = 1;
+                p->fm_rpt = s[0] == 'r';
+            } else {
+                p->frasermacrae = PyObject_IsTrue(v);
+            }
+        } else if (strcmp(name, "precision") == 0) {
+            const char *s = PyUnicode_Check(v) ? PyUnicode_AsUTF8(v) : "";
+            if (strcmp(s, "single") != 0 && strcmp(s, "double") != 0) {
+                PyErr_SetString(PyExc_ValueError, "precision must be 'single' or 'double'");
+                return -1;
+            }
+            p->set |= CCB_PARAM_PRECISION;
+            p->single = s[0] == 's';
+        } else if (strcmp(name, "check") == 0) {
+            check = PyObject_IsTrue(v);
+        } else {
+            PyErr_Format(PyExc_TypeError, "unknown parameter '%s'", name);
+            return -1;
+        }
+
+        if (PyErr_Occurred())
+            return -1;
+    }
+
+    if (check >= 0) {
+        if (!(p->set & CCB_PARAM_PRECISION)) {
+            PyErr_SetString(PyExc_TypeError, "check is given with precision");
+            return -1;
+        }
+        p->check = check;
+    }
+
+    return 0;
+}
+
+/* ----------------------------------------------------------------------
+   Builder
+------------------------------------------------------------------------- */
+
+/**
+ * @brief update an instance with keywords, without keeping them
+ */
+
+static int apply(void *ccb, PyObject *kw) {
+
+    Owned o;
+    o.n = 0;
+
+    ccb_params_t p;
+    int code = parse_params(kw, &p, o);
+    if (code == 0 && ccb_set_params(ccb, &p) != 0) {
+        PyErr_SetString(PyExc_ValueError, "ccb: invalid parameters");
+        code = -1;
+    }
+
+    release(o);
+    return code;
+}
+
+static int check_idle(Builder *self) {
+
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "the builder is in use by another thread");
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *Builder_new(PyTypeObject *type, PyObject * /*args*/, PyObject * /*kw*/) {
+
+    Builder *self = (Builder *) type->tp_alloc(type, 0);
+    if (self == NULL)
+        return NULL;
+
+    self->history = PyList_New(0);
+    if (self->history == NULL || ccb_open(&self->ccb) != 0) {
+        Py_DECREF(self);
+        PyErr_SetString(PyExc_RuntimeError, "ccb: could not create an instance");
+        return NULL;
+    }
+
+    return (PyObject *) self;
+}
+
+static int Builder_init(Builder *self, PyObject *args, PyObject *kw) {
+
+    if (PyTuple_GET_SIZE(args) != 0) {
+        PyErr_SetString(PyExc_TypeError, "Builder takes keyword arguments only");
+        return -1;
+    }
+
+    if (kw == NULL || PyDict_Size(kw) == 0)
+        return 0;
+
+    if (apply(self->ccb, kw) < 0)
+        return -1;
+
+    self->version++;
+    return PyList_Append(self->history, kw);
+}
+
+static void Builder_dealloc(Builder *self) {
+
+    for (int i = 0; i < self->npool; i++)
+        ccb_close(self->pool[i]);
+    PyMem_Free(self->pool);
+    PyMem_Free(self->pool_version);
+
+    ccb_close(self->ccb);
+    Py_XDECREF(self->history);
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+/**
+ * @brief true if applying kw after last is the same as kw alone,
+ * so a loop of set() calls keeps one entry in the history
+ */
+
+static int supersedes(PyObject *kw, PyObject *last) {
+
+    if (PyDict_Size(kw) != PyDict_Size(last))
+        return 0;
+
+    PyObject *key, *v;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(kw, &pos, &key, &v)) {
+        PyObject *old = PyDict_GetItem(last, key);
+        if (old == NULL)
+            return 0;
+
+        // A shorter list only replaces the leading helices
+        if (!PyUnicode_Check(old) && PySequence_Check(old)) {
+            Py_ssize_t nold = PySequence_Size(old);
+            Py_ssize_t nnew = !PyUnicode_Check(v) && PySequence_Check(v) ? PySequence_Size(v) : 1;
+            if (nold < 0 || nnew < 0) {
+                PyErr_Clear();
+                return 0;
+            }
+            if (nnew < nold)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+static PyObject *Builder_set(Builder *self, PyObject *args, PyObject *kw) {
+
+    if (check_idle(self) < 0)
+        return NULL;
+
+    if (PyTuple_GET_SIZE(args) != 0) {
+        PyErr_SetString(PyExc_TypeError, "set takes keyword arguments only");
+        return NULL;
+    }
+
+    if (kw && PyDict_Size(kw)) {
+        if (apply(self->ccb, kw) < 0)
+            return NULL;
+
+        PyObject *copy = PyDict_Copy(kw);
+        if (copy == NULL)
+            return NULL;
+
+        Py_ssize_t n = PyList_GET_SIZE(self->history);
+        int code = n && supersedes(copy, PyList_GET_ITEM(self->history, n - 1)) ?
+            PyList_SetItem(self->history, n - 1, copy) : PyList_Append(self->history, copy);
+        if (code < 0)
+            return NULL;
+        if (n == PyList_GET_SIZE(self->history) - 1)
+            Py_DECREF(copy);
+        self->version++;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *Builder_reset(Builder *self, PyObject * /*unused*/) {
+
+    if (check_idle(self) < 0)
+        return NULL;
+
+    if (ccb_reset(self->ccb) != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "ccb: reset failed");
+        return NULL;
+    }
+
+    if (PyList_SetSlice(self->history, 0, PyList_GET_SIZE(self->history), NULL) < 0)
+        return NULL;
+    self->version++;
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * @brief keep the last maxentry coils, each instance its own
+ */
+
+static PyObject *Builder_set_cache(Builder *self, PyObject *args, PyObject *kw) {
+
+    static const char *kwlist[] = { "maxentry", "resolution", NULL };
+    int maxentry;
+    double resolution = 0.0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "i|d", (char **) kwlist,
+                                     &maxentry, &resolution))
+        return NULL;
+    if (check_idle(self) < 0)
+        return NULL;
+
+    if (maxentry < 0 || resolution < 0.0) {
+        PyErr_SetString(PyExc_ValueError, "maxentry and resolution must be zero or positive");
+        return NULL;
+    }
+
+    for (int i = -1; i < self->npool; i++)
+        if (ccb_set_cache(i < 0 ? self->ccb : self->pool[i], maxentry, resolution) != 0) {
+            PyErr_SetString(PyExc_RuntimeError, "ccb: could not set the cache");
+            return NULL;
+        }
+
+    self->cache = maxentry;
+    if (resolution > 0.0 || maxentry == 0)
+        self->cacheres = resolution;
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * @brief build the coil, views of the last one follow it
+ */
+
+static PyObject *Builder_generate(Builder *self, PyObject * /*unused*/) {
+
+    if (check_idle(self) < 0)
+        return NULL;
+
+    int code;
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    code = ccb_generate(self->ccb);
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+
+    if (code != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "ccb: generate failed");
+        return NULL;
+    }
+
+    int natom = ccb_natoms(self->ccb);
+    if (self->exports > 0 && natom != self->natom) {
+        PyErr_SetString(PyExc_BufferError,
+                        "the number of atoms changed while the coordinates are exported");
+        return NULL;
+    }
+
+    self->x = ccb_coords(self->ccb);
+    if (self->x == NULL)
+        return PyErr_NoMemory();
+
+    self->natom = natom;
+    self->shape[0] = natom;
+    self->shape[1] = 3;
+    self->strides[0] = 3 * sizeof(double);
+    self->strides[1] = sizeof(double);
+
+    return PyLong_FromLong(natom);
+}
+
+static PyObject *Builder_atoms(Builder *self, PyObject * /*unused*/) {
+
+    const ccb_atom_t *a = self->x ? ccb_atoms(self->ccb) : NULL;
+    if (a == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "generate a coil first");
+        return NULL;
+    }
+
+    PyObject *list = PyList_New(self->natom);
+    if (list == NULL)
+        return NULL;
+
+    for (int i = 0; i < self->natom; i++) {
+        PyObject *t = Py_BuildValue("(isssis)", a[i].serial, a[i].name, a[i].resname,
+                                    a[i].chain, a[i].resid, a[i].element);
+        if (t == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, t);
+    }
+
+    return list;
+}
+
+/* ----------------------------------------------------------------------
+   generate_batch
+------------------------------------------------------------------------- */
+
+/// Columns generate_batch understands, repeats of the list ones add helices
+enum { K_PITCH, K_RPR, K_RADIUS, K_NRES, K_ROTATION, K_SQUARE, K_RPT, K_ZOFF, K_Z, NKIND };
+static const char *kind_name[NKIND] = {
+    "pitch", "rpr", "radius", "nres", "rotation", "square", "rpt", "zoff", "z"
+};
+
+/// One thread's share of a batch
+struct Job {
+    void *ccb;
+    int nset;
+    const ccb_params_t *set;
+    double *buf;
+    long stride;
+    int *natom;
+};
+
+static void *batch_thread(void *ptr) {
+    Job *job = (Job *) ptr;
+    ccb_generate_batch(job->ccb, job->nset, job->set, job->buf, job->stride, job->natom);
+    return NULL;
+}
+
+/**
+ * @brief an instance for the batch, brought up to the builder's
+ * parameters
+ */
+
+static void *pool_instance(Builder *self, int i) {
+
+    if (i >= self->npool) {
+        void **pool = (void **) PyMem_Realloc(self->pool, (i + 1) * sizeof(void *));
+        if (pool == NULL) return NULL;
+        self->pool = pool;
+        int *version = (int *) PyMem_Realloc(self->pool_version, (i + 1) * sizeof(int));
+        if (version == NULL) return NULL;
+        self->pool_version = version;
+
+        while (self->npool <= i) {
+            if (ccb_open(&self->pool[self->npool]) != 0)
+                return NULL;
+            if (self->cache > 0 &&
+                ccb_set_cache(self->pool[self->npool], self->cache, self->cacheres) != 0) {
+                ccb_close(self->pool[self->npool]);
+                return NULL;
+            }
+            self->pool_version[self->npool++] = -1;
+        }
+    }
+
+    if (self->pool_version[i] != self->version) {
+        if (ccb_reset(self->pool[i]) != 0)
+            return NULL;
+        for (Py_ssize_t k = 0; k < PyList_GET_SIZE(self->history); k++)
+            if (apply(self->pool[i], PyList_GET_ITEM(self->history, k)) < 0)
+                return NULL;
+        self->pool_version[i] = self->version;
+    }
+
+    return self->pool[i];
+}
+
+/**
+ * @brief the parameter rows as doubles, nrow * ncol
+ */
+
+static double *get_rows(PyObject *values, int ncol, Py_ssize_t &nrow) {
+
+    double *v = NULL;
+
+    // Anything exporting contiguous doubles, e.g. a numpy array
+    Py_buffer view;
+    if (PyObject_GetBuffer(values, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+        Py_ssize_t n = view.len / sizeof(double);
+        if (strcmp(view.format, "d") != 0 || n % ncol != 0) {
+            PyBuffer_Release(&view);
+            PyErr_SetString(PyExc_ValueError, "values must be doubles, one column per name");
+            return NULL;
+        }
+        nrow = n / ncol;
+        v = (double *) PyMem_Malloc((n ? n : 1) * sizeof(double));
+        if (v) memcpy(v, view.buf, n * sizeof(double));
+        PyBuffer_Release(&view);
+        return v ? v : (double *) PyErr_NoMemory();
+    }
+    PyErr_Clear();
+
+    // Otherwise a sequence of rows
+    PyObject *rows = PySequence_Fast(values, "values must be a sequence of rows");
+    if (rows == NULL)
+        return NULL;
+
+    nrow = PySequence_Fast_GET_SIZE(rows);
+    Py_ssize_t n = nrow * ncol;
+    v = (double *) PyMem_Malloc((n > 0 ? n : 1) * sizeof(double));
+    if (v == NULL) {
+        Py_DECREF(rows);
+        return (double *) PyErr_NoMemory();
+    }
+
+    for (Py_ssize_t r = 0; r < nrow; r++) {
+        PyObject *row = PySequence_Fast(PySequence_Fast_GET_ITEM(rows, r), "a row must be a sequence");
+        if (row == NULL || PySequence_Fast_GET_SIZE(row) != ncol) {
+            if (row) PyErr_SetString(PyExc_ValueError, "every row needs one value per name");
+            Py_XDECREF(row);
+            Py_DECREF(rows);
+            PyMem_Free(v);
+            return NULL;
+        }
+        for (int c = 0; c < ncol; c++)
+            v[r * ncol + c] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(row, c));
+        Py_DECREF(row);
+    }
+    Py_DECREF(rows);
+
+    if (PyErr_Occurred()) {
+        PyMem_Free(v);
+        return NULL;
+    }
+    return v;
+}
+
+static PyObject *Builder_generate_batch(Builder *self, PyObject *args, PyObject *kw) {
+
+    static const char *kwlist[] = { "values", "names", "threads", "out", NULL };
+    PyObject *values, *names, *outobj = Py_None;
+    int nthread = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "OO|iO", (char **) kwlist,
+                                     &values, &names, &nthread, &outobj))
+        return NULL;
+    if (check_idle(self) < 0)
+        return NULL;
+
+    // Which parameter each column sets, and where in a frame's lists it goes
+    PyObject *nameseq = PySequence_Fast(names, "names must be a sequence of parameter names");
+    if (nameseq == NULL)
+        return NULL;
+
+    int ncol = (int) PySequence_Fast_GET_SIZE(nameseq);
+    int count[NKIND] = { 0 }, offset[NKIND];
+    int *kind = (int *) PyMem_Malloc((ncol ? ncol : 1) * 2 * sizeof(int));
+    int *slot = kind + ncol;
+    if (kind == NULL) {
+        Py_DECREF(nameseq);
+        return PyErr_NoMemory();
+    }
+
+    for (int c = 0; c < ncol; c++) {
+        const char *s = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(nameseq, c));
+        kind[c] = -1;
+        for (int k = 0; s && k < NKIND; k++)
+            if (strcmp(s, kind_name[k]) == 0) kind[c] = k;
+        if (kind[c] < 0) {
+            if (s) PyErr_Format(PyExc_ValueError, "generate_batch can't vary '%s'", s);
+            Py_DECREF(nameseq);
+            PyMem_Free(kind);
+            return NULL;
+        }
+        slot[c] = count[kind[c]]++;
+    }
+    Py_DECREF(nameseq);
+
+    if (ncol == 0 || count[K_PITCH] > 1 || count[K_RPR] > 1 || count[K_RADIUS] > 4) {
+        PyErr_SetString(PyExc_ValueError, "names must be given, pitch and rpr once, radius at most 4 times");
+        PyMem_Free(kind);
+        return NULL;
+    }
+
+    offset[0] = 0;
+    for (int k = 1; k < NKIND; k++)
+        offset[k] = offset[k - 1] + count[k - 1];
+    for (int c = 0; c < ncol; c++)
+        slot[c] += offset[kind[c]];
+
+    Py_ssize_t nframe = 0;
+    double *v = get_rows(values, ncol, nframe);
+    if (v == NULL) {
+        PyMem_Free(kind);
+        return NULL;
+    }
+
+    // Every frame's parameters, lists point into its row of d or iv
+    Py_ssize_t nv = nframe * ncol > 0 ? nframe * ncol : 1;
+    ccb_params_t *set = (ccb_params_t *) PyMem_Malloc((nframe ? nframe : 1) * sizeof(ccb_params_t));
+    double *d = (double *) PyMem_Malloc(nv * sizeof(double));
+    int *iv = (int *) PyMem_Malloc(nv * sizeof(int));
+    int *natom = (int *) PyMem_Malloc((nframe ? nframe : 1) * sizeof(int));
+
+    PyObject *result = NULL;
+    Py_buffer out;
+    out.obj = NULL;
+
+    if (set == NULL || d == NULL || iv == NULL || natom == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    for (Py_ssize_t f = 0; f < nframe; f++) {
+        double *df = d + f * ncol;
+        int *ivf = iv + f * ncol;
+        for (int c = 0; c < ncol; c++) {
+            df[slot[c]] = v[f * ncol + c];
+            ivf[slot[c]] = (int) df[slot[c]];
+        }
+
+        ccb_params_t *p = &set[f];
+        ccb_params_init(p);
+        if (count[K_PITCH]) { p->set |= CCB_PARAM_PITCH; p->pitch = df[offset[K_PITCH]]; }
+        if (count[K_RPR]) { p->set |= CCB_PARAM_RPR; p->rpr = df[offset[K_RPR]]; }
+        if (count[K_RADIUS]) {
+            p->set |= CCB_PARAM_RADIUS;
+            memcpy(p->radius, df + offset[K_RADIUS], count[K_RADIUS] * sizeof(double));
+            p->nradius = count[K_RADIUS];
+        }
+        if (count[K_NRES]) { p->set |= CCB_PARAM_NRES; p->nres = ivf + offset[K_NRES]; p->nnres = count[K_NRES]; }
+        if (count[K_ROTATION]) { p->set |= CCB_PARAM_ROTATION; p->rotation = df + offset[K_ROTATION]; p->nrotation = count[K_ROTATION]; }
+        if (count[K_SQUARE]) { p->set |= CCB_PARAM_SQUARE; p->square = df + offset[K_SQUARE]; p->nsquare = count[K_SQUARE]; }
+        if (count[K_RPT]) { p->set |= CCB_PARAM_RPT; p->rpt = df + offset[K_RPT]; p->nrpt = count[K_RPT]; }
+        if (count[K_ZOFF]) { p->set |= CCB_PARAM_ZOFF; p->zoff = df + offset[K_ZOFF]; p->nzoff = count[K_ZOFF]; }
+        if (count[K_Z]) { p->set |= CCB_PARAM_Z; p->z = df + offset[K_Z]; p->nz = count[K_Z]; }
+    }
+
+    {
+        if (nthread < 1) nthread = 1;
+        if (nthread > BATCH_MAXTHREAD) nthread = BATCH_MAXTHREAD;
+        if (nthread > nframe - 1) nthread = nframe > 1 ? (int) nframe - 1 : 1;
+#ifdef _WIN32
+        nthread = 1;
+#endif
+
+        void *ccb[BATCH_MAXTHREAD];
+        for (int t = 0; t < nthread; t++)
+            if ((ccb[t] = pool_instance(self, t)) == NULL) {
+                if (!PyErr_Occurred())
+                    PyErr_SetString(PyExc_RuntimeError, "ccb: could not set up the batch instances");
+                goto done;
+            }
+
+        // The first frame sizes the result
+        int n0 = -1;
+        if (nframe > 0) {
+            if (ccb_set_params(ccb[0], &set[0]) != 0 || ccb_generate(ccb[0]) != 0) {
+                PyErr_SetString(PyExc_ValueError, "ccb: frame 0 failed");
+                goto done;
+            }
+            n0 = ccb_natoms(ccb[0]);
+        }
+
+        Py_ssize_t nvalue = nframe * (Py_ssize_t) (n0 > 0 ? n0 : 0) * 3;
+        double *buf;
+
+        if (outobj != Py_None) {
+            if (PyObject_GetBuffer(outobj, &out, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) < 0)
+                goto done;
+            // Doubles, or raw bytes such as a bytearray
+            bool raw = strcmp(out.format, "B") == 0 || strcmp(out.format, "b") == 0 ||
+                strcmp(out.format, "c") == 0;
+            if ((strcmp(out.format, "d") != 0 && !raw) ||
+                out.len < nvalue * (Py_ssize_t) sizeof(double)) {
+                PyErr_Format(PyExc_ValueError, "out must hold %zd doubles", nvalue);
+                goto done;
+            }
+            buf = (double *) out.buf;
+            Py_INCREF(outobj);
+            result = outobj;
+        } else {
+            PyObject *bytes = PyByteArray_FromStringAndSize(NULL, nvalue * sizeof(double));
+            if (bytes == NULL)
+                goto done;
+            PyObject *mv = PyMemoryView_FromObject(bytes);
+            Py_DECREF(bytes);
+            if (mv == NULL)
+                goto done;
+            result = PyObject_CallMethod(mv, "cast", "s(nii)", "d", nframe, n0 > 0 ? n0 : 0, 3);
+            Py_DECREF(mv);
+            if (result == NULL)
+                goto done;
+            buf = (double *) PyByteArray_AS_STRING(bytes);
+        }
+
+        long stride = 3 * (long) n0;
+        if (nframe > 0) {
+            memcpy(buf, ccb_coords(ccb[0]), stride * sizeof(double));
+            natom[0] = n0;
+        }
+
+        // The rest in contiguous shares, one instance per thread
+        Job job[BATCH_MAXTHREAD];
+        Py_ssize_t first = 1;
+        for (int t = 0; t < nthread; t++) {
+            Py_ssize_t n = (nframe - 1) / nthread + (t < (nframe - 1) % nthread);
+            job[t].ccb = ccb[t];
+            job[t].nset = (int) n;
+            job[t].set = set + first;
+            job[t].buf = buf + first * stride;
+            job[t].stride = stride;
+            job[t].natom = natom + first;
+            first += n;
+        }
+
+        self->busy = 1;
+        Py_BEGIN_ALLOW_THREADS
+#ifndef _WIN32
+        pthread_t thread[BATCH_MAXTHREAD];
+        int started[BATCH_MAXTHREAD];
+        for (int t = 1; t < nthread; t++)
+            started[t] = pthread_create(&thread[t], NULL, batch_thread, &job[t]) == 0;
+        batch_thread(&job[0]);
+        for (int t = 1; t < nthread; t++) {
+            if (started[t]) pthread_join(thread[t], NULL);
+            else batch_thread(&job[t]);
+        }
+#else
+        batch_thread(&job[0]);
+#endif
+        Py_END_ALLOW_THREADS
+        self->busy = 0;
+
+        // The frames were applied on top, start over next time
+        for (int t = 0; t < nthread; t++)
+            self->pool_version[t] = -1;
+
+        for (Py_ssize_t f = 1; f < nframe; f++)
+            if (natom[f] != n0) {
+                PyErr_Format(PyExc_ValueError, natom[f] < 0 ? "ccb: frame %zd failed" :
+                             "frame %zd has a different number of atoms", f);
+                Py_CLEAR(result);
+                break;
+            }
+    }
+
+done:
+    if (out.obj) PyBuffer_Release(&out);
+    PyMem_Free(natom);
+    PyMem_Free(iv);
+    PyMem_Free(d);
+    PyMem_Free(set);
+    PyMem_Free(v);
+    PyMem_Free(kind);
+    return result;
+}
+
+/* ----------------------------------------------------------------------
+   buffer protocol and attributes
+------------------------------------------------------------------------- */
+
+static int Builder_getbuffer(Builder *self, Py_buffer *view, int flags) {
+
+    if (self->x == NULL) {
+        PyErr_SetString(PyExc_BufferError, "generate a coil first");
+        return -1;
+    }
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "the coordinates are read only");
+        return -1;
+    }
+
+    view->buf = (void *) self->x;
+    view->obj = (PyObject *) self;
+    Py_INCREF(self);
+    view->len = self->natom * 3 * sizeof(double);
+    view->readonly = 1;
+    view->itemsize = sizeof(double);
+    view->format = (flags & PyBUF_FORMAT) ? (char *) "d" : NULL;
+    view->ndim = 2;
+    view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+    view->strides = (flags & PyBUF_STRIDES) ? self->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    self->exports++;
+    return 0;
+}
+
+static void Builder_releasebuffer(Builder *self, Py_buffer * /*view*/) {
+    self->exports--;
+}
+
+static PyObject *Builder_get_natom(Builder *self, void * /*closure*/) {
+    return PyLong_FromLong(self->x ? self->natom : 0);
+}
+
+static PyObject *Builder_get_coords(Builder *self, void * /*closure*/) {
+    return PyMemoryView_FromObject((PyObject *) self);
+}
+
+static PyBufferProcs Builder_as_buffer = {
+    (getbufferproc) Builder_getbuffer,
+    (releasebufferproc) Builder_releasebuffer
+};
+
+static PyMethodDef Builder_methods[] = {
+    { "set", (PyCFunction) (void (*)(void)) Builder_set, METH_VARARGS | METH_KEYWORDS,
+      "set(**params) update the parameters, nhelix=, pitch=, radius=, rotation=, ..." },
+    { "reset", (PyCFunction) Builder_reset, METH_NOARGS,
+      "reset() back to the default parameters" },
+    { "set_cache", (PyCFunction) (void (*)(void)) Builder_set_cache, METH_VARARGS | METH_KEYWORDS,
+      "set_cache(maxentry, resolution=0.0) keep the last maxentry coils, 0 for none,\n"
+      "parameters within resolution share one, 0 keeps the current resolution" },
+    { "generate", (PyCFunction) Builder_generate, METH_NOARGS,
+      "generate() build the coil, returns the number of atoms" },
+    { "atoms", (PyCFunction) Builder_atoms, METH_NOARGS,
+      "atoms() list of (serial, name, resname, chain, resid, element)" },
+    { "generate_batch", (PyCFunction) (void (*)(void)) Builder_generate_batch, METH_VARARGS | METH_KEYWORDS,
+      "generate_batch(values, names, threads=1, out=None) one coil per row of values,\n"
+      "returns their coordinates as (nframe, natom, 3) doubles, or out filled with them" },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyGetSetDef Builder_getset[] = {
+    { (char *) "natom", (getter) Builder_get_natom, NULL, (char *) "atoms in the last coil", NULL },
+    { (char *) "coords", (getter) Builder_get_coords, NULL, (char *) "memoryview of the coordinates, (natom, 3)", NULL },
+    { NULL, NULL, NULL, NULL, NULL }
+};
+
+static PyTypeObject BuilderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+static PyModuleDef ccbmodule = {
+    PyModuleDef_HEAD_INIT, "ccb", "Coiled-Coil Builder", -1, NULL, NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit_ccb(void) {
+
+    if (ccb_version() != CCB_API_VERSION) {
+        PyErr_Format(PyExc_ImportError, "libccb has API version %d, the module was built for %d",
+                     ccb_version(), CCB_API_VERSION);
+        return NULL;
+    }
+
+    BuilderType.tp_name = "ccb.Builder";
+    BuilderType.tp_doc = "Builder(**params) a coiled-coil kept between calls";
+    BuilderType.tp_basicsize = sizeof(Builder);
+    BuilderType.tp_flags = Py_TPFLAGS_DEFAULT;
+    BuilderType.tp_new = Builder_new;
+    BuilderType.tp_init = (initproc) Builder_init;
+    BuilderType.tp_dealloc = (destructor) Builder_dealloc;
+    BuilderType.tp_methods = Builder_methods;
+    BuilderType.tp_getset = Builder_getset;
+    BuilderType.tp_as_buffer = &Builder_as_buffer;
+
+    if (PyType_Ready(&BuilderType) < 0)
+        return NULL;
+
+    PyObject *m = PyModule_Create(&ccbmodule);
+    if (m == NULL)
+        return NULL;
+
+    Py_INCREF(&BuilderType);
+    if (PyModule_AddObject(m, "Builder", (PyObject *) &BuilderType) < 0 ||
+        PyModule_AddIntConstant(m, "API_VERSION", CCB_API_VERSION) < 0) {
+        Py_DECREF(&BuilderType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
+    return m;
+}
@@ -0,0 +1,47 @@
+# Regression checks for the Python module, run with "make check"
+#
+# A Builder must give the same coordinates every time it builds the
+# same parameters, whether generate() is called again on it or the
+# rows of generate_batch() repeat, on any number of threads.
+
+import sys
+
+import ccb
+
+failed = 0
+
+
+def check(name, ok):
+    global failed
+    print("%-32s %s" % (name, "ok" if ok else "FAIL"))
+    if not ok:
+        failed += 1
+
+
+def frames(f, n):
+    b = f.tobytes()
+    size = len(b) // n
+    return [b[i * size:(i + 1) * size] for i in range(n)]
+
+
+for params in (dict(nhelix=4, nres=21, square=10.0),
+               dict(nhelix=4, nres=30, antiparallel=1, square=10.0)):
+
+    name = " ".join("%s=%s" % (k, params[k]) for k in sorted(params))
+
+    b = ccb.Builder(**params)
+    b.generate()
+    first = memoryview(b).tobytes()
+    b.generate()
+    check("generate twice " + name, memoryview(b).tobytes() == first)
+
+    # Identical rows, split over threads, against the builder itself
+    b.set(pitch=150.0)
+    b.generate()
+    single = memoryview(b).tobytes()
+
+    for threads in (1, 2):
+        f = frames(b.generate_batch([[150.0]] * 4, ("pitch",), threads=threads), 4)
+        check("batch threads=%d %s" % (threads, name), all(x == single for x in f))
+
+sys.exit(1 if failed else 0)
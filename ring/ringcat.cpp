@@ -0,0 +1,167 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   ringcat.cpp
+ * @date   Mon Oct 19 16:20:41 2026
+ *
+ * @brief  Read the frames of a shared memory ring
+ *
+ * An example consumer of the shm output style and a check that a
+ * ring is being fed, built on ring.h alone:
+ *
+ * ringcat [-follow] [-xyz] [-n frames] [-timeout ms] name
+ *
+ * Prints a line per frame, or with -xyz the frame in XYZ format,
+ * until the producer is done or n frames have been read. A ring
+ * that is replaced is reopened. With -follow the producer waits
+ * for ringcat, otherwise frames it falls behind on are skipped
+ * and counted on stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ring.h"
+
+static void usage() {
+    fprintf(stderr, "usage: ringcat [-follow] [-xyz] [-n frames] [-timeout ms] name\n");
+}
+
+/// Open name, waiting up to timeout_ms for the producer to create it
+static int open_ring(const char *name, int follow, int timeout_ms, ccb_ring_t **r) {
+
+    int waited = 0;
+    while (true) {
+        int status = ccb_ring_open(name, follow, r);
+        if (status != CCB_RING_AGAIN || (timeout_ms >= 0 && waited >= timeout_ms))
+            return status;
+
+        struct timespec ts = { 0, 10000000L };
+        nanosleep(&ts, NULL);
+        waited += 10;
+    }
+}
+
+int main(int argc, char **argv) {
+
+    int follow = 0, xyz = 0, timeout_ms = -1;
+    long long nframe = -1;
+    const char *name = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-follow") == 0) {
+            follow = 1;
+        } else if (strcmp(argv[i], "-xyz") == 0) {
+            xyz = 1;
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            nframe = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-timeout") == 0 && i + 1 < argc) {
+            timeout_ms = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && name == NULL) {
+            name = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (name == NULL) {
+        usage();
+        return 1;
+    }
+
+    ccb_ring_t *r;
+    if (open_ring(name, follow, timeout_ms, &r) != CCB_RING_OK) {
+        fprintf(stderr, "ringcat: can't open ring %s\n", name);
+        return 1;
+    }
+
+    double *x = NULL;
+    int maxx = 0;
+    long long nread = 0, lost = 0;
+    int status = CCB_RING_OK;
+
+    while (nframe < 0 || nread < nframe) {
+
+        ccb_ring_frame_t f;
+        status = ccb_ring_next(r, &f, timeout_ms);
+
+        if (status == CCB_RING_MOVED) {
+            lost += ccb_ring_lost(r);
+            ccb_ring_close(r);
+            if (open_ring(name, follow, timeout_ms, &r) != CCB_RING_OK) {
+                r = NULL;
+                break;
+            }
+            continue;
+        }
+
+        if (status != CCB_RING_OK)
+            break;
+
+        // Followers may read in place, the rest copy and check
+        const double *fx = f.x;
+        if (!follow) {
+            if (f.natom > maxx) {
+                free(x);
+                maxx = f.natom;
+                x = (double *) malloc(3 * maxx * sizeof(double));
+            }
+            if (ccb_ring_copy(r, &f, x) != CCB_RING_OK) {
+                lost++;
+                continue;
+            }
+            fx = x;
+        }
+
+        if (xyz) {
+            printf("%d\nframe %llu topology %llu\n", f.natom,
+                   (unsigned long long) f.seq, (unsigned long long) f.topology);
+            for (int i = 0; i < f.natom; i++)
+                printf("%-2s %12.6f %12.6f %12.6f\n", f.atoms[i].element,
+                       fx[3 * i], fx[3 * i + 1], fx[3 * i + 2]);
+        } else {
+            printf("frame %llu topology %llu atoms %d first %s %.3f %.3f %.3f\n",
+                   (unsigned long long) f.seq, (unsigned long long) f.topology, f.natom,
+                   f.natom > 0 ? f.atoms[0].name : "-", f.natom > 0 ? fx[0] : 0.0,
+                   f.natom > 0 ? fx[1] : 0.0, f.natom > 0 ? fx[2] : 0.0);
+        }
+
+        nread++;
+    }
+
+    if (r) {
+        lost += ccb_ring_lost(r);
+        ccb_ring_close(r);
+    }
+    free(x);
+
+    fprintf(stderr, "ringcat: %lld frames read, %lld lost\n", nread, lost);
+
+    return status == CCB_RING_OK || status == CCB_RING_CLOSED ? 0 : 1;
+}
@@ -39,26 +39,29 @@ if (test $1 = "style") then
 
         # class name             fname.h         style_.h         dep .d file
   style BACKBONE_CLASS          backbone_        backbone        backbonehandler
+  style INPUT_CLASS             input_           input           ccbio
   style OUTPUT_CLASS            output_          output          ccbio
 
 # edit Makefile.lib
 # called by "make makelib"
-# use current list of *.cpp and *.h files in src dir w/out main.cpp
+# use current list of *.cpp and *.h files in src dir w/out main.cpp and
+# server.cpp, which only the executable needs
 
 elif (test $1 = "Makefile.lib") then
 
-  list=`ls -1 *.cpp | sed s/^main\.cpp// | tr "[:cntrl:]" " "`
+  list=`ls -1 *.cpp | sed -e s/^main\.cpp// -e s/^server\.cpp// | tr "[:cntrl:]" " "`
   sed -i -e "s/SRC =	.*/SRC =	$list/" Makefile.lib
   list=`ls -1 *.h | tr "[:cntrl:]" " "`
   sed -i -e "s/INC =	.*/INC =	$list/" Makefile.lib
 
 # edit Makefile.shlib, for creating shared lib
 # called by "make makeshlib"
-# use current list of *.cpp and *.h files in src dir w/out main.cpp
+# use current list of *.cpp and *.h files in src dir w/out main.cpp and
+# server.cpp, which only the executable needs
 
 elif (test $1 = "Makefile.shlib") then
 
-  list=`ls -1 *.cpp | sed s/^main\.cpp// | tr "[:cntrl:]" " "`
+  list=`ls -1 *.cpp | sed -e s/^main\.cpp// -e s/^server\.cpp// | tr "[:cntrl:]" " "`
   sed -i -e "s/SRC =	.*/SRC =	$list/" Makefile.shlib
   list=`ls -1 *.h | tr "[:cntrl:]" " "`
   sed -i -e "s/INC =	.*/INC =	$list/" Makefile.shlib
@@ -5,10 +5,14 @@ if (test $1 = 1) then
 
   cp backbone_coiledcoil.h ..
   cp backbone_coiledcoil.cpp ..
+  cp topology_coiledcoil.h ..
+  cp topology_coiledcoil.cpp ..
 
 elif (test $1 = 0) then
 
   rm -f ../backbone_coiledcoil.h
   rm -f ../backbone_coiledcoil.cpp
+  rm -f ../topology_coiledcoil.h
+  rm -f ../topology_coiledcoil.cpp
 
 fi
@@ -51,6 +51,8 @@
 #include "bitmask.h"
 #include "math_extra.h"
 #include "constants.h"
+#include "timer.h"
+#include "trace.h"
 
 /**
  * @def SITE_DELTA
@@ -63,6 +65,43 @@
 using namespace CCB_NS;
 using namespace MathExtra;
 
+// CHARMM27 RESI GLY bond lengths and angles for the peptide plane
+const double BackboneCoiledCoil::ca_c = 1.5166;
+const double BackboneCoiledCoil::c_o = 1.2273;
+const double BackboneCoiledCoil::c_n = 1.3475;
+const double BackboneCoiledCoil::n_ca = 1.4521;
+
+const double BackboneCoiledCoil::ca_c_o = 120.2400;
+const double BackboneCoiledCoil::ca_c_n = 117.5700;
+const double BackboneCoiledCoil::c_n_ca = 123.2700;
+const double BackboneCoiledCoil::n_ca_c = 108.9400;
+
+/**
+ * Grow a parameter array, moving it off the inline buffer
+ * the first time it outgrows it.
+ *
+ * @param array current storage, either inline or from memory
+ * @param inline_buf the inline buffer of the instance
+ * @param n number of entries in use
+ * @param nmax new length
+ * @return the new storage or NULL on failure
+ */
+
+template <typename TYPE>
+static TYPE *grow_param(Memory *memory, TYPE *array, TYPE *inline_buf,
+                        int n, int nmax, const char *name) {
+
+    if (array != inline_buf)
+        return memory->grow(array, nmax, name);
+
+    TYPE *heap = NULL;
+    memory->create(heap, nmax, name);
+    if (heap != NULL)
+        memcpy(heap, array, n * sizeof(TYPE));
+
+    return heap;
+}
+
 BackboneCoiledCoil::BackboneCoiledCoil(CCB *ccb, int narg, const char **arg) :
         Backbone(ccb, narg, arg),
         natom(0),
@@ -77,25 +116,37 @@ BackboneCoiledCoil::BackboneCoiledCoil(CCB *ccb, int narg, const char **arg) :
         rpr(1.495),
         asymmetric_flag(0),
         rebuild_domain(1),
+        single_flag(0),
+        check_flag(0),
+        xs(NULL),
         anti_flag(0),
-        fm_flag(0)
+        xhelix(0),
+        xrows(0),
+        xatomlarge(0),
+        fm_flag(0),
+        fm_rpt_flag(0)
 {
 
     // Check to see that we have a legit style and the format is correct.
     if (strcmp(style, "coiledcoil") != 0 || narg < 3)
         error->all(FLERR, "Illegal backbone coiled-coil command");
 
+    // Parameters start out in the inline buffers
+    maxhelix = HELIX_INLINE;
+    nres = nres_inline;
+    rotation = rotation_inline;
+    rpt = rpt_inline;
+    zoff = zoff_inline;
+    z = z_inline;
+    square = square_inline;
+    order = order_inline;
+    ap_order = ap_order_inline;
+
+    maxres = RES_INLINE;
+    radius = radius_inline;
+
     // Asymmetric parameters, assume parallel, 3.64 rpt
-    for (int i = 0; i < MAX_HELIX; i++) {
-        nres[i] = 35;
-        rotation[i] = 0.0;
-        zoff[i] = 0.0;
-        z[i] = 0.0;
-        rpt[i] = 3.64;
-        square[i] = 0;
-        order[i] = i;
-        ap_order[i] = 0;
-    }
+    helix_defaults(0, maxhelix);
 
     // Radius expansion/contraction parameters
     r0_params[0] = 4.65;        /**< r0_start */
@@ -104,28 +155,13 @@ BackboneCoiledCoil::BackboneCoiledCoil(CCB *ccb, int narg, const char **arg) :
     r0_params[3] = 0;           /**< res_end */
 
     // Fill radius array with default values
-    for (int i = 0; i < MAX_RES; i++)
+    for (int i = 0; i < maxres; i++)
         radius[i] = 4.65;
 
     x = NULL;
     pp_x = NULL;
     axis_x = NULL;
 
-    // hardcoded bond lengths/angles
-    // taken from CHARMM27 RESI GLY
-
-    // bond lengths
-    ca_c = 1.5166;
-    c_o = 1.2273;
-    c_n = 1.3475;
-    n_ca = 1.4521;
-
-    // bond angles
-    ca_c_o = 120.2400;
-    ca_c_n = 117.5700;
-    c_n_ca = 123.2700;
-    n_ca_c = 108.9400;
-
     // rotation to RAD
     rotation[0] *= DEG2RAD;
     square[0] *= DEG2RAD;
@@ -140,7 +176,7 @@ BackboneCoiledCoil::BackboneCoiledCoil(CCB *ccb, int narg, const char **arg) :
     // Update symmetric parameters
     if (!asymmetric_flag) {
         // Asymmetric parameters, assume parallel, 3.64 rpt
-        for (int i = 1; i < MAX_HELIX; i++) {
+        for (int i = 1; i < maxhelix; i++) {
             nres[i] = nres[0];
             rotation[i] = rotation[0];
             zoff[i] = zoff[0];
@@ -167,8 +203,8 @@ BackboneCoiledCoil::BackboneCoiledCoil(CCB *ccb, int narg, const char **arg) :
     natomlarge = nreslarge * 4;
 
     // Check for Fraser-MacRae Constraint
-    if (fm_flag)
-        pitch = fraser_macrae(0);
+    if (fm_flag && !fm_rpt_flag)
+        pitch = fraser_macrae(rpt[0], r0_params[0]);
 
     // Set parameter dependent values
     // Omega is negative because coiled-coils
@@ -194,9 +230,91 @@ BackboneCoiledCoil::~BackboneCoiledCoil() {
 
     // Memory for coil coordinates
     memory->destroy(x);
+    memory->destroy(xs);
 
     // Memory for associated sites
     memory->sfree(site);
+
+    // Parameters that outgrew the inline buffers
+    if (radius != radius_inline) memory->destroy(radius);
+    if (nres != nres_inline) memory->destroy(nres);
+    if (rotation != rotation_inline) memory->destroy(rotation);
+    if (rpt != rpt_inline) memory->destroy(rpt);
+    if (zoff != zoff_inline) memory->destroy(zoff);
+    if (z != z_inline) memory->destroy(z);
+    if (square != square_inline) memory->destroy(square);
+    if (order != order_inline) memory->destroy(order);
+    if (ap_order != ap_order_inline) memory->destroy(ap_order);
+}
+
+/**
+ * Default parameters for helices lo to hi-1, new helices
+ * follow the up-down pattern if the coil is antiparallel
+ */
+void BackboneCoiledCoil::helix_defaults(int lo, int hi) {
+
+    for (int i = lo; i < hi; i++) {
+        nres[i] = 35;
+        rotation[i] = 0.0;
+        zoff[i] = 0.0;
+        z[i] = 0.0;
+        rpt[i] = 3.64;
+        square[i] = 0;
+        order[i] = i;
+        ap_order[i] = anti_flag ? i % 2 : 0;
+    }
+}
+
+/**
+ * Make room in the per-helix parameter arrays for n helices
+ */
+int BackboneCoiledCoil::grow_helix(int n) {
+
+    if (n <= maxhelix)
+        return CCB_OK;
+
+    int nmax = maxhelix;
+    while (nmax < n) nmax *= 2;
+
+    nres = grow_param(memory, nres, nres_inline, maxhelix, nmax, "backbonecoiledcoil:nres");
+    rotation = grow_param(memory, rotation, rotation_inline, maxhelix, nmax, "backbonecoiledcoil:rotation");
+    rpt = grow_param(memory, rpt, rpt_inline, maxhelix, nmax, "backbonecoiledcoil:rpt");
+    zoff = grow_param(memory, zoff, zoff_inline, maxhelix, nmax, "backbonecoiledcoil:zoff");
+    z = grow_param(memory, z, z_inline, maxhelix, nmax, "backbonecoiledcoil:z");
+    square = grow_param(memory, square, square_inline, maxhelix, nmax, "backbonecoiledcoil:square");
+    order = grow_param(memory, order, order_inline, maxhelix, nmax, "backbonecoiledcoil:order");
+    ap_order = grow_param(memory, ap_order, ap_order_inline, maxhelix, nmax, "backbonecoiledcoil:ap_order");
+
+    if (nres == NULL || rotation == NULL || rpt == NULL || zoff == NULL ||
+        z == NULL || square == NULL || order == NULL || ap_order == NULL)
+        return error->one(FLERR, "CCB: could not allocate helix parameters");
+
+    helix_defaults(maxhelix, nmax);
+    maxhelix = nmax;
+
+    return CCB_OK;
+}
+
+/**
+ * Make room in the radius array for n residues
+ */
+int BackboneCoiledCoil::grow_res(int n) {
+
+    if (n <= maxres)
+        return CCB_OK;
+
+    int nmax = maxres;
+    while (nmax < n) nmax *= 2;
+
+    radius = grow_param(memory, radius, radius_inline, maxres, nmax, "backbonecoiledcoil:radius");
+    if (radius == NULL)
+        return error->one(FLERR, "CCB: could not allocate radius");
+
+    for (int i = maxres; i < nmax; i++)
+        radius[i] = r0_params[0];
+    maxres = nmax;
+
+    return CCB_OK;
 }
 
 /**
@@ -209,9 +327,9 @@ BackboneCoiledCoil::~BackboneCoiledCoil() {
  */
 int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
 
-    if (error->verbosity_level == 10)
+    if (CCB_TRACE_ON(10))
         for (int i = 0; i < argc; i++)
-            fprintf(screen, "%d\t %s\n", i, argv[i]);
+            trace->record("%d\t %s\n", i, argv[i]);
 
     while (n < argc) {
 
@@ -234,33 +352,40 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
             nhelix = atoi(argv[n]);
             rebuild_domain = true;
 
-            if (nhelix < 1 || nhelix > MAX_HELIX) {
-                char str[128];
-                sprintf(str, "CCB: nhelix must be greater than 0 and less than %d", MAX_HELIX);
-                return error->one(FLERR,str);
-            }
+            if (nhelix < 1)
+                return error->one(FLERR, "CCB: nhelix must be greater than 0");
+
+            if (grow_helix(nhelix) != CCB_OK) return CCB_ERROR;
 
         } else if (strcmp(argv[n], "-antiparallel") == 0) {
             n++;
 
             // Set default antiparallel option, e.g. 0 1 0 1...
-            for (int i = 0; i < MAX_HELIX; i += 2) {
-                ap_order[i] = 0;
-                ap_order[i+1] = 1;
-            }
+            anti_flag = true;
+            for (int i = 0; i < maxhelix; i++)
+                ap_order[i] = i % 2;
 
             int i = 0;
             while (n < argc && isfloat(argv[n])) {
+                if (grow_helix(i + 1) != CCB_OK) return CCB_ERROR;
                 ap_order[i++] = atoi(argv[n]);
                 n++;
             }
 
-            anti_flag = true;
             continue;
 
         } else if (strcmp(argv[n], "-frasermacrae") == 0) {
             fm_flag = true;
             n++;
+
+            // Optionally hold the pitch and solve for rpt instead
+            if (n < argc && strcmp(argv[n], "rpt") == 0) {
+                fm_rpt_flag = true;
+                n++;
+            } else if (n < argc && strcmp(argv[n], "pitch") == 0) {
+                fm_rpt_flag = false;
+                n++;
+            }
             continue;
 
         } else if (strcmp(argv[n], "-asymmetric") == 0) {
@@ -279,13 +404,8 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
             int i = 0;
             while (n < argc && isfloat(argv[n])) {
 
-                double rot = atof(argv[n]);
-
-                // Make sure rotation is between [-180, 180]
-                while (rot > 180) rot -= 360;
-                while (rot < -180) rot += 360;
-
-                rotation[i++] = rot * DEG2RAD;
+                if (grow_helix(i + 1) != CCB_OK) return CCB_ERROR;
+                rotation[i++] = wrap_angle(atof(argv[n])) * DEG2RAD;
                 n++;
             }
             continue;
@@ -296,13 +416,8 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
             int i = 0;
             while (n < argc && isfloat(argv[n])) {
 
-                double sq = atof(argv[n]);
-
-                // Make sure rotation is between [-180, 180]
-                while (sq > 180) sq -= 360;
-                while (sq < -180) sq += 360;
-
-                square[i++] = sq * DEG2RAD;
+                if (grow_helix(i + 1) != CCB_OK) return CCB_ERROR;
+                square[i++] = wrap_angle(atof(argv[n])) * DEG2RAD;
                 n++;
             }
             continue;
@@ -313,6 +428,7 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
             if (n == argc) return error->one(FLERR, "Missing argument to -rpt");
             int i = 0;
             while (n < argc && isfloat(argv[n])) {
+                if (grow_helix(i + 1) != CCB_OK) return CCB_ERROR;
                 rpt[i++] = atof(argv[n]);
                 n++;
             }
@@ -324,6 +440,7 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
             if (n == argc) return error->one(FLERR, "Missing argument to -zoff");
             int i = 0;
             while (n < argc && isfloat(argv[n])) {
+                if (grow_helix(i + 1) != CCB_OK) return CCB_ERROR;
                 zoff[i++] = atof(argv[n]);
                 n++;
             }
@@ -335,6 +452,7 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
             if (n == argc) return error->one(FLERR, "Missing argument to -Z");
             int i = 0;
             while (n < argc && isfloat(argv[n])) {
+                if (grow_helix(i + 1) != CCB_OK) return CCB_ERROR;
                 z[i++] = atof(argv[n]);
                 n++;
             }
@@ -347,6 +465,7 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
             if (n == argc) return error->one(FLERR, "Missing argument to -order");
             int i = 0;
             while (n < argc && isfloat(argv[n])) {
+                if (grow_helix(i + 1) != CCB_OK) return CCB_ERROR;
                 order[i++] = atoi(argv[n]);
                 n++;
             }
@@ -358,12 +477,10 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
             if (n == argc) return error->one(FLERR, "Missing argument to -nres");
             int i = 0;
             while (n < argc && isfloat(argv[n])) {
+                if (grow_helix(i + 1) != CCB_OK) return CCB_ERROR;
                 this->nres[i] = atoi(argv[n]);
-                if (this->nres[i] < 1 || this->nres[i] > MAX_RES) {
-                    char str[128];
-                    sprintf(str, "CCB: nres must be greater than 0 and less than %d", MAX_RES);
-                    return error->one(FLERR,str);
-                }
+                if (this->nres[i] < 1)
+                    return error->one(FLERR, "CCB: nres must be greater than 0");
                 i++;
                 n++;
             }
@@ -385,11 +502,32 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
             if (r0_params[2] == r0_params[3]) r0_params[1] = r0_params[0];
 
             // Update the radius
-            for (int i = 0; i < MAX_RES; i++)
-                radius[0] = r0_params[0];
+            for (int i = 0; i < maxres; i++)
+                radius[i] = r0_params[0];
 
             continue;
 
+            // Build and store the coordinates in single precision
+        } else if (strcmp(argv[n], "-precision") == 0) {
+            n++;
+            if (n == argc) return error->one(FLERR, "Missing argument to -precision");
+
+            if (strcmp(argv[n], "single") == 0)
+                single_flag = true;
+            else if (strcmp(argv[n], "double") == 0)
+                single_flag = false;
+            else
+                return error->one(FLERR, "CCB: precision must be single or double");
+            n++;
+
+            // Optionally compare against the double precision build
+            check_flag = false;
+            if (n < argc && strcmp(argv[n], "check") == 0) {
+                check_flag = true;
+                n++;
+            }
+            continue;
+
         } else if (strcmp(argv[n], "-help") == 0) {
             n++;
             print_help();
@@ -409,15 +547,344 @@ int BackboneCoiledCoil::set_params(int argc, const char **argv, int n) {
 
 }
 
+/**
+ * Checks the binary parameters before any of them are applied,
+ * so a rejected set leaves the backbone as it was
+ *
+ * @param p parameters, only the fields named in p.set are checked
+ * @return CCB_OK or CCB_ERROR
+ */
+int BackboneCoiledCoil::check_params(const CoiledCoilParams &p) {
+
+    const unsigned int set = p.set;
+
+    if ((set & CoiledCoilParams::NHELIX) && p.nhelix < 1)
+        return error->one(FLERR, "CCB: nhelix must be greater than 0");
+
+    if ((set & CoiledCoilParams::PITCH) && p.pitch == 0.0)
+        return error->one(FLERR, "CCB: pitch must be non-zero");
+
+    if ((set & CoiledCoilParams::RADIUS) && (p.nradius < 1 || p.nradius > 4))
+        return error->one(FLERR, "CCB: radius takes 1 to 4 values");
+
+    if ((set & CoiledCoilParams::NRES) && check_list(p.nres, p.nnres, "nres") != CCB_OK)
+        return CCB_ERROR;
+    if ((set & CoiledCoilParams::ROTATION) && check_list(p.rotation, p.nrotation, "rotation") != CCB_OK)
+        return CCB_ERROR;
+    if ((set & CoiledCoilParams::SQUARE) && check_list(p.square, p.nsquare, "square") != CCB_OK)
+        return CCB_ERROR;
+    if ((set & CoiledCoilParams::RPT) && check_list(p.rpt, p.nrpt, "rpt") != CCB_OK)
+        return CCB_ERROR;
+    if ((set & CoiledCoilParams::ZOFF) && check_list(p.zoff, p.nzoff, "zoff") != CCB_OK)
+        return CCB_ERROR;
+    if ((set & CoiledCoilParams::Z) && check_list(p.z, p.nz, "Z") != CCB_OK)
+        return CCB_ERROR;
+    if ((set & CoiledCoilParams::ORDER) && check_list(p.order, p.norder, "order") != CCB_OK)
+        return CCB_ERROR;
+    if ((set & CoiledCoilParams::ANTIPARALLEL) && p.ap_order &&
+        check_list(p.ap_order, p.nap_order, "antiparallel") != CCB_OK)
+        return CCB_ERROR;
+
+    if (set & CoiledCoilParams::NRES)
+        for (int i = 0; i < p.nnres; i++)
+            if (p.nres[i] < 1)
+                return error->one(FLERR, "CCB: nres must be greater than 0");
+
+    if (set & CoiledCoilParams::RPT)
+        for (int i = 0; i < p.nrpt; i++)
+            if (p.rpt[i] <= 0.0)
+                return error->one(FLERR, "CCB: rpt must be greater than 0");
+
+    if (set & CoiledCoilParams::ORDER)
+        for (int i = 0; i < p.norder; i++)
+            if (p.order[i] < 0)
+                return error->one(FLERR, "CCB: order must not be negative");
+
+    return CCB_OK;
+}
+
+int BackboneCoiledCoil::check_list(const void *v, int n, const char *name) {
+
+    if (n >= 0 && (v != NULL || n == 0))
+        return CCB_OK;
+
+    char str[128];
+    snprintf(str, 128, "CCB: %s list is missing or has a negative length", name);
+    return error->one(FLERR, str);
+}
+
+/**
+ * Sets the coiled-coil parameters from numbers, the binary
+ * counterpart of the string options. Fields are applied in
+ * the order that makes repeated string options agree with
+ * a single call
+ *
+ * @param p parameters, only the fields named in p.set are applied
+ * @return CCB_OK or CCB_ERROR, nothing changes if p fails check_params
+ */
+int BackboneCoiledCoil::set_params(const CoiledCoilParams &p) {
+
+    if (check_params(p) != CCB_OK)
+        return CCB_ERROR;
+
+    const unsigned int set = p.set;
+
+    if (set & CoiledCoilParams::NHELIX) {
+        nhelix = p.nhelix;
+        rebuild_domain = true;
+        if (grow_helix(nhelix) != CCB_OK) return CCB_ERROR;
+    }
+
+    if (set & CoiledCoilParams::ANTIPARALLEL) {
+        anti_flag = p.antiparallel != 0;
+        for (int i = 0; i < maxhelix; i++)
+            ap_order[i] = anti_flag ? i % 2 : 0;
+
+        if (p.ap_order) {
+            if (grow_helix(p.nap_order) != CCB_OK) return CCB_ERROR;
+            for (int i = 0; i < p.nap_order; i++)
+                ap_order[i] = p.ap_order[i];
+        }
+    }
+
+    if (set & CoiledCoilParams::FRASERMACRAE)
+        fm_flag = p.frasermacrae != 0;
+    if (set & CoiledCoilParams::FM_RPT)
+        fm_rpt_flag = p.fm_rpt != 0;
+    if (set & CoiledCoilParams::ASYMMETRIC)
+        asymmetric_flag = p.asymmetric != 0;
+
+    if (set & CoiledCoilParams::PRECISION) {
+        single_flag = p.single != 0;
+        check_flag = p.check != 0;
+    }
+
+    if (set & CoiledCoilParams::PITCH) pitch = p.pitch;
+    if (set & CoiledCoilParams::RPR) rpr = p.rpr;
+
+    // Per-helix lists, angles arrive in degrees
+    if (set & CoiledCoilParams::ROTATION) {
+        if (grow_helix(p.nrotation) != CCB_OK) return CCB_ERROR;
+        for (int i = 0; i < p.nrotation; i++)
+            rotation[i] = wrap_angle(p.rotation[i]) * DEG2RAD;
+    }
+
+    if (set & CoiledCoilParams::SQUARE) {
+        if (grow_helix(p.nsquare) != CCB_OK) return CCB_ERROR;
+        for (int i = 0; i < p.nsquare; i++)
+            square[i] = wrap_angle(p.square[i]) * DEG2RAD;
+    }
+
+    if (set & CoiledCoilParams::RPT) {
+        if (grow_helix(p.nrpt) != CCB_OK) return CCB_ERROR;
+        for (int i = 0; i < p.nrpt; i++)
+            rpt[i] = p.rpt[i];
+    }
+
+    if (set & CoiledCoilParams::ZOFF) {
+        if (grow_helix(p.nzoff) != CCB_OK) return CCB_ERROR;
+        for (int i = 0; i < p.nzoff; i++)
+            zoff[i] = p.zoff[i];
+    }
+
+    if (set & CoiledCoilParams::Z) {
+        if (grow_helix(p.nz) != CCB_OK) return CCB_ERROR;
+        for (int i = 0; i < p.nz; i++)
+            z[i] = p.z[i];
+    }
+
+    if (set & CoiledCoilParams::ORDER) {
+        if (grow_helix(p.norder) != CCB_OK) return CCB_ERROR;
+        for (int i = 0; i < p.norder; i++)
+            order[i] = p.order[i];
+    }
+
+    if (set & CoiledCoilParams::NRES) {
+        if (grow_helix(p.nnres) != CCB_OK) return CCB_ERROR;
+        for (int i = 0; i < p.nnres; i++)
+            nres[i] = p.nres[i];
+    }
+
+    if (set & CoiledCoilParams::RADIUS) {
+        for (int i = 0; i < p.nradius; i++)
+            r0_params[i] = p.radius[i];
+
+        // Make sure Ri == Rf if no modulation is specified
+        if (r0_params[2] == r0_params[3]) r0_params[1] = r0_params[0];
+
+        for (int i = 0; i < maxres; i++)
+            radius[i] = r0_params[0];
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * Single parameter setters, each is a one field set_params
+ * followed by the same bookkeeping as an update
+ */
+
+int BackboneCoiledCoil::set_nhelix(int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::NHELIX;
+    p.nhelix = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_pitch(double pitch) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::PITCH;
+    p.pitch = pitch;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_rpr(double rpr) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::RPR;
+    p.rpr = rpr;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_radius(const double *r, int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::RADIUS;
+    for (int i = 0; i < n && i < 4; i++)
+        p.radius[i] = r[i];
+    p.nradius = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_nres(const int *v, int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::NRES;
+    p.nres = v;
+    p.nnres = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_rotation(const double *deg, int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::ROTATION;
+    p.rotation = deg;
+    p.nrotation = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_square(const double *deg, int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::SQUARE;
+    p.square = deg;
+    p.nsquare = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_rpt(const double *v, int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::RPT;
+    p.rpt = v;
+    p.nrpt = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_zoff(const double *v, int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::ZOFF;
+    p.zoff = v;
+    p.nzoff = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_z(const double *v, int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::Z;
+    p.z = v;
+    p.nz = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_order(const int *v, int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::ORDER;
+    p.order = v;
+    p.norder = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_antiparallel(bool on, const int *v, int n) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::ANTIPARALLEL;
+    p.antiparallel = on;
+    p.ap_order = v;
+    p.nap_order = n;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_asymmetric(bool on) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::ASYMMETRIC;
+    p.asymmetric = on;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_frasermacrae(bool on, bool rpt) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::FRASERMACRAE | CoiledCoilParams::FM_RPT;
+    p.frasermacrae = on;
+    p.fm_rpt = rpt;
+    return update_style(p);
+}
+
+int BackboneCoiledCoil::set_precision(bool single, bool check) {
+    CoiledCoilParams p;
+    p.set = CoiledCoilParams::PRECISION;
+    p.single = single;
+    p.check = check;
+    return update_style(p);
+}
+
+/**
+ * Fold an angle in degrees onto [-180, 180], the bounds are
+ * kept as given
+ */
+double BackboneCoiledCoil::wrap_angle(double deg) {
+
+    if (deg > 180 || deg < -180) {
+        deg = fmod(deg, 360.0);
+        if (deg > 180) deg -= 360;
+        else if (deg < -180) deg += 360;
+    }
+
+    return deg;
+}
+
 int BackboneCoiledCoil::update_style(int argc, const char **argv, int n) {
 
     // set the params
     if (set_params(argc, argv, n) != CCB_OK)
         return CCB_ERROR;
 
+    update_derived();
+    return CCB_OK;
+}
+
+int BackboneCoiledCoil::update_style(const CoiledCoilParams &p) {
+
+    if (set_params(p) != CCB_OK)
+        return CCB_ERROR;
+
+    update_derived();
+    return CCB_OK;
+}
+
+/**
+ * Values that follow from the parameters, recomputed after
+ * every update whichever interface set them
+ */
+void BackboneCoiledCoil::update_derived() {
+
     // Check for FM Constraint
-    if (fm_flag)
-        pitch = fraser_macrae(0);
+    if (fm_flag && !fm_rpt_flag)
+        pitch = fraser_macrae(rpt[0], r0_params[0]);
 
     // Update parameter dependent values
     omega = -2 * PI * rpr / pitch;
@@ -426,7 +893,7 @@ int BackboneCoiledCoil::update_style(int argc, const char **argv, int n) {
     // Update symmetric parameters
     if (!asymmetric_flag) {
         // Asymmetric parameters, assume parallel, 3.64 rpt
-        for (int i = 1; i < MAX_HELIX; i++) {
+        for (int i = 1; i < maxhelix; i++) {
             nres[i] = nres[0];
             rotation[i] = rotation[0];
             zoff[i] = zoff[0];
@@ -449,9 +916,6 @@ int BackboneCoiledCoil::update_style(int argc, const char **argv, int n) {
             nreslarge = nres[i];
 
     natomlarge = nreslarge * 4;
-
-    return CCB_OK;
-
 }
 
 /**
@@ -475,6 +939,144 @@ int BackboneCoiledCoil::generate_style() {
     return CCB_OK;
 }
 
+/**
+ * Quantize every parameter that the coordinates depend on.
+ * Two parameter sets that pack to the same words generate
+ * the same coiled-coil to within resolution.
+ *
+ * @param buf destination, untouched if shorter than needed
+ * @param max length of buf
+ * @param resolution quantization step of the real valued parameters,
+ * the angles are taken in degrees as they are given
+ * @return the number of words needed
+ */
+
+int BackboneCoiledCoil::pack_params(int64_t *buf, int max, double resolution) {
+
+    int n = 13 + 4 + 8 * nhelix;
+    if (n > max) return n;
+
+    double scale = 1.0 / resolution;
+    int m = 0;
+
+#define QUANTIZE(v) static_cast<int64_t> (floor((v) * scale + 0.5))
+
+    buf[m++] = GEOMETRY_VERSION;
+    buf[m++] = nhelix;
+    buf[m++] = asymmetric_flag;
+    buf[m++] = anti_flag;
+    buf[m++] = fm_flag;
+    buf[m++] = fm_rpt_flag;
+    buf[m++] = single_flag;
+    buf[m++] = QUANTIZE(pitch);
+    buf[m++] = QUANTIZE(phi);
+    buf[m++] = QUANTIZE(psi);
+    buf[m++] = QUANTIZE(rpr);
+    buf[m++] = QUANTIZE(omega);
+    buf[m++] = QUANTIZE(omega_alpha);
+
+    for (int i = 0; i < 4; i++)
+        buf[m++] = QUANTIZE(r0_params[i]);
+
+    for (int i = 0; i < nhelix; i++) {
+        buf[m++] = nres[i];
+        buf[m++] = QUANTIZE(rotation[i] * RAD2DEG);
+        buf[m++] = QUANTIZE(rpt[i]);
+        buf[m++] = QUANTIZE(zoff[i]);
+        buf[m++] = QUANTIZE(z[i]);
+        buf[m++] = QUANTIZE(square[i] * RAD2DEG);
+        buf[m++] = order[i];
+        buf[m++] = ap_order[i];
+    }
+
+#undef QUANTIZE
+
+    return m;
+}
+
+bigint BackboneCoiledCoil::ncoords() {
+    return static_cast<bigint> (natom) * 3;
+}
+
+void BackboneCoiledCoil::pack_coords(double *buf) {
+
+    for (int i = 0; i < nhelix; i++)
+        for (int j = 0; j < nres[i] * 4; j++, buf += 3)
+            get_coord(i, j, buf);
+}
+
+/**
+ * Restore coordinates saved by pack_coords for the current
+ * parameters, the domain is rebuilt as after generate_style()
+ */
+
+int BackboneCoiledCoil::unpack_coords(const double *buf, bigint n) {
+
+    if (n != ncoords())
+        return error->one(FLERR, "Cached coordinates don't match the coiled-coil size");
+
+    if (allocate() != CCB_OK) return CCB_ERROR;
+
+    for (int i = 0; i < nhelix; i++)
+        for (int j = 0; j < nres[i] * 4; j++, buf += 3) {
+            if (single_flag) {
+                xs[i][3 * j] = buf[0];
+                xs[i][3 * j + 1] = buf[1];
+                xs[i][3 * j + 2] = buf[2];
+            } else {
+                x[i][j][0] = buf[0];
+                x[i][j][1] = buf[1];
+                x[i][j][2] = buf[2];
+                x[i][j][3] = 1.0;
+            }
+        }
+
+    return update_domain();
+}
+
+/**
+ * The parameters as the command line takes them, angles in
+ * degrees: nhelix, asymmetric, antiparallel, frasermacrae,
+ * pitch, rpr and the four radius parameters, then nres,
+ * rotation, rpt, zoff, z, square and the antiparallel order
+ * of each helix. The pitch or rpt is the one the Fraser-MacRae
+ * constraint solved for.
+ *
+ * @param buf destination, untouched if shorter than needed
+ * @param max length of buf
+ * @return the number of values needed
+ */
+
+int BackboneCoiledCoil::pack_values(double *buf, int max) {
+
+    int n = 10 + 7 * nhelix;
+    if (n > max) return n;
+
+    int m = 0;
+
+    buf[m++] = nhelix;
+    buf[m++] = asymmetric_flag;
+    buf[m++] = anti_flag;
+    buf[m++] = fm_flag;
+    buf[m++] = pitch;
+    buf[m++] = rpr;
+
+    for (int i = 0; i < 4; i++)
+        buf[m++] = r0_params[i];
+
+    for (int i = 0; i < nhelix; i++) {
+        buf[m++] = nres[i];
+        buf[m++] = rotation[i] * RAD2DEG;
+        buf[m++] = rpt[i];
+        buf[m++] = zoff[i];
+        buf[m++] = z[i];
+        buf[m++] = square[i] * RAD2DEG;
+        buf[m++] = ap_order[i];
+    }
+
+    return m;
+}
+
 /**
  * Initalize the coiled coil backbone style
  *
@@ -500,29 +1102,56 @@ int BackboneCoiledCoil::init_style() {
 
 /**
  * Allocates memory to store coordinates
- * for the entire helical system.
+ * for the entire helical system. Each helix of x, axis_x
+ * and xs starts on a CCB_ALIGN boundary, see Memory::grow_aligned.
+ *
+ * A symmetric single precision build without the check only
+ * needs the first helix in double, symmetry() writes the mates
+ * straight into xs, so x then holds one helix.
  */
 int BackboneCoiledCoil::allocate() {
 
     //reallocate coordinate array if natom >= maxatom
+    //or the helices no longer fit the current shape
+
+    bool resize = natom >= maxatom || nhelix > xhelix || natomlarge > xatomlarge;
 
-    if (natom >= maxatom) {
+    if (resize) {
         maxatom = natom;
+        xhelix = nhelix;
+        xatomlarge = natomlarge;
 
-        // reallocate the array to store coordinates of the atoms
-        x = memory->grow(x, nhelix, natomlarge, 4, "backbonecoiledcoil:x");
+        // reallocate the array to store the coodinates of the helical axis
+        axis_x = memory->grow_aligned(axis_x, nhelix, nreslarge + 2, 4, "backbonecoiledcoil:axis_x");
 
-        if (x == NULL)
+        if (axis_x == NULL)
             return CCB_ERROR;
 
-        // reallocate the array to store the coodinates of the helical axis
-        axis_x = memory->grow(axis_x, nhelix, nreslarge + 2, 4, "backbonecoiledcoild:axis_x");
+    }
 
-        if (axis_x == NULL)
+    // reallocate the array to store coordinates of the atoms
+    int rows = single_flag && !check_flag && !asymmetric_flag ? 1 : xhelix;
+
+    if (resize || rows != xrows || x == NULL) {
+        xrows = rows;
+        x = memory->grow_aligned(x, xrows, xatomlarge, 4, "backbonecoiledcoil:x");
+
+        if (x == NULL)
             return CCB_ERROR;
+    }
+
+    // single precision coordinates follow the shape of axis_x
+    if (single_flag && (resize || xs == NULL)) {
+        xs = memory->grow_aligned(xs, xhelix, xatomlarge * 3, "backbonecoiledcoil:xs");
 
+        if (xs == NULL)
+            return CCB_ERROR;
     }
 
+    // radius is indexed up to nres + 1 by helix_axis
+    if (grow_res(nreslarge + 2) != CCB_OK)
+        return CCB_ERROR;
+
     return CCB_OK;
 
 }
@@ -554,7 +1183,7 @@ int BackboneCoiledCoil::add_site(Site *s) {
 
 void BackboneCoiledCoil::azzero() {
 
-    for (int i = 0; i < nhelix; i++) {
+    for (int i = 0; i < xrows; i++) {
         for (unsigned int j = 0; j < natomlarge; j++) {
             x[i][j][0] = 0.0;
             x[i][j][1] = 0.0;
@@ -581,7 +1210,7 @@ void BackboneCoiledCoil::azzero() {
 int BackboneCoiledCoil::generate() {
 
     // Print Header with info
-    if (error->verbosity_level >= 4)
+    if (CCB_TRACE_ON(4))
         print_header();
 
     // Set initial peptide-plane coordiantes
@@ -596,77 +1225,17 @@ int BackboneCoiledCoil::generate() {
     // Generate the minior-helical axis
     helix_axis();
 
-    // bring the plane to the first
-    // helix axis point
-    double m[4][4];
-    double temp[4] = { 0.0 };
-
-    moveby(axis_x[0][0], m);
-
-    for (int i = 0; i < 5; i++) {
-        matvec4(m, pp_x[i], temp);
-        pp_x[i][0] = temp[0];
-        pp_x[i][1] = temp[1];
-        pp_x[i][2] = temp[2];
-        pp_x[i][3] = temp[3];
-    }
-
-    double v[3] = { 0.0 }, r[3] = { 0.0 }, u[3] = { 0.0 };
-    double theta = 0.0;
-
-    // Align the plane rotation vector with
-    // the helical axis
-    align_plane(axis_x[0][1]);
-
-    // get u, r, v for the peptide pane
-    // axis vector becomes normalized u at axis0
-    get_pp_params(axis_x[0][0], axis_x[0][1], u, v, r, theta);
-
-    //rotate the plane to set the correct crick angle
-    crick(u, rotation[0], r, axis_x[0][0]);
-
-    ////offset the plane by calculated r
-    get_pp_params(axis_x[0][0], axis_x[0][1], u, v, r, theta);
-    moveto(r, m);
-
-    for (int i = 0; i < 5; i++) {
-        matvec4(m, pp_x[i], temp);
-        pp_x[i][0] = temp[0];
-        pp_x[i][1] = temp[1];
-        pp_x[i][2] = temp[2];
-        pp_x[i][3] = temp[3];
-    }
-
-    get_pp_params(axis_x[0][0], axis_x[0][1], u, v, r, theta);
-
-    for (int i = 1, n = 0; i <= nres[0]; i++) {
-
-        // copy coordinates from peptide plane to x
-        for (int j = 0; j < 4; j++, n++) {
-            x[0][n][0] = pp_x[j][0];
-            x[0][n][1] = pp_x[j][1];
-            x[0][n][2] = pp_x[j][2];
-            x[0][n][3] = pp_x[j][3];
-        }
-
-        /**
-         * Get the next plane, use omega_alpha
-         * so the user can manipulate the residues
-         * per turn of the helix directly at risk
-         * of losing the rpt-pitch relaonship...
-         */
-        next_plane(u, v, omega_alpha);
-
-        // determine the next set of parameters
-        // to produce the next plane
-        get_pp_params(axis_x[0][i], axis_x[0][i + 1], u, v, r, theta);
-    }
+    // Build the first helix
+    (this->*helix_kernel(false))(0);
 
     // Terminate the helix
     terminate();
 
     // Generate helical symmetry mates
-    symmetry();
+    (this->*symmetry_kernel(single_flag))();
+
+    if (single_flag && check_flag)
+        return check_single();
 
     return CCB_OK;
 }
@@ -687,7 +1256,7 @@ int BackboneCoiledCoil::generate() {
 int BackboneCoiledCoil::generate_asymmetric() {
 
     // Print Header with info
-    if (error->verbosity_level >= 4)
+    if (CCB_TRACE_ON(4))
         print_header();
 
     // Set initial peptide-plane coordiantes
@@ -710,94 +1279,145 @@ int BackboneCoiledCoil::generate_asymmetric() {
      * after we terminate them in the final coordinate matrix and then return it
      */
 
-    for (int i = 0; i < nhelix; i++) {
+    HelixKernel kernel = helix_kernel(true);
+
+    for (int i = 0; i < nhelix; i++)
+        (this->*kernel)(i);
 
+    // Terminate the helices
+    terminate_asymmetric();
+
+    if (single_flag) {
+        store_single();
+        if (check_flag)
+            return check_single();
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * Builds helix i residue by residue along its axis in axis_x.
+ *
+ * Compiled once for each combination of modes so the residue
+ * loop carries no tests, see helix_kernel() for the selection.
+ *
+ * @tparam ASYM rebuild the plane and use the rpt of this helix
+ * @tparam FM_RPT the rpt follows the local radius (Fraser-MacRae)
+ * @tparam DEBUG print the screw parameters of every plane
+ */
+
+template <bool ASYM, bool FM_RPT, bool DEBUG>
+void BackboneCoiledCoil::build_helix(int i) {
+
+    if (ASYM) {
         // Set initial peptide-plane coordiantes (do this each time)
         build_plane();
 
         // calculate omega_alpha for the asymmetric rpt
         omega_alpha = 2 * PI / rpt[i];
+    }
 
-        // bring the plane to the first
-        // helix axis point
-        double m[4][4];
-        double temp[4] = { 0.0 };
+    // bring the plane to the first
+    // helix axis point
+    double m[4][4];
+    double temp[4] = { 0.0 };
 
-        moveby(axis_x[i][0], m);
+    moveby(axis_x[i][0], m);
 
-        for (int j = 0; j < 5; j++) {
-            matvec4(m, pp_x[j], temp);
-            pp_x[j][0] = temp[0];
-            pp_x[j][1] = temp[1];
-            pp_x[j][2] = temp[2];
-            pp_x[j][3] = temp[3];
-        }
+    for (int j = 0; j < 5; j++) {
+        matvec4(m, pp_x[j], temp);
+        pp_x[j][0] = temp[0];
+        pp_x[j][1] = temp[1];
+        pp_x[j][2] = temp[2];
+        pp_x[j][3] = temp[3];
+    }
 
-        double v[3] = { 0.0 }, r[3] = { 0.0 }, u[3] = { 0.0 };
-        double theta = 0.0;
+    double v[3] = { 0.0 }, r[3] = { 0.0 }, u[3] = { 0.0 };
+    double theta = 0.0;
 
-        // Align the plane rotation vector with
-        // the helical axis
-        align_plane(axis_x[i][1]);
+    // Align the plane rotation vector with
+    // the helical axis
+    align_plane(axis_x[i][1]);
+
+    // get u, r, v for the peptide pane
+    // axis vector becomes normalized u at axis0
+    get_pp_params<DEBUG>(axis_x[i][0], axis_x[i][1], u, v, r, theta);
 
-        // get u, r, v for the peptide pane
-        // axis vector becomes normalized u at axis0
-        get_pp_params(axis_x[i][0], axis_x[i][1], u, v, r, theta);
+    //rotate the plane to set the correct crick angle
+    crick(u, rotation[i], r, axis_x[i][0]);
 
-        //rotate the plane to set the correct crick angle
+    // the asymmetric build has always refined the crick angle
+    // with a second pass, kept so its coordinates don't move
+    if (ASYM) {
+        get_pp_params<DEBUG>(axis_x[i][0], axis_x[i][1], u, v, r, theta);
         crick(u, rotation[i], r, axis_x[i][0]);
+    }
 
+    ////offset the plane by calculated r
+    get_pp_params<DEBUG>(axis_x[i][0], axis_x[i][1], u, v, r, theta);
+    moveto(r, m);
 
-        // get u, r, v for the peptide pane
-        // axis vector becomes normalized u at axis0
-        get_pp_params(axis_x[i][0], axis_x[i][1], u, v, r, theta);
+    for (int j = 0; j < 5; j++) {
+        matvec4(m, pp_x[j], temp);
+        pp_x[j][0] = temp[0];
+        pp_x[j][1] = temp[1];
+        pp_x[j][2] = temp[2];
+        pp_x[j][3] = temp[3];
+    }
 
-        //rotate the plane to set the correct crick angle
-        crick(u, rotation[i], r, axis_x[i][0]);
+    get_pp_params<DEBUG>(axis_x[i][0], axis_x[i][1], u, v, r, theta);
 
+    CCB_TIMER(RESIDUES, nres[i]);
 
-        ////offset the plane by calculated r
-        get_pp_params(axis_x[i][0], axis_x[i][1], u, v, r, theta);
-        moveto(r, m);
+    for (int j = 1, n = 0; j <= nres[i]; j++) {
 
-        for (int j = 0; j < 5; j++) {
-            matvec4(m, pp_x[j], temp);
-            pp_x[j][0] = temp[0];
-            pp_x[j][1] = temp[1];
-            pp_x[j][2] = temp[2];
-            pp_x[j][3] = temp[3];
+        // copy coordinates from peptide plane to x
+        for (int k = 0; k < 4; k++, n++) {
+            x[i][n][0] = pp_x[k][0];
+            x[i][n][1] = pp_x[k][1];
+            x[i][n][2] = pp_x[k][2];
+            x[i][n][3] = pp_x[k][3];
         }
 
-        get_pp_params(axis_x[i][0], axis_x[i][1], u, v, r, theta);
+        /**
+         * Get the next plane, use omega_alpha
+         * so the user can manipulate the residues
+         * per turn of the helix directly at risk
+         * of losing the rpt-pitch relationship...
+         */
+        if (FM_RPT)
+            omega_alpha = 2 * PI / local_rpt(i, j - 1);
 
-        for (int j = 1, n = 0; j <= nres[i]; j++) {
+        next_plane(u, v, omega_alpha);
 
-            // copy coordinates from peptide plane to x
-            for (int k = 0; k < 4; k++, n++) {
-                x[i][n][0] = pp_x[k][0];
-                x[i][n][1] = pp_x[k][1];
-                x[i][n][2] = pp_x[k][2];
-                x[i][n][3] = pp_x[k][3];
-            }
+        // determine the next set of parameters
+        // to produce the next plane
+        get_pp_params<DEBUG>(axis_x[i][j], axis_x[i][j + 1], u, v, r, theta);
+    }
+}
 
-            /**
-             * Get the next plane, use omega_alpha
-             * so the user can manipulate the residues
-             * per turn of the helix directly at risk
-             * of losing the rpt-pitch relationship...
-             */
-            next_plane(u, v, omega_alpha);
+/**
+ * Picks the helix builder for the current modes, once per
+ * generate call rather than once per residue.
+ *
+ * @param asym true for the asymmetric build
+ */
 
-            // determine the next set of parameters
-            // to produce the next plane
-            get_pp_params(axis_x[i][j], axis_x[i][j + 1], u, v, r, theta);
-        }
-    }
+BackboneCoiledCoil::HelixKernel BackboneCoiledCoil::helix_kernel(bool asym) {
 
-    // Terminate the helices
-    terminate_asymmetric();
+    static const HelixKernel kernel[2][2][2] = {
+        { { &BackboneCoiledCoil::build_helix<false, false, false>,
+            &BackboneCoiledCoil::build_helix<false, false, true> },
+          { &BackboneCoiledCoil::build_helix<false, true, false>,
+            &BackboneCoiledCoil::build_helix<false, true, true> } },
+        { { &BackboneCoiledCoil::build_helix<true, false, false>,
+            &BackboneCoiledCoil::build_helix<true, false, true> },
+          { &BackboneCoiledCoil::build_helix<true, true, false>,
+            &BackboneCoiledCoil::build_helix<true, true, true> } }
+    };
 
-    return CCB_OK;
+    return kernel[asym][fm_rpt_flag][CCB_TRACE_ON(10)];
 }
 
 /**
@@ -808,6 +1428,8 @@ int BackboneCoiledCoil::generate_asymmetric() {
 
 void BackboneCoiledCoil::helix_axis() {
 
+    CCB_TIMER(HELIX_AXIS, nres[0]);
+
     // Build array of radius values
     int start = r0_params[2] - 1;
     int end = r0_params[3] - 1;
@@ -836,15 +1458,30 @@ void BackboneCoiledCoil::helix_axis() {
             reverse(&radius[0],nres[i]);
 
         // Output radius values if debugging
-        if (error->verbosity_level > 8) {
+        if (CCB_TRACE_ON(9))
             for (j = 0; j < nres[i]; j++)
-                fprintf(screen, "%d %10.4f\n", j + 1, radius[j]);
-            fflush(screen);
-        }
+                trace->record("%d %10.4f\n", j + 1, radius[j]);
 
         // center the helix axis in the x,y plane
         double z0 = -(nres[i] * rpr / 2);
 
+        // Under the Fraser-MacRae constraint the pitch follows the
+        // local radius, so the superhelical phase is accumulated
+        // residue by residue from this helix's rpt
+        if (fm_flag && !fm_rpt_flag) {
+            double phase = (z0 + zoff[i]) * (-2 * PI / fraser_macrae(rpt[i], radius[0]));
+
+            for (j = 0; j <= nres[i] + 1; j++) {
+                axis_x[i][j][0] = radius[j] * cos(phase);
+                axis_x[i][j][1] = radius[j] * sin(phase);
+                axis_x[i][j][2] = j * rpr + z0 + zoff[i] + z[i];
+                axis_x[i][j][3] = 1.0;
+
+                phase += -2 * PI * rpr / fraser_macrae(rpt[i], radius[j]);
+            }
+            continue;
+        }
+
         // generate the coordinates
         for (j = 0; j <= nres[i] + 1; j++) {
             axis_x[i][j][0] = radius[j] * cos(j * omega + ((z0 + zoff[i]) * omega / rpr));
@@ -862,6 +1499,8 @@ void BackboneCoiledCoil::helix_axis() {
 
 void BackboneCoiledCoil::build_plane() {
 
+    CCB_TIMER(BUILD_PLANE, 0);
+
     // build the peptide plane
 
     double m[4][4];
@@ -1106,6 +1745,7 @@ void BackboneCoiledCoil::crick(double *u, double rho, double *r1, double *r2) {
  * @param theta rotation about u to produce next plane
  */
 
+template <bool DEBUG>
 void BackboneCoiledCoil::get_pp_params(
     double *axis0, double *axis1,
     double *u, double *v, double *r,
@@ -1132,8 +1772,13 @@ void BackboneCoiledCoil::get_pp_params(
         matvec4(m, pp_x[i], pp_temp[i]);
 
     // Center the axis vector axis1, at axis0 and
-    // normalize it
-    matvec4(m, axis1, u);
+    // normalize it. matvec4 writes the homogeneous
+    // component too, so go through a 4-vector
+    double u4[4];
+    matvec4(m, axis1, u4);
+    u[0] = u4[0];
+    u[1] = u4[1];
+    u[2] = u4[2];
     norm3(u);
 
     double a[3] = { 0.0 }, c[3] = { 0.0 }, n[3] = { 0.0 };
@@ -1181,17 +1826,20 @@ void BackboneCoiledCoil::get_pp_params(
     sub3(r, r1, r);
     scale3(0.5, r);
 
-    if (error->verbosity_level == 10) {
-        fprintf(screen, "theta:\t%10.4f\n", theta);
-        fprintf(screen, "len u:\t%10.4f\n", len3(u));
-        fprintf(screen, "len v:\t%10.4f\n", len3(v));
-        fprintf(screen, "len r:\t%10.4f\n\n", len3(r));
+    if (DEBUG)
+        print_pp_params(u, v, r, theta);
+}
 
-        fprintf(screen, "u:\t%10.4f %10.4f %10.4f\n", u[0], u[1], u[2]);
-        fprintf(screen, "v:\t%10.4f %10.4f %10.4f\n", v[0], v[1], v[2]);
-        fprintf(screen, "r:\t%10.4f %10.4f %10.4f\n\n", r[0], r[1], r[2]);
-    }
+void BackboneCoiledCoil::print_pp_params(double *u, double *v, double *r, double theta) {
+
+    trace->record("theta:\t%10.4f\n", theta);
+    trace->record("len u:\t%10.4f\n", len3(u));
+    trace->record("len v:\t%10.4f\n", len3(v));
+    trace->record("len r:\t%10.4f\n\n", len3(r));
 
+    trace->record("u:\t%10.4f %10.4f %10.4f\n", u[0], u[1], u[2]);
+    trace->record("v:\t%10.4f %10.4f %10.4f\n", v[0], v[1], v[2]);
+    trace->record("r:\t%10.4f %10.4f %10.4f\n\n", r[0], r[1], r[2]);
 }
 
 /**
@@ -1248,10 +1896,19 @@ void BackboneCoiledCoil::next_plane(double *u, double *v, double theta) {
  * on the options specified
  *
  * This is a pretty hacky way of doing the symmetry.
+ *
+ * @tparam ANTI antiparallel coiled-coil
+ * @tparam NHELIX number of helices when known at compile time, 0 otherwise
+ * @tparam SINGLE build the mates from a single precision copy into xs
  */
 
+template <bool ANTI, int NHELIX, bool SINGLE>
 void BackboneCoiledCoil::symmetry() {
 
+    const int nh = NHELIX ? NHELIX : nhelix;
+
+    CCB_TIMER(SYMMETRY, nh - 1);
+
     // Vector for offsetting helices
     double v[3] = { 0.0 };
 
@@ -1277,15 +1934,20 @@ void BackboneCoiledCoil::symmetry() {
     identity4(m4);
     identity4(ident);
 
+    // Single precision copy of the first helix
+    if (SINGLE)
+        for (int j = 0; j < nres[0] * 4; j++) {
+            xs[0][3 * j] = x[0][j][0];
+            xs[0][3 * j + 1] = x[0][j][1];
+            xs[0][3 * j + 2] = x[0][j][2];
+        }
+
     // Legacy squareness for symmetric systems
-    // odd index helices are offset.
-    square[1] = square[0];
-    for (int i = 0, j = 1; i < nhelix; i+=2, j+=2) {
-        square[i] = 0.0;
-        square[j] = square[1];
-    }
+    // odd index helices are offset, square[] itself is left
+    // as given so the next build starts from the same values.
+    const double offset = square[0];
 
-    if (anti_flag) {
+    if (ANTI) {
 
         // antiparallel
         // Calculate the superhelical radius
@@ -1324,15 +1986,15 @@ void BackboneCoiledCoil::symmetry() {
      * z a magnitude 2*pi*i/nhelix.
      */
 
-    for (int i = 0; i < nhelix; i++) {
+    for (int i = 0; i < nh; i++) {
 
         copy4(m4, ident);
-        double theta = (2 * PI * i / nhelix) + square[i];
+        double theta = (2 * PI * i / nh) + (i % 2 ? offset : 0.0);
 
         if (ap_order[i] == 0) {
             v[2] = 0.0;
         } else {
-            if (anti_flag)
+            if (ANTI)
                 copy4(m4, m1);
         }
 
@@ -1344,6 +2006,24 @@ void BackboneCoiledCoil::symmetry() {
 
         // Perform rotation. Copy atoms.
         int natomper = nres[i] * 4;
+
+        if (SINGLE) {
+            float mf[3][4];
+            for (int k = 0; k < 3; k++)
+                for (int l = 0; l < 4; l++)
+                    mf[k][l] = m3[k][l];
+
+            const float *src = xs[0];
+            float *dst = xs[i];
+            for (int j = 0; j < 3 * natomper; j += 3) {
+                float px = src[j], py = src[j + 1], pz = src[j + 2];
+                dst[j] = mf[0][0] * px + mf[0][1] * py + mf[0][2] * pz + mf[0][3];
+                dst[j + 1] = mf[1][0] * px + mf[1][1] * py + mf[1][2] * pz + mf[1][3];
+                dst[j + 2] = mf[2][0] * px + mf[2][1] * py + mf[2][2] * pz + mf[2][3];
+            }
+            continue;
+        }
+
         for (int j = 0; j < natomper; j++) {
             matvec4(m3, x[0][j], xtemp);
             x[i][j][0] = xtemp[0];
@@ -1354,6 +2034,109 @@ void BackboneCoiledCoil::symmetry() {
     }
 }
 
+/**
+ * Picks the symmetry operation for the current modes, small
+ * coiled-coils get a version with the helix loop unrolled.
+ */
+
+BackboneCoiledCoil::SymmetryKernel BackboneCoiledCoil::symmetry_kernel(bool single) {
+
+#define SYMMETRY_KERNEL(n)                                                   \
+    (single ? (anti_flag ? &BackboneCoiledCoil::symmetry<true, n, true>      \
+                         : &BackboneCoiledCoil::symmetry<false, n, true>)    \
+            : (anti_flag ? &BackboneCoiledCoil::symmetry<true, n, false>     \
+                         : &BackboneCoiledCoil::symmetry<false, n, false>))
+
+    switch (nhelix) {
+        case 2: return SYMMETRY_KERNEL(2);
+        case 3: return SYMMETRY_KERNEL(3);
+        case 4: return SYMMETRY_KERNEL(4);
+        case 5: return SYMMETRY_KERNEL(5);
+        case 6: return SYMMETRY_KERNEL(6);
+        case 7: return SYMMETRY_KERNEL(7);
+    }
+
+    return SYMMETRY_KERNEL(0);
+
+#undef SYMMETRY_KERNEL
+}
+
+/**
+ * Rounds the double precision coordinates into xs, the
+ * asymmetric build walks every helix in double precision
+ */
+
+void BackboneCoiledCoil::store_single() {
+
+    for (int i = 0; i < nhelix; i++)
+        for (int j = 0; j < nres[i] * 4; j++) {
+            xs[i][3 * j] = x[i][j][0];
+            xs[i][3 * j + 1] = x[i][j][1];
+            xs[i][3 * j + 2] = x[i][j][2];
+        }
+}
+
+/**
+ * Compares the single precision coordinates with the double
+ * precision build of the same coiled-coil, which is left in x.
+ *
+ * @return CCB_ERROR if any atom moved by more than SINGLE_TOLERANCE
+ */
+
+int BackboneCoiledCoil::check_single() {
+
+    // The asymmetric build already walked every helix in double precision
+    if (!asymmetric_flag)
+        (this->*symmetry_kernel(false))();
+
+    double dmax = 0.0, msd = 0.0;
+
+    for (int i = 0; i < nhelix; i++)
+        for (int j = 0; j < nres[i] * 4; j++) {
+            double dx = xs[i][3 * j] - x[i][j][0];
+            double dy = xs[i][3 * j + 1] - x[i][j][1];
+            double dz = xs[i][3 * j + 2] - x[i][j][2];
+            double dsq = dx * dx + dy * dy + dz * dz;
+
+            msd += dsq;
+            if (dsq > dmax) dmax = dsq;
+        }
+
+    dmax = sqrt(dmax);
+    double rmsd = natom ? sqrt(msd / natom) : 0.0;
+
+    CCB_TRACE(3, "Single precision: max deviation %g rmsd %g over %u atoms\n",
+              dmax, rmsd, natom);
+
+    if (dmax > SINGLE_TOLERANCE) {
+        char str[128];
+        sprintf(str, "CCB: single precision coordinates deviate by %g, more than %g",
+                dmax, SINGLE_TOLERANCE);
+        return error->one(FLERR, str);
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * Coordinates of atom j of helix i in whichever precision
+ * they were stored
+ */
+
+void BackboneCoiledCoil::get_coord(int i, int j, double *p) {
+
+    if (single_flag) {
+        const float *f = &xs[i][3 * j];
+        p[0] = f[0];
+        p[1] = f[1];
+        p[2] = f[2];
+    } else {
+        p[0] = x[i][j][0];
+        p[1] = x[i][j][1];
+        p[2] = x[i][j][2];
+    }
+}
+
 /**
  * Applies the symmetry to just the helical axis, allows
  * for asymmetry in the individual helicles while retaining
@@ -1364,6 +2147,8 @@ void BackboneCoiledCoil::symmetry() {
 
 void BackboneCoiledCoil::symmetry_axis() {
 
+    CCB_TIMER(SYMMETRY_AXIS, nhelix);
+
     // Vector for offsetting helices
     double v[3] = { 0.0 };
 
@@ -1448,6 +2233,8 @@ void BackboneCoiledCoil::symmetry_axis() {
 
 void BackboneCoiledCoil::terminate() {
 
+    CCB_TIMER(TERMINATE, 1);
+
     /* move all the coordinates + 1 index */
     int jstart = nres[0] * 4 - 1;
     for (int j = jstart; j > 0; j--) {
@@ -1471,6 +2258,8 @@ void BackboneCoiledCoil::terminate() {
 
 void BackboneCoiledCoil::terminate_asymmetric() {
 
+    CCB_TIMER(TERMINATE, nhelix);
+
     /* move all the coordinates + 1 index */
 
     for (int i = 0; i < nhelix; i++) {
@@ -1492,25 +2281,63 @@ void BackboneCoiledCoil::terminate_asymmetric() {
  * Constrains the pitch such that the global residues per turn
  * of the alpha-helix is always 3.5
  *
- * @param flag designates the types of constraints to apply to
- * @param flag the coiled-coil parameters during generation
- * @param idx asymmetric index, if applicable, if symmetric
- * @param idx idx = 0
- * @return calculated value
+ * The length of one superhelical turn along the helix,
+ * L = 3.5 * rpr * rpt / (rpt - 3.5), is also sqrt(P^2 + (2 pi r)^2)
+ * so the pitch follows in closed form for any radius.
+ *
+ * @param rpt residues per turn of the minor helix
+ * @param r superhelical radius
+ * @return calculated pitch
  */
-double BackboneCoiledCoil::fraser_macrae(int idx) {
+double BackboneCoiledCoil::fraser_macrae(double rpt, double r) {
 
     // Check if we're near rpt = 3.5, which gives inf pitch
-    if (fabs(3.5-rpt[idx]) < fabs(rpt[idx])*0.0001)
-        rpt[idx] = 3.5001;
+    if (fabs(3.5 - rpt) < fabs(rpt) * 0.0001)
+        rpt = 3.5001;
 
-    double a = (3.50 * rpr * rpt[idx] / (rpt[idx] - 3.5)) *
-               (3.50 * rpr * rpt[idx] / (rpt[idx] - 3.5));
-    double b = (2 * PI * radius[0]) * (2 * PI * radius[0]);
+    double a = (3.50 * rpr * rpt / (rpt - 3.5)) *
+               (3.50 * rpr * rpt / (rpt - 3.5));
+    double b = (2 * PI * r) * (2 * PI * r);
 
     return sqrt(a - b);
 }
 
+/**
+ * The inverse of fraser_macrae(), the residues per turn that
+ * keep the global residues per turn at 3.5 for a fixed pitch,
+ * rpt = 3.5 * L / (L - 3.5 * rpr) with L = sqrt(P^2 + (2 pi r)^2)
+ *
+ * @param pitch superhelical pitch
+ * @param r superhelical radius
+ * @return calculated residues per turn
+ */
+double BackboneCoiledCoil::fraser_macrae_rpt(double pitch, double r) {
+
+    double l = sqrt(pitch * pitch + (2 * PI * r) * (2 * PI * r));
+
+    // A turn shorter than 3.5 residues can't be satisfied
+    if (l <= 3.5 * rpr * 1.0001)
+        l = 3.5 * rpr * 1.0001;
+
+    return 3.5 * l / (l - 3.5 * rpr);
+}
+
+/**
+ * Residues per turn used to place residue j of helix i. Under
+ * the Fraser-MacRae rpt constraint this is solved from the local
+ * superhelical radius, the distance of the axis point from z.
+ */
+double BackboneCoiledCoil::local_rpt(int i, int j) {
+
+    if (!fm_rpt_flag)
+        return rpt[i];
+
+    double r = sqrt(axis_x[i][j][0] * axis_x[i][j][0] +
+                    axis_x[i][j][1] * axis_x[i][j][1]);
+
+    return fraser_macrae_rpt(pitch, r);
+}
+
 /**
  * Passes the coordinates to ccb by creating
  * or updating the domain on the fly and adding the atoms.
@@ -1518,12 +2345,16 @@ double BackboneCoiledCoil::fraser_macrae(int idx) {
 
 int BackboneCoiledCoil::update_domain() {
 
+    CCB_TIMER(UPDATE_DOMAIN, nhelix);
+
     Site *cursite = NULL;
     Atom *curatom = NULL;
     int serial = 1;
+    double p[3];
 
-    static const char *chainid[] = { "A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M",
-                                     "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z" };
+    // Single character chain ids, segids stay unique past the last one
+    static const char chainid[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+    static const int nchainid = sizeof(chainid) - 1;
 
     /**
      * Delete all the sites associated with the old
@@ -1551,17 +2382,17 @@ int BackboneCoiledCoil::update_domain() {
             int isite = domain->add_site();
             cursite = domain->site[isite];
 
-            // Set the site-bitmask for construction and atom inheritance
-            cursite->mask |= mask;
-
             // add a pointer to this site to this style
             if (add_site(cursite) != CCB_OK) return CCB_ERROR;
 
             // Set the site resid number, chain
             // and seg id
             cursite->resid = j + 1;
-            strcpy(cursite->chain, chainid[i]);
-            strcpy(cursite->seg, chainid[i]);
+            sprintf(cursite->chain, "%c", chainid[i % nchainid]);
+            if (i < nchainid)
+                strcpy(cursite->seg, cursite->chain);
+            else
+                sprintf(cursite->seg, "%c%d", chainid[i % nchainid], i / nchainid);
 
             // set the group properties
             strcpy(cursite->fixed_atoms->type, "GLY");
@@ -1573,9 +2404,10 @@ int BackboneCoiledCoil::update_domain() {
             curatom->serial = serial++;
             strcpy(curatom->name, "N");
 
-            curatom->x = x[hindex][offset][0];
-            curatom->y = x[hindex][offset][1];
-            curatom->z = x[hindex][offset][2];
+            get_coord(hindex, offset, p);
+            curatom->x = p[0];
+            curatom->y = p[1];
+            curatom->z = p[2];
 
             //curatom->backbone = true;
             curatom->fixed = true;
@@ -1585,7 +2417,7 @@ int BackboneCoiledCoil::update_domain() {
             curatom->group = cursite->fixed_atoms;
 
             // Set bitmask
-            curatom->mask |= mask;
+            bitmask->set(mask, curatom->index);
 
             // Add CA atom to the fixed_atoms group
             iatom = cursite->fixed_atoms->add_atom();
@@ -1594,9 +2426,10 @@ int BackboneCoiledCoil::update_domain() {
             curatom->serial = serial++;
             strcpy(curatom->name, "CA");
 
-            curatom->x = x[hindex][offset+1][0];
-            curatom->y = x[hindex][offset+1][1];
-            curatom->z = x[hindex][offset+1][2];
+            get_coord(hindex, offset + 1, p);
+            curatom->x = p[0];
+            curatom->y = p[1];
+            curatom->z = p[2];
 
             //curatom->backbone = true;
             curatom->fixed = true;
@@ -1606,7 +2439,7 @@ int BackboneCoiledCoil::update_domain() {
             curatom->group = cursite->fixed_atoms;
 
             // Set bitmask
-            curatom->mask |= mask;
+            bitmask->set(mask, curatom->index);
 
             // Add C atom to the fixed_atoms group
             iatom = cursite->fixed_atoms->add_atom();
@@ -1615,9 +2448,10 @@ int BackboneCoiledCoil::update_domain() {
             curatom->serial = serial++;
             strcpy(curatom->name, "C");
 
-            curatom->x = x[hindex][offset+2][0];
-            curatom->y = x[hindex][offset+2][1];
-            curatom->z = x[hindex][offset+2][2];
+            get_coord(hindex, offset + 2, p);
+            curatom->x = p[0];
+            curatom->y = p[1];
+            curatom->z = p[2];
 
             //curatom->backbone = true;
             curatom->fixed = true;
@@ -1627,7 +2461,7 @@ int BackboneCoiledCoil::update_domain() {
             curatom->group = cursite->fixed_atoms;
 
             // Set bitmask
-            curatom->mask |= mask;
+            bitmask->set(mask, curatom->index);
 
             // Add O atom to the fixed_atoms group
             iatom = cursite->fixed_atoms->add_atom();
@@ -1636,9 +2470,10 @@ int BackboneCoiledCoil::update_domain() {
             curatom->serial = serial++;
             strcpy(curatom->name, "O");
 
-            curatom->x = x[hindex][offset+3][0];
-            curatom->y = x[hindex][offset+3][1];
-            curatom->z = x[hindex][offset+3][2];
+            get_coord(hindex, offset + 3, p);
+            curatom->x = p[0];
+            curatom->y = p[1];
+            curatom->z = p[2];
 
             //curatom->backbone = true;
             curatom->fixed = true;
@@ -1648,7 +2483,7 @@ int BackboneCoiledCoil::update_domain() {
             curatom->group = cursite->fixed_atoms;
 
             // Set bitmask
-            curatom->mask |= mask;
+            bitmask->set(mask, curatom->index);
 
         }
     }
@@ -1659,7 +2494,7 @@ int BackboneCoiledCoil::update_domain() {
 
 void BackboneCoiledCoil::print_header() {
 
-    fprintf(screen, "\nGenerating a coiled-coil with the following parameters:\n"
+    trace->record("\nGenerating a coiled-coil with the following parameters:\n"
             "N helices:            %d\n"
             "Pitch (angstroms):    %.2f\n"
             "Radius (angstroms):   %.2f\n"
@@ -1676,9 +2511,9 @@ void BackboneCoiledCoil::print_header() {
             anti_flag, fm_flag);
 
     if (asymmetric_flag)
-        fprintf(screen, "Asymmetric Parameters:\n");
+        trace->record("Asymmetric Parameters:\n");
     for (int i = 0; i < nhelix; i++)
-        fprintf(screen,
+        trace->record(
                 "N residues:          %d: %3d\n"
                 "Rotation (degrees)   %d: %.2f\n"
                 "Squareness (degrees) %d: %.2f\n"
@@ -1693,12 +2528,12 @@ void BackboneCoiledCoil::print_header() {
                 i+1, z[i],
                 i+1, rpt[i],
                 i+1, ap_order[i]);
-    fprintf(screen, "\n\n");
+    trace->record("\n\n");
 }
 
 void BackboneCoiledCoil::print_help() {
 
-    fprintf(screen, "ccb -nhelix <# helices> -nres <# residues/helix> [-rpr <length>] [-pitch <length>] [-radius <length>] [-rpt <#>] [-rotation <angle>] [-square <angle>] [-zoff <length>] [-Z <length>] [-pdb <file name>] [-antiparallel 0 1 0 1] [-asymmetric] [-frasermacrae] [-xyz] [-newmol] [-v] [-help]\n");
+    fprintf(screen, "ccb -nhelix <# helices> -nres <# residues/helix> [-rpr <length>] [-pitch <length>] [-radius <length>] [-rpt <#>] [-rotation <angle>] [-square <angle>] [-zoff <length>] [-Z <length>] [-pdb <file name>] [-antiparallel 0 1 0 1] [-asymmetric] [-frasermacrae [pitch|rpt]] [-precision single|double [check]] [-xyz] [-newmol] [-v] [-help]\n");
 
 }
 
@@ -1878,17 +2713,28 @@ void BackboneCoiledCoil::inner_to_outer(double *&a, double *&b, double *&c, doub
 
 double BackboneCoiledCoil::memory_usage() {
 
-    // Coordinates of helix
-    double bytes = natom * 4 * sizeof(double);
+    // The style itself, including the inline parameter arrays
+    double bytes = sizeof(BackboneCoiledCoil);
+
+    // Per-helix parameters once they outgrow the inline arrays
+    if (nres != nres_inline)
+        bytes += maxhelix * (5 * sizeof(double) + 3 * sizeof(int));
+
+    // Radius of every residue
+    bytes += maxres * sizeof(double);
+
+    // Coordinates of the helices and their axes, as allocated
+    if (x) bytes += memory->usage_aligned(x, xrows, xatomlarge, 4);
+    if (axis_x) bytes += memory->usage_aligned(axis_x, xhelix, xatomlarge / 4 + 2, 4);
 
-    // Coordinates of helix axis
-    bytes += (nreslarge + 2) * 4 * sizeof(double);
+    // Single precision coordinates
+    if (xs) bytes += memory->usage_aligned(xs, xhelix, xatomlarge * 3);
 
     // Coordinates of peptide plane
-    bytes += 5 * 4 * sizeof(double);
+    bytes += memory->usage(pp_x, 5, 4);
 
-    // Sites
-    bytes += maxsite * sizeof(Site);
+    // Site list, the sites themselves belong to the domain
+    bytes += maxsite * sizeof(Site *);
 
     return bytes;
 }
@@ -48,22 +48,45 @@ BackboneStyle(coiledcoil,BackboneCoiledCoil)
 #include "pointers.h"
 #include "backbone.h"
 #include "site.h"
+#include "coiledcoil_params.h"
 
 /**
- * @def MAX_HELIX
+ * @def HELIX_INLINE
  *
- * @brief maximum number of asymmetric helices
+ * @brief number of helices whose parameters are stored in
+ * the instance, larger assemblies move them to the heap
  */
 
-#define MAX_HELIX 20
+#define HELIX_INLINE 8
 
 /**
- * @def MAX_RES
+ * @def RES_INLINE
  *
- * @brief maximum number residues per helix
+ * @brief number of residues per helix whose radius is stored
+ * in the instance, longer helices move it to the heap
  */
 
-#define MAX_RES 500
+#define RES_INLINE 128
+
+/**
+ * @def GEOMETRY_VERSION
+ *
+ * @brief Leads every cache key, bump it whenever a change
+ * moves the generated coordinates so stale cache files are
+ * never reused
+ */
+
+#define GEOMETRY_VERSION 1
+
+/**
+ * @def SINGLE_TOLERANCE
+ *
+ * @brief Largest deviation (Angstrom) of a single precision
+ * coordinate from the double precision build allowed when
+ * the single precision mode is checked
+ */
+
+#define SINGLE_TOLERANCE 1.0e-3
 
 namespace CCB_NS {
 
@@ -75,12 +98,40 @@ class BackboneCoiledCoil : public Backbone {
 
     // Member Functions
     int generate();                                              /**< build coiled-coil, update coordinates in x */
+    int generate_asymmetric();                                   /**< build each helix on its own axis, update coordinates in x */
     int update_domain();                                         /**< set the domain coordinates to the backbone coordianates*/
     int set_params(int argc, const char **argv, int n);          /**< set the backbone parameters before generation*/
 
+    // Binary parameters, no string parsing, see coiledcoil_params.h
+    int set_params(const CoiledCoilParams &p);                   /**< validate, then apply the fields named in p.set */
+    int check_params(const CoiledCoilParams &p);                 /**< CCB_OK if every field named in p.set is legal */
+    int set_nhelix(int n);
+    int set_pitch(double pitch);
+    int set_rpr(double rpr);
+    int set_radius(const double *r, int n);                      /**< r0_start [r0_end res_start res_end] */
+    int set_nres(const int *v, int n);
+    int set_rotation(const double *deg, int n);
+    int set_square(const double *deg, int n);
+    int set_rpt(const double *v, int n);
+    int set_zoff(const double *v, int n);
+    int set_z(const double *v, int n);
+    int set_order(const int *v, int n);
+    int set_antiparallel(bool on, const int *v, int n);          /**< v NULL keeps the up-down default */
+    int set_asymmetric(bool on);
+    int set_frasermacrae(bool on, bool rpt);
+    int set_precision(bool single, bool check);
+
+    // Coordinate caching
+    int pack_params(int64_t *buf, int max, double resolution);   /**< quantized parameters that determine the coordinates */
+    bigint ncoords();                                            /**< number of values written by pack_coords */
+    void pack_coords(double *buf);                               /**< copy x out, helices in turn */
+    int unpack_coords(const double *buf, bigint n);              /**< copy x back in and update the domain */
+    int pack_values(double *buf, int max);                       /**< parameters of the coil, one row of a table */
+
   protected:
     virtual int init_style();                                     /**< Initialize the style (declare member variables, etc.. */
     virtual int update_style(int argc, const char **argv, int n); /**< Update the parameters and re-generate the structure */
+    virtual int update_style(const CoiledCoilParams &p);          /**< Update from binary parameters */
     virtual int generate_style();                                 /**< Generate coordinates */
 
   private:
@@ -102,30 +153,59 @@ class BackboneCoiledCoil : public Backbone {
     double omega_alpha;           /**< minor helix angular yield per residue; 2*pi/rpt */
 
     // Radius expansion/contraction
-    double radius[MAX_RES];       /**<Radius of the coiled-coil*/
+    double *radius;               /**<Radius of the coiled-coil, per residue*/
+    int maxres;                   /**< length of radius */
     double r0_params[4];          /**<Array of radius parameters for expansion/contraction r0_start, r0_end, res_start, res_end */
 
-    // Asymmetric Parameters
-    int nres[MAX_HELIX];          /**< number of residues per helix */
-    double rotation[MAX_HELIX];   /**< rotation of the helices, for asymmetric, a list of rotations for each helix */
-    double rpt[MAX_HELIX];        /**< residues per turn of the helices */
-    double zoff[MAX_HELIX];       /**< z-axis displacement of helices along their axis, for asymmetric, a list of offsets for each helix */
-    double z[MAX_HELIX];          /**< z-axis displacement of helices along the coiled-coil axis*/
-    double square[MAX_HELIX];     /**< phi_0 offset in addition to the normal 2*pi/i placement about the superhelix */
+    // Asymmetric Parameters, each array holds maxhelix entries
+    int maxhelix;                 /**< length of the per-helix parameter arrays */
+    int *nres;                    /**< number of residues per helix */
+    double *rotation;             /**< rotation of the helices, for asymmetric, a list of rotations for each helix */
+    double *rpt;                  /**< residues per turn of the helices */
+    double *zoff;                 /**< z-axis displacement of helices along their axis, for asymmetric, a list of offsets for each helix */
+    double *z;                    /**< z-axis displacement of helices along the coiled-coil axis*/
+    double *square;               /**< phi_0 offset in addition to the normal 2*pi/i placement about the superhelix */
 
     bool asymmetric_flag;         /**< Are the helices in the coiled-coil symmetric? **/
     bool rebuild_domain;          /**< if true, we erase the existing coiled coil when we update */
 
     double **pp_x;                /**< 2D-array of initial peptide-plane coordinates */
     double ***axis_x;             /**< coordinates of the minor-helical axis */
-    double ***x;                  /**< 3D-array of coordinates for coiled-coil */
+    double ***x;                  /**< 3D-array of coordinates for coiled-coil, only helix 0 when xs holds the mates */
+
+    // Single precision mode, the helix is walked in double precision
+    // but its symmetry mates are built and stored in single precision
+    bool single_flag;             /**< store coordinates in xs rather than x */
+    bool check_flag;              /**< compare xs against the double precision build */
+    float **xs;                   /**< x, y, z of each atom per helix when single_flag */
+    int check_single();           /**< deviation of xs from the double precision build */
+    void store_single();          /**< round x into xs */
+    void get_coord(int i, int j, double *p); /**< coordinates of atom j of helix i */
 
     //Order of output by chain
-    int order[MAX_HELIX];         /**< Order of chain output, e.g. {0 3 1 2} switches {A B C D} to {A D B C} */
+    int *order;                   /**< Order of chain output, e.g. {0 3 1 2} switches {A B C D} to {A D B C} */
 
     // Specify Antiparallel and individual helical orientations
     bool anti_flag;               /**< antiparallel flag, specifies construction of antiparallel coiled-coil */
-    int ap_order[MAX_HELIX];      /**< Specifies order of helices with respect to first helix. e.g. an up-down-up is 0 1 0 */
+    int *ap_order;                /**< Specifies order of helices with respect to first helix. e.g. an up-down-up is 0 1 0 */
+
+    // Inline storage for the parameters of small coiled-coils
+    double radius_inline[RES_INLINE];
+    int nres_inline[HELIX_INLINE];
+    double rotation_inline[HELIX_INLINE];
+    double rpt_inline[HELIX_INLINE];
+    double zoff_inline[HELIX_INLINE];
+    double z_inline[HELIX_INLINE];
+    double square_inline[HELIX_INLINE];
+    int order_inline[HELIX_INLINE];
+    int ap_order_inline[HELIX_INLINE];
+
+    int grow_helix(int n);        /**< make room for parameters of n helices */
+    int grow_res(int n);          /**< make room for the radius of n residues */
+    void helix_defaults(int lo, int hi); /**< default parameters for helices lo to hi-1 */
+    void update_derived();        /**< omega, atom counts and symmetric copies after the parameters change */
+    int check_list(const void *v, int n, const char *name); /**< a per-helix list is well formed */
+    static double wrap_angle(double deg); /**< fold an angle onto [-180, 180] */
 
     Site **site;                  /**< Array of sites that this style created and can update or delete */
     unsigned int nsite;           /**< current number of sites that belong to this style */
@@ -134,16 +214,32 @@ class BackboneCoiledCoil : public Backbone {
 
     int mask;                     /**< sets the backbone atom's bitmask */
 
+    // Generation kernels, specialized on the modes and picked once per generate call
+    typedef void (BackboneCoiledCoil::*HelixKernel)(int);
+    typedef void (BackboneCoiledCoil::*SymmetryKernel)();
+
+    template <bool ASYM, bool FM_RPT, bool DEBUG>
+    void build_helix(int i);        /**< build helix i along its axis */
+    HelixKernel helix_kernel(bool asym); /**< build_helix for the current modes */
+
+    template <bool ANTI, int NHELIX, bool SINGLE>
+    void symmetry();                /**< apply symmetry operations to helix to generate coil */
+    SymmetryKernel symmetry_kernel(bool single); /**< symmetry for the current modes */
+
     void build_plane();             /**< build the first peptide plane */
     void align_plane(double *w);    /**< align the peptide-plane rotation vector with w (axis) */
     void helix_axis(); /**< generate the axis of the minor helix */
-    void symmetry();                /**< apply symmetry operations to helix to generate coil */
     void azzero();                  /**< zero out coordinates in x array */
     int allocate();                /**< increase size of x, axis if necessary */
+    int xhelix;                    /**< number of helices axis_x and xs were allocated for */
+    int xrows;                     /**< number of helices x was allocated for */
+    unsigned int xatomlarge;       /**< atoms per helix x was allocated for */
 
 
+    template <bool DEBUG>
     void get_pp_params(double *axis0, double *axis1,
                        double *u, double *v, double *r, double &theta);             /**< Determines the screw-rotation parameters from the peptide plane */
+    void print_pp_params(double *u, double *v, double *r, double theta);            /**< Prints the screw-rotation parameters */
     void crick(double *u, double rho, double *r1, double *r2);       /**< Sets the rotation angle to correspond to the crick angle */
     void next_plane(double *u, double *v, double theta);             /**< Generates the next plane given u, v, theat */
     void terminate();                                                /**< Adds the n-terminal nitrogen, rearranges coordinates */
@@ -153,11 +249,13 @@ class BackboneCoiledCoil : public Backbone {
 
     // Stuff for asymmetry
     void symmetry_axis();
-    int generate_asymmetric();
 
     // Constraint functions
     bool fm_flag;                         /**<apply the fraser-macrae constraint?  */
-    double fraser_macrae(int idx);        /**< Constrain the pitch to rpt (Fraser & MacRae) */
+    bool fm_rpt_flag;                     /**< solve rpt for the pitch rather than the pitch for rpt */
+    double fraser_macrae(double rpt, double r);       /**< Constrain the pitch to rpt at radius r (Fraser & MacRae) */
+    double fraser_macrae_rpt(double pitch, double r); /**< Constrain rpt to the pitch at radius r (Fraser & MacRae) */
+    double local_rpt(int i, int j);       /**< residues per turn of residue j of helix i */
 
     /**
      * Helper Functions
@@ -178,18 +276,19 @@ class BackboneCoiledCoil : public Backbone {
 
     // Hardcoded bond lenghts and angles for
     // peptide plane construction
+    // taken from CHARMM27 RESI GLY
 
     // bond lengths
-    double ca_c;
-    double c_o;
-    double c_n;
-    double n_ca;
+    static const double ca_c;
+    static const double c_o;
+    static const double c_n;
+    static const double n_ca;
 
     //bond angles
-    double ca_c_o;
-    double ca_c_n;
-    double c_n_ca;
-    double n_ca_c;
+    static const double ca_c_o;
+    static const double ca_c_n;
+    static const double c_n_ca;
+    static const double n_ca_c;
 
 };
 }
@@ -0,0 +1,577 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   topology_coiledcoil.cpp
+ * @date   Mon Oct 19 15:10:52 2026
+ *
+ * @brief  Coiled-coil topology detection from coordinates
+ *
+ * A single pass over the domain finds the chain breaks and a
+ * second pass per helix fits its axis, so the whole detection
+ * is linear in the number of sites.
+ */
+
+#include "math.h"
+#include "stdio.h"
+#include "string.h"
+#include "topology_coiledcoil.h"
+#include "error.h"
+#include "memory.h"
+#include "universe.h"
+#include "domain.h"
+#include "site.h"
+#include "group.h"
+#include "atom.h"
+#include "bitmask.h"
+#include "math_extra.h"
+#include "trace.h"
+
+/**
+ * @def MIN_HELIX_RES
+ *
+ * @brief chains shorter than this are not treated as helices
+ */
+
+#define MIN_HELIX_RES 4
+
+using namespace CCB_NS;
+using namespace MathExtra;
+
+/**
+ * @brief dominant eigenvector of a symmetric 3x3 matrix
+ *
+ * @param m the matrix
+ * @param v start vector, returns the normalized eigenvector
+ * @return the eigenvalue
+ */
+
+static double power_iteration(double m[3][3], double *v) {
+
+    double b[3];
+    for (int iter = 0; iter < 100; iter++) {
+        matvec(m, v, b);
+        if (len3(b) == 0.0) return 0.0;
+        norm3(b);
+        double delta = 1.0 - dot3(v, b);
+        v[0] = b[0]; v[1] = b[1]; v[2] = b[2];
+        if (fabs(delta) < 1e-12) break;
+    }
+
+    matvec(m, v, b);
+    return dot3(v, b);
+}
+
+/**
+ * @brief find a named atom in the fixed atoms of a site
+ *
+ * @return the atom or NULL if it isn't there or isn't in mask
+ */
+
+static Atom *find_backbone(Bitmask *bitmask, Site *s, const char *name, int mask) {
+
+    Group *g = s->fixed_atoms;
+    for (int i = 0; i < g->natom; i++)
+        if (bitmask->test(mask, g->atom[i]->index) && strcmp(g->atom[i]->name, name) == 0)
+            return g->atom[i];
+
+    return NULL;
+}
+
+TopologyCoiledCoil::TopologyCoiledCoil(CCB *ccb) :
+        Pointers(ccb),
+        nhelix(0),
+        nres(NULL),
+        ap_order(NULL),
+        order(NULL),
+        anti_flag(false),
+        first(NULL),
+        last(NULL),
+        axis(NULL),
+        com(NULL),
+        crossing(NULL),
+        radius(0.0),
+        cutoff(2.0),
+        maxhelix(0),
+        count(NULL),
+        anti(NULL),
+        rank(NULL),
+        ang(NULL),
+        maxarg(0),
+        argbuf(NULL),
+        args(NULL)
+{
+    zero3(bundle_axis);
+    zero3(center);
+}
+
+TopologyCoiledCoil::~TopologyCoiledCoil() {
+
+    memory->destroy(nres);
+    memory->destroy(ap_order);
+    memory->destroy(order);
+    memory->destroy(first);
+    memory->destroy(last);
+    memory->destroy(axis);
+    memory->destroy(com);
+    memory->destroy(crossing);
+    memory->destroy(count);
+    memory->destroy(anti);
+    memory->destroy(rank);
+    memory->destroy(ang);
+    memory->destroy(argbuf);
+    memory->sfree(args);
+}
+
+/**
+ * Make room in the per-helix arrays for n helices
+ */
+int TopologyCoiledCoil::grow(int n) {
+
+    if (n <= maxhelix)
+        return CCB_OK;
+
+    maxhelix = maxhelix ? 2 * maxhelix : 8;
+    if (maxhelix < n) maxhelix = n;
+
+    memory->grow(nres, maxhelix, "topology:nres");
+    memory->grow(ap_order, maxhelix, "topology:ap_order");
+    memory->grow(order, maxhelix, "topology:order");
+    memory->grow(first, maxhelix, "topology:first");
+    memory->grow(last, maxhelix, "topology:last");
+    memory->grow(axis, maxhelix, 3, "topology:axis");
+    memory->grow(com, maxhelix, 3, "topology:com");
+    memory->grow(crossing, maxhelix, "topology:crossing");
+    memory->grow(count, maxhelix, "topology:count");
+    memory->grow(anti, maxhelix, "topology:anti");
+    memory->grow(rank, maxhelix, "topology:rank");
+    memory->grow(ang, maxhelix, "topology:ang");
+
+    if (nres == NULL || ap_order == NULL || order == NULL || first == NULL ||
+        last == NULL || axis == NULL || com == NULL || crossing == NULL ||
+        count == NULL || anti == NULL || rank == NULL || ang == NULL)
+        return error->one(FLERR, "CCB: could not allocate topology");
+
+    return CCB_OK;
+}
+
+/**
+ * Detect the helices, their orientation and their order
+ * about the bundle axis.
+ *
+ * @param mask only atoms in mask are considered
+ */
+
+int TopologyCoiledCoil::detect(int mask) {
+
+    nhelix = 0;
+    anti_flag = false;
+
+    // Find the chain breaks, a new helix starts when the chain
+    // changes or the peptide bond to the previous residue is broken
+    Site *prev = NULL;
+    Atom *prev_c = NULL;
+    Atom *prev_ca = NULL;
+    int nchain = 0;
+
+    for (int i = 0; i < domain->nsite; i++) {
+
+        Site *s = domain->site[i];
+
+        Atom *ca = find_backbone(bitmask, s, "CA", mask);
+        if (ca == NULL) continue;
+
+        Atom *n = find_backbone(bitmask, s, "N", mask);
+        Atom *c = find_backbone(bitmask, s, "C", mask);
+
+        bool brk = prev == NULL || strcmp(prev->chain, s->chain) != 0 ||
+                   strcmp(prev->seg, s->seg) != 0;
+
+        if (!brk) {
+            double d[3];
+            if (prev_c != NULL && n != NULL) {
+                d[0] = n->x - prev_c->x;
+                d[1] = n->y - prev_c->y;
+                d[2] = n->z - prev_c->z;
+                brk = lensq3(d) > cutoff * cutoff;
+            } else {
+                // Missing N or C, fall back on the CA-CA distance
+                d[0] = ca->x - prev_ca->x;
+                d[1] = ca->y - prev_ca->y;
+                d[2] = ca->z - prev_ca->z;
+                brk = lensq3(d) > 4.2 * 4.2;
+            }
+        }
+
+        if (brk) {
+            // Drop the previous chain if it's too short to be a helix
+            if (nchain > 0 && count[nchain - 1] < MIN_HELIX_RES)
+                nchain--;
+
+            if (grow(nchain + 1) != CCB_OK)
+                return CCB_ERROR;
+
+            first[nchain] = i;
+            count[nchain] = 0;
+            nchain++;
+        }
+
+        last[nchain - 1] = i;
+        count[nchain - 1]++;
+
+        prev = s;
+        prev_c = c;
+        prev_ca = ca;
+    }
+
+    if (nchain > 0 && count[nchain - 1] < MIN_HELIX_RES)
+        nchain--;
+
+    if (nchain == 0)
+        return error->one(FLERR, "CCB: topology found no helices");
+
+    // Fit the axis of each helix
+    for (int k = 0; k < nchain; k++)
+        if (fit_axis(first[k], last[k], mask, com[k], axis[k]) != CCB_OK)
+            return CCB_ERROR;
+
+    zero3(center);
+    for (int k = 0; k < nchain; k++)
+        for (int d = 0; d < 3; d++)
+            center[d] += com[k][d] / nchain;
+
+    // First guess at the bundle axis, the helix axes averaged with
+    // their direction taken relative to the first helix
+    double guess[2][3];
+    int nguess = 1;
+
+    zero3(guess[0]);
+    for (int k = 0; k < nchain; k++) {
+        double s = dot3(axis[k], axis[0]) < 0.0 ? -1.0 : 1.0;
+        for (int d = 0; d < 3; d++)
+            guess[0][d] += s * axis[k][d];
+    }
+    norm3(guess[0]);
+
+    // Wide barrels cross at large angles and the average tilts
+    // toward the first helix, the normal to the ring of helix
+    // centers is a better guess when the centers span a plane
+    if (nchain >= 3) {
+        double m[3][3], e1[3], e2[3], tmp[3];
+        zero3(m);
+        for (int k = 0; k < nchain; k++) {
+            double d[3];
+            sub3(com[k], center, d);
+            for (int p = 0; p < 3; p++)
+                for (int q = 0; q < 3; q++)
+                    m[p][q] += d[p] * d[q];
+        }
+
+        sub3(com[0], center, e1);
+        if (len3(e1) > 0.0) {
+            norm3(e1);
+            double l1 = power_iteration(m, e1);
+
+            // Deflate and find the second direction in the plane
+            cross3(e1, guess[0], e2);
+            if (len3(e2) > 0.0) {
+                norm3(e2);
+                double md[3][3];
+                for (int p = 0; p < 3; p++)
+                    for (int q = 0; q < 3; q++)
+                        md[p][q] = m[p][q] - l1 * e1[p] * e1[q];
+                double l2 = power_iteration(md, e2);
+
+                if (l2 > 0.1 * l1) {
+                    cross3(e1, e2, tmp);
+                    norm3(tmp);
+                    if (dot3(tmp, axis[0]) < 0.0) negate3(tmp);
+                    guess[1][0] = tmp[0]; guess[1][1] = tmp[1]; guess[1][2] = tmp[2];
+                    nguess = 2;
+                }
+            }
+        }
+    }
+
+    // Refine each guess and keep the one the helices are most
+    // nearly tangent to
+    double best = HUGE_VAL;
+    for (int g = 0; g < nguess; g++) {
+        double cost = refine_axis(nchain, guess[g]);
+        if (cost < best) {
+            best = cost;
+            bundle_axis[0] = guess[g][0];
+            bundle_axis[1] = guess[g][1];
+            bundle_axis[2] = guess[g][2];
+        }
+    }
+
+    // Antiparallel w.r.t the bundle axis, which points along the first helix
+    for (int k = 0; k < nchain; k++) {
+        anti[k] = dot3(axis[k], bundle_axis) < 0.0;
+        if (anti[k]) anti_flag = true;
+    }
+
+    // Angle of each helix about the bundle axis, counter-clockwise
+    // from the first helix looking down the axis
+    double p0[3];
+    radius = 0.0;
+    for (int k = 0; k < nchain; k++) {
+        double p[3], t[3];
+        sub3(com[k], center, p);
+        snormalize3(dot3(p, bundle_axis), bundle_axis, t);
+        sub3(p, t, p);
+        radius += len3(p) / nchain;
+
+        if (k == 0) {
+            p0[0] = p[0]; p0[1] = p[1]; p0[2] = p[2];
+        }
+
+        cross3(p0, p, t);
+        ang[k] = atan2(dot3(t, bundle_axis), dot3(p0, p));
+        if (ang[k] < 0.0) ang[k] += 2 * PI;
+
+        double c = fabs(dot3(axis[k], bundle_axis));
+        crossing[k] = acos(c > 1.0 ? 1.0 : c) * RAD2DEG;
+    }
+
+    // Rank the helices by angle, chain k is helix order[k] of the bundle
+    for (int k = 0; k < nchain; k++) rank[k] = k;
+    for (int k = 1; k < nchain; k++)
+        for (int j = k; j > 0 && ang[rank[j]] < ang[rank[j - 1]]; j--) {
+            int tmp = rank[j];
+            rank[j] = rank[j - 1];
+            rank[j - 1] = tmp;
+        }
+
+    nhelix = nchain;
+    for (int h = 0; h < nhelix; h++) {
+        int k = rank[h];
+        order[k] = h;
+        nres[h] = count[k];
+        ap_order[h] = anti[k];
+    }
+
+    if (universe->me == 0 && CCB_TRACE_ON(3))
+        print_topology();
+
+    return CCB_OK;
+}
+
+/**
+ * Fit an axis to the CA atoms between two sites. The axis is the
+ * principal component of the CA positions, found by power iteration
+ * starting from the vector joining the first and last turn, which
+ * also fixes its direction from N to C.
+ *
+ * @param ifirst first domain site
+ * @param ilast last domain site
+ * @param mask only CA atoms in mask are used
+ * @param c returns the center of the CA atoms
+ * @param a returns the unit axis
+ */
+
+int TopologyCoiledCoil::fit_axis(int ifirst, int ilast, int mask, double *c, double *a) {
+
+    double cov[3][3];
+    double head[3], tail[3];
+    int n = 0, nhead = 0, ntail = 0;
+
+    zero3(c);
+    zero3(head);
+    zero3(tail);
+
+    for (int i = ifirst; i <= ilast; i++) {
+        Atom *ca = find_backbone(bitmask, domain->site[i], "CA", mask);
+        if (ca == NULL) continue;
+        c[0] += ca->x;
+        c[1] += ca->y;
+        c[2] += ca->z;
+        if (nhead < 4) {
+            head[0] += ca->x; head[1] += ca->y; head[2] += ca->z;
+            nhead++;
+        }
+        n++;
+    }
+
+    if (n < MIN_HELIX_RES)
+        return error->one(FLERR, "CCB: topology helix is too short to fit an axis");
+
+    scale3(1.0 / n, c);
+    scale3(1.0 / nhead, head);
+
+    zero3(cov);
+    for (int i = ifirst, j = 0; i <= ilast; i++) {
+        Atom *ca = find_backbone(bitmask, domain->site[i], "CA", mask);
+        if (ca == NULL) continue;
+        double d[3] = { ca->x - c[0], ca->y - c[1], ca->z - c[2] };
+        for (int p = 0; p < 3; p++)
+            for (int q = 0; q < 3; q++)
+                cov[p][q] += d[p] * d[q];
+        if (j++ >= n - 4) {
+            tail[0] += ca->x; tail[1] += ca->y; tail[2] += ca->z;
+            ntail++;
+        }
+    }
+    scale3(1.0 / ntail, tail);
+
+    sub3(tail, head, a);
+    norm3(a);
+
+    // The start vector is already close
+    power_iteration(cov, a);
+
+    // Keep the N to C direction
+    double d[3];
+    sub3(tail, head, d);
+    if (dot3(a, d) < 0.0) negate3(a);
+
+    return CCB_OK;
+}
+
+/**
+ * Refine a bundle axis. A coiled-coil helix only tilts tangentially
+ * about the bundle axis, so removing the tangential part of each
+ * helix axis leaves a vector along the bundle axis. The average of
+ * these is iterated to convergence.
+ *
+ * @param nchain number of helices
+ * @param a the axis to refine, pointing along the first helix
+ * @return sum of the squared radial components of the helix axes
+ */
+
+double TopologyCoiledCoil::refine_axis(int nchain, double *a) {
+
+    double cost = 0.0;
+
+    for (int iter = 0; iter < 50; iter++) {
+
+        double next[3];
+        zero3(next);
+        cost = 0.0;
+
+        for (int k = 0; k < nchain; k++) {
+            double r[3], t[3], v[3];
+
+            sub3(com[k], center, r);
+            snormalize3(dot3(r, a), a, t);
+            sub3(r, t, r);
+
+            v[0] = axis[k][0]; v[1] = axis[k][1]; v[2] = axis[k][2];
+
+            // A helix on the bundle axis has no tangent direction
+            if (len3(r) > 1e-6) {
+                norm3(r);
+                cost += dot3(v, r) * dot3(v, r);
+                cross3(a, r, t);
+                snormalize3(dot3(v, t), t, t);
+                sub3(v, t, v);
+            }
+
+            double s = dot3(v, a) < 0.0 ? -1.0 : 1.0;
+            for (int d = 0; d < 3; d++)
+                next[d] += s * v[d];
+        }
+
+        if (len3(next) == 0.0) break;
+        norm3(next);
+        if (dot3(next, axis[0]) < 0.0) negate3(next);
+
+        double delta = 1.0 - dot3(next, a);
+        a[0] = next[0]; a[1] = next[1]; a[2] = next[2];
+        if (fabs(delta) < 1e-12) break;
+    }
+
+    return cost;
+}
+
+/**
+ * Fill the parameter block from the detected topology
+ *
+ * @param argv set to the argument list, valid until the next detect()
+ * @return number of arguments
+ */
+
+int TopologyCoiledCoil::get_params(const char **&argv) {
+
+    int n = 0;
+
+    // -nhelix N -asymmetric -nres ... -antiparallel ... -order ...
+    int narg = 6 + 3 * nhelix;
+    if (narg > maxarg) {
+        maxarg = narg;
+        memory->grow(argbuf, maxarg, 16, "topology:argbuf");
+        args = (const char **) memory->srealloc(args, maxarg * sizeof(char *), "topology:args");
+        if (argbuf == NULL || args == NULL) {
+            error->one(FLERR, "CCB: could not allocate topology parameters");
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < maxarg; i++)
+        args[i] = argbuf[i];
+
+    strcpy(argbuf[n++], "-nhelix");
+    sprintf(argbuf[n++], "%d", nhelix);
+
+    // set_params copies nres[0] to every helix unless asymmetric
+    bool asymmetric = false;
+    for (int h = 1; h < nhelix; h++)
+        if (nres[h] != nres[0]) asymmetric = true;
+    if (asymmetric)
+        strcpy(argbuf[n++], "-asymmetric");
+
+    strcpy(argbuf[n++], "-nres");
+    for (int h = 0; h < nhelix; h++)
+        sprintf(argbuf[n++], "%d", nres[h]);
+
+    if (anti_flag) {
+        strcpy(argbuf[n++], "-antiparallel");
+        for (int h = 0; h < nhelix; h++)
+            sprintf(argbuf[n++], "%d", ap_order[h]);
+    }
+
+    strcpy(argbuf[n++], "-order");
+    for (int k = 0; k < nhelix; k++)
+        sprintf(argbuf[n++], "%d", order[k]);
+
+    argv = args;
+
+    return n;
+}
+
+void TopologyCoiledCoil::print_topology() {
+
+    fprintf(screen, "\n---------- CCB Topology ----------\n");
+    fprintf(screen, "nhelix: %d  radius: %.3f\n", nhelix, radius);
+    fprintf(screen, "chain  first  nres  order  ap  crossing\n");
+    for (int k = 0; k < nhelix; k++) {
+        Site *s = domain->site[first[k]];
+        fprintf(screen, "%-5s  %5d  %4d  %5d  %2d  %8.2f\n", s->chain, s->resid,
+                nres[order[k]], order[k], ap_order[order[k]], crossing[k]);
+    }
+    fprintf(screen, "----------------------------------\n");
+}
@@ -0,0 +1,99 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   topology_coiledcoil.h
+ * @date   Mon Oct 19 15:02:37 2026
+ *
+ * @brief  Coiled-coil topology detection from coordinates
+ *
+ * Splits the backbone in the domain into helices at chain breaks,
+ * fits an axis to each helix and works out which helices run
+ * antiparallel to the first and the order of the helices about
+ * the bundle axis. The result is returned as an argument list
+ * that can be passed directly to BackboneCoiledCoil::set_params,
+ * e.g. -nhelix 4 -nres 28 28 28 28 -antiparallel 0 1 0 1 -order 0 1 2 3
+ */
+
+#ifndef CCB_TOPOLOGY_COILEDCOIL_H
+#define CCB_TOPOLOGY_COILEDCOIL_H
+
+#include "pointers.h"
+#include "backbone_coiledcoil.h"
+
+namespace CCB_NS {
+
+class TopologyCoiledCoil : protected Pointers {
+
+  public:
+    TopologyCoiledCoil(class CCB *);
+    ~TopologyCoiledCoil();
+
+    int detect(int mask = 0);                 /**< detect the topology of the atoms in mask */
+    int get_params(const char **&argv);       /**< parameter block for set_params, returns argc */
+
+    // Parameter block
+    int nhelix;                   /**< number of helices found */
+    int *nres;                    /**< residues per helix, in set_params (bundle) order */
+    int *ap_order;                /**< 1 if the helix is antiparallel to the first */
+    int *order;                   /**< helix written as each chain, as in BackboneCoiledCoil */
+    bool anti_flag;               /**< at least one helix is antiparallel */
+
+    // Per-chain geometry, in domain (chain) order
+    int *first;                   /**< first domain site of each chain */
+    int *last;                    /**< last domain site of each chain */
+    double **axis;                /**< unit axis of each chain, N to C */
+    double **com;                 /**< center of the CA atoms of each chain */
+    double *crossing;             /**< angle between each chain and the bundle axis (degrees) */
+
+    // Bundle geometry
+    double bundle_axis[3];        /**< average helix axis, parallel to the first helix */
+    double center[3];             /**< center of the bundle */
+    double radius;                /**< mean distance of the helix centers from the bundle axis */
+
+    double cutoff;                /**< C-N distance above which the chain is broken */
+
+  private:
+    int fit_axis(int ifirst, int ilast, int mask, double *c, double *a); /**< principal axis of the CA atoms */
+    double refine_axis(int nchain, double *a); /**< refine the bundle axis from the helix axes */
+    void print_topology();
+
+    int maxhelix;                 /**< length of the per-helix arrays */
+    int grow(int n);              /**< make room for n helices */
+
+    // Scratch used while ordering the helices
+    int *count;
+    int *anti;
+    int *rank;
+    double *ang;
+
+    int maxarg;                   /**< length of the parameter block storage */
+    char **argbuf;                /**< storage for the parameter block */
+    const char **args;
+};
+}
+
+#endif
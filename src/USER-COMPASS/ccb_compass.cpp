@@ -131,6 +131,20 @@ int CCB_Compass::init(const int argc, const char **argv)
     return PLUGIN_OK;
 }
 
+int CCB_Compass::update(const CCB_NS::CoiledCoilParams &p)
+{
+
+    if (!init_done) {
+        std::cout << "CCB:Update: You must call 'init' first" << std::endl;
+        return PLUGIN_FAIL;
+    }
+
+    if (ccb->backbone->update_backbone(name,p) != CCB_OK)
+        return PLUGIN_FAIL;
+
+    return PLUGIN_OK;
+}
+
 int CCB_Compass::compute(int UNUSED(flag))
 {
 
@@ -32,6 +32,7 @@
 #include <vector>
 #include "plugin_baseclass.h"
 #include "ccb.h"
+#include "coiledcoil_params.h"
 #include "plugin.h"
 
 extern "C"
@@ -61,6 +62,10 @@ class CCB_Compass : public Plugin_BaseClass
     virtual double single(int,int);
     virtual bool get_atomic_data(std::vector<pluginatomic_t> &);
 
+    // Binary parameters for callers that link the plugin directly,
+    // skips the string options that init passes along
+    int update(const CCB_NS::CoiledCoilParams &);
+
    private:
      int init_done;
 
@@ -36,6 +36,41 @@
  * %load libccb.so
  * then call it using the "ccb" command
  *
+ * ccb -topology fname returns the coiled-coil parameters
+ * detected from the structure in fname (pdb or cif) instead
+ * of building a coil.
+ *
+ * ccb ... -clash cutoff screens the coil for atoms in different
+ * chains closer than cutoff before any output. If there are
+ * clashes nothing is written and the number of clashing pairs
+ * is returned, otherwise the command behaves as usual.
+ *
+ * ccb -cache N keeps a ccb instance alive between calls with an
+ * LRU cache of the last N coiled-coils built, so repeated
+ * parameter sets skip generation. -cache 0 releases it.
+ * ccb -cachedir path also keeps the coils built in path so later
+ * runs and other processes can reuse them.
+ * ccb -cacheres r quantizes the parameters to steps of r Angstrom
+ * and degrees before the lookup, so nearby sets share a coil.
+ * ccb -cachestats returns {hits misses evictions entries disk}.
+ *
+ * ccb -stats on keeps a ccb instance alive like -cache and times
+ * the phases of every call on it, -stats off stops timing and
+ * -stats reset zeros the counts. ccb -stats returns a dict of
+ * phase {calls items seconds}. ccb -stats json fname writes the
+ * same as JSON to fname when the instance is released.
+ *
+ * ccb ... -memory returns the memory held once the command is done
+ * instead of the usual result, as a dict with the live and peak
+ * bytes, the number of allocations, the bytes held by the domain,
+ * backbones and cache, and a tags entry of name {live peak allocs}
+ * for every named allocation. Without a coil to build it reports
+ * the instance kept by -cache or -stats.
+ *
+ * ccb ... -select "text" limits -pdb, -xyz, -newmol, -clash and
+ * -topology to the atoms matching the selection text, e.g.
+ * "name CA and chain A B" (see select.h).
+ *
  */
 
 #include <stdio.h>
@@ -48,11 +83,18 @@
 #include "backbonehandler.h"
 #include "backbone.h"
 #include "ccbio.h"
+#include "bitmask.h"
 #include "output.h"
 #include "domain.h"
 #include "site.h"
 #include "group.h"
 #include "atom.h"
+#include "topology_coiledcoil.h"
+#include "coiledcoil_params.h"
+#include "clash.h"
+#include "cache.h"
+#include "timer.h"
+#include "memory.h"
 
 /**
  * @def BLEN
@@ -62,11 +104,12 @@
 #define BLEN 64
 
 /**
- * @def MAX_ARGS
- * @brief Maximim number of argumets to parse
+ * @def ARGS_INLINE
+ * @brief Number of arguments parsed without allocating,
+ * longer argument lists are allocated to fit
  */
 
-#define MAX_ARGS 64
+#define ARGS_INLINE 64
 
 //Error flags for CCB
 //#define CCB_OK 0
@@ -75,28 +118,214 @@
 using namespace CCB_NS;
 
 /**
- * @brief parse commands
+ * @brief delete a ccb instance unless it is the one kept for caching
+ */
+
+static void release_ccb(CCB *ccb, CCB **keep) {
+    if (ccb != *keep) delete ccb;
+}
+
+/**
+ * @brief read the numbers that follow an option
  *
- * @param ccb ccb pointer
- * @param interp tcl interp pointer
- * @param objc number of tcl objects passed
- * @param objv object array
+ * @param n number of objects
+ * @param objs the style options
+ * @param k position of the first value, left on the next option
+ * @param v filled with the values
+ *
+ * @return number of values read
+ */
+
+static int tcl_values(int n, Tcl_Obj **objs, int &k, double *v) {
+
+    int nv = 0;
+    while (k < n && Tcl_GetDoubleFromObj(NULL, objs[k], &v[nv]) == TCL_OK) {
+        nv++;
+        k++;
+    }
+    return nv;
+}
+
+/**
+ * @brief read the style options straight into binary parameters
+ *
+ * Values are taken with Tcl_GetDoubleFromObj, so a number that
+ * is already a double is never printed and parsed again. An
+ * option the parameters can't express, a repeated option or a
+ * malformed list returns TCL_ERROR and the caller falls back to
+ * the string options, which also report any error.
+ *
+ * @param n number of objects
+ * @param objs the style options
+ * @param p filled with the parameters
+ * @param dbuf storage for the values, n long
+ * @param ibuf storage for the integer lists, n long
  *
  * @return TCL_OK/TCL_ERROR
  */
 
-/* Tcl plugin wrapper. it parses the arguments, calls the
-   real code and then passes the result to the interpreter. */
-int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
-            int objc, Tcl_Obj *const objv[])
+static int tcl_params(int n, Tcl_Obj **objs, CoiledCoilParams &p,
+                      double *dbuf, int *ibuf) {
+
+    int k = 0;
+    while (k < n) {
+
+        const char *opt = Tcl_GetString(objs[k++]);
+        double *v = dbuf + k;
+        int *iv = ibuf + k;
+        int nv = tcl_values(n, objs, k, v);
+        for (int i = 0; i < nv; i++)
+            iv[i] = (int) v[i];
+
+        unsigned int bit = 0;
+
+        if (strcmp(opt, "-pitch") == 0 && nv == 1) {
+            bit = CoiledCoilParams::PITCH;
+            p.pitch = v[0];
+        } else if (strcmp(opt, "-rpr") == 0 && nv == 1) {
+            bit = CoiledCoilParams::RPR;
+            p.rpr = v[0];
+        } else if (strcmp(opt, "-nhelix") == 0 && nv == 1) {
+            bit = CoiledCoilParams::NHELIX;
+            p.nhelix = iv[0];
+        } else if (strcmp(opt, "-radius") == 0 && nv >= 1 && nv <= 4) {
+            bit = CoiledCoilParams::RADIUS;
+            for (int i = 0; i < nv; i++)
+                p.radius[i] = v[i];
+            p.nradius = nv;
+        } else if (strcmp(opt, "-nres") == 0 && nv > 0) {
+            bit = CoiledCoilParams::NRES;
+            p.nres = iv;
+            p.nnres = nv;
+        } else if (strcmp(opt, "-rotation") == 0 && nv > 0) {
+            bit = CoiledCoilParams::ROTATION;
+            p.rotation = v;
+            p.nrotation = nv;
+        } else if (strcmp(opt, "-square") == 0 && nv > 0) {
+            bit = CoiledCoilParams::SQUARE;
+            p.square = v;
+            p.nsquare = nv;
+        } else if (strcmp(opt, "-rpt") == 0 && nv > 0) {
+            bit = CoiledCoilParams::RPT;
+            p.rpt = v;
+            p.nrpt = nv;
+        } else if (strcmp(opt, "-zoff") == 0 && nv > 0) {
+            bit = CoiledCoilParams::ZOFF;
+            p.zoff = v;
+            p.nzoff = nv;
+        } else if (strcmp(opt, "-Z") == 0 && nv > 0) {
+            bit = CoiledCoilParams::Z;
+            p.z = v;
+            p.nz = nv;
+        } else if (strcmp(opt, "-order") == 0 && nv > 0) {
+            bit = CoiledCoilParams::ORDER;
+            p.order = iv;
+            p.norder = nv;
+        } else if (strcmp(opt, "-antiparallel") == 0) {
+            bit = CoiledCoilParams::ANTIPARALLEL;
+            p.antiparallel = 1;
+            p.ap_order = nv ? iv : NULL;
+            p.nap_order = nv;
+        } else if (strcmp(opt, "-asymmetric") == 0 && nv == 0) {
+            bit = CoiledCoilParams::ASYMMETRIC;
+            p.asymmetric = 1;
+        } else if (strcmp(opt, "-frasermacrae") == 0 && nv == 0) {
+            bit = CoiledCoilParams::FRASERMACRAE;
+            p.frasermacrae = 1;
+
+            const char *next = k < n ? Tcl_GetString(objs[k]) : "";
+            if (strcmp(next, "rpt") == 0 || strcmp(next, "pitch") == 0) {
+                bit |= CoiledCoilParams::FM_RPT;
+                p.fm_rpt = next[0] == 'r';
+                k++;
+            }
+        } else if (strcmp(opt, "-precision") == 0 && nv == 0 && k < n) {
+            bit = CoiledCoilParams::PRECISION;
+
+            const char *mode = Tcl_GetString(objs[k++]);
+            if (strcmp(mode, "single") == 0) p.single = 1;
+            else if (strcmp(mode, "double") != 0) return TCL_ERROR;
+
+            if (k < n && strcmp(Tcl_GetString(objs[k]), "check") == 0) {
+                p.check = 1;
+                k++;
+            }
+        }
+
+        if (bit == 0 || (p.set & bit))
+            return TCL_ERROR;
+        p.set |= bit;
+    }
+
+    return TCL_OK;
+}
+
+/**
+ * @brief memory report of a ccb instance as a dict
+ */
+
+static Tcl_Obj *memory_dict(Tcl_Interp *interp, CCB *ccb) {
+
+    Tcl_Obj *result = Tcl_NewListObj(0,NULL);
+    Memory *m = ccb ? ccb->memory : NULL;
+
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewStringObj("live",-1));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewWideIntObj(m ? m->live : 0));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewStringObj("peak",-1));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewWideIntObj(m ? m->peak : 0));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewStringObj("allocs",-1));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewWideIntObj(m ? m->nalloc : 0));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewStringObj("domain",-1));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewWideIntObj(ccb ? (Tcl_WideInt) ccb->domain->memory_usage() : 0));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewStringObj("backbone",-1));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewWideIntObj(ccb ? (Tcl_WideInt) ccb->backbone->memory_usage() : 0));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewStringObj("cache",-1));
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewWideIntObj(ccb && ccb->backbone->cache ?
+                                                             (Tcl_WideInt) ccb->backbone->cache->memory_usage() : 0));
+
+    Tcl_Obj *tags = Tcl_NewListObj(0,NULL);
+    for (int i = 0; m && i < m->ntag; i++) {
+        Tcl_Obj *t = Tcl_NewListObj(0,NULL);
+        Tcl_ListObjAppendElement(interp,t,Tcl_NewWideIntObj(m->tag[i].live));
+        Tcl_ListObjAppendElement(interp,t,Tcl_NewWideIntObj(m->tag[i].peak));
+        Tcl_ListObjAppendElement(interp,t,Tcl_NewWideIntObj(m->tag[i].nalloc));
+        Tcl_ListObjAppendElement(interp,tags,Tcl_NewStringObj(m->tag[i].name,-1));
+        Tcl_ListObjAppendElement(interp,tags,t);
+    }
+    Tcl_ListObjAppendElement(interp,result,Tcl_NewStringObj("tags",-1));
+    Tcl_ListObjAppendElement(interp,result,tags);
+
+    return result;
+}
+
+/**
+ * @brief delete the cached instance with the ccb command
+ */
+
+static void delete_ccb(ClientData clientdata) {
+    CCB **keep = (CCB **) clientdata;
+    delete *keep;
+    delete keep;
+}
+
+/**
+ * @brief build the coil the options ask for and set the result
+ *
+ * @param argv room for the options as strings
+ * @param objs room for the options as objects
+ *
+ * @return TCL_OK/TCL_ERROR
+ */
+
+static int run_ccb(CCB **keep, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[],
+                   const char **argv, Tcl_Obj **objs)
 {
 
     // Parse the commandline options
     int argc = 0;
     int v = 0;
     const char *outfile;
-
-    const char **argv = new const char*[MAX_ARGS];
+    const char *topfile;
 
     // Look for and expand lists to pass to interface
     Tcl_Obj **list = NULL;
@@ -107,6 +336,17 @@ int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
 
     bool xyz = 0;
     bool newmol = 0;
+    bool topology = 0;
+    double clash = 0.0;
+    int cache = -1;
+    bool cachestats = 0;
+    const char *cachedir = NULL;
+    double cacheres = 0.0;
+    bool stats = 0;
+    const char *statsmode = NULL;
+    const char *statsjson = NULL;
+    bool memusage = 0;
+    const char *selection = NULL;
 
     // Parse Arguments
     for (int i = 1; i < objc; ++i) {
@@ -116,8 +356,17 @@ int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
 
         for (int j = 0; j < len; j++) {
 
+            // Numbers only ever belong to the style, keep them as
+            // objects so they are not converted to strings
+            double value;
+            if (Tcl_GetDoubleFromObj(NULL, list[j], &value) == TCL_OK) {
+                objs[argc++] = list[j];
+                continue;
+            }
+
             // is this OK to do?
             argv[argc] = Tcl_GetString(list[j]);
+            objs[argc] = list[j];
 
             // Check for PDB
             if (strcmp("-pdb", argv[argc]) == 0) {
@@ -148,6 +397,102 @@ int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
             } else if (strcmp("-newmol", argv[argc]) == 0) {
               newmol = 1;
 
+                // Detect the topology of a structure
+            } else if (strcmp("-topology", argv[argc]) == 0) {
+
+                if (i + 1 == objc) {
+                    Tcl_AppendResult(interp, "Missing argument to -topology\n", NULL);
+                    return TCL_ERROR;
+                }
+
+                topology = 1;
+                topfile = Tcl_GetString(objv[++i]);
+
+                // Clash screening before output
+            } else if (strcmp("-clash", argv[argc]) == 0) {
+
+                if (i + 1 == objc) {
+                    Tcl_AppendResult(interp, "Missing argument to -clash\n", NULL);
+                    return TCL_ERROR;
+                }
+
+                if (Tcl_GetDoubleFromObj(interp, objv[++i], &clash) != TCL_OK)
+                    return TCL_ERROR;
+
+                // Cache generated coils between calls
+            } else if (strcmp("-cache", argv[argc]) == 0) {
+
+                if (i + 1 == objc) {
+                    Tcl_AppendResult(interp, "Missing argument to -cache\n", NULL);
+                    return TCL_ERROR;
+                }
+
+                if (Tcl_GetIntFromObj(interp, objv[++i], &cache) != TCL_OK)
+                    return TCL_ERROR;
+
+                if (cache < 0) {
+                    Tcl_AppendResult(interp, "Cache size must be zero or positive\n", NULL);
+                    return TCL_ERROR;
+                }
+
+            } else if (strcmp("-cachedir", argv[argc]) == 0) {
+
+                if (i + 1 == objc) {
+                    Tcl_AppendResult(interp, "Missing argument to -cachedir\n", NULL);
+                    return TCL_ERROR;
+                }
+
+                cachedir = Tcl_GetString(objv[++i]);
+
+            } else if (strcmp("-cacheres", argv[argc]) == 0) {
+
+                if (i + 1 == objc) {
+                    Tcl_AppendResult(interp, "Missing argument to -cacheres\n", NULL);
+                    return TCL_ERROR;
+                }
+
+                if (Tcl_GetDoubleFromObj(interp, objv[++i], &cacheres) != TCL_OK)
+                    return TCL_ERROR;
+
+                if (cacheres <= 0.0) {
+                    Tcl_AppendResult(interp, "Cache resolution must be positive\n", NULL);
+                    return TCL_ERROR;
+                }
+
+            } else if (strcmp("-cachestats", argv[argc]) == 0) {
+                cachestats = 1;
+
+            } else if (strcmp("-memory", argv[argc]) == 0) {
+                memusage = 1;
+
+                // Atoms the output, screen and topology work on
+            } else if (strcmp("-select", argv[argc]) == 0) {
+
+                if (i + 1 == objc) {
+                    Tcl_AppendResult(interp, "Missing argument to -select\n", NULL);
+                    return TCL_ERROR;
+                }
+
+                selection = Tcl_GetString(objv[++i]);
+
+                // Phase timers, the mode is optional
+            } else if (strcmp("-stats", argv[argc]) == 0) {
+                stats = 1;
+
+                const char *next = i + 1 < objc ? Tcl_GetString(objv[i + 1]) : "";
+                if (strcmp(next, "on") == 0 || strcmp(next, "off") == 0 ||
+                    strcmp(next, "reset") == 0) {
+                    statsmode = next;
+                    i++;
+                } else if (strcmp(next, "json") == 0) {
+                    if (i + 2 == objc) {
+                        Tcl_AppendResult(interp, "Missing file name to -stats json\n", NULL);
+                        return TCL_ERROR;
+                    }
+                    statsjson = Tcl_GetString(objv[i + 2]);
+                    i += 2;
+                }
+
             } else {
 
                 argc++;
@@ -155,45 +500,232 @@ int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
         }
     }
 
-    //Fire up a ccb  instance
-    CCB *ccb = new CCB(objc, NULL);
+    /// Create, resize or release the cached instance
+    if (cache > 0) {
+        if (*keep == NULL)
+            *keep = new CCB(objc, NULL);
+
+        if ((*keep)->backbone->set_cache(cache) != CCB_OK)
+            return TCL_ERROR;
+
+    } else if (cache == 0) {
+        delete *keep;
+        *keep = NULL;
+    }
+
+    if (cachedir) {
+        if (*keep == NULL) {
+            Tcl_AppendResult(interp, "-cachedir needs a cache, set one with -cache\n", NULL);
+            return TCL_ERROR;
+        }
+
+        if ((*keep)->backbone->cache->set_dir(cachedir) != CCB_OK)
+            return TCL_ERROR;
+    }
+
+    if (cacheres > 0.0) {
+        if (*keep == NULL || (*keep)->backbone->cache == NULL) {
+            Tcl_AppendResult(interp, "-cacheres needs a cache, set one with -cache\n", NULL);
+            return TCL_ERROR;
+        }
+
+        if ((*keep)->backbone->set_cache((*keep)->backbone->cache->maxentry, cacheres) != CCB_OK)
+            return TCL_ERROR;
+    }
 
-    const char **newarg = new const char*[5];
+    /// Turn the timers on or off, they live with the cached instance
+    if (statsmode && strcmp(statsmode, "on") == 0) {
+        if (*keep == NULL)
+            *keep = new CCB(objc, NULL);
+        (*keep)->timer->enabled = true;
+
+    } else if (statsmode && *keep) {
+        if (strcmp(statsmode, "off") == 0)
+            (*keep)->timer->enabled = false;
+        else
+            (*keep)->timer->reset();
+    }
 
-    /// Add the coiled-coil plugin
+    if (statsjson) {
+        if (*keep == NULL) {
+            Tcl_AppendResult(interp, "-stats json needs an instance, set one with -stats on\n", NULL);
+            return TCL_ERROR;
+        }
+
+        if ((*keep)->timer->set_json(statsjson) != CCB_OK)
+            return TCL_ERROR;
+    }
+
+    if (stats && !statsmode && !statsjson) {
+        Timer *t = *keep ? (*keep)->timer : NULL;
+        Tcl_Obj *resultPtr = Tcl_NewListObj(0,NULL);
+        for (int k = 0; k < Timer::NPHASE; k++) {
+            Tcl_Obj *phase = Tcl_NewListObj(0,NULL);
+            Tcl_ListObjAppendElement(interp,phase,Tcl_NewStringObj("calls",-1));
+            Tcl_ListObjAppendElement(interp,phase,Tcl_NewWideIntObj(t ? t->count[k] : 0));
+            Tcl_ListObjAppendElement(interp,phase,Tcl_NewStringObj("items",-1));
+            Tcl_ListObjAppendElement(interp,phase,Tcl_NewWideIntObj(t ? t->items[k] : 0));
+            Tcl_ListObjAppendElement(interp,phase,Tcl_NewStringObj("seconds",-1));
+            Tcl_ListObjAppendElement(interp,phase,Tcl_NewDoubleObj(t ? t->seconds[k] : 0.0));
+            Tcl_ListObjAppendElement(interp,resultPtr,Tcl_NewStringObj(Timer::name(k),-1));
+            Tcl_ListObjAppendElement(interp,resultPtr,phase);
+        }
+        Tcl_SetObjResult(interp, resultPtr);
+    }
+
+    if (memusage && argc == 0 && !topology)
+        Tcl_SetObjResult(interp, memory_dict(interp, *keep));
+
+    if (cachestats) {
+        Cache *c = *keep ? (*keep)->backbone->cache : NULL;
+        Tcl_Obj *resultPtr = Tcl_NewListObj(0,NULL);
+        Tcl_ListObjAppendElement(interp,resultPtr,Tcl_NewWideIntObj(c ? c->nhit : 0));
+        Tcl_ListObjAppendElement(interp,resultPtr,Tcl_NewWideIntObj(c ? c->nmiss : 0));
+        Tcl_ListObjAppendElement(interp,resultPtr,Tcl_NewWideIntObj(c ? c->nevict : 0));
+        Tcl_ListObjAppendElement(interp,resultPtr,Tcl_NewIntObj(c ? c->nentry : 0));
+        Tcl_ListObjAppendElement(interp,resultPtr,Tcl_NewWideIntObj(c ? c->ndisk : 0));
+        Tcl_SetObjResult(interp, resultPtr);
+    }
+
+    // Nothing to build
+    if ((cache >= 0 || cachedir || cacheres > 0.0 || cachestats || stats || memusage) && argc == 0 && !topology) {
+        return TCL_OK;
+    }
+
+    //Fire up a ccb  instance, the cached one is reused
+    CCB *ccb = *keep && !topology ? *keep : new CCB(objc, NULL);
+
+    const char *newarg[5];
+
+    /// Add the coiled-coil plugin, replacing the last call's so
+    /// every call starts from the default parameters
     newarg[0] = (char *) "backbone";
     newarg[1] = (char *) "add";
     newarg[2] = (char *) "coiledcoil";
     newarg[3] = (char *) "bbcc1";
 
+    if (ccb->backbone->find_backbone(newarg[3]) >= 0 &&
+        ccb->backbone->delete_backbone(newarg[3]) != CCB_OK) {
+      release_ccb(ccb, keep);
+      return TCL_ERROR;
+    }
+
     if (ccb->backbone->add_backbone(4,newarg) != CCB_OK ||
         ccb->backbone->init_backbone(newarg[3]) != CCB_OK) {
-      delete ccb;
+      release_ccb(ccb, keep);
       return TCL_ERROR;
     }
 
     // Set Verbosity
     ccb->error->verbosity_level = v;
 
-    //Pass parsed commands to the style
-    if (ccb->backbone->update_backbone(newarg[3],argc,argv,0) != CCB_OK ||
+    /// Read the structure and return its parameter block
+    if (topology) {
+        int n = strlen(topfile);
+        newarg[0] = (char *) "input";
+        newarg[1] = n > 4 && strcmp(topfile + n - 4, ".cif") == 0 ? "cif" : "pdb";
+        newarg[2] = (char *) "top1";
+        newarg[3] = topfile;
+
+        // The topology frees through ccb->memory, so it must
+        // go before the instance does
+        TopologyCoiledCoil *top = new TopologyCoiledCoil(ccb);
+        const char **params = NULL;
+
+        if (ccb->ccbio->add_input(4, newarg) != CCB_OK ||
+            ccb->ccbio->init_input(newarg[2]) != CCB_OK ||
+            ccb->ccbio->read_input(newarg[2]) != CCB_OK ||
+            (selection && ccb->bitmask->select(newarg[2], selection) != CCB_OK) ||
+            top->detect(ccb->bitmask->find_mask(newarg[2])) != CCB_OK) {
+            Tcl_AppendResult(interp, "Could not detect topology of ", topfile, NULL);
+            delete top;
+            release_ccb(ccb, keep);
+            return TCL_ERROR;
+        }
+
+        int nparam = top->get_params(params);
+        Tcl_Obj *resultPtr = Tcl_NewListObj(0,NULL);
+        for (int k = 0; k < nparam; k++)
+            Tcl_ListObjAppendElement(interp,resultPtr,Tcl_NewStringObj(params[k],-1));
+        Tcl_SetObjResult(interp, resultPtr);
+
+        delete top;
+        release_ccb(ccb, keep);
+        return TCL_OK;
+    }
+
+    //Pass parsed commands to the style, as numbers when the binary
+    //parameters can hold them, else as strings
+    double dbuf_inline[ARGS_INLINE];
+    int ibuf_inline[ARGS_INLINE];
+    double *dbuf = argc > ARGS_INLINE ? new double[argc] : dbuf_inline;
+    int *ibuf = argc > ARGS_INLINE ? new int[argc] : ibuf_inline;
+
+    CoiledCoilParams params;
+    int code;
+    if (tcl_params(argc, objs, params, dbuf, ibuf) == TCL_OK)
+        code = ccb->backbone->update_backbone(newarg[3], params);
+    else {
+        for (int k = 0; k < argc; k++)
+            argv[k] = Tcl_GetString(objs[k]);
+        code = ccb->backbone->update_backbone(newarg[3], argc, argv, 0);
+    }
+
+    if (dbuf != dbuf_inline) delete [] dbuf;
+    if (ibuf != ibuf_inline) delete [] ibuf;
+
+    if (code != CCB_OK ||
         ccb->backbone->generate_backbone(newarg[3]) != CCB_OK) {
-        delete ccb;
+        release_ccb(ccb, keep);
         return TCL_ERROR;
     }
 
+    /// The selected atoms, all of them without -select
+    int mask = 0;
+    if (selection) {
+        if (ccb->bitmask->select("tcl_select", selection) != CCB_OK) {
+            release_ccb(ccb, keep);
+            return TCL_ERROR;
+        }
+        mask = ccb->bitmask->find_mask("tcl_select");
+    }
+
+    /// Prune clashing geometries before any output
+    if (clash > 0.0) {
+        // Like the topology, the screen frees through ccb->memory
+        Clash *clashes = new Clash(ccb);
+        clashes->cutoff = clash;
+
+        int status = clashes->check(mask);
+        int npair = clashes->npair;
+        delete clashes;
+
+        if (status != CCB_OK) {
+            release_ccb(ccb, keep);
+            return TCL_ERROR;
+        }
+
+        Tcl_SetObjResult(interp, Tcl_NewIntObj(npair));
+
+        if (npair > 0) {
+            release_ccb(ccb, keep);
+            return TCL_OK;
+        }
+    }
+
     /// Write out the coordinates to a pdb file
     if (pdb) {
         newarg[0] = (char *) "output";
         newarg[1] = (char *) "pdb";
         newarg[2] = (char *) "pdb1";
         newarg[3] = outfile;
-        newarg[4] = (char *) "all";
+        newarg[4] = selection ? "tcl_select" : "all";
 
         if (ccb->ccbio->add_output(5, newarg) != CCB_OK ||
             ccb->ccbio->init_output(newarg[2]) != CCB_OK ||
-            ccb->ccbio->write_output(newarg[2]) != CCB_OK) {
-            delete ccb;
+            ccb->ccbio->write_output(newarg[2]) != CCB_OK ||
+            ccb->ccbio->delete_output(newarg[2]) != CCB_OK) {
+            release_ccb(ccb, keep);
             return TCL_ERROR;
         }
     }
@@ -207,6 +739,9 @@ int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
         for (int i = 0; i < ccb->domain->nsite; i++)
             for (int j = 0; j < ccb->domain->site[i]->fixed_atoms->natom; j++) {
 
+                if (!ccb->bitmask->test(mask, ccb->domain->site[i]->fixed_atoms->atom[j]->index))
+                    continue;
+
                 Tcl_Obj *xyz;
 
                 double coords[3] = { 0.0 };
@@ -238,6 +773,9 @@ int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
         for (int i = 0; i < ccb->domain->nsite; i++)
             for (int j = 0; j < ccb->domain->site[i]->fixed_atoms->natom; j++) {
 
+                if (!ccb->bitmask->test(mask, ccb->domain->site[i]->fixed_atoms->atom[j]->index))
+                    continue;
+
                 Tcl_Obj *nxyz;
 
                 double coords[3] = { 0.0 };
@@ -263,16 +801,58 @@ int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
         Tcl_SetObjResult(interp, resultPtr);
     }
 
-
-    // Delete argv
-    delete [] argv;
+    if (memusage)
+        Tcl_SetObjResult(interp, memory_dict(interp, ccb));
 
     // Delete ccb instance
-    delete ccb;
+    release_ccb(ccb, keep);
 
     return TCL_OK;
 }
 
+/**
+ * @brief parse commands
+ *
+ * @param ccb ccb pointer
+ * @param interp tcl interp pointer
+ * @param objc number of tcl objects passed
+ * @param objv object array
+ *
+ * @return TCL_OK/TCL_ERROR
+ */
+
+/* Tcl plugin wrapper. it parses the arguments, calls the
+   real code and then passes the result to the interpreter. */
+int tcl_ccb(ClientData clientdata, Tcl_Interp *interp,
+            int objc, Tcl_Obj *const objv[])
+{
+
+    // Instance kept alive for the cache, NULL if not caching
+    CCB **keep = (CCB **) clientdata;
+
+    // Count the arguments once the lists are expanded
+    int len = 0;
+    int nargs = 0;
+    for (int i = 1; i < objc; ++i) {
+        if (Tcl_ListObjLength(interp, objv[i], &len) != TCL_OK)
+            return TCL_ERROR;
+        nargs += len;
+    }
+
+    // Short commands stay on the stack, the buffers go on every exit
+    const char *argv_inline[ARGS_INLINE];
+    const char **argv = nargs > ARGS_INLINE ? new const char*[nargs] : argv_inline;
+    Tcl_Obj *objs_inline[ARGS_INLINE];
+    Tcl_Obj **objs = nargs > ARGS_INLINE ? new Tcl_Obj*[nargs] : objs_inline;
+
+    int code = run_ccb(keep, interp, objc, objv, argv, objs);
+
+    if (argv != argv_inline) delete [] argv;
+    if (objs != objs_inline) delete [] objs;
+
+    return code;
+}
+
 /**
  * Register the plugin with the TCL interpreter
  *
@@ -314,8 +894,11 @@ extern "C" {
         if (Tcl_PkgProvide(interp, PACKAGE_NAME, PACKAGE_VERSION) != TCL_OK)
             return TCL_ERROR;
 
+        CCB **keep = new CCB*;
+        *keep = NULL;
+
         Tcl_CreateObjCommand(interp,"ccb",tcl_ccb,
-                             (ClientData)NULL, (Tcl_CmdDeleteProc*)NULL);
+                             (ClientData)keep, (Tcl_CmdDeleteProc*)delete_ccb);
 
         return TCL_OK;
     }
@@ -67,11 +67,12 @@
 #define BLEN 64
 
 /**
- * @def MAX_ARGS
- * @brief Maximim number of argumets to parse
+ * @def ARGS_INLINE
+ * @brief Number of arguments parsed without allocating,
+ * longer argument lists are allocated to fit
  */
 
-#define MAX_ARGS 64
+#define ARGS_INLINE 64
 
 using namespace CCB_NS;
 
@@ -112,12 +113,21 @@ int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
     // Parse the commandline options
     int argc = 0;
 
-    const char **argv = new const char*[MAX_ARGS];
-
     // Look for and expand lists to pass to interface
     Tcl_Obj **list = NULL;
     int len = 0;
 
+    // Count the arguments once the lists are expanded
+    int nargs = 0;
+    for (int i = 1; i < objc; ++i) {
+        if (Tcl_ListObjLength(interp, objv[i], &len) != TCL_OK)
+            return TCL_ERROR;
+        nargs += len;
+    }
+
+    const char *argv_inline[ARGS_INLINE];
+    const char **argv = nargs > ARGS_INLINE ? new const char*[nargs] : argv_inline;
+
     // flags
     bool pdb_flag = 0;
     const char *outfile = NULL;
@@ -339,7 +349,7 @@ int tcl_ccb(ClientData UNUSED(clientdata), Tcl_Interp *interp,
     }
 
     // Delete argv
-    delete [] argv;
+    if (argv != argv_inline) delete [] argv;
 
     // Delete ccb instance
     delete ccb;
@@ -41,6 +41,7 @@
 #include "site.h"
 #include "group.h"
 #include "atom.h"
+#include "bitmask.h"
 
 using namespace CCB_NS;
 
@@ -50,7 +51,7 @@ Atom::Atom(CCB *ccb, int myid) :
         group(),
         id(myid),
         serial(0),
-        mask(1),
+        index(bitmask->add_column()),
         x(0.0),
         y(0.0),
         z(0.0),
@@ -67,6 +68,7 @@ Atom::Atom(CCB *ccb, int myid) :
 }
 
 Atom::~Atom() {
+    bitmask->free_column(index);
 }
 
 Atom::Atom(const Atom &a) : Pointers(a) {
@@ -76,7 +78,8 @@ Atom::Atom(const Atom &a) : Pointers(a) {
 
     id = a.id;
     serial = a.serial;
-    mask = a.mask;
+    index = bitmask->add_column();
+    bitmask->copy_column(a.index, index);
     strcpy(name, a.name);
     strcpy(type, a.type);
     strcpy(element, a.element);
@@ -102,7 +105,7 @@ Atom& Atom::operator= (Atom const& a) {
 
     id = a.id;
     serial = a.serial;
-    mask = a.mask;
+    bitmask->copy_column(a.index, index);
     strcpy(name, a.name);
     strcpy(type, a.type);
     strcpy(element, a.element);
@@ -63,11 +63,11 @@ namespace CCB_NS {
         // Atom quantities
         int id; /**< Local Internal indexing counter */
         int serial; /**< Atom serial number from input */
-        int mask; /**< Bitmasking*/
+        int index; /**< Column of the atom in the Bitmask groups */
 
         char name[10]; /**< Atom name from input */
         char type[10]; /**< Atom type from input */
-        char element[2]; /**< Atom element type from input */
+        char element[3]; /**< Atom element type from input */
 
         double x; /**< Atom x coordinate */
         double y; /**< Atom y coordinate */
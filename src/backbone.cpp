@@ -41,6 +41,7 @@
 #include "error.h"
 #include "universe.h"
 #include "backbone.h"
+#include "trace.h"
 
 using namespace CCB_NS;
 
@@ -84,6 +85,56 @@ int Backbone::update(int argc, const char **argv, int n) {
      return update_style(argc, argv, n);
 }
 
+int Backbone::update(const CoiledCoilParams &p) {
+     return update_style(p);
+}
+
+/**
+ * Styles that take typed parameters override this, the
+ * rest only understand their string options
+ */
+
+int Backbone::update_style(const CoiledCoilParams & /*p*/) {
+     char str[128];
+     snprintf(str, 128, "Backbone style %s does not take typed parameters", style);
+     return error->one(FLERR, str);
+}
+
 int Backbone::generate() {
-     return generate_style();
+     int code = generate_style();
+     trace->flush();
+     return code;
+}
+
+/**
+ * Styles that can be cached override these, by default
+ * a style is regenerated every time
+ */
+
+int Backbone::pack_params(int64_t * /*buf*/, int /*max*/, double /*resolution*/) {
+     return -1;
+}
+
+bigint Backbone::ncoords() {
+     return 0;
+}
+
+void Backbone::pack_coords(double * /*buf*/) {
+}
+
+int Backbone::unpack_coords(const double * /*buf*/, bigint /*n*/) {
+     return error->one(FLERR, "Backbone style doesn't support cached coordinates");
+}
+
+/**
+ * Styles whose parameters can be tabulated override this, by
+ * default a style has none
+ */
+
+int Backbone::pack_values(double * /*buf*/, int /*max*/) {
+     return 0;
+}
+
+double Backbone::memory_usage() {
+     return 0.0;
 }
@@ -39,6 +39,9 @@
 #include "pointers.h"
 
 namespace CCB_NS {
+
+  struct CoiledCoilParams;
+
   class Backbone: protected Pointers {
 
     public:
@@ -52,13 +55,26 @@ namespace CCB_NS {
 
             int init();
             int update(int argc, const char **argv, int n); /**< Update parameters */
+            int update(const CoiledCoilParams &p); /**< Update parameters without parsing strings */
             int generate();    /**< Generate coordiantes */
 
+            // Optional support for caching generated coordinates, styles
+            // that don't override pack_params are never cached
+            virtual int pack_params(int64_t *buf, int max, double resolution); /**< quantized parameters, returns the length needed */
+            virtual bigint ncoords(); /**< number of values written by pack_coords */
+            virtual void pack_coords(double *buf); /**< copy out the generated coordinates */
+            virtual int unpack_coords(const double *buf, bigint n); /**< restore coordinates as if generated */
+
+            virtual int pack_values(double *buf, int max); /**< the parameters as numbers, returns the length needed */
+
+            virtual double memory_usage(); /**< bytes held by the style, 0 if not known */
+
     protected:
 
             // Child Class Functions
             virtual int init_style() = 0; /**< Initialize the style (declare member variables, etc.. */
             virtual int update_style(int argc, const char **argv, int n) = 0; /**< update coordinates based on passed params*/
+            virtual int update_style(const CoiledCoilParams &p); /**< binary parameters, NOT pure virtual, only coiledcoil takes them */
             virtual int generate_style() = 0; /**< Generate Coordiantes for the particular style */
 
     private:
@@ -42,6 +42,8 @@
 #include "backbonehandler.h"
 #include "style_backbone.h"
 #include "backbone.h"
+#include "cache.h"
+#include "trace.h"
 
 using namespace CCB_NS;
 
@@ -56,8 +58,16 @@ using namespace CCB_NS;
 
 #define BACKBONE_DELTA 2
 
+/**
+ * @def KEY_DELTA
+ * @brief Initial length of the cache key, grown to whatever
+ * the backbone style asks for.
+ */
+
+#define KEY_DELTA 64
+
 BackboneHandler::BackboneHandler(CCB *ccb) :
-		Pointers(ccb),nbackbone(0),maxbackbone(0) {
+		Pointers(ccb),nbackbone(0),maxbackbone(0),cache(NULL),key(NULL),maxkey(0) {
 
      backbone = NULL;
 
@@ -69,6 +79,11 @@ BackboneHandler::~BackboneHandler() {
           delete_backbone(backbone[0]->id);
 
      memory->sfree(backbone);
+     if (cache && CCB_TRACE_ON(3))
+          cache->print_stats();
+
+     memory->destroy(key);
+     delete cache;
 }
 
 /**
@@ -106,7 +121,7 @@ int BackboneHandler::add_backbone(int narg, const char **arg) {
         
 	if (nbackbone == maxbackbone) {
 		maxbackbone += BACKBONE_DELTA;
-		backbone = (Backbone **) memory->srealloc(backbone, maxbackbone * sizeof(Backbone *), "backbonehandler::backbone");
+		backbone = (Backbone **) memory->srealloc(backbone, maxbackbone * sizeof(Backbone *), "backbonehandler:backbone");
 	}
 
      if (backbone == NULL)
@@ -177,6 +192,17 @@ int BackboneHandler::find_backbone(const char *id) {
         return ibackbone;  
 }
 
+double BackboneHandler::memory_usage() {
+
+     double bytes = maxbackbone * sizeof(Backbone *);
+     bytes += maxkey * sizeof(int64_t);
+
+     for (int i = 0; i < nbackbone; i++)
+          bytes += backbone[i]->memory_usage();
+
+     return bytes;
+}
+
 int BackboneHandler::init_backbone(const char *id) {
 
 	int ibackbone = find_backbone(id);
@@ -198,6 +224,22 @@ int BackboneHandler::update_backbone(const char *id, int argc, const char **argv
      return backbone[ibackbone]->update(argc, argv, n);
 }
 
+/**
+ * Update a backbone from binary parameters, see coiledcoil_params.h
+ */
+
+int BackboneHandler::update_backbone(const char *id, const CoiledCoilParams &p) {
+
+     int ibackbone = find_backbone(id);
+     if (ibackbone < 0) {
+          char str[128];
+          sprintf(str, "Could not find backbone id %s to update", id);
+          return error->one(FLERR, str);
+     }
+
+     return backbone[ibackbone]->update(p);
+}
+
 int BackboneHandler::generate_backbone(const char *id) {
 
      int ibackbone = find_backbone(id);
@@ -207,5 +249,102 @@ int BackboneHandler::generate_backbone(const char *id) {
           return error->one(FLERR, str);
      }
 
-     return backbone[ibackbone]->generate();
+     Backbone *bb = backbone[ibackbone];
+     if (cache == NULL)
+          return bb->generate();
+
+     // Key is the style name followed by its quantized parameters
+     int nkey = bb->pack_params(key + 1, maxkey - 1, cache->resolution);
+     if (nkey < 0)
+          return bb->generate();
+
+     if (nkey + 1 > maxkey) {
+          maxkey = nkey + 1;
+          memory->destroy(key);
+          memory->create(key, maxkey, "backbonehandler:key");
+          bb->pack_params(key + 1, maxkey - 1, cache->resolution);
+     }
+
+     // Keys made at another resolution never match
+     key[0] = Cache::hash(bb->style, strlen(bb->style)) ^
+              Cache::hash(&cache->resolution, sizeof(double));
+     nkey++;
+
+     bigint n = 0;
+     const double *data = cache->find(key, nkey, n);
+     if (data)
+          return bb->unpack_coords(data, n);
+
+     if (bb->generate() != CCB_OK)
+          return CCB_ERROR;
+
+     n = bb->ncoords();
+     double *buf = cache->insert(key, nkey, n);
+     if (buf == NULL)
+          return CCB_ERROR;
+     bb->pack_coords(buf);
+
+     return cache->save(key, nkey);
+}
+
+/**
+ * @brief Create, resize or delete the coordinate cache
+ *
+ * Resizing, or changing the resolution, drops the cached
+ * structures but keeps the counters.
+ *
+ * @param maxentry number of structures to keep, 0 deletes the cache
+ * @param resolution parameters closer than this, in Angstrom and
+ * degrees, share a structure, 0 keeps the current one
+ */
+
+int BackboneHandler::set_cache(int maxentry, double resolution) {
+
+     if (maxentry < 0)
+          return error->one(FLERR, "Cache size must be zero or positive");
+
+     if (resolution < 0.0)
+          return error->one(FLERR, "Cache resolution must be zero or positive");
+
+     if (maxentry == 0) {
+          delete cache;
+          cache = NULL;
+          return CCB_OK;
+     }
+
+     if (cache && cache->maxentry == maxentry) {
+          if (resolution > 0.0 && resolution != cache->resolution) {
+               cache->resolution = resolution;
+               cache->clear();
+          }
+          return CCB_OK;
+     }
+
+     if (key == NULL) {
+          maxkey = KEY_DELTA;
+          memory->create(key, maxkey, "backbonehandler:key");
+     }
+
+     Cache *c = new Cache(ccb, maxentry);
+
+     if (cache) {
+          c->resolution = cache->resolution;
+          c->nhit = cache->nhit;
+          c->nmiss = cache->nmiss;
+          c->nevict = cache->nevict;
+          c->ndisk = cache->ndisk;
+          c->nwrite = cache->nwrite;
+          if (c->set_dir(cache->dir) != CCB_OK) {
+               delete c;
+               return CCB_ERROR;
+          }
+          delete cache;
+     }
+
+     if (resolution > 0.0)
+          c->resolution = resolution;
+
+     cache = c;
+
+     return CCB_OK;
 }
@@ -47,7 +47,7 @@ namespace CCB_NS {
           ~BackboneHandler(); /**< BackboneHandler deconstructor */
 
           // Memory Usage
-          void memory_usage();
+          double memory_usage(); /**< bytes held by the styles, excluding the cache */
 
           class Backbone **backbone; /**< List of backbone modelers */
 
@@ -61,11 +61,19 @@ namespace CCB_NS {
           int add_backbone(int, const char **);
           int delete_backbone(const char *);
           int update_backbone(const char *id, int argc, const char **argv, int n);
+          int update_backbone(const char *id, const struct CoiledCoilParams &p);
           int generate_backbone(const char *id);
           int find_backbone(const char *);
-               
+
+          // Cache of generated coordinates
+          class Cache *cache; /**< NULL unless caching was requested */
+          int set_cache(int maxentry, double resolution = 0.0); /**< keep up to maxentry structures, 0 disables the cache */
+
      private:
 
+          int64_t *key; /**< parameter key of the backbone being generated */
+          int maxkey; /**< allocated length of key */
+
 	};
 }
 
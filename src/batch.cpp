@@ -0,0 +1,737 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   batch.cpp
+ * @date   Tue Oct 20 09:14:37 2026
+ *
+ * @brief  Batch generation of coiled-coils from the command line
+ *
+ */
+
+#include "ctype.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "batch.h"
+#include "memory.h"
+#include "error.h"
+#include "ccbio.h"
+#include "output.h"
+#include "output_npy.h"
+#include "timer.h"
+#include "trace.h"
+#include "atom.h"
+#include "bitmask.h"
+#include "backbonehandler.h"
+#include "cache.h"
+#include "clash.h"
+
+/**
+ * @def BLEN
+ *
+ * Length of path name or genaric buffer
+ */
+
+#define BLEN 512
+
+/**
+ * @def BATCH_DELTA
+ *
+ * Options or characters added when the buffers run out
+ */
+
+#define BATCH_DELTA 256
+
+using namespace CCB_NS;
+
+Batch::Batch(CCB *ccb) : Pointers(ccb) {
+
+    help = false;
+    nset = nwrite = nclash = nfail = 0;
+
+    nbase = 0;
+
+    paramfile = NULL;
+    axis = NULL;
+    naxis = 0;
+
+    pdbname = xyzname = shmname = nslot = imdport = npyname = dtype = NULL;
+    npy = NULL;
+    xyzfp = NULL;
+    multiple = false;
+    ipart = 0;
+    npart = 1;
+
+    selection = NULL;
+    cutoff = 0.0;
+    clash = NULL;
+
+    args = NULL;
+    maxargs = 0;
+    mask = 0;
+    clashing = false;
+
+    serve = NULL;
+    nworker = 0;
+
+    line = NULL;
+    maxline = 0;
+}
+
+Batch::~Batch() {
+
+    if (xyzfp && xyzfp != stdout) fclose(xyzfp);
+
+    delete clash;
+    memory->sfree(axis);
+    memory->sfree(args);
+    memory->sfree(line);
+}
+
+void Batch::usage(FILE *fp) {
+
+    fprintf(fp,
+            "usage: ccb [style options] [-params fname] [-grid option lo hi step ...]\n"
+            "           [-pdb fname] [-xyz fname] [-shm name [-slots N]] [-imd port]\n"
+            "           [-npy fname [-dtype f4|f8]] [-part k n]\n"
+            "           [-select text] [-clash cutoff] [-cache N [-cacheres r]]\n"
+            "           [-stats] [-v level] [-serve [path] [-workers N]]\n"
+            "\n"
+            "  -params fname  one set of style options per line, - for stdin\n"
+            "  -grid          run every value of option from lo to hi\n"
+            "  -pdb fname     a file per set, %%d is the set number, - for stdout\n"
+            "  -xyz fname     a frame per set, - for stdout\n"
+            "  -shm name      a frame per set in shared memory ring name\n"
+            "  -slots N       sets the ring holds, default 64\n"
+            "  -imd port      stream the sets to VMD, imd connect localhost port\n"
+            "  -npy fname     a frame per set in a NumPy array, fname_params.npy\n"
+            "                 holds the parameters\n"
+            "  -dtype f4|f8   float32 or float64 coordinates, default f4\n"
+            "  -part k n      run the sets numbered k modulo n\n"
+            "  -select text   atoms screened and written, e.g. \"name CA\"\n"
+            "  -clash cutoff  skip sets with chains closer than cutoff\n"
+            "  -cache N       reuse the last N structures built\n"
+            "  -cacheres r    share a structure between sets closer than r\n"
+            "                 Angstrom and degrees\n"
+            "  -stats         print the phase timers when done\n"
+            "  -serve [path]  run requests from stdin or a unix socket at path\n"
+            "  -workers N     threads running requests, default one per processor\n");
+}
+
+/**
+ * @brief parse the command line, anything not for the batch is
+ * kept for the coiled-coil style
+ *
+ * @param narg number of arguments, without the program name
+ */
+
+int Batch::settings(int narg, const char **arg) {
+
+    char *end;
+    double cacheres = 0.0;
+
+    for (int i = 0; i < narg; i++) {
+
+        if (strcmp(arg[i], "-h") == 0 || strcmp(arg[i], "-help") == 0) {
+            help = true;
+
+        } else if (strcmp(arg[i], "-params") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing file name to -params");
+            paramfile = arg[++i];
+            multiple = true;
+
+        } else if (strcmp(arg[i], "-grid") == 0) {
+            if (i + 4 >= narg)
+                return error->one(FLERR, "batch: -grid needs option lo hi step");
+
+            axis = (Axis *) memory->srealloc(axis, (naxis + 1) * sizeof(Axis), "batch:axis");
+            if (axis == NULL) return CCB_ERROR;
+
+            Axis &a = axis[naxis++];
+            a.option = arg[i + 1];
+            a.lo = strtod(arg[i + 2], &end);
+            bool ok = *end == '\0';
+            double hi = strtod(arg[i + 3], &end);
+            ok = ok && *end == '\0';
+            a.step = strtod(arg[i + 4], &end);
+            ok = ok && *end == '\0';
+            i += 4;
+
+            if (!ok || a.step <= 0.0 || hi < a.lo)
+                return error->one(FLERR, "batch: -grid needs numbers with lo <= hi and step > 0");
+
+            // Allow for round off in the last value
+            a.n = static_cast<int> ((hi - a.lo) / a.step + 1.0e-9) + 1;
+            multiple = true;
+
+        } else if (strcmp(arg[i], "-pdb") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing file name to -pdb");
+            pdbname = arg[++i];
+
+        } else if (strcmp(arg[i], "-xyz") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing file name to -xyz");
+            xyzname = arg[++i];
+
+        } else if (strcmp(arg[i], "-shm") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing name to -shm");
+            shmname = arg[++i];
+
+        } else if (strcmp(arg[i], "-imd") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing port to -imd");
+            imdport = arg[++i];
+
+        } else if (strcmp(arg[i], "-npy") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing file name to -npy");
+            npyname = arg[++i];
+
+        } else if (strcmp(arg[i], "-dtype") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing type to -dtype");
+            dtype = arg[++i];
+
+        } else if (strcmp(arg[i], "-part") == 0) {
+            if (i + 2 >= narg)
+                return error->one(FLERR, "batch: -part needs k n");
+            ipart = strtol(arg[i + 1], &end, 10);
+            bool ok = *end == '\0';
+            npart = strtol(arg[i + 2], &end, 10);
+            ok = ok && *end == '\0';
+            i += 2;
+
+            if (!ok || npart < 1 || ipart < 0 || ipart >= npart)
+                return error->one(FLERR, "batch: -part needs 0 <= k < n");
+
+        } else if (strcmp(arg[i], "-slots") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing number to -slots");
+            nslot = arg[++i];
+
+        } else if (strcmp(arg[i], "-select") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing selection to -select");
+            selection = arg[++i];
+
+        } else if (strcmp(arg[i], "-clash") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing cutoff to -clash");
+            cutoff = strtod(arg[++i], &end);
+            if (*end != '\0' || cutoff < 0.0)
+                return error->one(FLERR, "batch: -clash needs a positive cutoff");
+
+        } else if (strcmp(arg[i], "-cache") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing size to -cache");
+            int n = strtol(arg[++i], &end, 10);
+            if (*end != '\0' || n < 0)
+                return error->one(FLERR, "batch: cache size must be zero or positive");
+            if (backbone->set_cache(n) != CCB_OK)
+                return CCB_ERROR;
+
+        } else if (strcmp(arg[i], "-cacheres") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing resolution to -cacheres");
+            cacheres = strtod(arg[++i], &end);
+            if (*end != '\0' || cacheres <= 0.0)
+                return error->one(FLERR, "batch: cache resolution must be positive");
+
+        } else if (strcmp(arg[i], "-serve") == 0) {
+            // The path is optional, stdin without
+            serve = i + 1 < narg && arg[i + 1][0] != '-' ? arg[++i] : "-";
+
+        } else if (strcmp(arg[i], "-workers") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing number to -workers");
+            nworker = strtol(arg[++i], &end, 10);
+            if (*end != '\0' || nworker < 0)
+                return error->one(FLERR, "batch: -workers must be zero or positive");
+
+        } else if (strcmp(arg[i], "-stats") == 0) {
+            timer->enabled = true;
+
+        } else if (strcmp(arg[i], "-v") == 0) {
+            if (i + 1 == narg)
+                return error->one(FLERR, "batch: missing level to -v");
+            error->verbosity_level = strtol(arg[++i], &end, 10);
+            if (*end != '\0')
+                return error->one(FLERR, "batch: -v needs an integer level");
+
+        } else {
+            nbase = add_arg(nbase, arg[i]);
+            if (nbase < 0) return CCB_ERROR;
+        }
+    }
+
+    // Applied once the cache exists, whatever the order
+    if (cacheres > 0.0) {
+        if (backbone->cache == NULL)
+            return error->one(FLERR, "batch: -cacheres needs -cache");
+        if (backbone->set_cache(backbone->cache->maxentry, cacheres) != CCB_OK)
+            return CCB_ERROR;
+    }
+
+    // Keep stdout for the coordinates
+    if (serve || (pdbname && strcmp(pdbname, "-") == 0) ||
+        (xyzname && strcmp(xyzname, "-") == 0))
+        screen = stderr;
+
+    if (cutoff > 0.0)
+        clash = new Clash(ccb);
+
+    return CCB_OK;
+}
+
+/**
+ * @brief run every set
+ *
+ * A set that fails is reported and skipped, the rest still run.
+ */
+
+int Batch::run() {
+
+    if (xyzname) {
+        xyzfp = strcmp(xyzname, "-") == 0 ? stdout : fopen(xyzname, "w");
+        if (xyzfp == NULL) {
+            char str[BLEN];
+            snprintf(str, BLEN, "batch: can't open %s for writing", xyzname);
+            return error->one(FLERR, str);
+        }
+    }
+
+    // The ring lives for the whole batch, readers follow it
+    if (shmname) {
+        const char *newarg[7] = { "output", "shm", "batch_shm", shmname };
+        int n = 4;
+        if (nslot) {
+            newarg[n++] = "-slots";
+            newarg[n++] = nslot;
+        }
+        if (selection)
+            newarg[n++] = selection;
+
+        if (ccbio->add_output(n, newarg) != CCB_OK ||
+            ccbio->init_output(newarg[2]) != CCB_OK)
+            return CCB_ERROR;
+    }
+
+    // The first set waits for VMD to connect
+    if (imdport) {
+        const char *newarg[6] = { "output", "imd", "batch_imd", imdport, "-wait", selection };
+        if (ccbio->add_output(selection ? 6 : 5, newarg) != CCB_OK ||
+            ccbio->init_output(newarg[2]) != CCB_OK)
+            return CCB_ERROR;
+    }
+
+    if (npyname && create_npy() != CCB_OK)
+        return CCB_ERROR;
+
+    if (paramfile == NULL) {
+        run_grid(nbase);
+
+    } else {
+        FILE *fp = strcmp(paramfile, "-") == 0 ? stdin : fopen(paramfile, "r");
+        if (fp == NULL) {
+            char str[BLEN];
+            snprintf(str, BLEN, "batch: can't open %s for reading", paramfile);
+            return error->one(FLERR, str);
+        }
+
+        while (read_line(fp)) {
+            int n = split(line);
+            if (n > nbase)
+                run_grid(n);
+        }
+
+        if (fp != stdin) fclose(fp);
+    }
+
+    if (xyzfp) fflush(xyzfp);
+
+    // Readers see the ring done
+    if (shmname)
+        ccbio->delete_output("batch_shm");
+
+    if (imdport)
+        ccbio->delete_output("batch_imd");
+
+    // A file that grew is cut to the last set
+    if (npy) {
+        ccbio->delete_output("batch_npy");
+        npy = NULL;
+    }
+
+    CCB_TRACE(1, "Batch: %lld sets, %lld written, %lld clashing, %lld failed\n",
+              (long long) nset, (long long) nwrite, (long long) nclash, (long long) nfail);
+    trace->flush();
+
+    if (timer->enabled)
+        timer->print_stats();
+
+    return nfail > 0 ? CCB_ERROR : CCB_OK;
+}
+
+/**
+ * @brief add the -npy output, sized for the grid when there is
+ * no -params to read more sets from
+ */
+
+int Batch::create_npy() {
+
+    if (npart > 1 && paramfile)
+        return error->one(FLERR, "batch: -part with -npy needs the sets on a -grid, not -params");
+
+    char frames[32];
+    const char *newarg[10] = { "output", "npy", "batch_npy", npyname };
+    int n = 4;
+
+    if (dtype) {
+        newarg[n++] = "-dtype";
+        newarg[n++] = dtype;
+    }
+
+    if (paramfile == NULL) {
+        bigint npoint = 1;
+        for (int a = 0; a < naxis; a++)
+            npoint *= axis[a].n;
+
+        snprintf(frames, 32, "%lld", (long long) npoint);
+        newarg[n++] = "-frames";
+        newarg[n++] = frames;
+    }
+
+    // The parts fill the same files
+    if (npart > 1)
+        newarg[n++] = "-shared";
+    if (selection)
+        newarg[n++] = selection;
+
+    if (ccbio->add_output(n, newarg) != CCB_OK ||
+        ccbio->init_output(newarg[2]) != CCB_OK)
+        return CCB_ERROR;
+
+    npy = (OutputNPY *) ccbio->output[ccbio->find_output(newarg[2])];
+
+    return CCB_OK;
+}
+
+/**
+ * @brief run the options in args[0, n) at every point of the grid
+ *
+ * The option and value of each axis follow the options in args.
+ */
+
+int Batch::run_grid(int n) {
+
+    bigint npoint = 1;
+    for (int a = 0; a < naxis; a++)
+        npoint *= axis[a].n;
+
+    for (int a = 0; a < naxis; a++) {
+        if (add_arg(n + 2 * a + 1, NULL) < 0) return CCB_ERROR;
+        args[n + 2 * a] = axis[a].option;
+        args[n + 2 * a + 1] = axis[a].value;
+    }
+
+    for (bigint p = 0; p < npoint; p++) {
+
+        // The last axis varies fastest
+        bigint k = p;
+        for (int a = naxis - 1; a >= 0; a--) {
+            snprintf(axis[a].value, 32, "%g", axis[a].lo + (k % axis[a].n) * axis[a].step);
+            k /= axis[a].n;
+        }
+
+        run_set(n + 2 * naxis, args);
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * @brief build one set, screen it and write it out
+ */
+
+int Batch::run_set(int narg, const char **arg) {
+
+    nset++;
+
+    // Another process of -part runs this one
+    if ((nset - 1) % npart != ipart)
+        return CCB_OK;
+
+    if (build_set(narg, arg) != CCB_OK) {
+        nfail++;
+        return CCB_ERROR;
+    }
+
+    if (clashing) {
+        CCB_TRACE(2, "Batch: set %lld clashes, skipped\n", (long long) nset - 1);
+        nclash++;
+        return CCB_OK;
+    }
+
+    char title[32];
+    snprintf(title, 32, "set %lld", (long long) nset - 1);
+
+    // Frames line up with the set numbers
+    if (npy)
+        npy->frame = nset - 1;
+
+    if ((pdbname && write_pdb(NULL) != CCB_OK) ||
+        (xyzfp && write_xyz(xyzfp, title, narg, arg) != CCB_OK) ||
+        (shmname && ccbio->write_output("batch_shm") != CCB_OK) ||
+        (imdport && ccbio->write_output("batch_imd") != CCB_OK) ||
+        (npy && ccbio->write_output("batch_npy") != CCB_OK)) {
+        nfail++;
+        return CCB_ERROR;
+    }
+
+    nwrite++;
+
+    return CCB_OK;
+}
+
+/**
+ * @brief build one set and screen it, setting mask and clashing
+ *
+ * The style is created anew so every set starts from the defaults.
+ */
+
+int Batch::build_set(int narg, const char **arg) {
+
+    const char *add[] = { "backbone", "add", "coiledcoil", "bb1" };
+
+    mask = 0;
+    clashing = false;
+
+    if ((backbone->find_backbone(add[3]) >= 0 && backbone->delete_backbone(add[3]) != CCB_OK) ||
+        backbone->add_backbone(4, add) != CCB_OK ||
+        backbone->init_backbone(add[3]) != CCB_OK ||
+        backbone->update_backbone(add[3], narg, arg, 0) != CCB_OK ||
+        backbone->generate_backbone(add[3]) != CCB_OK)
+        return CCB_ERROR;
+
+    if (selection) {
+        if (bitmask->select("batch_select", selection) != CCB_OK)
+            return CCB_ERROR;
+        mask = bitmask->find_mask("batch_select");
+    }
+
+    // One clashing pair is enough to reject the set
+    if (clash) {
+        clash->cutoff = cutoff;
+        if (clash->check(mask, 1) != CCB_OK)
+            return CCB_ERROR;
+        clashing = clash->npair > 0;
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * @brief write the set through the pdb output style
+ *
+ * @param fp the stream to write to, NULL for the -pdb file
+ */
+
+int Batch::write_pdb(FILE *fp) {
+
+    char fname[BLEN];
+    long long iset = nset - 1;
+    const char *pct = fp ? NULL : strstr(pdbname, "%d");
+
+    if (fp) {
+        strcpy(fname, "-");
+
+    } else if (pct) {
+        snprintf(fname, BLEN, "%.*s%lld%s", (int) (pct - pdbname), pdbname, iset, pct + 2);
+
+    } else if (multiple && strcmp(pdbname, "-") != 0) {
+        // out.pdb becomes out_N.pdb
+        const char *dot = strrchr(pdbname, '.');
+        if (dot == NULL || strchr(dot, '/'))
+            dot = pdbname + strlen(pdbname);
+        snprintf(fname, BLEN, "%.*s_%lld%s", (int) (dot - pdbname), pdbname, iset, dot);
+
+    } else {
+        snprintf(fname, BLEN, "%s", pdbname);
+    }
+
+    const char *newarg[5];
+    newarg[0] = "output";
+    newarg[1] = "pdb";
+    newarg[2] = "batch_pdb";
+    newarg[3] = fname;
+    newarg[4] = selection ? "batch_select" : "all";
+
+    if (ccbio->add_output(5, newarg) != CCB_OK)
+        return CCB_ERROR;
+
+    if (fp)
+        ccbio->output[ccbio->find_output(newarg[2])]->stream = fp;
+
+    if (ccbio->init_output(newarg[2]) != CCB_OK ||
+        ccbio->write_output(newarg[2]) != CCB_OK ||
+        ccbio->delete_output(newarg[2]) != CCB_OK)
+        return CCB_ERROR;
+
+    return CCB_OK;
+}
+
+/**
+ * @brief write the set as an xyz frame, the comment is the title
+ * and the options of the set
+ */
+
+int Batch::write_xyz(FILE *fp, const char *title, int narg, const char **arg) {
+
+    int natom = 0;
+    Atom **list = bitmask->list(mask, natom);
+
+    fprintf(fp, "%d\n%s:", natom, title);
+    for (int i = 0; i < narg; i++)
+        fprintf(fp, " %s", arg[i]);
+    fprintf(fp, "\n");
+
+    // Generated atoms have no element, the name starts with it
+    for (int i = 0; i < natom; i++) {
+        Atom *a = list[i];
+        if (a->element[0])
+            fprintf(fp, "%-2s", a->element);
+        else
+            fprintf(fp, "%-2.1s", a->name);
+        fprintf(fp, " %12.6f %12.6f %12.6f\n", a->x, a->y, a->z);
+    }
+
+    if (ferror(fp))
+        return error->one(FLERR, "batch: can't write the xyz frame");
+
+    return CCB_OK;
+}
+
+/**
+ * @brief write x y z of the atoms in native byte order
+ *
+ * @param bytes 4 for float, 8 for double
+ */
+
+int Batch::write_raw(FILE *fp, int bytes) {
+
+    int natom = 0;
+    Atom **list = bitmask->list(mask, natom);
+
+    for (int i = 0; i < natom; i++) {
+        if (bytes == 4) {
+            float x[3] = { (float) list[i]->x, (float) list[i]->y, (float) list[i]->z };
+            fwrite(x, sizeof(float), 3, fp);
+        } else {
+            double x[3] = { list[i]->x, list[i]->y, list[i]->z };
+            fwrite(x, sizeof(double), 3, fp);
+        }
+    }
+
+    if (ferror(fp))
+        return error->one(FLERR, "batch: can't write the coordinates");
+
+    return CCB_OK;
+}
+
+/**
+ * @brief split s in place into the options of a set, after the
+ * common ones in args
+ *
+ * @return the number of options in args, nbase for a blank line
+ * or a comment, -1 if out of memory
+ */
+
+int Batch::split(char *s) {
+
+    int n = nbase;
+
+    for (char *p = s; *p; ) {
+        while (isspace(*p)) p++;
+        if (*p == '\0' || (*p == '#' && n == nbase)) break;
+
+        if ((n = add_arg(n, p)) < 0) break;
+        while (*p && !isspace(*p)) p++;
+        if (*p) *p++ = '\0';
+    }
+
+    return n;
+}
+
+/**
+ * @brief read a whole line of any length into line
+ *
+ * @return 1 if a line was read, 0 at the end of the file
+ */
+
+int Batch::read_line(FILE *fp) {
+
+    int n = 0;
+
+    while (true) {
+        if (maxline - n < 2) {
+            maxline += BATCH_DELTA;
+            line = (char *) memory->srealloc(line, maxline, "batch:line");
+            if (line == NULL) return 0;
+        }
+
+        if (fgets(line + n, maxline - n, fp) == NULL)
+            return n > 0;
+
+        n += strlen(line + n);
+        if (n > 0 && line[n - 1] == '\n') {
+            line[--n] = '\0';
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief put s at args[n], growing args as needed
+ *
+ * @return n + 1, -1 if out of memory
+ */
+
+int Batch::add_arg(int n, const char *s) {
+
+    if (n >= maxargs) {
+        maxargs = n + BATCH_DELTA;
+        args = (const char **) memory->srealloc(args, maxargs * sizeof(const char *), "batch:args");
+        if (args == NULL) return -1;
+    }
+
+    args[n] = s;
+
+    return n + 1;
+}
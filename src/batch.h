@@ -0,0 +1,161 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   batch.h
+ * @date   Tue Oct 20 09:14:37 2026
+ *
+ * @brief  Batch generation of coiled-coils from the command line
+ *
+ * Runs the coiled-coil style over many parameter sets in one CCB
+ * instance, so a batch job pays for the setup once:
+ *
+ *   ccb [style options] [-params fname] [-grid option lo hi step ...]
+ *       [-pdb fname] [-xyz fname] [-shm name [-slots N]] [-imd port]
+ *       [-npy fname [-dtype f4|f8]] [-part k n]
+ *       [-select text] [-clash cutoff] [-cache N [-cacheres r]]
+ *       [-stats] [-v level] [-serve [path] [-workers N]]
+ *
+ * Options not listed are handed to the coiled-coil style, the
+ * same as the Tcl command, and are common to every set.
+ *
+ * -params reads one set per line from fname, "-" for stdin. The
+ * options on a line follow the common ones, blank lines and lines
+ * starting with # are skipped. Every -grid adds an axis, the sets
+ * are every combination of the axes, the last varying fastest,
+ * run for every line of -params if there is one.
+ *
+ * -pdb writes every set to its own file, %d in fname is replaced
+ * by the number of the set, counting from 0, or the number is put
+ * in front of the extension when there is more than one set.
+ * -xyz writes every set as a frame of one XYZ file, with the
+ * options of the set as the comment. Either may be "-" for stdout,
+ * messages then go to stderr. -shm publishes every set as a frame
+ * of a shared memory ring for readers on the same node, holding
+ * the last -slots sets, see ring.h. -imd streams the sets to VMD,
+ * once it has connected to port, see output_imd.h. -npy writes the
+ * coordinates of set N as frame N of a NumPy array, and its
+ * parameters as row N of a second one, see output_npy.h.
+ *
+ * -part k n runs only the sets whose number is k modulo n, so n
+ * processes can share a batch. They fill the same -npy files,
+ * which are then sized for the whole -grid up front.
+ *
+ * -clash skips the sets with atoms in different chains closer than
+ * cutoff and -select limits the atoms screened and written.
+ * -cache keeps the last N structures built for sets that repeat,
+ * -cacheres r lets sets within r Angstrom and degrees share one.
+ *
+ * -serve runs the sets sent as requests instead, see server.h.
+ */
+
+#ifndef CCB_BATCH_H
+#define CCB_BATCH_H
+
+#include "stdio.h"
+#include "pointers.h"
+
+namespace CCB_NS {
+class Batch: protected Pointers {
+
+  public:
+
+    // Constructor and Destructor
+    Batch(class CCB *); /**< Batch constructor */
+    ~Batch(); /**< Batch deconstructor */
+
+    int settings(int narg, const char **arg); /**< parse the command line */
+    int run(); /**< run every set, CCB_ERROR if any failed */
+    int run_set(int narg, const char **arg); /**< build, screen and write one set */
+
+    // Steps of run_set, for the server
+    int split(char *s); /**< options of a set into args, returns their number */
+    int build_set(int narg, const char **arg); /**< build and screen one set */
+    int write_pdb(FILE *fp); /**< NULL for the -pdb file */
+    int write_xyz(FILE *fp, const char *title, int narg, const char **arg);
+    int write_raw(FILE *fp, int bytes); /**< x y z as float (4) or double (8) */
+
+    const char **args; /**< common options, then those of the current set */
+    int nbase; /**< number of common options */
+    int mask; /**< atoms written, set by build_set() */
+    bool clashing; /**< the last set built clashes */
+
+    const char *serve; /**< -serve socket path, "-" for stdin, NULL to run the batch */
+    int nworker; /**< -workers, 0 for one per processor */
+
+    bool help; /**< -h was given, nothing to run */
+    static void usage(FILE *fp);
+
+    bigint nset; /**< sets run */
+    bigint nwrite; /**< sets written */
+    bigint nclash; /**< sets skipped by the clash screen */
+    bigint nfail; /**< sets that failed to build or write */
+
+  private:
+
+
+    const char *paramfile; /**< sets one per line, NULL for none */
+
+    /// One -grid axis
+    struct Axis {
+        const char *option;
+        double lo, step;
+        int n; /**< number of values */
+        char value[32]; /**< the current value as text */
+    };
+
+    Axis *axis;
+    int naxis;
+
+    const char *pdbname; /**< -pdb file name or template */
+    const char *xyzname; /**< -xyz file name */
+    const char *shmname; /**< -shm ring name */
+    const char *nslot; /**< -slots, NULL for the default */
+    const char *imdport; /**< -imd port */
+    const char *npyname; /**< -npy file name */
+    const char *dtype; /**< -dtype, NULL for the default */
+    class OutputNPY *npy; /**< the -npy output while the batch runs */
+    FILE *xyzfp;
+    bool multiple; /**< more than one set may be run */
+    int ipart, npart; /**< -part, sets numbered ipart modulo npart are run */
+
+    const char *selection; /**< -select text, NULL for all atoms */
+    double cutoff; /**< -clash cutoff, 0 for no screen */
+    class Clash *clash;
+
+    int maxargs; /**< allocated length of args */
+
+    char *line; /**< the current line of -params */
+    int maxline;
+
+    int run_grid(int n);
+    int create_npy();
+    int read_line(FILE *fp);
+    int add_arg(int n, const char *s);
+};
+}
+
+#endif
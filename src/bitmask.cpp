@@ -46,31 +46,60 @@
 #include "site.h"
 #include "domain.h"
 #include "bitmask.h"
+#include "select.h"
 
 /**
- * @def MAX_BITMASK
+ * @def BITMASK_DELTA
  *
- * Maximum number of Bitmasking groups, this number
- * is machine dependent and can not be increased
- * on 32 bit machines or 64 bit with 32bit int
+ * Rows added to the bit matrix when it runs out of groups
  */
 
-#define MAX_BITMASK 32
+#define BITMASK_DELTA 32
+
+/**
+ * @def COLUMN_DELTA
+ *
+ * Smallest number of columns added when the atoms outgrow
+ * the bit matrix, one cache line of bits per row
+ */
+
+#define COLUMN_DELTA 512
+
+/**
+ * @def SELECT_CACHE
+ *
+ * Compiled selections kept by select()
+ */
+
+#define SELECT_CACHE 16
 
 using namespace CCB_NS;
 
 Bitmask::Bitmask(CCB *ccb) : Pointers(ccb) {
 
-    names = new char*[MAX_BITMASK];
-    mask = new int[MAX_BITMASK];
-    inversemask = new int[MAX_BITMASK];
+    nmask = maxmask = 0;
+    names = NULL;
+
+    bits = NULL;
+    nword = ncol = 0;
+
+    freecol = NULL;
+    nfree = maxfree = 0;
+
+    // ticks start above the 0 of a list never built
+    tick = coltick = 1;
+    rowtick = listtick = NULL;
+
+    member = NULL;
+    nmember = maxmember = NULL;
 
-    // Set name=null, and bitmask, invbitmask to necessary values
-    for (int i = 0; i < MAX_BITMASK; i++) names[i] = NULL;
-    for (int i = 0; i < MAX_BITMASK; i++) mask[i] = 1 << i;
-    for (int i = 0; i < MAX_BITMASK; i++) inversemask[i] = mask[i] ^ ~0;
+    sel = (Select **) memory->smalloc(SELECT_CACHE * sizeof(Select *), "bitmask:sel");
+    nsel = 0;
 
-    // create "all" bitmask containing all atoms (mask == 1)
+    grow_columns(COLUMN_DELTA);
+    grow_rows(BITMASK_DELTA);
+
+    // create "all" bitmask containing all atoms (mask == 0)
 
     char *str = (char *) "all";
     int n = strlen(str) + 1;
@@ -82,35 +111,47 @@ Bitmask::Bitmask(CCB *ccb) : Pointers(ccb) {
 
 Bitmask::~Bitmask() {
 
-    for (int i = 0; i < MAX_BITMASK; i++) delete [] names[i];
+    for (int i = 0; i < nsel; i++)
+        delete sel[i];
+    memory->sfree(sel);
+
+    for (int i = 0; i < maxmask; i++) {
+        delete [] names[i];
+        memory->sfree(member[i]);
+    }
 
-    delete [] names;
-    delete [] mask;
-    delete [] inversemask;
+    memory->sfree(names);
+    memory->sfree(member);
+    memory->destroy(nmember);
+    memory->destroy(maxmember);
+    memory->destroy(rowtick);
+    memory->destroy(listtick);
+    memory->destroy(freecol);
+    memory->destroy(bits);
 }
 
 int Bitmask::find(const char *name)
 {
-    for (int imask = 0; imask < MAX_BITMASK; imask++)
+    for (int imask = 0; imask < maxmask; imask++)
         if (names[imask] && strcmp(name,names[imask]) == 0) return imask;
 
     return -1;
 }
 
-int Bitmask::find_mask(const char *name) {
-
-    int imask = find(name);
+/**
+ * The handle of a group for set(), test(), list() etc.,
+ * this is now simply its row.
+ */
 
-    if (imask < 0)
-        return -1;
+int Bitmask::find_mask(const char *name) {
 
-    return mask[imask];
+    return find(name);
 
 }
 
 int Bitmask::find_unused()
 {
-    for (int imask = 0; imask < MAX_BITMASK; imask++)
+    for (int imask = 0; imask < maxmask; imask++)
         if (names[imask] == NULL) return imask;
     return -1;
 }
@@ -126,7 +167,7 @@ int Bitmask::add_bitmask(const char *name) {
     int imask = find(name);
 
     if (imask < 0) {
-        if (nmask == MAX_BITMASK) return error->all(FLERR,"bitmask: Too many bitmasks");
+        if (nmask == maxmask) grow_rows(maxmask + BITMASK_DELTA);
         imask = find_unused();
         int n = strlen(name) + 1;
         names[imask] = new char[n];
@@ -147,15 +188,309 @@ int Bitmask::delete_bitmask(const char *name) {
     if (imask < 0)
         return CCB_OK;
 
-    int bmask = mask[imask];
-
-    // unset bit on all atoms in domain
-    for (int i = 0; i < domain->nsite; i++)
-        for (int j = 0; j < domain->site[i]->nrotamer; j++)
-            for (int k = 0; k < domain->site[i]->rotamer[j]->natom; k++)
-                domain->site[i]->rotamer[j]->atom[k]->mask &= ~bmask;
+    // unset the group for all atoms in domain
+    memset(bits[imask], 0, nword * sizeof(uint64_t));
+    rowtick[imask] = ++tick;
+    nmember[imask] = 0;
 
     delete [] names[imask];
+    names[imask] = NULL;
+    nmask--;
+
+    return CCB_OK;
+}
+
+/**
+ * @brief set the group name to the result of a set operation
+ *
+ * The group is created if needed and may be one of the operands.
+ * NOT ignores mask2 and takes the complement within "all".
+ *
+ * @param op one of AND, OR, ANDNOT, XOR, NOT
+ */
+
+int Bitmask::combine(const char *name, int op, int mask1, int mask2) {
+
+    if (mask1 < 0 || mask1 >= maxmask || names[mask1] == NULL ||
+        mask2 < 0 || mask2 >= maxmask || names[mask2] == NULL)
+        return error->one(FLERR, "bitmask: combine of a group that doesn't exist");
+
+    if (add_bitmask(name) != CCB_OK)
+        return CCB_ERROR;
+
+    int imask = find(name);
+
+    // rows may have moved in add_bitmask
+    uint64_t *r = bits[imask];
+    const uint64_t *a = bits[mask1];
+    const uint64_t *b = op == NOT ? bits[0] : bits[mask2];
+    int n = nword;
+
+    switch (op) {
+    case AND:
+        for (int w = 0; w < n; w++) r[w] = a[w] & b[w];
+        break;
+    case OR:
+        for (int w = 0; w < n; w++) r[w] = a[w] | b[w];
+        break;
+    case ANDNOT:
+        for (int w = 0; w < n; w++) r[w] = a[w] & ~b[w];
+        break;
+    case XOR:
+        for (int w = 0; w < n; w++) r[w] = a[w] ^ b[w];
+        break;
+    case NOT:
+        for (int w = 0; w < n; w++) r[w] = b[w] & ~a[w];
+        break;
+    default:
+        return error->one(FLERR, "bitmask: unknown set operation");
+    }
+
+    rowtick[imask] = ++tick;
 
     return CCB_OK;
 }
+
+/**
+ * number of atoms in the group
+ */
+
+bigint Bitmask::count(int mask) {
+
+    bigint n = 0;
+    const uint64_t *r = bits[mask];
+    for (int w = 0; w < nword; w++)
+        n += __builtin_popcountll(r[w]);
+
+    return n;
+}
+
+/**
+ * @brief atoms of a group in the order of the domain
+ *
+ * Fixed atoms come before the rotamers of each site. The list
+ * is kept until the group or the set of atoms changes, so
+ * repeated output of an unchanged domain doesn't walk it again.
+ *
+ * @param n returns the number of atoms
+ * @return the list, owned by the bitmask
+ */
+
+Atom **Bitmask::list(int mask, int &n) {
+
+    if (listtick[mask] < rowtick[mask] || listtick[mask] < coltick)
+        build_list(mask);
+
+    n = nmember[mask];
+    return member[mask];
+}
+
+/**
+ * @brief set the group name to the atoms matching a selection
+ *
+ * The group is created if needed. The compiled selection is kept,
+ * and while the groups it reads and the atoms are unchanged the
+ * group is left as it is.
+ *
+ * @param text the selection, see select.h
+ */
+
+int Bitmask::select(const char *name, const char *text) {
+
+    if (add_bitmask(name) != CCB_OK)
+        return CCB_ERROR;
+
+    int imask = find(name);
+
+    int i = 0;
+    while (i < nsel && strcmp(sel[i]->text, text) != 0) i++;
+
+    Select *s;
+    if (i < nsel) {
+        s = sel[i];
+    } else {
+        s = new Select(ccb, text);
+        if (s->status != CCB_OK) {
+            delete s;
+            return CCB_ERROR;
+        }
+        if (nsel == SELECT_CACHE)
+            delete sel[--nsel];
+        i = nsel++;
+    }
+
+    // move to the front
+    memmove(sel + 1, sel, i * sizeof(Select *));
+    sel[0] = s;
+
+    if (s->current(imask))
+        return CCB_OK;
+
+    return s->apply(imask);
+}
+
+void Bitmask::build_list(int mask) {
+
+    int n = 0;
+    bigint nmax = count(mask);
+
+    if (nmax > maxmember[mask]) {
+        maxmember[mask] = nmax;
+        member[mask] = (Atom **) memory->srealloc(member[mask], nmax * sizeof(Atom *), "bitmask:member");
+    }
+
+    Atom **m = member[mask];
+    const uint64_t *r = bits[mask];
+
+    for (int i = 0; i < domain->nsite && n < nmax; i++) {
+        Site *s = domain->site[i];
+        for (int j = -1; j < s->nrotamer; j++) {
+            Group *g = j < 0 ? s->fixed_atoms : s->rotamer[j];
+            for (int k = 0; k < g->natom; k++) {
+                int col = g->atom[k]->index;
+                if ((r[col >> 6] >> (col & 63)) & 1)
+                    m[n++] = g->atom[k];
+            }
+        }
+    }
+
+    nmember[mask] = n;
+    listtick[mask] = tick;
+}
+
+/**
+ * @brief a column for a new atom, which joins "all"
+ *
+ * Freed columns are reused, once every column is free they are
+ * handed out from 0 again so the columns follow the domain.
+ */
+
+int Bitmask::add_column() {
+
+    int col;
+
+    if (nfree > 0) {
+        col = freecol[--nfree];
+    } else {
+        if (ncol == nword * 64)
+            grow_columns(ncol + COLUMN_DELTA);
+        col = ncol++;
+    }
+
+    set(0, col);
+    coltick = tick;
+
+    return col;
+}
+
+/**
+ * give column to the groups of column from
+ */
+
+void Bitmask::copy_column(int from, int to) {
+
+    uint64_t fbit = (uint64_t) 1 << (from & 63);
+    uint64_t tbit = (uint64_t) 1 << (to & 63);
+
+    for (int i = 0; i < maxmask; i++) {
+        if (bits[i][from >> 6] & fbit)
+            bits[i][to >> 6] |= tbit;
+        else
+            bits[i][to >> 6] &= ~tbit;
+    }
+
+    coltick = ++tick;
+}
+
+/**
+ * remove a deleted atom from every group
+ */
+
+void Bitmask::free_column(int col) {
+
+    uint64_t bit = ~((uint64_t) 1 << (col & 63));
+    for (int i = 0; i < maxmask; i++)
+        bits[i][col >> 6] &= bit;
+
+    if (nfree == maxfree) {
+        maxfree += COLUMN_DELTA;
+        memory->grow(freecol, maxfree, "bitmask:freecol");
+    }
+    freecol[nfree++] = col;
+
+    if (nfree == ncol)
+        nfree = ncol = 0;
+
+    coltick = ++tick;
+}
+
+/**
+ * @brief make room for n groups
+ */
+
+void Bitmask::grow_rows(int n) {
+
+    memory->grow_aligned(bits, n, nword, "bitmask:bits");
+    for (int i = maxmask; i < n; i++)
+        memset(bits[i], 0, nword * sizeof(uint64_t));
+
+    names = (char **) memory->srealloc(names, n * sizeof(char *), "bitmask:names");
+    member = (Atom ***) memory->srealloc(member, n * sizeof(Atom **), "bitmask:member");
+    memory->grow(nmember, n, "bitmask:nmember");
+    memory->grow(maxmember, n, "bitmask:maxmember");
+    memory->grow(rowtick, n, "bitmask:rowtick");
+    memory->grow(listtick, n, "bitmask:listtick");
+
+    for (int i = maxmask; i < n; i++) {
+        names[i] = NULL;
+        member[i] = NULL;
+        nmember[i] = maxmember[i] = 0;
+        rowtick[i] = listtick[i] = 0;
+    }
+
+    maxmask = n;
+}
+
+/**
+ * @brief make room for n columns
+ *
+ * The row length changes, so the matrix is copied row by row
+ */
+
+void Bitmask::grow_columns(int n) {
+
+    int nwordnew = Memory::padded<uint64_t>((n + 63) / 64);
+
+    uint64_t **bitsnew = NULL;
+    if (maxmask > 0) {
+        memory->create_aligned(bitsnew, maxmask, nwordnew, "bitmask:bits");
+        for (int i = 0; i < maxmask; i++) {
+            memcpy(bitsnew[i], bits[i], nword * sizeof(uint64_t));
+            memset(bitsnew[i] + nword, 0, (nwordnew - nword) * sizeof(uint64_t));
+        }
+        memory->destroy(bits);
+    }
+
+    bits = bitsnew;
+    nword = nwordnew;
+}
+
+/**
+ * bytes held by the bit matrix and the lists
+ */
+
+double Bitmask::memory_usage() {
+
+    double bytes = sizeof(Bitmask);
+
+    bytes += memory->usage_aligned(bits, maxmask, nword);
+    bytes += maxmask * (sizeof(char *) + sizeof(Atom **) + 2 * sizeof(int) + 2 * sizeof(bigint));
+    for (int i = 0; i < maxmask; i++)
+        bytes += maxmember[i] * sizeof(Atom *);
+    bytes += maxfree * sizeof(int);
+    bytes += SELECT_CACHE * sizeof(Select *);
+    for (int i = 0; i < nsel; i++)
+        bytes += sel[i]->memory_usage();
+
+    return bytes;
+}
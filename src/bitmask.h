@@ -31,27 +31,38 @@
  * 
  * @brief  keeps track of groups of atoms via bitmask 
  *
+ * Groups are the rows of a bit matrix with one column per atom
+ * in the domain, the column is Atom::index. The number of groups
+ * is only limited by memory. A group is addressed by its row, the
+ * "mask" returned by find_mask(), row 0 is the "all" group.
  *
+ * Rows are padded to whole cache lines so the set operations run
+ * over aligned words without a remainder and vectorize.
+ *
+ * select() sets a group from selection text, see select.h. The
+ * compiled selections are kept for reuse by the text.
  */
 
 #ifndef CCB_BITMASK_H
 #define CCB_BITMASK_H
 
+#include "stdint.h"
 #include "pointers.h"
 
 namespace CCB_NS {
 
   class Bitmask: protected Pointers {
       public:
+
+          enum {AND, OR, ANDNOT, XOR, NOT}; /**< set operations for combine() */
   
           //Constructor and Destructor
           Bitmask(class CCB *);
           ~Bitmask(); 
   
-          int nmask;
-          char **names;
-          int *mask;
-          int *inversemask;
+          int nmask; /**< groups in use */
+          int maxmask; /**< rows allocated */
+          char **names; /**< group names, NULL for a free row */
 
           int find(const char *name);
           int find_unused();
@@ -60,10 +71,96 @@ namespace CCB_NS {
           int add_bitmask(const char *name);
           int delete_bitmask(const char *name);
 
+          // Membership of the atom in column col
+          void set(int mask, int col);
+          void unset(int mask, int col);
+          bool test(int mask, int col) const;
+
+          // Whole group operations
+          int combine(const char *name, int op, int mask1, int mask2 = 0); /**< name = mask1 op mask2 */
+          bigint count(int mask); /**< atoms in the group */
+          class Atom **list(int mask, int &n); /**< members in domain order, cached */
+          int select(const char *name, const char *text); /**< name = atoms matching text */
+
+          // Raw rows, for the selections
+          int words() const { return nword; }
+          const uint64_t *peek(int mask) const { return bits[mask]; }
+          uint64_t *row(int mask); /**< for writing, marks the row changed */
+          bigint changed(int mask) const; /**< tick of the last change to the group or the atoms */
+
+          // Columns, handed out to atoms as they are created
+          int add_column();
+          void copy_column(int from, int to);
+          void free_column(int col);
+
+          double memory_usage();
+
       private:
-  
+
+          uint64_t **bits; /**< bits[mask][word] */
+          int nword; /**< words per row */
+          int ncol; /**< columns handed out, freed ones included */
+
+          int *freecol; /**< freed columns, reused first */
+          int nfree, maxfree;
+
+          // Lists are rebuilt when their row or the columns changed after them
+          bigint tick; /**< advanced on every change */
+          bigint coltick; /**< tick of the last column change */
+          bigint *rowtick; /**< tick of the last change to each row */
+          bigint *listtick; /**< tick each list was built at */
+
+          class Atom ***member; /**< cached list of each group */
+          int *nmember, *maxmember;
+
+          class Select **sel; /**< compiled selections, most recently used first */
+          int nsel;
+
+          void grow_rows(int n);
+          void grow_columns(int n);
+          void build_list(int mask);
   };
+
+  /**
+   * add the atom in column col to the group
+   */
+
+  inline void Bitmask::set(int mask, int col) {
+      bits[mask][col >> 6] |= (uint64_t) 1 << (col & 63);
+      rowtick[mask] = ++tick;
+  }
+
+  /**
+   * remove the atom in column col from the group
+   */
+
+  inline void Bitmask::unset(int mask, int col) {
+      bits[mask][col >> 6] &= ~((uint64_t) 1 << (col & 63));
+      rowtick[mask] = ++tick;
+  }
+
+  /**
+   * the words of the group, which the caller is about to write
+   */
+
+  inline uint64_t *Bitmask::row(int mask) {
+      rowtick[mask] = ++tick;
+      return bits[mask];
+  }
+
+  inline bigint Bitmask::changed(int mask) const {
+      return rowtick[mask] > coltick ? rowtick[mask] : coltick;
+  }
+
+  /**
+   * true if the atom in column col is in the group
+   */
+
+  inline bool Bitmask::test(int mask, int col) const {
+      return (bits[mask][col >> 6] >> (col & 63)) & 1;
+  }
   
 }
 
 #endif
+
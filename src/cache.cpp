@@ -0,0 +1,453 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+
+/**
+ * @file   cache.cpp
+ * @date   Mon Oct 19 18:11:52 2026
+ *
+ * @brief  Bounded LRU cache of generated coordinates
+ *
+ * Slots are filled in order until the cache is full, after that
+ * the least recently used slot is recycled for every new entry.
+ *
+ * A file in the cache directory is
+ *
+ *   Header, int64_t key[nkey], double data[ndata]
+ *
+ * in native byte order, it is only meant to be shared on one node.
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "errno.h"
+#include "cache.h"
+#include "memory.h"
+#include "error.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace CCB_NS;
+
+Cache::Cache(CCB *ccb, int max) :
+          Pointers(ccb),
+          maxentry(max > 0 ? max : 1),
+          nentry(0),
+          resolution(CACHE_RESOLUTION),
+          nhit(0),
+          nmiss(0),
+          nevict(0),
+          ndisk(0),
+          nwrite(0),
+          dir(NULL),
+          entry(NULL),
+          head(-1),
+          tail(-1),
+          bucket(NULL),
+          nbucket(1)
+{
+    // Keep the load factor at or below one half
+    while (nbucket < 2 * maxentry)
+        nbucket <<= 1;
+
+    entry = (Entry *) memory->smalloc(maxentry * sizeof(Entry), "cache:entry");
+    memory->create(bucket, nbucket, "cache:bucket");
+
+    for (int i = 0; i < nbucket; i++)
+        bucket[i] = -1;
+}
+
+Cache::~Cache() {
+    clear();
+    delete [] dir;
+    memory->sfree(entry);
+    memory->destroy(bucket);
+}
+
+/**
+ * FNV-1a, also used to fold strings into a key
+ */
+
+uint64_t Cache::hash(const void *buf, bigint nbyte) {
+
+    uint64_t h = 14695981039346656037ULL;
+    const unsigned char *p = (const unsigned char *) buf;
+    const unsigned char *end = p + nbyte;
+
+    for (; p < end; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+/**
+ * Look up the coordinates stored for key. A hit makes the entry the
+ * most recently used one.
+ *
+ * @param ndata set to the number of values stored on a hit
+ * @return the stored values or NULL on a miss
+ */
+
+const double *Cache::find(const int64_t *key, int nkey, bigint &ndata) {
+
+    uint64_t h = hash(key, nkey * sizeof(int64_t));
+    int i = lookup(h, key, nkey);
+
+    if (i < 0) {
+        const double *data = dir ? load(h, key, nkey, ndata) : NULL;
+        if (data) ndisk++;
+        else nmiss++;
+        return data;
+    }
+
+    nhit++;
+    if (i != head) {
+        unlink(i);
+        push_front(i);
+    }
+
+    ndata = entry[i].ndata;
+    return entry[i].data;
+}
+
+/**
+ * Add an entry for key, evicting the least recently used entry if the
+ * cache is full. An existing entry for the same key is replaced.
+ *
+ * @return storage for ndata values that the caller fills, NULL if
+ * it couldn't be allocated, the cache is then unchanged
+ */
+
+double *Cache::insert(const int64_t *key, int nkey, bigint ndata) {
+
+    uint64_t h = hash(key, nkey * sizeof(int64_t));
+    int i = lookup(h, key, nkey);
+    bool found = i >= 0;
+
+    // The slot the entry will take, its storage is reused when it fits
+    int slot = found ? i : nentry < maxentry ? -1 : tail;
+    int64_t *k = slot >= 0 && entry[slot].key && entry[slot].nkey == nkey ? entry[slot].key : NULL;
+    double *d = slot >= 0 && entry[slot].data && entry[slot].ndata == ndata ? entry[slot].data : NULL;
+
+    bool fresh_key = k == NULL, fresh_data = d == NULL;
+    if (fresh_key)
+        k = (int64_t *) memory->smalloc(nkey * sizeof(int64_t), "cache:key");
+    if (fresh_data)
+        d = (double *) memory->smalloc(ndata * sizeof(double), "cache:data");
+
+    if ((k == NULL && nkey > 0) || (d == NULL && ndata > 0)) {
+        if (fresh_key) memory->sfree(k);
+        if (fresh_data) memory->sfree(d);
+        return NULL;
+    }
+
+    if (found) {
+        unlink(i);
+    } else if (nentry < maxentry) {
+        i = nentry++;
+        entry[i].key = NULL;
+        entry[i].data = NULL;
+    } else {
+        i = evict();
+    }
+
+    Entry &e = entry[i];
+
+    if (fresh_key) memory->sfree(e.key);
+    e.key = k;
+    memcpy(e.key, key, nkey * sizeof(int64_t));
+    e.nkey = nkey;
+
+    if (fresh_data) memory->sfree(e.data);
+    e.data = d;
+    e.ndata = ndata;
+
+    // A replaced entry is already in its bucket
+    if (!found) {
+        e.hash = h;
+        int b = h & (nbucket - 1);
+        e.chain = bucket[b];
+        bucket[b] = i;
+    }
+
+    push_front(i);
+
+    return e.data;
+}
+
+/**
+ * Set the directory entries are written to and read from.
+ *
+ * @param path directory, created if it doesn't exist, NULL only
+ * keeps entries in memory
+ */
+
+int Cache::set_dir(const char *path) {
+
+    delete [] dir;
+    dir = NULL;
+
+    if (path == NULL)
+        return CCB_OK;
+
+#if !defined(_WIN32)
+
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+        char str[128];
+        snprintf(str, 128, "Can't create cache directory %s", path);
+        return error->one(FLERR, str);
+    }
+
+    dir = new char[strlen(path) + 1];
+    strcpy(dir, path);
+
+    return CCB_OK;
+
+#else
+
+    return error->one(FLERR, "A cache directory is not supported on this platform");
+
+#endif
+}
+
+/**
+ * Write the entry for key to the cache directory. The file is
+ * written under a name unique to this process and renamed into
+ * place, so readers never see a partial entry.
+ */
+
+int Cache::save(const int64_t *key, int nkey) {
+
+    if (dir == NULL)
+        return CCB_OK;
+
+#if !defined(_WIN32)
+
+    uint64_t h = hash(key, nkey * sizeof(int64_t));
+    int i = lookup(h, key, nkey);
+    if (i < 0)
+        return error->one(FLERR, "No cache entry to save");
+
+    const Entry &e = entry[i];
+
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, "CCBCACHE", 8);
+    header.format = CACHE_FORMAT;
+    header.nkey = nkey;
+    header.ndata = e.ndata;
+    header.hash = h;
+
+    char name[512], tmp[544];
+    blob_name(name, 512, h);
+    snprintf(tmp, 544, "%s.%d.tmp", name, (int) getpid());
+
+    FILE *fp = fopen(tmp, "wb");
+    if (fp == NULL) {
+        error->warning(FLERR, "Can't write to the cache directory");
+        return CCB_OK;
+    }
+
+    bool ok = fwrite(&header, sizeof(Header), 1, fp) == 1 &&
+              fwrite(e.key, sizeof(int64_t), nkey, fp) == (size_t) nkey &&
+              fwrite(e.data, sizeof(double), e.ndata, fp) == (size_t) e.ndata;
+
+    if (fclose(fp) != 0) ok = false;
+
+    if (!ok || rename(tmp, name) != 0) {
+        ::unlink(tmp);
+        error->warning(FLERR, "Can't write to the cache directory");
+        return CCB_OK;
+    }
+
+    nwrite++;
+
+#endif
+
+    return CCB_OK;
+}
+
+void Cache::blob_name(char *str, int n, uint64_t h) {
+    snprintf(str, n, "%s/%016llx.ccb", dir, (unsigned long long) h);
+}
+
+/**
+ * Map the file for hash h and, if it holds key, copy it into
+ * memory as the most recently used entry.
+ *
+ * @return the stored values or NULL if there is no usable file
+ */
+
+const double *Cache::load(uint64_t h, const int64_t *key, int nkey, bigint &ndata) {
+
+#if !defined(_WIN32)
+
+    char name[512];
+    blob_name(name, 512, h);
+
+    int fd = open(name, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(Header)) {
+        close(fd);
+        return NULL;
+    }
+
+    bigint nbyte = st.st_size;
+    void *ptr = mmap(NULL, nbyte, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+        return NULL;
+
+    // Anything but an exact match for key is treated as a miss
+    const Header *header = (const Header *) ptr;
+    const int64_t *fkey = (const int64_t *) (header + 1);
+    const double *fdata = (const double *) (fkey + nkey);
+
+    double *data = NULL;
+
+    if (memcmp(header->magic, "CCBCACHE", 8) == 0 &&
+        header->format == CACHE_FORMAT &&
+        header->nkey == nkey &&
+        header->hash == h &&
+        header->ndata >= 0 &&
+        nbyte == (bigint) (sizeof(Header) + nkey * sizeof(int64_t) + header->ndata * sizeof(double)) &&
+        memcmp(fkey, key, nkey * sizeof(int64_t)) == 0) {
+
+        ndata = header->ndata;
+        data = insert(key, nkey, ndata);
+        if (data)
+            memcpy(data, fdata, ndata * sizeof(double));
+    }
+
+    munmap(ptr, nbyte);
+
+    return data;
+
+#else
+
+    return NULL;
+
+#endif
+}
+
+void Cache::clear() {
+
+    for (int i = 0; i < nentry; i++) {
+        memory->sfree(entry[i].key);
+        memory->sfree(entry[i].data);
+    }
+
+    for (int i = 0; i < nbucket; i++)
+        bucket[i] = -1;
+
+    nentry = 0;
+    head = tail = -1;
+}
+
+int Cache::lookup(uint64_t h, const int64_t *key, int nkey) {
+
+    for (int i = bucket[h & (nbucket - 1)]; i >= 0; i = entry[i].chain) {
+        const Entry &e = entry[i];
+        if (e.hash == h && e.nkey == nkey &&
+            memcmp(e.key, key, nkey * sizeof(int64_t)) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+void Cache::unlink(int i) {
+
+    Entry &e = entry[i];
+
+    if (e.prev >= 0) entry[e.prev].next = e.next;
+    else head = e.next;
+
+    if (e.next >= 0) entry[e.next].prev = e.prev;
+    else tail = e.prev;
+}
+
+void Cache::push_front(int i) {
+
+    entry[i].prev = -1;
+    entry[i].next = head;
+
+    if (head >= 0) entry[head].prev = i;
+    head = i;
+
+    if (tail < 0) tail = i;
+}
+
+int Cache::evict() {
+
+    int i = tail;
+    unlink(i);
+
+    // Take it out of its bucket
+    int *p = &bucket[entry[i].hash & (nbucket - 1)];
+    while (*p != i)
+        p = &entry[*p].chain;
+    *p = entry[i].chain;
+
+    nevict++;
+    return i;
+}
+
+void Cache::print_stats() {
+
+    if (screen)
+        fprintf(screen, "Cache: " BIGINT_FORMAT " hits " BIGINT_FORMAT " misses "
+                BIGINT_FORMAT " evictions %d/%d entries %g Mbytes\n",
+                nhit, nmiss, nevict, nentry, maxentry, memory_usage() / 1024.0 / 1024.0);
+
+    if (screen && dir)
+        fprintf(screen, "Cache: " BIGINT_FORMAT " read from and " BIGINT_FORMAT " written to %s\n",
+                ndisk, nwrite, dir);
+}
+
+double Cache::memory_usage() {
+
+    double bytes = 0.0;
+
+    bytes += maxentry * sizeof(Entry);
+    bytes += nbucket * sizeof(int);
+
+    for (int i = 0; i < nentry; i++)
+        bytes += entry[i].nkey * sizeof(int64_t) + entry[i].ndata * sizeof(double);
+
+    return bytes;
+}
@@ -0,0 +1,139 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   cache.h
+ * @date   Mon Oct 19 18:04:33 2026
+ *
+ * @brief  Bounded LRU cache of generated coordinates
+ *
+ * Entries are keyed by the quantized parameters of a backbone
+ * style (see Backbone::pack_params) and hold the finished
+ * coordinates. Lookups hash the key into a bucket table, the
+ * entries themselves sit on a doubly linked list in order of use
+ * so the least recently used one is evicted when the cache is full.
+ *
+ * If a directory is set, entries are also written there as one
+ * file per key, named by the hash of the key. A file holds a
+ * fixed header, the key and the coordinates, all 8-byte aligned,
+ * so it can be mapped and used in place. Files are written under
+ * a temporary name and renamed, so several processes can share a
+ * directory. A miss in memory checks the directory before the
+ * caller regenerates.
+ */
+
+#ifndef CCB_CACHE_H
+#define CCB_CACHE_H
+
+#include "pointers.h"
+
+/**
+ * @def CACHE_FORMAT
+ *
+ * @brief Layout version of the cache files, files written
+ * with another layout are ignored
+ */
+
+#define CACHE_FORMAT 1
+
+/**
+ * @def CACHE_RESOLUTION
+ *
+ * @brief Default quantization step of the cache keys, in Angstrom
+ * and degrees, close enough that only repeated parameters hit
+ */
+
+#define CACHE_RESOLUTION 1.0e-6
+
+namespace CCB_NS {
+class Cache: protected Pointers {
+
+  public:
+
+    // Constructor and Destructor
+    Cache(class CCB *, int); /**< Cache constructor, maximum number of entries */
+    ~Cache(); /**< Cache deconstructor */
+
+    int maxentry; /**< maximum number of entries held */
+    int nentry; /**< current number of entries */
+    double resolution; /**< parameters closer than this share an entry */
+
+    bigint nhit; /**< lookups that found an entry */
+    bigint nmiss; /**< lookups that didn't */
+    bigint nevict; /**< entries evicted to make room */
+    bigint ndisk; /**< misses in memory found in the directory */
+    bigint nwrite; /**< entries written to the directory */
+
+    char *dir; /**< directory entries spill to, NULL keeps them in memory only */
+    int set_dir(const char *path); /**< spill to path, created if needed, NULL stops */
+
+    const double *find(const int64_t *key, int nkey, bigint &ndata); /**< coordinates stored for key or NULL */
+    double *insert(const int64_t *key, int nkey, bigint ndata); /**< storage for the coordinates of a new entry */
+    int save(const int64_t *key, int nkey); /**< write the entry for key to the directory */
+    void clear(); /**< drop all entries */
+
+    void print_stats();
+    double memory_usage();
+
+    static uint64_t hash(const void *buf, bigint nbyte); /**< FNV-1a hash of nbyte bytes */
+
+  private:
+    struct Entry {
+        uint64_t hash; /**< hash of the key */
+        int64_t *key; /**< quantized parameters */
+        int nkey;
+        double *data; /**< the cached coordinates */
+        bigint ndata;
+        int prev, next; /**< neighbors in order of use, -1 terminates */
+        int chain; /**< next entry in the same bucket, -1 terminates */
+    };
+
+    Entry *entry; /**< entry storage, maxentry long */
+    int head, tail; /**< most and least recently used entries */
+
+    int *bucket; /**< first entry in each hash bucket, -1 if empty */
+    int nbucket; /**< number of buckets, a power of 2 */
+
+    int lookup(uint64_t h, const int64_t *key, int nkey); /**< index of the entry or -1 */
+    void unlink(int i); /**< take an entry off the list of use */
+    void push_front(int i); /**< make an entry the most recently used */
+    int evict(); /**< drop the least recently used entry, returns its slot */
+
+    // Files in the cache directory
+    struct Header {
+        char magic[8]; /**< "CCBCACHE" */
+        int32_t format; /**< CACHE_FORMAT */
+        int32_t nkey;
+        int64_t ndata;
+        uint64_t hash; /**< hash of the key, also the file name */
+    };
+
+    void blob_name(char *str, int n, uint64_t h); /**< file holding the entry with hash h */
+    const double *load(uint64_t h, const int64_t *key, int nkey, bigint &ndata); /**< read an entry from the directory */
+};
+}
+
+#endif
@@ -46,6 +46,8 @@
 #include "bitmask.h"
 #include "domain.h"
 #include "backbonehandler.h"
+#include "timer.h"
+#include "trace.h"
 
 #define BLEN 200
 
@@ -63,9 +65,11 @@ CCB::CCB(int , char **) {
 
 	/// Initialize fundamental classes
 	memory = new Memory(this);
+	trace = new Trace(this);
 	error = new Error(this);
 	universe = new Universe(this);
 	ccbio = new Ccbio(this);
+	timer = new Timer(this);
 
 	/// Set screen to stdout
 	screen = stdout;
@@ -86,19 +90,26 @@ CCB::CCB(int , char **) {
 
 CCB::~CCB() {
 
+	if (CCB_TRACE_ON(10)) {
+		ccbio->memory_usage();
+		fprintf(screen, "-----Normal Termination of CCB-----\n");
+	}
+
 	// Kill top level classes
 	destroy();
 
-	// Delete fundamental classes
+	// Stats are complete once the top level classes are gone
+	delete timer;
+
+	// Errors from here on go straight to screen
+	delete trace;
+	trace = NULL;
+
+	// Delete fundamental classes, memory last as the others free through it
+	delete ccbio;
 	delete universe;
 	delete error;
 	delete memory;
-	delete ccbio;
-
-     if (error->verbosity_level == 10) {
-          ccbio->memory_usage();
-          fprintf(screen, "-----Normal Termination of CCB-----\n");
-     }
 }
 
 /**
@@ -107,9 +118,10 @@ CCB::~CCB() {
 
 void CCB::create() {
 
+	// atoms take a bitmask column as they are created
+	bitmask = new Bitmask(this);
 	domain = new Domain(this);
 	backbone = new BackboneHandler(this);
-	bitmask = new Bitmask(this);
 }
 
 /**
@@ -124,9 +136,9 @@ void CCB::init() {
  */
 void CCB::destroy() {
 
-	delete bitmask;
 	delete backbone;
 	delete domain;
+	delete bitmask;
 
 }
 
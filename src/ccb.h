@@ -68,6 +68,8 @@ namespace CCB_NS {
           class Error *error; /**< Error handling: error.cpp/error.h,	taken from LAMMPS */
           class Universe *universe; /**< Universe of Processors: universe.cpp/universe.h, taken from LAMMPS */
           class Ccbio *ccbio; /**< Input and output styles for reading and outputting files */
+          class Timer *timer; /**< Per-phase timers and counters: timer.cpp/timer.h */
+          class Trace *trace; /**< Leveled diagnostic messages: trace.cpp/trace.h */
 
           // Pointers to top-level CCB classes
 
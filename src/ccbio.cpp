@@ -37,12 +37,17 @@
 #include "stdio.h"
 #include "string.h"
 #include "ccbio.h"
+#include "input.h"
+#include "style_input.h"
 #include "output.h"
 #include "style_output.h"
 #include "memory.h"
 #include "error.h"
 #include "universe.h"
 #include "domain.h"
+#include "backbonehandler.h"
+#include "cache.h"
+#include "bitmask.h"
 
 using namespace CCB_NS;
 
@@ -61,6 +66,9 @@ Ccbio::Ccbio(CCB *ccb) :
 		Pointers(ccb) {
 
 	// Initialize some variables
+	ninput = maxinput = 0;
+	input = NULL;
+
 	noutput = maxoutput = 0;
 	output = NULL;
 }
@@ -73,12 +81,107 @@ Ccbio::Ccbio(CCB *ccb) :
 
 Ccbio::~Ccbio() {
 
+	// Delete Inputs
+	while (ninput)
+		delete_input(input[0]->id);
+	memory->sfree(input);
+
 	// Delete Outputs
 	while (noutput)
 		delete_output(output[0]->id);
 	memory->sfree(output);
 }
 
+  // +-----------------------------------------+ 
+  // |  *  INPUT CREATION / DELETION ROUTINES  | 
+  // +-----------------------------------------+ 
+
+
+int Ccbio::add_input(int narg, const char **arg) {
+
+	if (narg < 4)
+		return error->one(FLERR,"Illegal input command");
+
+	// Check to see if the input is already defined.
+	if (find_input(arg[2]) >= 0)
+		return error->one(FLERR,"The input already exists");
+
+	// realloc more space if we don't have enough to create a new input
+	if (ninput == maxinput) {
+		maxinput += DELTA_INOUT;
+		input = (Input **) memory->srealloc(input, maxinput * sizeof(Input *), "ccbio:input");
+	}
+
+	if (input == NULL)
+		return CCB_ERROR;
+
+	//create the input
+
+	if (0)
+		return CCB_OK;
+
+#define INPUT_CLASS
+#define InputStyle(key,Class)\
+    else if (strcmp(arg[1],#key) == 0) input[ninput] = new Class(ccb,narg,arg);
+#include "style_input.h"
+#undef INPUT_CLASS
+
+	else
+		return error->one(FLERR,"Invalid input style");
+
+	//Update the total number of active inputs.
+	ninput++;
+
+	return CCB_OK;
+}
+
+int Ccbio::delete_input(const char *id) {
+
+	int iinput = find_input(id);
+
+	if (iinput < 0)
+		return error->one(FLERR,"Could not find input type ID to delete");
+	delete input[iinput];
+
+	for (int i = iinput + 1; i < ninput; i++)
+		input[i - 1] = input[i];
+
+	ninput--;
+
+	return CCB_OK;
+}
+
+int Ccbio::find_input(const char *id) {
+	int iinput;
+	for (iinput = 0; iinput < ninput; iinput++)
+		if (strcmp(id, input[iinput]->id) == 0)
+			break;
+	if (iinput == ninput)
+		return -1;
+	return iinput;
+}
+
+int Ccbio::init_input(const char *id) {
+	int iinput = find_input(id);
+	if (iinput < 0)
+		return error->one(FLERR,"Could not find input type ID to initialize");
+
+	return input[iinput]->init();
+}
+
+int Ccbio::read_input(const char *id) {
+	int iinput = find_input(id);
+	if (iinput < 0)
+		return error->one(FLERR,"Could not find input type ID to read");
+
+	return input[iinput]->read();
+}
+
+void Ccbio::active_inputs() {
+	for (int i = 0; i < ninput; i++)
+		fprintf(screen, "%s\n", input[i]->id);
+}
+
   // +-----------------------------------------+ 
   // |  *  OUTPUT CREATION / DELETION ROUTINES | 
   // +-----------------------------------------+ 
@@ -163,9 +266,7 @@ int Ccbio::init_output(const char *id) {
 	if (ioutput < 0)
 		return error->one(FLERR,"Could not find output type ID to initialize");
 
-	output[ioutput]->init();
-
-     return CCB_OK;
+	return output[ioutput]->init();
 
 }
 
@@ -174,9 +275,7 @@ int Ccbio::write_output(const char *id) {
 	if (ioutput < 0)
 		return error->one(FLERR,"Could not find output type ID to write");
 
-	output[ioutput]->write();
-
-     return CCB_OK;
+	return output[ioutput]->write();
 
 }
 
@@ -186,14 +285,30 @@ void Ccbio::active_outputs() {
 }
 
 
-void Ccbio::memory_usage() {
-
-	bigint bytes = 0;
-
-	bytes += domain->memory_usage();
+/**
+ * Report the memory held by every subsystem, followed by the
+ * live and peak bytes of each named allocation
+ */
 
-	double mbytes = bytes / 1024.0 / 1024.0;
+void Ccbio::memory_usage() {
 
-	if (universe->me == 0)
-		fprintf(screen, "Domain memory usage per processor = %g Mbytes\n", mbytes);
+	double mbyte = 1024.0 * 1024.0;
+	double bytes = (maxinput + maxoutput) * sizeof(void *);
+
+	if (universe->me != 0 || screen == NULL)
+		return;
+
+	fprintf(screen, "Domain memory usage per processor = %g Mbytes\n",
+			domain->memory_usage() / mbyte);
+	fprintf(screen, "Backbone memory usage per processor = %g Mbytes\n",
+			backbone->memory_usage() / mbyte);
+	fprintf(screen, "Bitmask memory usage per processor = %g Mbytes\n",
+			bitmask->memory_usage() / mbyte);
+	if (backbone->cache)
+		fprintf(screen, "Cache memory usage per processor = %g Mbytes\n",
+				backbone->cache->memory_usage() / mbyte);
+	fprintf(screen, "Input/output memory usage per processor = %g Mbytes\n",
+			bytes / mbyte);
+
+	memory->print_usage();
 }
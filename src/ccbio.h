@@ -60,12 +60,26 @@ class Ccbio: protected Pointers {
     // Memory Usage
     void memory_usage();
 
+    class Input **input; /**< List of Inputs */
     class Output **output; /**< List of Outputs, e.g. pointer to pointer to output */
 
+    //Input Styles
+    int ninput; /**< Running count of input styles */
+    int maxinput; /**< Maximum number of inputs to create */
+
     //Output Styles
     int noutput; /**< Running count of output styles */
     int maxoutput; /**< Maximum number of outputs to create */
 
+    //Inputs
+    int init_input(const char *);
+    int read_input(const char *);
+    int add_input(int, const char **);
+    int delete_input(const char *);
+    int find_input(const char *);
+
+    void active_inputs();
+
     //Outputs
     int init_output(const char *);
     int write_output(const char *);
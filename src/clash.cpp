@@ -0,0 +1,279 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   clash.cpp
+ * @date   Mon Oct 19 16:29:45 2026
+ *
+ * @brief  Inter-chain clash screening
+ *
+ * Binning follows the usual linked-cell approach: binhead holds
+ * the first atom of each bin and next chains the rest.
+ */
+
+#include "math.h"
+#include "string.h"
+#include "clash.h"
+#include "memory.h"
+#include "error.h"
+#include "domain.h"
+#include "site.h"
+#include "group.h"
+#include "atom.h"
+#include "bitmask.h"
+
+/**
+ * @def MAX_CHAIN
+ *
+ * @brief Number of distinct chain identifiers tracked
+ */
+
+#define MAX_CHAIN 256
+
+/**
+ * @def BIN_PER_ATOM
+ *
+ * @brief Upper bound on bins per atom, a sparse system
+ * gets larger bins rather than a huge empty grid
+ */
+
+#define BIN_PER_ATOM 8
+
+using namespace CCB_NS;
+
+Clash::Clash(CCB *ccb) :
+          Pointers(ccb),
+          cutoff(3.0),
+          npair(0),
+          dmin(0.0),
+          natom(0),
+          maxatom(0),
+          x(NULL),
+          chain(NULL),
+          next(NULL),
+          maxbin(0),
+          binhead(NULL),
+          bininv(0.0)
+{
+    nbin[0] = nbin[1] = nbin[2] = 0;
+    binlo[0] = binlo[1] = binlo[2] = 0.0;
+}
+
+Clash::~Clash() {
+    memory->destroy(x);
+    memory->destroy(chain);
+    memory->destroy(next);
+    memory->destroy(binhead);
+}
+
+/**
+ * Count pairs of atoms in different chains closer than the cutoff.
+ *
+ * @param mask only atoms in mask are screened
+ * @param maxpair stop once this many clashes are found, 0 counts all
+ */
+
+int Clash::check(int mask, int maxpair) {
+
+    npair = 0;
+    dmin = HUGE_VAL;
+
+    if (cutoff <= 0.0)
+        return error->one(FLERR, "Clash cutoff must be positive");
+
+    if (gather(mask) != CCB_OK || setup_bins() != CCB_OK)
+        return CCB_ERROR;
+
+    double cutsq = cutoff * cutoff;
+    int nx = nbin[0], ny = nbin[1], nz = nbin[2];
+
+    // Each pair is visited once, from the bin of the lower index
+    for (int i = 0; i < natom; i++) {
+
+        int ix = coord2bin(x[i][0], 0);
+        int iy = coord2bin(x[i][1], 1);
+        int iz = coord2bin(x[i][2], 2);
+
+        for (int kz = (iz > 0 ? iz - 1 : 0); kz <= iz + 1 && kz < nz; kz++)
+            for (int ky = (iy > 0 ? iy - 1 : 0); ky <= iy + 1 && ky < ny; ky++)
+                for (int kx = (ix > 0 ? ix - 1 : 0); kx <= ix + 1 && kx < nx; kx++)
+                    for (int j = binhead[(kz * ny + ky) * nx + kx]; j >= 0; j = next[j]) {
+
+                        if (j <= i || chain[j] == chain[i]) continue;
+
+                        double dx = x[j][0] - x[i][0];
+                        double dy = x[j][1] - x[i][1];
+                        double dz = x[j][2] - x[i][2];
+                        double rsq = dx * dx + dy * dy + dz * dz;
+
+                        if (rsq < dmin) dmin = rsq;
+
+                        if (rsq < cutsq) {
+                            npair++;
+                            if (maxpair > 0 && npair >= maxpair) {
+                                dmin = sqrt(dmin);
+                                return CCB_OK;
+                            }
+                        }
+                    }
+    }
+
+    dmin = sqrt(dmin);
+
+    return CCB_OK;
+}
+
+/**
+ * Copy the coordinates of the atoms in mask into a contiguous
+ * array and give each a chain index.
+ */
+
+int Clash::gather(int mask) {
+
+    const char *names[MAX_CHAIN];
+    int nchain = 0;
+    int ichain = -1;
+    Site *prev = NULL;
+
+    int nlist = 0;
+    Atom **list = bitmask->list(mask, nlist);
+
+    if (nlist > maxatom) {
+        maxatom = nlist + 1024;
+        memory->grow(x, maxatom, 3, "clash:x");
+        memory->grow(chain, maxatom, "clash:chain");
+        memory->grow(next, maxatom, "clash:next");
+        if (x == NULL || chain == NULL || next == NULL)
+            return CCB_ERROR;
+    }
+
+    for (natom = 0; natom < nlist; natom++) {
+
+        Atom *a = list[natom];
+        Site *s = a->site;
+
+        // Sites come in chain order, only look up a chain when it changes
+        if (s != prev && (ichain < 0 || strcmp(names[ichain], s->chain) != 0)) {
+            for (ichain = 0; ichain < nchain; ichain++)
+                if (strcmp(names[ichain], s->chain) == 0) break;
+            if (ichain == nchain) {
+                if (nchain == MAX_CHAIN)
+                    return error->one(FLERR, "Too many chains for clash screening");
+                names[nchain++] = s->chain;
+            }
+        }
+        prev = s;
+
+        x[natom][0] = a->x;
+        x[natom][1] = a->y;
+        x[natom][2] = a->z;
+        chain[natom] = ichain;
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * Size the grid to the bounding box of the atoms and
+ * thread each atom onto the list of its bin.
+ */
+
+int Clash::setup_bins() {
+
+    if (natom == 0) {
+        nbin[0] = nbin[1] = nbin[2] = 0;
+        return CCB_OK;
+    }
+
+    double hi[3];
+    for (int d = 0; d < 3; d++)
+        binlo[d] = hi[d] = x[0][d];
+
+    for (int i = 1; i < natom; i++)
+        for (int d = 0; d < 3; d++) {
+            if (x[i][d] < binlo[d]) binlo[d] = x[i][d];
+            if (x[i][d] > hi[d]) hi[d] = x[i][d];
+        }
+
+    // Bins no smaller than the cutoff, grown if the grid
+    // would be much larger than the number of atoms. The
+    // count uses the same product as coord2bin() so the atoms
+    // on the upper bound land in the last bin.
+    double binsize = cutoff;
+    bigint ntotal;
+    while (true) {
+        bininv = 1.0 / binsize;
+        ntotal = 1;
+        for (int d = 0; d < 3; d++) {
+            nbin[d] = static_cast<int> ((hi[d] - binlo[d]) * bininv) + 1;
+            ntotal *= nbin[d];
+        }
+        if (ntotal <= (bigint) BIN_PER_ATOM * natom + 27) break;
+        binsize *= 2.0;
+    }
+
+    if (ntotal > maxbin) {
+        maxbin = ntotal;
+        memory->grow(binhead, maxbin, "clash:binhead");
+        if (binhead == NULL) return CCB_ERROR;
+    }
+
+    for (int b = 0; b < ntotal; b++)
+        binhead[b] = -1;
+
+    // Thread in reverse so each bin lists atoms in increasing order
+    for (int i = natom - 1; i >= 0; i--) {
+        int ix = coord2bin(x[i][0], 0);
+        int iy = coord2bin(x[i][1], 1);
+        int iz = coord2bin(x[i][2], 2);
+        int b = (iz * nbin[1] + iy) * nbin[0] + ix;
+        next[i] = binhead[b];
+        binhead[b] = i;
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * Bin of coordinate v along dimension d, clamped to the grid
+ * so round off at the upper bound can't step past it.
+ */
+
+int Clash::coord2bin(double v, int d) {
+
+    int i = static_cast<int> ((v - binlo[d]) * bininv);
+    return i < nbin[d] ? i : nbin[d] - 1;
+}
+
+double Clash::memory_usage() {
+
+    double bytes = 0.0;
+
+    bytes += maxatom * (3 * sizeof(double) + 2 * sizeof(int));
+    bytes += maxbin * sizeof(int);
+
+    return bytes;
+}
@@ -0,0 +1,82 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   clash.h
+ * @date   Mon Oct 19 16:21:08 2026
+ *
+ * @brief  Inter-chain clash screening
+ *
+ * Bins the atoms of the domain on a uniform grid with a bin
+ * size of at least the cutoff so only neighboring bins need
+ * to be searched. Only pairs of atoms in different chains are
+ * counted, so a single check costs O(N) and can be used to
+ * reject a geometry before anything is written.
+ */
+
+#ifndef CCB_CLASH_H
+#define CCB_CLASH_H
+
+#include "pointers.h"
+
+namespace CCB_NS {
+class Clash: protected Pointers {
+
+  public:
+
+    // Constructor and Destructor
+    Clash(class CCB *); /**< Clash constructor */
+    ~Clash(); /**< Clash deconstructor */
+
+    double cutoff; /**< atoms in different chains closer than this clash */
+
+    int npair; /**< number of clashing pairs found by the last check */
+    double dmin; /**< shortest inter-chain distance within the searched bins */
+
+    int check(int mask, int maxpair = 0); /**< count clashes among atoms in mask, stop after maxpair if > 0 */
+
+    double memory_usage();
+
+  private:
+    int natom; /**< number of atoms binned */
+    int maxatom; /**< allocated length of the per-atom arrays */
+    double **x; /**< coordinates of the binned atoms */
+    int *chain; /**< chain index of each atom */
+    int *next; /**< next atom in the same bin, -1 terminates */
+
+    int nbin[3]; /**< number of bins in each dimension */
+    int maxbin; /**< allocated length of binhead */
+    int *binhead; /**< first atom in each bin, -1 if empty */
+    double binlo[3]; /**< lower corner of the grid */
+    double bininv; /**< inverse bin size */
+
+    int gather(int mask); /**< copy the masked atoms out of the domain */
+    int setup_bins(); /**< size the grid and bin the atoms */
+    int coord2bin(double v, int d); /**< bin of coordinate v along dimension d */
+};
+}
+
+#endif
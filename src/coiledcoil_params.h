@@ -0,0 +1,117 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   coiledcoil_params.h
+ * @date   Mon Oct 19 09:20:31 2026
+ *
+ * @brief  Binary parameters of the coiledcoil backbone style
+ *
+ * The same options the style parses from strings, handed over
+ * as numbers so that callers in a loop, an objective function
+ * or an interpreter that already holds doubles, skip the
+ * string round trip. Only the fields named in set are applied,
+ * everything else keeps its current value. Lists point to
+ * caller owned arrays and angles are in degrees, as on the
+ * command line.
+ *
+ *     CoiledCoilParams p;
+ *     p.set = CoiledCoilParams::PITCH | CoiledCoilParams::ROTATION;
+ *     p.pitch = 140.0;
+ *     p.rotation = rot; p.nrotation = 4;
+ *     ccb->backbone->update_backbone("coil", p);
+ */
+
+#ifndef CCB_COILEDCOIL_PARAMS_H
+#define CCB_COILEDCOIL_PARAMS_H
+
+#include <stddef.h>
+
+namespace CCB_NS {
+
+struct CoiledCoilParams {
+
+  /// Bits of set, one per option of the string interface
+  enum {
+    NHELIX       = 1 << 0,      /**< -nhelix */
+    PITCH        = 1 << 1,      /**< -pitch */
+    RPR          = 1 << 2,      /**< -rpr */
+    RADIUS       = 1 << 3,      /**< -radius */
+    NRES         = 1 << 4,      /**< -nres */
+    ROTATION     = 1 << 5,      /**< -rotation */
+    SQUARE       = 1 << 6,      /**< -square */
+    RPT          = 1 << 7,      /**< -rpt */
+    ZOFF         = 1 << 8,      /**< -zoff */
+    Z            = 1 << 9,      /**< -Z */
+    ORDER        = 1 << 10,     /**< -order */
+    ANTIPARALLEL = 1 << 11,     /**< -antiparallel */
+    ASYMMETRIC   = 1 << 12,     /**< -asymmetric */
+    FRASERMACRAE = 1 << 13,     /**< -frasermacrae */
+    FM_RPT       = 1 << 14,     /**< -frasermacrae rpt|pitch */
+    PRECISION    = 1 << 15      /**< -precision */
+  };
+
+  CoiledCoilParams() :
+    set(0), nhelix(0), pitch(0.0), rpr(0.0), nradius(0),
+    nres(NULL), nnres(0), rotation(NULL), nrotation(0),
+    square(NULL), nsquare(0), rpt(NULL), nrpt(0),
+    zoff(NULL), nzoff(0), z(NULL), nz(0),
+    order(NULL), norder(0), ap_order(NULL), nap_order(0),
+    antiparallel(0), asymmetric(0), frasermacrae(0), fm_rpt(0),
+    single(0), check(0) {
+    radius[0] = radius[1] = radius[2] = radius[3] = 0.0;
+  }
+
+  unsigned int set;             /**< which of the fields below to apply */
+
+  int nhelix;                   /**< number of helices */
+  double pitch;                 /**< pitch of the coiled-coil */
+  double rpr;                   /**< rise per residue */
+
+  double radius[4];             /**< r0_start r0_end res_start res_end */
+  int nradius;                  /**< leading entries of radius given, 1 to 4 */
+
+  // Per helix lists, entry i is helix i, helices past the end keep their values
+  const int *nres;              int nnres;
+  const double *rotation;       int nrotation; /**< degrees */
+  const double *square;         int nsquare;   /**< degrees */
+  const double *rpt;            int nrpt;
+  const double *zoff;           int nzoff;
+  const double *z;              int nz;
+  const int *order;             int norder;
+  const int *ap_order;          int nap_order; /**< NULL keeps the up-down default */
+
+  int antiparallel;             /**< build an antiparallel coil */
+  int asymmetric;               /**< every helix takes its own parameters */
+  int frasermacrae;             /**< apply the Fraser-MacRae constraint */
+  int fm_rpt;                   /**< constrain rpt to the pitch rather than the pitch to rpt */
+  int single;                   /**< store coordinates in single precision */
+  int check;                    /**< compare single against double precision */
+};
+
+}
+
+#endif
@@ -49,6 +49,7 @@
 #include "sort.h"
 #include "atom.h"
 #include "bitmask.h"
+#include "timer.h"
 
 /**
  * @def SITE_DELTA
@@ -86,11 +87,30 @@ Domain::~Domain() {
 
 void Domain::reset() {
 
+    CCB_TIMER(DOMAIN_RESET, nsite);
+
     // delete all the sites
     while (nsite)
         delete_site(site[0]->id);
 }
 
+/**
+ * Grow the site array so that at least n sites can be
+ * held, used by bulk readers to avoid reallocating every
+ * SITE_DELTA sites.
+ *
+ * @param n number of sites
+ */
+
+void Domain::reserve(int n) {
+
+    if (n <= maxsite)
+        return;
+
+    maxsite = n;
+    site = (Site **) memory->srealloc(site, maxsite * sizeof(Site *), "domain:site");
+}
+
 /**
  * Add empty site to the domain
  */
@@ -59,6 +59,7 @@ class Domain: protected Pointers {
 
     //domain management:
     void reset(); /**< clear the domain of all sites */
+    void reserve(int n); /**< make room for at least n sites without further reallocation */
 
     // Functions to manage sites
     int add_site(); /**< add an empty site */
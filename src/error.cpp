@@ -54,6 +54,7 @@
 #include "error.h"
 #include "universe.h"
 #include "memory.h"
+#include "trace.h"
 
 using namespace CCB_NS;
 
@@ -75,6 +76,8 @@ Error::Error(CCB *ccb) :
 
 int Error::all(const char *file, int line, const char *str) {
 
+    if (trace) trace->flush();
+
     if (universe->me == 0) {
         if (screen) {
             fprintf(screen, "ERROR: %s (%s:%d)\n", str, file, line);
@@ -94,6 +97,8 @@ int Error::all(const char *file, int line, const char *str) {
 
 int Error::one(const char *file, int line, const char *str) {
 
+    if (trace) trace->flush();
+
     if (screen) {
         fprintf(screen, "ERROR on proc %d: %s (%s:%d)\n", universe->me, str, file, line);
         fflush(screen);
@@ -113,6 +118,7 @@ int Error::one(const char *file, int line, const char *str) {
  */
 
 void Error::warning(const char *file, int line, const char *str) {
+    if (trace) trace->flush();
     if (screen)
         fprintf(screen, "WARNING: %s (%s:%d)\n", str, file, line);
 }
@@ -127,23 +133,7 @@ void Error::warning(const char *file, int line, const char *str) {
  */
 
 void Error::message(const char *file, int line, const char *str) {
+    if (trace) trace->flush();
     if (screen)
         fprintf(screen, "%s (%s:%d)\n", str, file, line);
 }
-
-/**
- * error->message(char *str, int verbosity)
- * called by one proc in universe, typically proc 0
- *
- * write message to screen if verbosity level is
- * greater than the specified verbosity.
- *
- * @param str
- * @param logflag
- */
-
-void Error::message_verb(char *str, int verbosity) {
-
-    if (screen && verbosity_level >= verbosity)
-        fprintf(screen, "%s\n", str);
-}
@@ -60,7 +60,6 @@ class Error: protected Pointers {
     int  one(const char *file, int line, const char *str);
     void warning(const char *file, int line, const char *str);
     void message(const char *file, int line, const char *str);
-    void message_verb(char *str, int verbosity);
 };
 
 }
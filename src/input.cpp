@@ -0,0 +1,472 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   input.cpp
+ * @date   Mon Oct 19 10:31:02 2026
+ *
+ * @brief  Routines for the Input Class and Styles
+ *
+ * The style implementation follows from that of Output. Files
+ * are memory mapped where available so the styles can walk the
+ * buffer without copying lines or tokens.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "ccbio.h"
+#include "memory.h"
+#include "error.h"
+#include "input.h"
+#include "universe.h"
+#include "domain.h"
+#include "site.h"
+#include "group.h"
+#include "atom.h"
+#include "bitmask.h"
+#include "trace.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * @def ATOMS_PER_SITE
+ *
+ * Rough number of atoms per residue used to size the
+ * domain before parsing
+ */
+
+#define ATOMS_PER_SITE 8
+
+using namespace CCB_NS;
+
+/**
+ * The Input Constructor
+ *
+ * input style id fname [-chain A B ...] [-resid lo hi]
+ *
+ * @param ccb The ccb class pointer
+ * @param narg number of arguments passed to constructor
+ * @param arg the arguments passed to the constructor
+ */
+
+Input::Input(CCB *ccb, int narg, const char **arg) :
+		Pointers(ccb),
+		natom(0),
+		nsite(0),
+		buf(NULL),
+		nbuf(0),
+		mask(0),
+		cursite(NULL),
+		chains(NULL),
+		nchain(0),
+		resid_flag(0),
+		resid_lo(0),
+		resid_hi(0),
+		mapped(false) {
+
+	//Set the name of the input style
+	int n = strlen(arg[1]) + 1;
+	style = new char[n];
+	strcpy(style, arg[1]);
+
+	//Set the input ID
+	n = strlen(arg[2]) + 1;
+	id = new char[n];
+	strcpy(id, arg[2]);
+
+	// Check to see that the ID is legit
+	for (int i = 0; i < n - 1; i++)
+		if (!isalnum(id[i]) && id[i] != '_') error->one(FLERR,
+				"Input style ID must be alphanumeric or underscore characters");
+
+	/// Set the filename
+	n = strlen(arg[3]) + 1;
+	filename = new char[n];
+	strcpy(filename, arg[3]);
+
+	// Parse-time filters
+	int iarg = 4;
+	while (iarg < narg) {
+		if (strcmp(arg[iarg], "-chain") == 0) {
+			iarg++;
+			// A repeated -chain adds to the list, narg bounds the total
+			if (chains == NULL) chains = new char*[narg];
+			int first = nchain;
+			while (iarg < narg && arg[iarg][0] != '-') {
+				chains[nchain] = new char[strlen(arg[iarg]) + 1];
+				strcpy(chains[nchain++], arg[iarg++]);
+			}
+			if (nchain == first) error->one(FLERR, "Missing argument to -chain");
+
+		} else if (strcmp(arg[iarg], "-resid") == 0) {
+			if (iarg + 2 >= narg) {
+				error->one(FLERR, "Missing argument to -resid");
+				break;
+			}
+			resid_lo = atoi(arg[iarg + 1]);
+			resid_hi = atoi(arg[iarg + 2]);
+			resid_flag = 1;
+			iarg += 3;
+
+		} else {
+			char str[128];
+			snprintf(str, sizeof(str), "Unknown input option: %s", arg[iarg]);
+			error->one(FLERR, str);
+			iarg++;
+		}
+	}
+}
+
+/**
+ * The Input deconstructor
+ *
+ * Delete id, style and filters, release the file
+ */
+
+Input::~Input() {
+
+	closefile();
+
+	for (int i = 0; i < nchain; i++)
+		delete[] chains[i];
+	delete[] chains;
+
+	delete[] id;
+	delete[] style;
+	delete[] filename;
+}
+
+/**
+ * Create the bitmask for the atoms read by this style,
+ * named after the style id, then initialize the style.
+ */
+
+int Input::init() {
+
+	if (bitmask->add_bitmask(id) != CCB_OK) return CCB_ERROR;
+	mask = bitmask->find_mask(id);
+
+	return init_style();
+}
+
+int Input::read() {
+
+	natom = nsite = 0;
+	cursite = NULL;
+
+	if (openfile() != CCB_OK) return CCB_ERROR;
+
+	int code = read_style();
+
+	closefile();
+
+	if (code == CCB_OK && universe->me == 0)
+		CCB_TRACE(3, "Input %s: %d atoms in %d sites, read from %s\n",
+				style, natom, nsite, filename);
+
+	trace->flush();
+
+	return code;
+}
+
+/**
+ * Map the whole file into buf. Falls back on a single
+ * fread into memory on platforms without mmap.
+ */
+
+int Input::openfile() {
+
+	closefile();
+
+#if !defined(_WIN32)
+
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		char str[128];
+		snprintf(str, 128, "Can't open input file %s", filename);
+		return error->one(FLERR, str);
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return error->one(FLERR, "Can't stat input file");
+	}
+
+	nbuf = st.st_size;
+	if (nbuf > 0) {
+		void *ptr = mmap(NULL, nbuf, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (ptr == MAP_FAILED) {
+			close(fd);
+			nbuf = 0;
+			return error->one(FLERR, "Can't map input file");
+		}
+		madvise(ptr, nbuf, MADV_SEQUENTIAL);
+		buf = (const char *) ptr;
+		mapped = true;
+	}
+	close(fd);
+
+#else
+
+	FILE *fp = fopen(filename, "rb");
+	if (fp == NULL) {
+		char str[128];
+		snprintf(str, 128, "Can't open input file %s", filename);
+		return error->one(FLERR, str);
+	}
+
+	fseek(fp, 0, SEEK_END);
+	nbuf = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	if (nbuf > 0) {
+		char *ptr = (char *) memory->smalloc(nbuf, "input:buf");
+		if (ptr == NULL || (bigint) fread(ptr, 1, nbuf, fp) != nbuf) {
+			memory->sfree(ptr);
+			fclose(fp);
+			nbuf = 0;
+			return error->one(FLERR, "Can't read input file");
+		}
+		buf = ptr;
+		mapped = false;
+	}
+	fclose(fp);
+
+#endif
+
+	return CCB_OK;
+}
+
+int Input::closefile() {
+
+	if (buf == NULL) return CCB_OK;
+
+#if !defined(_WIN32)
+	if (mapped)
+		munmap((void *) buf, nbuf);
+	else
+#endif
+		memory->sfree((void *) buf);
+
+	buf = NULL;
+	nbuf = 0;
+	mapped = false;
+
+	return CCB_OK;
+}
+
+/**
+ * @brief check a chain identifier against the -chain filter
+ *
+ * @param chain the chain field, not null terminated
+ * @param n length of the field
+ */
+
+int Input::accept_chain(const char *chain, int n) {
+
+	if (nchain == 0) return 1;
+
+	for (int i = 0; i < nchain; i++)
+		if ((int) strlen(chains[i]) == n && strncmp(chains[i], chain, n) == 0)
+			return 1;
+
+	return 0;
+}
+
+/**
+ * Pre-size the domain site array so bulk reads don't
+ * reallocate once per SITE_DELTA residues
+ *
+ * @param natom_estimate expected number of atoms
+ */
+
+void Input::reserve(bigint natom_estimate) {
+
+	bigint n = natom_estimate / ATOMS_PER_SITE + 1;
+	if (n > MAXSMALLINT) n = MAXSMALLINT;
+
+	domain->reserve(domain->nsite + (int) n);
+}
+
+/**
+ * @brief start a new site in the domain
+ *
+ * @return the new site, atoms added with add_atom() go here
+ */
+
+Site *Input::begin_site(int resid, const char *chain, const char *seg, const char *resname) {
+
+	int isite = domain->add_site();
+	cursite = domain->site[isite];
+
+	cursite->resid = resid;
+	strcpy(cursite->chain, chain);
+	strcpy(cursite->seg, seg);
+	strcpy(cursite->fixed_atoms->type, resname);
+	sprintf(cursite->fixed_atoms->name, "%s", "FIX");
+
+	nsite++;
+
+	return cursite;
+}
+
+/**
+ * @brief add an atom to the current site's fixed atoms
+ */
+
+Atom *Input::add_atom(const char *name, const char *element, int serial,
+		double x, double y, double z, double o, double b) {
+
+	Group *g = cursite->fixed_atoms;
+	int iatom = g->add_atom();
+	Atom *a = g->atom[iatom];
+
+	a->serial = serial;
+	strcpy(a->name, name);
+	strcpy(a->element, element);
+
+	a->x = x;
+	a->y = y;
+	a->z = z;
+	a->o = o;
+	a->b = b;
+
+	a->fixed = true;
+	a->site = cursite;
+	a->group = g;
+	bitmask->set(mask, a->index);
+
+	natom++;
+
+	return a;
+}
+
+/**
+ * @brief parse an integer from a fixed-width field
+ *
+ * Leading and trailing blanks are ignored.
+ */
+
+int Input::parse_int(const char *s, int n) {
+
+	int i = 0;
+	while (i < n && s[i] == ' ') i++;
+
+	int sign = 1;
+	if (i < n && (s[i] == '-' || s[i] == '+')) {
+		if (s[i] == '-') sign = -1;
+		i++;
+	}
+
+	int val = 0;
+	while (i < n && s[i] >= '0' && s[i] <= '9')
+		val = val * 10 + (s[i++] - '0');
+
+	return sign * val;
+}
+
+/**
+ * @brief parse a real number from a fixed-width field
+ *
+ * Handles the plain %8.3f style fields found in structure
+ * files directly, anything with an exponent goes to strtod.
+ */
+
+double Input::parse_real(const char *s, int n) {
+
+	int i = 0;
+	while (i < n && s[i] == ' ') i++;
+
+	int start = i;
+
+	double sign = 1.0;
+	if (i < n && (s[i] == '-' || s[i] == '+')) {
+		if (s[i] == '-') sign = -1.0;
+		i++;
+	}
+
+	double val = 0.0;
+	while (i < n && s[i] >= '0' && s[i] <= '9')
+		val = val * 10.0 + (s[i++] - '0');
+
+	if (i < n && s[i] == '.') {
+		i++;
+		static const double pow10[] = { 1.0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8 };
+		bigint frac = 0;
+		int ndigit = 0;
+		while (i < n && s[i] >= '0' && s[i] <= '9' && ndigit < 8) {
+			frac = frac * 10 + (s[i++] - '0');
+			ndigit++;
+		}
+		val += frac / pow10[ndigit];
+		while (i < n && s[i] >= '0' && s[i] <= '9') i++;
+	}
+
+	if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+		char tmp[64];
+		int len = n - start < 63 ? n - start : 63;
+		memcpy(tmp, s + start, len);
+		tmp[len] = '\0';
+		return strtod(tmp, NULL);
+	}
+
+	return sign * val;
+}
+
+/**
+ * @brief copy a blank padded field into a null terminated string
+ *
+ * @param dest destination string
+ * @param max size of dest including the terminator
+ * @param s source field
+ * @param n width of the source field
+ *
+ * @return length of the copied string
+ */
+
+int Input::copy_field(char *dest, int max, const char *s, int n) {
+
+	while (n > 0 && *s == ' ') {
+		s++;
+		n--;
+	}
+	while (n > 0 && (s[n - 1] == ' ' || s[n - 1] == '\r'))
+		n--;
+
+	if (n > max - 1) n = max - 1;
+	memcpy(dest, s, n);
+	dest[n] = '\0';
+
+	return n;
+}
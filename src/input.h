@@ -0,0 +1,111 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   input.h
+ * @date   Mon Oct 19 10:12:44 2026
+ *
+ * @brief  Main header for Input class and subclasses
+ *
+ * All input styles inherit from this input class, mirroring
+ * the output styles. The file is mapped into memory once by
+ * openfile() and the style parses the buffer in place, adding
+ * sites and atoms to the domain as it goes.
+ *
+ * input pdb in1 fname [-chain A B ...] [-resid lo hi]
+ */
+
+#ifndef CCB_INPUT_H
+#define CCB_INPUT_H
+
+#include "pointers.h"
+
+namespace CCB_NS {
+
+class Input: protected Pointers {
+
+public:
+
+	char *filename; /**< the input filename */
+	char *id; /**< the ID of the syle */
+	char *style; /**< the name of the style */
+
+	int natom; /**< number of atoms read by the last call to read() */
+	int nsite; /**< number of sites created by the last call to read() */
+
+	//Constructor and Destructor
+	Input(class CCB *, int, const char **); /**< Input constructor */
+	virtual ~Input(); /**< Input destructor, must be virtual! */
+
+	int init();
+	int read();
+
+protected:
+
+	// Child Class Functions
+	virtual int init_style() = 0; /**< Initialize the style */
+	virtual int read_style() = 0; /**< parse buf and populate the domain */
+
+	virtual int openfile(); /**< map the file into buf, note this is NOT pure virtual */
+	virtual int closefile(); /**< unmap buf */
+
+	const char *buf; /**< contents of the file */
+	bigint nbuf; /**< length of buf in bytes */
+
+	int mask; /**< bitmask group given to every atom read */
+
+	// Parse-time filters
+	int accept_chain(const char *chain, int n); /**< true if chain passes the -chain filter */
+	int accept_resid(int resid) {
+		return !resid_flag || (resid >= resid_lo && resid <= resid_hi);
+	}
+
+	// Domain population helpers shared by the styles
+	class Site *begin_site(int resid, const char *chain, const char *seg, const char *resname);
+	class Atom *add_atom(const char *name, const char *element, int serial,
+	                     double x, double y, double z, double o, double b);
+	void reserve(bigint natom_estimate); /**< size the domain for the expected number of sites */
+
+	// Fixed-width field parsers, no allocation
+	static int parse_int(const char *s, int n);
+	static double parse_real(const char *s, int n);
+	static int copy_field(char *dest, int max, const char *s, int n);
+
+private:
+	class Site *cursite; /**< the site atoms are currently being added to */
+
+	char **chains; /**< chain identifiers to keep, NULL keeps all */
+	int nchain;
+
+	int resid_flag; /**< apply the residue range filter */
+	int resid_lo, resid_hi;
+
+	bool mapped; /**< buf came from mmap rather than smalloc */
+};
+
+}
+
+#endif
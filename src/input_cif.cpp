@@ -0,0 +1,323 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   input_cif.cpp
+ * @date   Mon Oct 19 13:42:51 2026
+ *
+ * @brief  mmCIF input style routine.
+ *
+ * Reads the _atom_site loop of the first model into the domain.
+ * Author chain, residue and atom names are preferred over the
+ * label_ ones so the sites match those read from the equivalent
+ * pdb file. Tokens are referenced in place in the mapped file.
+ *
+ * http://mmcif.wwpdb.org/dictionaries/mmcif_pdbx_v50.dic/Categories/atom_site.html
+ *
+ * loop_
+ * _atom_site.group_PDB
+ * _atom_site.id
+ * _atom_site.type_symbol
+ * _atom_site.label_atom_id
+ * ...
+ * ATOM   1    N N   . VAL A 1 1   ? 6.204   16.869  4.854   1.00 49.05 ? 1   VAL A N   1
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "input_cif.h"
+#include "error.h"
+#include "universe.h"
+#include "memory.h"
+#include "domain.h"
+
+/**
+ * @def MAX_COLUMN
+ *
+ * Maximum number of columns in the _atom_site loop
+ */
+
+#define MAX_COLUMN 64
+
+using namespace CCB_NS;
+
+/**
+ * _atom_site items used to build the domain
+ */
+
+enum {
+    GROUP, ID, TYPE, LABEL_ATOM, AUTH_ATOM, ALT, LABEL_COMP, AUTH_COMP,
+    LABEL_ASYM, AUTH_ASYM, LABEL_SEQ, AUTH_SEQ, INS, X, Y, Z, OCC, BFAC,
+    MODEL, NITEM
+};
+
+static const char *item[NITEM] = {
+    "group_PDB", "id", "type_symbol", "label_atom_id", "auth_atom_id",
+    "label_alt_id", "label_comp_id", "auth_comp_id", "label_asym_id",
+    "auth_asym_id", "label_seq_id", "auth_seq_id", "pdbx_PDB_ins_code",
+    "Cartn_x", "Cartn_y", "Cartn_z", "occupancy", "B_iso_or_equiv",
+    "pdbx_PDB_model_num"
+};
+
+/**
+ * The InputCIF Constructor
+ *
+ * @param ccb The ccb pointer
+ * @param narg number of arguments passed
+ * @param arg the arguments passed
+ */
+
+InputCIF::InputCIF(CCB *ccb, int narg, const char **arg) :
+        Input(ccb, narg, arg) {
+    // Check to see that we have a legit style and the format is correct.
+    if (narg < 4)
+        error->one(FLERR, "Illegal input CIF command");
+}
+
+int InputCIF::init_style() {
+
+    return CCB_OK;
+
+}
+
+/**
+ * @brief return the next token, skipping comments
+ *
+ * Quoted tokens are returned without their quotes.
+ *
+ * @param p current position, advanced past the token
+ * @param end end of the buffer
+ * @param len length of the returned token
+ *
+ * @return start of the token or NULL at end of buffer
+ */
+
+const char *InputCIF::next_token(const char *&p, const char *end, int &len) {
+
+    while (p < end) {
+        if (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+            p++;
+        } else if (*p == '#') {
+            while (p < end && *p != '\n') p++;
+        } else {
+            break;
+        }
+    }
+
+    if (p >= end) return NULL;
+
+    const char *start = p;
+
+    if (*p == '\'' || *p == '"') {
+        // Quote ends at a matching quote followed by whitespace
+        char q = *p++;
+        start = p;
+        while (p < end && !(*p == q && (p + 1 == end || p[1] == ' ' || p[1] == '\t' ||
+                                        p[1] == '\n' || p[1] == '\r')))
+            p++;
+        len = p - start;
+        if (p < end) p++;
+        return start;
+    }
+
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') p++;
+    len = p - start;
+
+    return start;
+}
+
+/**
+ * Locates the _atom_site loop and adds the atoms in each row
+ * to the domain.
+ */
+
+int InputCIF::read_style() {
+
+    if (buf == NULL)
+        return CCB_OK;
+
+    const char *p = buf;
+    const char *end = buf + nbuf;
+    const char *tok = NULL;
+    int len = 0;
+
+    int col[NITEM];
+    for (int i = 0; i < NITEM; i++) col[i] = -1;
+    int ncol = 0;
+
+    // Find the loop_ whose items are _atom_site.*
+    while ((tok = next_token(p, end, len)) != NULL) {
+
+        if (len != 5 || strncmp(tok, "loop_", 5) != 0)
+            continue;
+
+        const char *q = p;
+        while ((tok = next_token(q, end, len)) != NULL &&
+               len > 11 && strncmp(tok, "_atom_site.", 11) == 0) {
+            for (int i = 0; i < NITEM; i++)
+                if (len - 11 == (int) strlen(item[i]) && strncmp(tok + 11, item[i], len - 11) == 0)
+                    col[i] = ncol;
+            ncol++;
+            p = q;
+        }
+
+        if (ncol > 0) break;
+    }
+
+    if (ncol == 0) {
+        char str[128];
+        snprintf(str, 128, "Input CIF: no _atom_site loop in %s", filename);
+        return error->one(FLERR, str);
+    }
+
+    if (ncol > MAX_COLUMN)
+        return error->one(FLERR, "Input CIF: too many _atom_site columns");
+
+    if (col[X] < 0 || col[Y] < 0 || col[Z] < 0)
+        return error->one(FLERR, "Input CIF: _atom_site is missing Cartn_x/y/z");
+
+    // Prefer author chain/residue/atom names
+    int ichain = col[AUTH_ASYM] >= 0 ? col[AUTH_ASYM] : col[LABEL_ASYM];
+    int iseq = col[AUTH_SEQ] >= 0 ? col[AUTH_SEQ] : col[LABEL_SEQ];
+    int icomp = col[AUTH_COMP] >= 0 ? col[AUTH_COMP] : col[LABEL_COMP];
+    int iname = col[AUTH_ATOM] >= 0 ? col[AUTH_ATOM] : col[LABEL_ATOM];
+
+    // Size the domain, an atom_site row is ~80-100 characters
+    reserve((end - p) / 90);
+
+    const char *t[MAX_COLUMN];
+    int n[MAX_COLUMN];
+
+    const char *model = NULL;
+    int nmodel = 0;
+    char altloc = 0;
+
+    // previous row identifiers, to detect new sites
+    const char *last[4] = { NULL, NULL, NULL, NULL };
+    int nlast[4] = { 0, 0, 0, 0 };
+    int key[4] = { ichain, iseq, icomp, col[INS] };
+
+    char name[10], resname[15], chain[10], element[3];
+
+    while (true) {
+
+        // Read a row
+        const char *rowstart = p;
+        int i = 0;
+        for (i = 0; i < ncol; i++) {
+            t[i] = next_token(p, end, n[i]);
+            if (t[i] == NULL) break;
+
+            // The loop ends at the next item, loop or data block
+            if (i == 0 && (*t[0] == '_' || (n[0] >= 5 && (strncmp(t[0], "loop_", 5) == 0 ||
+                                                      strncmp(t[0], "data_", 5) == 0)))) {
+                t[0] = NULL;
+                break;
+            }
+        }
+
+        if (i == 0 || t[0] == NULL) break;
+
+        if (i < ncol) {
+            char str[128];
+            snprintf(str, 128, "Input CIF: truncated _atom_site row at byte %ld in %s",
+                     (long) (rowstart - buf), filename);
+            return error->one(FLERR, str);
+        }
+
+        // Only the first model is read
+        if (col[MODEL] >= 0) {
+            if (model == NULL) {
+                model = t[col[MODEL]];
+                nmodel = n[col[MODEL]];
+            } else if (n[col[MODEL]] != nmodel || strncmp(model, t[col[MODEL]], nmodel) != 0) {
+                break;
+            }
+        }
+
+        // Parse-time filtering on chain and resid
+        int chainlen = 0;
+        if (ichain >= 0)
+            chainlen = copy_field(chain, 10, t[ichain], n[ichain]);
+        else
+            chain[0] = '\0';
+
+        if (!accept_chain(chain, chainlen))
+            continue;
+
+        int resid = iseq >= 0 ? parse_int(t[iseq], n[iseq]) : 0;
+        if (!accept_resid(resid))
+            continue;
+
+        // Keep the first alternate location only
+        if (col[ALT] >= 0) {
+            char alt = t[col[ALT]][0];
+            if (n[col[ALT]] == 1 && (alt == '.' || alt == '?')) alt = 0;
+            if (alt) {
+                if (altloc == 0) altloc = alt;
+                if (alt != altloc) continue;
+            }
+        }
+
+        bool newsite = natom == 0;
+        for (int k = 0; k < 4; k++) {
+            if (key[k] < 0) continue;
+            if (last[k] == NULL || nlast[k] != n[key[k]] ||
+                strncmp(last[k], t[key[k]], nlast[k]) != 0)
+                newsite = true;
+            last[k] = t[key[k]];
+            nlast[k] = n[key[k]];
+        }
+
+        if (newsite) {
+            if (icomp >= 0)
+                copy_field(resname, 15, t[icomp], n[icomp]);
+            else
+                resname[0] = '\0';
+            begin_site(resid, chain, chain, resname);
+        }
+
+        copy_field(name, 10, t[iname >= 0 ? iname : 0], iname >= 0 ? n[iname] : 0);
+
+        if (col[TYPE] >= 0 && *t[col[TYPE]] != '.' && *t[col[TYPE]] != '?')
+            copy_field(element, 3, t[col[TYPE]], n[col[TYPE]]);
+        else
+            element[0] = '\0';
+
+        double o = col[OCC] >= 0 ? parse_real(t[col[OCC]], n[col[OCC]]) : 1.0;
+        double b = col[BFAC] >= 0 ? parse_real(t[col[BFAC]], n[col[BFAC]]) : 0.0;
+        int serial = col[ID] >= 0 ? parse_int(t[col[ID]], n[col[ID]]) : natom + 1;
+
+        add_atom(name, element, serial,
+                 parse_real(t[col[X]], n[col[X]]),
+                 parse_real(t[col[Y]], n[col[Y]]),
+                 parse_real(t[col[Z]], n[col[Z]]),
+                 o, b);
+    }
+
+    return CCB_OK;
+
+}
@@ -0,0 +1,65 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   input_cif.h
+ * @date   Mon Oct 19 13:40:19 2026
+ *
+ * @brief  mmCIF input style header
+ *
+ *
+ */
+
+
+#ifdef INPUT_CLASS
+
+InputStyle(cif,InputCIF)
+
+#else
+
+#ifndef CCB_INPUT_CIF_H
+#define CCB_INPUT_CIF_H
+
+#include "input.h"
+
+namespace CCB_NS {
+
+     class InputCIF : public Input {
+
+     public:
+          InputCIF(class CCB *, int, const char **);
+          ~InputCIF() {}
+
+     private:
+          int init_style();          /**< Initialize the style */
+          int read_style();          /**< parse the mapped file */
+
+          const char *next_token(const char *&p, const char *end, int &len); /**< next whitespace delimited token */
+     };
+}
+
+#endif
+#endif
@@ -0,0 +1,199 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   input_pdb.cpp
+ * @date   Mon Oct 19 11:07:12 2026
+ *
+ * @brief  pdb input style routine.
+ *
+ * Reads ATOM/HETATM records of the first model into the domain.
+ * A new site is started whenever the residue name, chain, resid,
+ * insertion code or segment changes. Only the first alternate
+ * location of an atom is kept.
+ *
+ * http://deposit.rcsb.org/adit/docs/pdb_atom_format.html
+ *
+ * COLUMNS        DATA TYPE       CONTENTS
+ * --------------------------------------------------------------------------------
+ *  1 -  6        Record name     "ATOM  "
+ *  7 - 11        Integer         Atom serial number.
+ * 13 - 16        Atom            Atom name.
+ * 17             Character       Alternate location indicator.
+ * 18 - 20        Residue name    Residue name.
+ * 22             Character       Chain identifier.
+ * 23 - 26        Integer         Residue sequence number.
+ * 27             AChar           Code for insertion of residues.
+ * 31 - 38        Real(8.3)       Orthogonal coordinates for X in Angstroms.
+ * 39 - 46        Real(8.3)       Orthogonal coordinates for Y in Angstroms.
+ * 47 - 54        Real(8.3)       Orthogonal coordinates for Z in Angstroms.
+ * 55 - 60        Real(6.2)       Occupancy.
+ * 61 - 66        Real(6.2)       Temperature factor (Default = 0.0).
+ * 73 - 76        LString(4)      Segment identifier, left-justified.
+ * 77 - 78        LString(2)      Element symbol, right-justified.
+ * 79 - 80        LString(2)      Charge on the atom.
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "input_pdb.h"
+#include "error.h"
+#include "universe.h"
+#include "memory.h"
+#include "domain.h"
+
+/**
+ * @def PDB_LINE
+ *
+ * Length of a full pdb record without the newline
+ */
+
+#define PDB_LINE 80
+
+using namespace CCB_NS;
+
+/**
+ * The InputPDB Constructor
+ *
+ * @param ccb The ccb pointer
+ * @param narg number of arguments passed
+ * @param arg the arguments passed
+ */
+
+InputPDB::InputPDB(CCB *ccb, int narg, const char **arg) :
+        Input(ccb, narg, arg) {
+    // Check to see that we have a legit style and the format is correct.
+    if (narg < 4)
+        error->one(FLERR, "Illegal input PDB command");
+}
+
+int InputPDB::init_style() {
+
+    return CCB_OK;
+
+}
+
+/**
+ * Walks the mapped file a line at a time and adds the atoms
+ * to the domain. Fields are read straight out of the buffer.
+ */
+
+int InputPDB::read_style() {
+
+    if (buf == NULL)
+        return CCB_OK;
+
+    // Size the domain from the number of records in the file
+    reserve(nbuf / (PDB_LINE + 1));
+
+    const char *p = buf;
+    const char *end = buf + nbuf;
+    const char *last = NULL;  /**< last accepted record, for site changes */
+    int lastseg = 0;          /**< segid width of the last accepted record */
+
+    char name[10], resname[15], chain[10], seg[10], element[3];
+    char altloc = 0;
+
+    while (p < end) {
+
+        const char *eol = (const char *) memchr(p, '\n', end - p);
+        if (eol == NULL) eol = end;
+        int len = eol - p;
+
+        const char *line = p;
+        p = eol + 1;
+
+        if (len < 6)
+            continue;
+
+        bool atom = strncmp(line, "ATOM  ", 6) == 0 || strncmp(line, "HETATM", 6) == 0;
+
+        if (!atom) {
+            // Only the first model is read
+            if (strncmp(line, "ENDMDL", 6) == 0 ||
+                (strncmp(line, "END", 3) == 0 && (len == 3 || line[3] == ' ' || line[3] == '\r')))
+                break;
+            continue;
+        }
+
+        if (len < 54) {
+            char str[128];
+            snprintf(str, sizeof(str), "Input PDB: truncated atom record in %s", filename);
+            return error->one(FLERR, str);
+        }
+
+        // Parse-time filtering on chain and resid
+        int chainlen = copy_field(chain, 10, line + 21, 1);
+        if (!accept_chain(chain, chainlen))
+            continue;
+
+        int resid = parse_int(line + 22, 4);
+        if (!accept_resid(resid))
+            continue;
+
+        // Keep the first alternate location only
+        char alt = line[16];
+        if (alt != ' ') {
+            if (altloc == 0) altloc = alt;
+            if (alt != altloc) continue;
+        }
+
+        // New residue if any of cols 18-27 or the segid changed
+        int seglen = len > 72 ? (len < 76 ? len - 72 : 4) : 0;
+        bool newsite = last == NULL || memcmp(last + 17, line + 17, 10) != 0 ||
+                       seglen != lastseg || memcmp(last + 72, line + 72, seglen) != 0;
+
+        if (newsite) {
+            copy_field(resname, 15, line + 17, 3);
+            copy_field(seg, 10, line + 72, seglen);
+            begin_site(resid, chain, seg, resname);
+        }
+        last = line;
+        lastseg = seglen;
+
+        copy_field(name, 10, line + 12, 4);
+
+        if (len > 76) {
+            copy_field(element, 3, line + 76, len > 77 ? 2 : 1);
+        } else {
+            // Guess the element from the first letter of the name
+            int i = 0;
+            while (name[i] && !(name[i] >= 'A' && name[i] <= 'Z')) i++;
+            element[0] = name[i];
+            element[1] = '\0';
+        }
+
+        double o = len >= 60 ? parse_real(line + 54, 6) : 1.0;
+        double b = len >= 66 ? parse_real(line + 60, 6) : 0.0;
+
+        add_atom(name, element, parse_int(line + 6, 5),
+                 parse_real(line + 30, 8), parse_real(line + 38, 8), parse_real(line + 46, 8),
+                 o, b);
+    }
+
+    return CCB_OK;
+
+}
@@ -0,0 +1,403 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   library.cpp
+ * @date   Mon Oct 19 14:02:18 2026
+ *
+ * @brief  C interface to CCB, see library.h
+ *
+ * Each handle is a CCB instance with one coiled-coil backbone.
+ * Atoms live in the domain as objects, so the coordinates are
+ * gathered once per coil into a buffer the instance owns and
+ * lends out, or straight into the caller's buffer in a batch.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "library.h"
+#include "ccb.h"
+#include "error.h"
+#include "memory.h"
+#include "backbonehandler.h"
+#include "bitmask.h"
+#include "atom.h"
+#include "site.h"
+#include "group.h"
+#include "coiledcoil_params.h"
+
+using namespace CCB_NS;
+
+// Fails to compile if library.h and coiledcoil_params.h disagree on the parameter bits
+typedef char param_bits_agree[CCB_PARAM_NHELIX == CoiledCoilParams::NHELIX &&
+                              CCB_PARAM_PRECISION == CoiledCoilParams::PRECISION ? 1 : -1];
+
+/**
+ * @def LIBRARY_ID
+ * @brief id of the backbone every handle builds
+ */
+
+#define LIBRARY_ID "lib1"
+
+/**
+ * @def TOPOLOGY_BITS
+ * @brief parameters that change the atoms and their names
+ */
+
+#define TOPOLOGY_BITS (CCB_PARAM_NHELIX | CCB_PARAM_NRES | CCB_PARAM_ORDER)
+
+namespace {
+
+/// What a void * handed out by ccb_open points to
+struct Handle {
+    CCB *ccb;
+
+    int natom;                  /**< atoms in the last coil built, -1 before the first */
+    bool built;                 /**< a coil was generated since the last update */
+
+    double *x;                  /**< 3*natom gathered coordinates */
+    int xatom;                  /**< natom that x is current for, -1 if stale */
+    int maxx;                   /**< allocated atoms in x */
+
+    ccb_atom_t *atoms;          /**< the atom table */
+    bool topology;              /**< the atoms may have changed since atoms was filled */
+    int maxatoms;               /**< allocated rows in atoms */
+};
+
+}
+
+/**
+ * @brief the style starts over from its defaults
+ */
+
+static int add_style(CCB *ccb) {
+
+    const char *add[] = { "backbone", "add", "coiledcoil", LIBRARY_ID };
+
+    BackboneHandler *backbone = ccb->backbone;
+    if ((backbone->find_backbone(add[3]) >= 0 && backbone->delete_backbone(add[3]) != CCB_OK) ||
+        backbone->add_backbone(4, add) != CCB_OK ||
+        backbone->init_backbone(add[3]) != CCB_OK)
+        return CCB_ERROR;
+
+    return CCB_OK;
+}
+
+static void convert(const ccb_params_t *c, CoiledCoilParams &p) {
+
+    p.set = c->set;
+    p.nhelix = c->nhelix;
+    p.pitch = c->pitch;
+    p.rpr = c->rpr;
+    for (int i = 0; i < 4; i++)
+        p.radius[i] = c->radius[i];
+    p.nradius = c->nradius;
+
+    p.nres = c->nres;           p.nnres = c->nnres;
+    p.rotation = c->rotation;   p.nrotation = c->nrotation;
+    p.square = c->square;       p.nsquare = c->nsquare;
+    p.rpt = c->rpt;             p.nrpt = c->nrpt;
+    p.zoff = c->zoff;           p.nzoff = c->nzoff;
+    p.z = c->z;                 p.nz = c->nz;
+    p.order = c->order;         p.norder = c->norder;
+    p.ap_order = c->ap_order;   p.nap_order = c->nap_order;
+
+    p.antiparallel = c->antiparallel;
+    p.asymmetric = c->asymmetric;
+    p.frasermacrae = c->frasermacrae;
+    p.fm_rpt = c->fm_rpt;
+    p.single = c->single;
+    p.check = c->check;
+}
+
+/**
+ * @brief copy the coordinates of the coil out, n atoms
+ */
+
+static void gather(CCB *ccb, double *buf, int n) {
+
+    int natom = 0;
+    Atom **list = ccb->bitmask->list(0, natom);
+
+    for (int i = 0; i < n; i++) {
+        buf[3 * i] = list[i]->x;
+        buf[3 * i + 1] = list[i]->y;
+        buf[3 * i + 2] = list[i]->z;
+    }
+}
+
+/**
+ * @brief update and build, counting the atoms of the coil
+ */
+
+static int build(Handle *h, const ccb_params_t *p) {
+
+    CCB *ccb = h->ccb;
+    h->built = false;
+    h->xatom = -1;
+
+    if (p) {
+        CoiledCoilParams params;
+        convert(p, params);
+        if (p->set & TOPOLOGY_BITS) h->topology = true;
+        if (ccb->backbone->update_backbone(LIBRARY_ID, params) != CCB_OK)
+            return CCB_ERROR;
+    }
+
+    if (ccb->backbone->generate_backbone(LIBRARY_ID) != CCB_OK)
+        return CCB_ERROR;
+
+    int natom = 0;
+    ccb->bitmask->list(0, natom);
+    if (natom != h->natom) h->topology = true;
+    h->natom = natom;
+    h->built = true;
+
+    return CCB_OK;
+}
+
+extern "C" {
+
+int ccb_version(void) {
+    return CCB_API_VERSION;
+}
+
+int ccb_open(void **ptr) {
+
+    *ptr = NULL;
+
+    Handle *h = (Handle *) calloc(1, sizeof(Handle));
+    if (h == NULL)
+        return CCB_ERROR;
+
+    h->ccb = new CCB(0, NULL);
+    h->natom = -1;
+    h->xatom = -1;
+    h->topology = true;
+
+    if (add_style(h->ccb) != CCB_OK) {
+        delete h->ccb;
+        free(h);
+        return CCB_ERROR;
+    }
+
+    *ptr = h;
+    return CCB_OK;
+}
+
+void ccb_close(void *ptr) {
+
+    Handle *h = (Handle *) ptr;
+    if (h == NULL)
+        return;
+
+    h->ccb->memory->destroy(h->x);
+    h->ccb->memory->sfree(h->atoms);
+    delete h->ccb;
+    free(h);
+}
+
+int ccb_reset(void *ptr) {
+
+    Handle *h = (Handle *) ptr;
+    h->built = false;
+    h->xatom = -1;
+    h->topology = true;
+
+    return add_style(h->ccb);
+}
+
+void ccb_set_screen(void *ptr, FILE *fp) {
+    ((Handle *) ptr)->ccb->screen = fp;
+}
+
+void ccb_set_verbosity(void *ptr, int level) {
+    ((Handle *) ptr)->ccb->error->verbosity_level = level;
+}
+
+/**
+ * Coils generated again from parameters within resolution, in
+ * Angstrom and degrees, of a cached one are copied from it, 0
+ * keeps the current resolution.
+ */
+
+int ccb_set_cache(void *ptr, int maxentry, double resolution) {
+    return ((Handle *) ptr)->ccb->backbone->set_cache(maxentry, resolution);
+}
+
+void ccb_params_init(ccb_params_t *p) {
+    memset(p, 0, sizeof(ccb_params_t));
+}
+
+int ccb_set_params(void *ptr, const ccb_params_t *p) {
+
+    Handle *h = (Handle *) ptr;
+    CoiledCoilParams params;
+    convert(p, params);
+
+    h->built = false;
+    h->xatom = -1;
+    if (p->set & TOPOLOGY_BITS) h->topology = true;
+
+    return h->ccb->backbone->update_backbone(LIBRARY_ID, params);
+}
+
+int ccb_set_options(void *ptr, int argc, const char **argv) {
+
+    Handle *h = (Handle *) ptr;
+    h->built = false;
+    h->xatom = -1;
+    h->topology = true;
+
+    return h->ccb->backbone->update_backbone(LIBRARY_ID, argc, argv, 0);
+}
+
+int ccb_generate(void *ptr) {
+    return build((Handle *) ptr, NULL);
+}
+
+/**
+ * @return atoms in the last coil built, -1 if there is none
+ */
+
+int ccb_natoms(void *ptr) {
+
+    Handle *h = (Handle *) ptr;
+    return h->built ? h->natom : -1;
+}
+
+/**
+ * @return 3*ccb_natoms() coordinates, NULL if there is no coil
+ */
+
+const double *ccb_coords(void *ptr) {
+
+    Handle *h = (Handle *) ptr;
+    if (!h->built)
+        return NULL;
+
+    if (h->xatom != h->natom) {
+        if (h->natom > h->maxx) {
+            h->ccb->memory->destroy(h->x);
+            h->maxx = 0;
+            if (h->ccb->memory->create(h->x, 3 * h->natom, "library:x") == NULL)
+                return NULL;
+            h->maxx = h->natom;
+        }
+        gather(h->ccb, h->x, h->natom);
+        h->xatom = h->natom;
+    }
+
+    return h->x;
+}
+
+/**
+ * @return ccb_natoms() rows, NULL if there is no coil
+ */
+
+const ccb_atom_t *ccb_atoms(void *ptr) {
+
+    Handle *h = (Handle *) ptr;
+    if (!h->built)
+        return NULL;
+
+    if (!h->topology)
+        return h->atoms;
+
+    if (h->natom > h->maxatoms) {
+        h->ccb->memory->sfree(h->atoms);
+        h->atoms = (ccb_atom_t *) h->ccb->memory->smalloc(h->natom * sizeof(ccb_atom_t), "library:atoms");
+        if (h->atoms == NULL) {
+            h->maxatoms = 0;
+            return NULL;
+        }
+        h->maxatoms = h->natom;
+    }
+
+    int natom = 0;
+    Atom **list = h->ccb->bitmask->list(0, natom);
+
+    for (int i = 0; i < h->natom; i++) {
+        ccb_atom_t &a = h->atoms[i];
+        a.serial = i + 1;
+        a.resid = list[i]->site->resid;
+        strcpy(a.name, list[i]->name);
+        strcpy(a.resname, list[i]->group->type);
+        strcpy(a.chain, list[i]->site->chain);
+        strcpy(a.seg, list[i]->site->seg);
+        strcpy(a.element, list[i]->element);
+
+        // Generated atoms have no element, the name starts with it
+        if (a.element[0] == '\0') {
+            a.element[0] = list[i]->name[0];
+            a.element[1] = '\0';
+        }
+    }
+
+    h->topology = false;
+    return h->atoms;
+}
+
+/**
+ * @brief apply nset parameter sets in turn, each on top of the
+ * last, and write the coordinates of each into the caller's
+ * buffer without keeping a copy
+ *
+ * @param set the parameter sets
+ * @param buf coordinates of set i start at buf + i*stride
+ * @param stride doubles per set, at least 3 * the atoms of any set
+ * @param natom atoms of each set, -1 where it failed, may be NULL
+ *
+ * @return CCB_OK if every set was built, the sets after a failed
+ * one are still tried
+ */
+
+int ccb_generate_batch(void *ptr, int nset, const ccb_params_t *set,
+                       double *buf, long stride, int *natom) {
+
+    Handle *h = (Handle *) ptr;
+    int code = CCB_OK;
+
+    for (int i = 0; i < nset; i++) {
+
+        int n = -1;
+        if (build(h, &set[i]) == CCB_OK) {
+            if (3 * (long) h->natom <= stride) {
+                gather(h->ccb, buf + i * stride, h->natom);
+                n = h->natom;
+            } else {
+                h->ccb->error->one(FLERR, "ccb_generate_batch: stride is too short for the coil");
+            }
+        }
+
+        if (n < 0) code = CCB_ERROR;
+        if (natom) natom[i] = n;
+    }
+
+    return code;
+}
+
+}
@@ -0,0 +1,168 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   library.h
+ * @date   Mon Oct 19 14:02:18 2026
+ *
+ * @brief  C interface to CCB for embedding in other codes
+ *
+ * A plain C interface, stable across releases of the same
+ * CCB_API_VERSION, to drive the coiled-coil style from another
+ * engine, e.g. a Monte Carlo or MD loop:
+ *
+ *     void *ccb;
+ *     ccb_open(&ccb);
+ *     ccb_params_t p;
+ *     ccb_params_init(&p);
+ *     p.set = CCB_PARAM_NHELIX | CCB_PARAM_PITCH;
+ *     p.nhelix = 3; p.pitch = 140.0;
+ *     ccb_set_params(ccb, &p);
+ *     ccb_generate(ccb);
+ *     const double *x = ccb_coords(ccb);      // 3 * ccb_natoms(ccb)
+ *     const ccb_atom_t *a = ccb_atoms(ccb);   // ccb_natoms(ccb)
+ *     ccb_close(ccb);
+ *
+ * Parameter updates are cumulative, fields not named in set keep
+ * their current values, ccb_reset() returns to the defaults.
+ * Pointers handed out are owned by the instance and stay valid
+ * until the next call that changes the coil, or ccb_close().
+ * Functions returning int return CCB_OK (0) or CCB_ERROR (1)
+ * unless noted, the message goes to the instance's screen.
+ *
+ * An instance must only be used by one thread at a time,
+ * separate instances are independent.
+ */
+
+#ifndef CCB_LIBRARY_H
+#define CCB_LIBRARY_H
+
+#include <stdio.h>
+
+/**
+ * @def CCB_API_VERSION
+ *
+ * @brief Version of this interface, bumped whenever a signature
+ * or the layout of a struct below changes. Compare against
+ * ccb_version() to catch a mismatched shared library.
+ */
+
+#define CCB_API_VERSION 1
+
+/// Bits of ccb_params_t.set, one per option of the string interface
+#define CCB_PARAM_NHELIX       (1u << 0)
+#define CCB_PARAM_PITCH        (1u << 1)
+#define CCB_PARAM_RPR          (1u << 2)
+#define CCB_PARAM_RADIUS       (1u << 3)
+#define CCB_PARAM_NRES         (1u << 4)
+#define CCB_PARAM_ROTATION     (1u << 5)
+#define CCB_PARAM_SQUARE       (1u << 6)
+#define CCB_PARAM_RPT          (1u << 7)
+#define CCB_PARAM_ZOFF         (1u << 8)
+#define CCB_PARAM_Z            (1u << 9)
+#define CCB_PARAM_ORDER        (1u << 10)
+#define CCB_PARAM_ANTIPARALLEL (1u << 11)
+#define CCB_PARAM_ASYMMETRIC   (1u << 12)
+#define CCB_PARAM_FRASERMACRAE (1u << 13)
+#define CCB_PARAM_FM_RPT       (1u << 14)
+#define CCB_PARAM_PRECISION    (1u << 15)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Coiled-coil parameters, see coiledcoil_params.h for the
+ * meaning of each field. Lists are borrowed for the duration
+ * of the call and angles are in degrees.
+ */
+typedef struct ccb_params {
+  unsigned int set;             /**< CCB_PARAM_* bits of the fields to apply */
+
+  int nhelix;
+  double pitch;
+  double rpr;
+
+  double radius[4];             /**< r0_start r0_end res_start res_end */
+  int nradius;
+
+  const int *nres;        int nnres;
+  const double *rotation; int nrotation;
+  const double *square;   int nsquare;
+  const double *rpt;      int nrpt;
+  const double *zoff;     int nzoff;
+  const double *z;        int nz;
+  const int *order;       int norder;
+  const int *ap_order;    int nap_order;
+
+  int antiparallel;
+  int asymmetric;
+  int frasermacrae;
+  int fm_rpt;
+  int single;
+  int check;
+} ccb_params_t;
+
+/**
+ * One row of the atom table, in the order of the coordinates
+ */
+typedef struct ccb_atom {
+  int serial;                   /**< serial number, counting from 1 */
+  int resid;                    /**< residue number */
+  char name[10];                /**< atom name, N CA C O */
+  char resname[15];             /**< residue name */
+  char chain[10];               /**< chain, one per helix */
+  char seg[10];                 /**< segment */
+  char element[3];              /**< element symbol */
+} ccb_atom_t;
+
+int ccb_version(void);          /**< CCB_API_VERSION the library was built with */
+
+int ccb_open(void **ptr);       /**< a new instance with one coiled-coil in ptr */
+void ccb_close(void *ptr);      /**< free the instance and everything it lent out */
+int ccb_reset(void *ptr);       /**< back to the default parameters */
+
+void ccb_set_screen(void *ptr, FILE *fp); /**< where messages go, NULL for none */
+void ccb_set_verbosity(void *ptr, int level);
+int ccb_set_cache(void *ptr, int maxentry, double resolution); /**< keep the last maxentry coils, 0 for none */
+
+void ccb_params_init(ccb_params_t *p); /**< clear p, nothing set */
+int ccb_set_params(void *ptr, const ccb_params_t *p);
+int ccb_set_options(void *ptr, int argc, const char **argv); /**< string options as for the Tcl command */
+
+int ccb_generate(void *ptr);    /**< build the coil from the current parameters */
+int ccb_natoms(void *ptr);      /**< atoms in the last coil built */
+const double *ccb_coords(void *ptr);    /**< x y z of every atom, contiguous */
+const ccb_atom_t *ccb_atoms(void *ptr); /**< the atom table */
+
+int ccb_generate_batch(void *ptr, int nset, const ccb_params_t *set,
+                       double *buf, long stride, int *natom);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,13 +29,16 @@
  * @author Chris <chris@mount-doom.chem.upenn.edu>
  * @date   Tue Jun 21 08:53:03 2011
  * 
- * @brief  Initialization of CCB instance: sets up namespace, and cleans up. 
+ * @brief  Initialization of CCB instance: sets up namespace, runs the batch and cleans up. 
  * 
  * 
  */
 
 #include <stdio.h>
 #include "ccb.h"
+#include "batch.h"
+#include "server.h"
+#include "error.h"
 
 using namespace CCB_NS;
 
@@ -46,15 +49,38 @@ using namespace CCB_NS;
  * ccb.h/ccb.cpp. This way, the initilization and cleanup is straightforward,
  * e.g. CCB *ccb = new CCB(argc, argv) 
  * e.g. delete ccb
+ *
+ * The command line is run as a batch of coiled-coils, see batch.h,
+ * or with -serve as a service, see server.h. Returns 1 if any set
+ * failed.
  */
 
 int main(int argc, char **argv) {
 
+	if (argc < 2) {
+		Batch::usage(stderr);
+		return 1;
+	}
+
 	// Create a CCB instance, pass arguments;
 	CCB *ccb = new CCB(argc, argv);
 
+	Batch *batch = new Batch(ccb);
+
+	int code = batch->settings(argc - 1, (const char **) argv + 1);
+	if (code == CCB_OK && batch->help)
+		Batch::usage(stdout);
+	else if (code == CCB_OK && batch->serve) {
+		Server *server = new Server(ccb, batch, argc - 1, (const char **) argv + 1);
+		code = server->run();
+		delete server;
+	} else if (code == CCB_OK)
+		code = batch->run();
+
+	delete batch;
+
 	// Delete the CCB instance and clean up
 	delete ccb;
 
-	return 0;
+	return code == CCB_OK ? 0 : 1;
 }
@@ -37,17 +37,50 @@
    ------------------------------------------------------------------------- */
 
 #include "ccbtype.h"
+#include "stdint.h"
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
 #include "memory.h"
 #include "error.h"
 
+#if defined(__linux__)
+#include "sys/mman.h"
+#endif
+
+#define HUGEPAGE_SIZE (2*1024*1024)
+
 using namespace CCB_NS;
 
 /* ---------------------------------------------------------------------- */
 
-Memory::Memory(CCB *ccb) : Pointers(ccb) {}
+Memory::Memory(CCB *ccb) : Pointers(ccb)
+{
+  live = peak = nalloc = 0;
+  ntag = 0;
+  tag = NULL;
+
+  block = NULL;
+  nslot = nblock = 0;
+
+  // huge pages only pay off where the kernel can be asked for them
+#if defined(MADV_HUGEPAGE)
+  hugepage = CCB_HUGEPAGE_MIN;
+#else
+  hugepage = 0;
+#endif
+  const char *env = getenv("CCB_HUGEPAGE");
+  if (env) hugepage = strtoll(env,NULL,10);
+}
+
+/* ---------------------------------------------------------------------- */
+
+Memory::~Memory()
+{
+  for (int i = 0; i < ntag; i++) free(tag[i].name);
+  free(tag);
+  free(block);
+}
 
 /* ----------------------------------------------------------------------
    safe malloc 
@@ -68,7 +101,10 @@ void *Memory::smalloc(bigint nbytes, const char *name)
     sprintf(str,"Failed to allocate " BIGINT_FORMAT " bytes for array %s",
 	    nbytes,name);
     error->one(FLERR,str);
+    return NULL;
   }
+
+  track(ptr,nbytes,name);
   return ptr;
 }
 
@@ -83,13 +119,17 @@ void *Memory::srealloc(void *ptr, bigint nbytes, const char *name)
     return NULL;
   }
 
+  untrack(ptr);
   ptr = realloc(ptr,nbytes);
   if (ptr == NULL) {
     char str[128];
     sprintf(str,"Failed to reallocate " BIGINT_FORMAT " bytes for array %s",
 	    nbytes,name);
     error->one(FLERR,str);
+    return NULL;
   }
+
+  track(ptr,nbytes,name);
   return ptr;
 }
 
@@ -100,9 +140,99 @@ void *Memory::srealloc(void *ptr, bigint nbytes, const char *name)
 void Memory::sfree(void *ptr)
 {
   if (ptr == NULL) return;
+  untrack(ptr);
   free(ptr);
 }
 
+/* ----------------------------------------------------------------------
+   ask for transparent huge pages behind a block
+------------------------------------------------------------------------- */
+
+static void advise_hugepage(void *ptr, bigint nbytes)
+{
+#if defined(MADV_HUGEPAGE)
+  madvise(ptr,nbytes,MADV_HUGEPAGE);
+#else
+  (void) ptr;
+  (void) nbytes;
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   safe malloc on a CCB_ALIGN boundary
+   blocks of at least hugepage bytes are rounded up to whole huge
+   pages and aligned on one, so the kernel can back them with huge pages
+------------------------------------------------------------------------- */
+
+void *Memory::smalloc_aligned(bigint nbytes, const char *name)
+{
+  if (nbytes == 0) return NULL;
+
+  bigint align = CCB_ALIGN;
+  int huge = hugepage > 0 && nbytes >= hugepage;
+  if (huge) {
+    align = HUGEPAGE_SIZE;
+    nbytes = (nbytes + HUGEPAGE_SIZE-1) / HUGEPAGE_SIZE * HUGEPAGE_SIZE;
+  }
+
+  void *ptr = NULL;
+  if (posix_memalign(&ptr,align,nbytes) != 0) ptr = NULL;
+  if (ptr == NULL) {
+    char str[128];
+    sprintf(str,"Failed to allocate " BIGINT_FORMAT " aligned bytes for array %s",
+	    nbytes,name);
+    error->one(FLERR,str);
+    return NULL;
+  }
+
+  if (huge) advise_hugepage(ptr,nbytes);
+  track(ptr,nbytes,name);
+  return ptr;
+}
+
+/* ----------------------------------------------------------------------
+   safe realloc keeping the alignment of smalloc_aligned
+   realloc() cannot be asked for an alignment, so the block is
+   moved by hand, the old size comes from the block table
+------------------------------------------------------------------------- */
+
+void *Memory::srealloc_aligned(void *ptr, bigint nbytes, const char *name)
+{
+  if (ptr == NULL) return smalloc_aligned(nbytes,name);
+  if (nbytes == 0) {
+    destroy(ptr);
+    return NULL;
+  }
+
+  bigint nold = block_bytes(ptr);
+
+  // a block the table lost track of, realloc keeps its contents
+  // and the copy below restores the alignment
+  if (nold < 0) {
+    ptr = realloc(ptr,nbytes);
+    if (ptr == NULL) {
+      char str[128];
+      sprintf(str,"Failed to reallocate " BIGINT_FORMAT " bytes for array %s",
+	      nbytes,name);
+      error->one(FLERR,str);
+      return NULL;
+    }
+    if (((uintptr_t) ptr) % CCB_ALIGN == 0 &&
+        (hugepage <= 0 || nbytes < hugepage)) {
+      track(ptr,nbytes,name);
+      return ptr;
+    }
+    nold = nbytes;
+  }
+
+  void *ptrnew = smalloc_aligned(nbytes,name);
+  if (ptrnew == NULL) return NULL;
+
+  memcpy(ptrnew,ptr,nold < nbytes ? nold : nbytes);
+  sfree(ptr);
+  return ptrnew;
+}
+
 /* ----------------------------------------------------------------------
    erroneous usage of templated create/grow functions
 ------------------------------------------------------------------------- */
@@ -113,3 +243,193 @@ void Memory::fail(const char *name)
   sprintf(str,"Cannot create/grow a vector/array of pointers for %s",name);
   error->one(FLERR,str);
 }
+
+/* ----------------------------------------------------------------------
+   slot of a block address, addresses are mixed so aligned
+   blocks spread over the table
+------------------------------------------------------------------------- */
+
+static inline bigint slot_of(const void *ptr, bigint nslot)
+{
+  uint64_t h = (uint64_t) (uintptr_t) ptr;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return (bigint) (h & (uint64_t) (nslot - 1));
+}
+
+/* ----------------------------------------------------------------------
+   index of the tag called name, added if new
+   names are usually literals so the address is compared first
+------------------------------------------------------------------------- */
+
+int Memory::find_tag(const char *name)
+{
+  if (name == NULL) name = "unknown";
+
+  for (int i = 0; i < ntag; i++)
+    if (tag[i].name == name || strcmp(tag[i].name,name) == 0) return i;
+
+  Tag *t = (Tag *) realloc(tag,(ntag+1)*sizeof(Tag));
+  if (t == NULL) return -1;
+  tag = t;
+
+  Tag &n = tag[ntag];
+  n.name = (char *) malloc(strlen(name)+1);
+  if (n.name == NULL) return -1;
+  strcpy(n.name,name);
+  n.live = n.peak = n.nalloc = n.nfree = 0;
+
+  return ntag++;
+}
+
+/* ----------------------------------------------------------------------
+   record a new block
+------------------------------------------------------------------------- */
+
+void Memory::track(void *ptr, bigint nbytes, const char *name)
+{
+  if (2*(nblock+1) > nslot) grow_blocks();
+  if (2*(nblock+1) > nslot) return;
+
+  int itag = find_tag(name);
+  if (itag < 0) return;
+
+  // an address still in the table was freed behind our back
+  bigint i = slot_of(ptr,nslot);
+  while (block[i].ptr && block[i].ptr != ptr) i = (i+1) & (nslot-1);
+  if (block[i].ptr) untrack(ptr);
+
+  i = slot_of(ptr,nslot);
+  while (block[i].ptr) i = (i+1) & (nslot-1);
+
+  block[i].ptr = ptr;
+  block[i].nbytes = nbytes;
+  block[i].itag = itag;
+  nblock++;
+
+  Tag &t = tag[itag];
+  t.live += nbytes;
+  t.nalloc++;
+  if (t.live > t.peak) t.peak = t.live;
+
+  live += nbytes;
+  nalloc++;
+  if (live > peak) peak = live;
+}
+
+/* ----------------------------------------------------------------------
+   forget a block, unknown addresses are ignored
+   removal shifts later entries of the probe run back so no
+   tombstones are needed
+------------------------------------------------------------------------- */
+
+void Memory::untrack(void *ptr)
+{
+  if (ptr == NULL || nblock == 0) return;
+
+  bigint mask = nslot-1;
+  bigint i = slot_of(ptr,nslot);
+  while (block[i].ptr && block[i].ptr != ptr) i = (i+1) & mask;
+  if (block[i].ptr == NULL) return;
+
+  Tag &t = tag[block[i].itag];
+  t.live -= block[i].nbytes;
+  t.nfree++;
+  live -= block[i].nbytes;
+  nblock--;
+
+  bigint j = i;
+  while (1) {
+    j = (j+1) & mask;
+    if (block[j].ptr == NULL) break;
+    bigint k = slot_of(block[j].ptr,nslot);
+    if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j)) {
+      block[i] = block[j];
+      i = j;
+    }
+  }
+  block[i].ptr = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   double the block table and rehash
+------------------------------------------------------------------------- */
+
+void Memory::grow_blocks()
+{
+  bigint nnew = nslot ? 2*nslot : 1024;
+  Block *b = (Block *) calloc(nnew,sizeof(Block));
+  if (b == NULL) return;
+
+  for (bigint i = 0; i < nslot; i++) {
+    if (block[i].ptr == NULL) continue;
+    bigint k = slot_of(block[i].ptr,nnew);
+    while (b[k].ptr) k = (k+1) & (nnew-1);
+    b[k] = block[i];
+  }
+
+  free(block);
+  block = b;
+  nslot = nnew;
+}
+
+/* ----------------------------------------------------------------------
+   size of a live block, -1 if it is not in the table
+------------------------------------------------------------------------- */
+
+bigint Memory::block_bytes(void *ptr)
+{
+  if (nblock == 0) return -1;
+
+  bigint i = slot_of(ptr,nslot);
+  while (block[i].ptr && block[i].ptr != ptr) i = (i+1) & (nslot-1);
+  return block[i].ptr ? block[i].nbytes : -1;
+}
+
+/* ----------------------------------------------------------------------
+   live bytes of every tag whose name starts with prefix
+------------------------------------------------------------------------- */
+
+bigint Memory::tag_bytes(const char *prefix)
+{
+  bigint n = 0;
+  int len = strlen(prefix);
+  for (int i = 0; i < ntag; i++)
+    if (strncmp(tag[i].name,prefix,len) == 0) n += tag[i].live;
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   table of live and peak bytes per tag, largest peak first
+------------------------------------------------------------------------- */
+
+void Memory::print_usage()
+{
+  if (screen == NULL) return;
+
+  int *order = (int *) malloc((ntag+1)*sizeof(int));
+  if (order == NULL) return;
+
+  for (int i = 0; i < ntag; i++) {
+    int j = i;
+    while (j > 0 && tag[order[j-1]].peak < tag[i].peak) {
+      order[j] = order[j-1];
+      j--;
+    }
+    order[j] = i;
+  }
+
+  fprintf(screen,"%-32s %12s %12s %10s %10s\n",
+          "allocation","live Mb","peak Mb","allocs","frees");
+  for (int k = 0; k < ntag; k++) {
+    Tag &t = tag[order[k]];
+    fprintf(screen,"%-32s %12.4f %12.4f %10lld %10lld\n",t.name,
+            t.live/1024.0/1024.0,t.peak/1024.0/1024.0,
+            (long long) t.nalloc,(long long) t.nfree);
+  }
+  fprintf(screen,"%-32s %12.4f %12.4f %10lld\n","total",
+          live/1024.0/1024.0,peak/1024.0/1024.0,(long long) nalloc);
+
+  free(order);
+}
@@ -41,17 +41,65 @@
 
 #include "pointers.h"
 
+// alignment of the blocks from smalloc_aligned and of the rows of
+// the arrays from create_aligned/grow_aligned, in bytes
+
+#ifndef CCB_ALIGN
+#define CCB_ALIGN 64
+#endif
+
+// smallest block put on transparent huge pages by default, the
+// CCB_HUGEPAGE environment variable overrides it and 0 disables
+
+#ifndef CCB_HUGEPAGE_MIN
+#define CCB_HUGEPAGE_MIN (4*1024*1024)
+#endif
+
 namespace CCB_NS {
 
+/* ----------------------------------------------------------------------
+   every block from smalloc/srealloc is recorded with its size and the
+   name it was allocated under, so live and peak bytes can be reported
+   per name. Names are usually "class:array", blocks freed with free()
+   rather than sfree() are dropped when their address is reused.
+------------------------------------------------------------------------- */
+
 class Memory : protected Pointers {
  public:
   Memory(class CCB *);
+  ~Memory();
 
   void *smalloc(bigint n, const char *);
   void *srealloc(void *, bigint n, const char *);
   void sfree(void *);
   void fail(const char *);
 
+  // allocation accounting
+
+  struct Tag {
+    char *name;               // name passed to smalloc/srealloc
+    bigint live;              // live bytes
+    bigint peak;              // most live bytes at once
+    bigint nalloc;            // blocks allocated or reallocated
+    bigint nfree;             // blocks freed
+  };
+
+  bigint live;                // live bytes over all tags
+  bigint peak;                // most live bytes at once
+  bigint nalloc;              // blocks allocated or reallocated
+  int ntag;
+  Tag *tag;
+
+  bigint tag_bytes(const char *prefix);   // live bytes of tags starting with prefix
+  void print_usage();                     // per tag report to screen
+
+  // aligned allocation
+
+  bigint hugepage;            // smallest block given huge pages, 0 for never
+
+  void *smalloc_aligned(bigint n, const char *);
+  void *srealloc_aligned(void *, bigint n, const char *);
+
 /* ----------------------------------------------------------------------
    create/grow/destroy vecs and multidim arrays with contiguous memory blocks
    only use with primitive data types, e.g. 1d vec of ints, 2d array of doubles
@@ -462,19 +510,194 @@ class Memory : protected Pointers {
       sfree(array);
     }
 
+/* ----------------------------------------------------------------------
+   aligned vecs and arrays, the data block starts on a CCB_ALIGN boundary
+   and the stride of the 1st index of multidim arrays is padded to a
+   multiple of CCB_ALIGN, so every row can be loaded aligned and a
+   vector loop may run to the end of the padding without a remainder.
+   free them with destroy(), grow them only with grow_aligned()
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   number of elements n rounds up to so a row ends on CCB_ALIGN
+------------------------------------------------------------------------- */
+
+  template <typename TYPE>
+    static bigint padded(bigint n)
+    {
+      if (CCB_ALIGN % sizeof(TYPE)) return n;
+      bigint m = CCB_ALIGN / sizeof(TYPE);
+      return (n + m-1) / m * m;
+    }
+
+/* ----------------------------------------------------------------------
+   create an aligned 1d array 
+------------------------------------------------------------------------- */
+
+  template <typename TYPE>
+    TYPE *create_aligned(TYPE *&array, int n, const char *name)
+    {
+      bigint nbytes = ((bigint) sizeof(TYPE)) * n;
+      array = (TYPE *) smalloc_aligned(nbytes,name);
+      return array;
+    }
+
+  template <typename TYPE>
+    TYPE **create_aligned(TYPE **&array, int n, const char *name)
+    {fail(name);}
+
+/* ----------------------------------------------------------------------
+   grow or shrink an aligned 1d array
+------------------------------------------------------------------------- */
+
+  template <typename TYPE>
+    TYPE *grow_aligned(TYPE *&array, int n, const char *name)
+    {
+      if (array == NULL) return create_aligned(array,n,name);
+
+      bigint nbytes = ((bigint) sizeof(TYPE)) * n;
+      array = (TYPE *) srealloc_aligned(array,nbytes,name);
+      return array;
+    }
+
+  template <typename TYPE>
+    TYPE **grow_aligned(TYPE **&array, int n, const char *name)
+    {fail(name);}
+
+/* ----------------------------------------------------------------------
+   create an aligned 2d array, rows are padded(n2) apart
+------------------------------------------------------------------------- */
+
+  template <typename TYPE>
+    TYPE **create_aligned(TYPE **&array, int n1, int n2, const char *name)
+    {
+      bigint stride = padded<TYPE>(n2);
+      bigint nbytes = ((bigint) sizeof(TYPE)) * n1*stride;
+      TYPE *data = (TYPE *) smalloc_aligned(nbytes,name);
+      nbytes = ((bigint) sizeof(TYPE *)) * n1;
+      array = (TYPE **) smalloc(nbytes,name);
+
+      bigint n = 0;
+      for (int i = 0; i < n1; i++) {
+	array[i] = &data[n];
+	n += stride;
+      }
+      return array;
+    }
+
+  template <typename TYPE>
+    TYPE ***create_aligned(TYPE ***&array, int n1, int n2, const char *name)
+    {fail(name);}
+
+/* ----------------------------------------------------------------------
+   grow or shrink 1st dim of an aligned 2d array
+   last dim must stay the same
+------------------------------------------------------------------------- */
+
+  template <typename TYPE>
+    TYPE **grow_aligned(TYPE **&array, int n1, int n2, const char *name)
+    {
+      if (array == NULL) return create_aligned(array,n1,n2,name);
+
+      bigint stride = padded<TYPE>(n2);
+      bigint nbytes = ((bigint) sizeof(TYPE)) * n1*stride;
+      TYPE *data = (TYPE *) srealloc_aligned(array[0],nbytes,name);
+      nbytes = ((bigint) sizeof(TYPE *)) * n1;
+      array = (TYPE **) srealloc(array,nbytes,name);
+
+      bigint n = 0;
+      for (int i = 0; i < n1; i++) {
+	array[i] = &data[n];
+	n += stride;
+      }
+      return array;
+    }
+
+  template <typename TYPE>
+    TYPE ***grow_aligned(TYPE ***&array, int n1, int n2, const char *name)
+    {fail(name);}
+
+/* ----------------------------------------------------------------------
+   create an aligned 3d array, each n2 x n3 plane is padded(n2*n3)
+   apart and is contiguous inside
+------------------------------------------------------------------------- */
+
+  template <typename TYPE>
+    TYPE ***create_aligned(TYPE ***&array, int n1, int n2, int n3,
+			   const char *name)
+    {
+      bigint stride = padded<TYPE>(((bigint) n2)*n3);
+      bigint nbytes = ((bigint) sizeof(TYPE)) * n1*stride;
+      TYPE *data = (TYPE *) smalloc_aligned(nbytes,name);
+      nbytes = ((bigint) sizeof(TYPE *)) * n1*n2;
+      TYPE **plane = (TYPE **) smalloc(nbytes,name);
+      nbytes = ((bigint) sizeof(TYPE **)) * n1;
+      array = (TYPE ***) smalloc(nbytes,name);
+
+      int i,j;
+      bigint m;
+      for (i = 0; i < n1; i++) {
+	m = ((bigint) i) * n2;
+	array[i] = &plane[m];
+	for (j = 0; j < n2; j++)
+	  plane[m+j] = &data[i*stride + ((bigint) j)*n3];
+      }
+      return array;
+    }
+
+  template <typename TYPE>
+    TYPE ****create_aligned(TYPE ****&array, int n1, int n2, int n3,
+			    const char *name)
+    {fail(name);}
+
+/* ----------------------------------------------------------------------
+   grow or shrink 1st dim of an aligned 3d array
+   last 2 dims must stay the same
+------------------------------------------------------------------------- */
+
+  template <typename TYPE>
+    TYPE ***grow_aligned(TYPE ***&array, int n1, int n2, int n3,
+			 const char *name)
+    {
+      if (array == NULL) return create_aligned(array,n1,n2,n3,name);
+
+      bigint stride = padded<TYPE>(((bigint) n2)*n3);
+      bigint nbytes = ((bigint) sizeof(TYPE)) * n1*stride;
+      TYPE *data = (TYPE *) srealloc_aligned(array[0][0],nbytes,name);
+      nbytes = ((bigint) sizeof(TYPE *)) * n1*n2;
+      TYPE **plane = (TYPE **) srealloc(array[0],nbytes,name);
+      nbytes = ((bigint) sizeof(TYPE **)) * n1;
+      array = (TYPE ***) srealloc(array,nbytes,name);
+
+      int i,j;
+      bigint m;
+      for (i = 0; i < n1; i++) {
+	m = ((bigint) i) * n2;
+	array[i] = &plane[m];
+	for (j = 0; j < n2; j++)
+	  plane[m+j] = &data[i*stride + ((bigint) j)*n3];
+      }
+      return array;
+    }
+
+  template <typename TYPE>
+    TYPE ****grow_aligned(TYPE ****&array, int n1, int n2, int n3,
+			  const char *name)
+    {fail(name);}
+
 /* ----------------------------------------------------------------------
    memory usage of arrays, including pointers
 ------------------------------------------------------------------------- */
 
   template <typename TYPE>
-    bigint usage(TYPE *array, int n)
+    bigint usage(TYPE * /*array*/, int n)
     {
       bigint bytes = ((bigint) sizeof(TYPE)) * n;
       return bytes;
     }
 
   template <typename TYPE>
-    bigint usage(TYPE **array, int n1, int n2)
+    bigint usage(TYPE ** /*array*/, int n1, int n2)
     {
       bigint bytes = ((bigint) sizeof(TYPE)) * n1*n2;
       bytes += ((bigint) sizeof(TYPE *)) * n1;
@@ -482,7 +705,7 @@ class Memory : protected Pointers {
     }
 
   template <typename TYPE>
-    bigint usage(TYPE ***array, int n1, int n2, int n3)
+    bigint usage(TYPE *** /*array*/, int n1, int n2, int n3)
     {
       bigint bytes = ((bigint) sizeof(TYPE)) * n1*n2*n3;
       bytes += ((bigint) sizeof(TYPE *)) * n1*n2;
@@ -491,7 +714,7 @@ class Memory : protected Pointers {
     }
 
   template <typename TYPE>
-    bigint usage(TYPE ****array, int n1, int n2, int n3, int n4)
+    bigint usage(TYPE **** /*array*/, int n1, int n2, int n3, int n4)
     {
       bigint bytes = ((bigint) sizeof(TYPE)) * n1*n2*n3*n4;
       bytes += ((bigint) sizeof(TYPE *)) * n1*n2*n3;
@@ -499,6 +722,40 @@ class Memory : protected Pointers {
       bytes += ((bigint) sizeof(TYPE ***)) * n1;
       return bytes;
     }
+
+  template <typename TYPE>
+    bigint usage_aligned(TYPE ** /*array*/, int n1, int n2)
+    {
+      bigint bytes = ((bigint) sizeof(TYPE)) * n1*padded<TYPE>(n2);
+      bytes += ((bigint) sizeof(TYPE *)) * n1;
+      return bytes;
+    }
+
+  template <typename TYPE>
+    bigint usage_aligned(TYPE *** /*array*/, int n1, int n2, int n3)
+    {
+      bigint bytes = ((bigint) sizeof(TYPE)) * n1*padded<TYPE>(((bigint) n2)*n3);
+      bytes += ((bigint) sizeof(TYPE *)) * n1*n2;
+      bytes += ((bigint) sizeof(TYPE **)) * n1;
+      return bytes;
+    }
+
+ private:
+  struct Block {
+    void *ptr;
+    bigint nbytes;
+    int itag;
+  };
+
+  Block *block;               // open addressed table of live blocks
+  bigint nslot;               // size of block, a power of 2
+  bigint nblock;              // live blocks in block
+
+  int find_tag(const char *);
+  void track(void *, bigint, const char *);
+  void untrack(void *);
+  void grow_blocks();
+  bigint block_bytes(void *);
 };
 
 }
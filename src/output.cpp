@@ -41,7 +41,18 @@
 #include "memory.h"
 #include "error.h"
 #include "output.h"
+#include "bitmask.h"
 #include "universe.h"
+#include "timer.h"
+#include "trace.h"
+
+/**
+ * @def BLEN
+ *
+ * Length of the selection group name
+ */
+
+#define BLEN 200
 
 using namespace CCB_NS;
 
@@ -79,6 +90,10 @@ Output::Output(CCB *ccb, int /*narg*/, const char **arg) :
 	strcpy(filename, arg[3]);
 
 	fp = NULL;
+	stream = stdout;
+
+	mask = 0;
+	selection = NULL;
 
 }
 
@@ -93,6 +108,7 @@ Output::~Output() {
 	delete[] id;
 	delete[] style;
 	delete[] filename;
+	delete[] selection;
 
 }
 
@@ -101,11 +117,22 @@ int Output::init() {
 }
 
 int Output::write() {
-	return write_style();
+	int code;
+	{
+		CCB_TIMER(OUTPUT, 1);
+		code = write_style();
+	}
+
+	trace->flush();
+	return code;
 }
 
+/**
+ * Opens filename for writing, "-" writes to stream
+ */
+
 int Output::openfile() {
-	fp = fopen(filename, "w");
+	fp = strcmp(filename, "-") == 0 ? stream : fopen(filename, "w");
 	if (fp == NULL && universe->me == 0) 
           return error->one(FLERR, "Can't open output file");
 
@@ -113,6 +140,60 @@ int Output::openfile() {
 }
 
 int Output::closefile() {
-	if (universe->me == 0 && fp != NULL) fclose(fp);
+	if (universe->me == 0 && fp == stream) fflush(fp);
+	else if (universe->me == 0 && fp != NULL) fclose(fp);
      return CCB_OK;
 }
+
+/**
+ * Sets the atoms to output from the trailing arguments, a
+ * bitmask group, or a selection (see select.h) with its words
+ * rejoined, all atoms if there are none.
+ *
+ * @param iarg index of the first argument naming the atoms
+ */
+
+void Output::set_atoms(int narg, const char **arg, int iarg) {
+
+	delete[] selection;
+	selection = NULL;
+
+	if (narg == iarg + 1 && bitmask->find_mask(arg[iarg]) >= 0) {
+		mask = bitmask->find_mask(arg[iarg]);
+
+	} else if (narg > iarg) {
+		int n = 0;
+		for (int i = iarg; i < narg; i++)
+			n += strlen(arg[i]) + 1;
+
+		selection = new char[n];
+		selection[0] = '\0';
+		for (int i = iarg; i < narg; i++) {
+			if (i > iarg) strcat(selection, " ");
+			strcat(selection, arg[i]);
+		}
+		mask = -1;
+
+	} else {
+		mask = 0;
+	}
+}
+
+/**
+ * Applies the selection, if there is one, to the current atoms.
+ * It lands in a group named after the output.
+ */
+
+int Output::select_atoms() {
+
+	if (selection == NULL)
+		return CCB_OK;
+
+	char group[BLEN];
+	snprintf(group, BLEN, "%s_select", id);
+	if (bitmask->select(group, selection) != CCB_OK)
+		return CCB_ERROR;
+	mask = bitmask->find_mask(group);
+
+	return CCB_OK;
+}
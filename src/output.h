@@ -51,6 +51,7 @@ public:
 	char *filename; /**< the output filename */
 	char *id; /**< the ID of the syle */
 	char *style; /**< the name of the style */
+	FILE *stream; /**< written when the filename is "-", stdout by default */
 
 	//Constructor and Destructor
 	Output(class CCB *, int, const char **); /**< Output constructor */
@@ -69,6 +70,13 @@ protected:
 	virtual int openfile(); /**< open the file, note this is NOT pure virtual */
 	virtual int closefile();
 
+	// Atoms written, shared by the styles
+	int mask; /**< bitmask for atoms to output */
+	char *selection; /**< selection for atoms to output, NULL for mask */
+
+	void set_atoms(int narg, const char **arg, int iarg); /**< group or selection from arg[iarg] on */
+	int select_atoms(); /**< apply the selection, before every write */
+
 	FILE *fp; /**< file pointer */
 private:
 
@@ -0,0 +1,520 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   output_imd.cpp
+ * @date   Mon Oct 19 19:43:27 2026
+ *
+ * @brief  imd output style routine.
+ *
+ * The engine side of the IMD protocol of VMD, version 2. Every
+ * message starts with an 8 byte header, type and length as 32 bit
+ * integers in network order. The handshake is the exception, its
+ * length is the version in the order of this machine, and from it
+ * VMD learns whether to swap the bytes of everything that follows,
+ * which is sent as is:
+ *
+ *   HANDSHAKE  2                   engine to VMD, once
+ *   GO         0                   VMD to engine, within a second
+ *   ENERGIES   1   int32 + 9 float engine to VMD, the frame number
+ *   FCOORDS    n   3 n float       engine to VMD, x y z of each atom
+ *   PAUSE      0                   VMD to engine, toggles
+ *   TRATE      n                   VMD to engine, send every nth frame
+ *   MDCOMM     n   n int32, 3n float  VMD to engine, forces
+ *   DISCONNECT 0 / KILL 0          VMD to engine
+ *
+ * Frames are packed into one buffer and sent without blocking, so
+ * a slow VMD costs dropped frames rather than a stalled producer.
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "stdlib.h"
+#include "errno.h"
+#include "output_imd.h"
+#include "error.h"
+#include "universe.h"
+#include "memory.h"
+#include "atom.h"
+#include "bitmask.h"
+#include "trace.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+/**
+ * @def BLEN
+ *
+ * Length of path name or genaric buffer
+ */
+
+#define BLEN 200
+
+/// Message types, in the order of VMD's imd.h
+enum { IMD_DISCONNECT, IMD_ENERGIES, IMD_FCOORDS, IMD_GO, IMD_HANDSHAKE,
+       IMD_KILL, IMD_MDCOMM, IMD_PAUSE, IMD_TRATE, IMD_IOERROR };
+
+#define IMD_VERSION 2
+#define IMD_HEADER 8
+#define IMD_ENERGIES_BYTES 40   /**< int32 step and nine floats */
+#define IMD_WAIT 1000           /**< ms VMD has to answer the handshake or take the last frame */
+#define IMD_MAXLEN (1 << 26)    /**< longest message accepted from VMD */
+
+#if defined(MSG_NOSIGNAL)
+#define IMD_SEND MSG_NOSIGNAL
+#else
+#define IMD_SEND 0
+#endif
+
+using namespace CCB_NS;
+
+/// A header in network order
+static inline void put_header(char *p, int32_t type, int32_t length) {
+    uint32_t h[2] = { htonl((uint32_t) type), htonl((uint32_t) length) };
+    memcpy(p, h, IMD_HEADER);
+}
+
+/**
+ * The OutputIMD Constructor, the arguments are checked by
+ * init_style()
+ *
+ * @param ccb The ccb pointer
+ * @param narg number of arguments passed
+ * @param arg the arguments passed
+ */
+
+OutputIMD::OutputIMD(CCB *ccb, int narg, const char **arg) :
+        Output(ccb, narg, arg) {
+
+    host = NULL;
+    wait = all = false;
+    bad = NULL;
+
+    listenfd = clientfd = -1;
+    killed = paused = false;
+    rate = 1;
+    natom = -1;
+    nframe = nsent = ndrop = 0;
+
+    out = in = NULL;
+    nout = maxout = sent = 0;
+    nin = maxin = 0;
+
+    char *end;
+    port = narg < 4 ? 0 : strtol(filename, &end, 10);
+    if (narg < 4 || *end != '\0' || port < 1 || port > 65535)
+        bad = "Output imd needs a port from 1 to 65535";
+
+    int iarg = 4;
+    while (iarg < narg) {
+        if (strcmp(arg[iarg], "-wait") == 0) {
+            wait = true;
+            iarg++;
+        } else if (strcmp(arg[iarg], "-all") == 0) {
+            all = true;
+            iarg++;
+        } else if (strcmp(arg[iarg], "-host") == 0 && iarg + 1 < narg) {
+            delete [] host;
+            host = new char[strlen(arg[iarg + 1]) + 1];
+            strcpy(host, arg[iarg + 1]);
+            iarg += 2;
+        } else {
+            break;
+        }
+    }
+
+    // Set the bitmask for atoms to output
+    set_atoms(narg, arg, iarg);
+}
+
+OutputIMD::~OutputIMD() {
+
+#if !defined(_WIN32)
+    // Don't leave VMD half a frame
+    if (clientfd >= 0 && (sent == nout || flush(IMD_WAIT) == CCB_OK))
+        close_client("output deleted");
+    if (listenfd >= 0)
+        close(listenfd);
+#endif
+
+    memory->sfree(out);
+    memory->sfree(in);
+    delete [] host;
+}
+
+/**
+ * Starts listening, VMD may connect from now on
+ */
+
+int OutputIMD::init_style() {
+
+    if (bad)
+        return error->one(FLERR, bad);
+
+#if defined(_WIN32)
+    return error->one(FLERR, "Output imd is not supported on this platform");
+#else
+    if (listenfd < 0 && universe->me == 0)
+        return open_socket();
+
+    return CCB_OK;
+#endif
+}
+
+/**
+ * Sends the atoms to VMD as the next frame, when there is a client
+ * that wants it
+ */
+
+int OutputIMD::write_style() {
+
+    if (bad)
+        return error->one(FLERR, bad);
+
+    if (select_atoms() != CCB_OK)
+        return CCB_ERROR;
+
+    if (universe->me != 0)
+        return CCB_OK;
+
+#if defined(_WIN32)
+    return error->one(FLERR, "Output imd is not supported on this platform");
+#else
+
+    if (listenfd < 0 && open_socket() != CCB_OK)
+        return CCB_ERROR;
+
+    bigint frame = nframe++;
+
+    if (killed)
+        return CCB_OK;
+
+    // Only the first frame waits for a client
+    if (clientfd < 0)
+        accept_client(0);
+    while (clientfd < 0 && wait && nsent == 0)
+        accept_client(-1);
+
+    if (clientfd >= 0)
+        receive(0);
+
+    while (paused && clientfd >= 0)
+        receive(-1);
+
+    if (clientfd < 0 || frame % rate != 0)
+        return CCB_OK;
+
+    // VMD is still taking the last frame
+    if (sent < nout && (flush(all ? -1 : 0) != CCB_OK || sent < nout)) {
+        ndrop++;
+        return CCB_OK;
+    }
+
+    int n = 0;
+    Atom **list = bitmask->list(mask, n);
+
+    if (natom >= 0 && n != natom)
+        CCB_TRACE(1, "Output IMD: %d atoms after %d, the molecule in VMD won't match\n", n, natom);
+    natom = n;
+
+    pack(list, n);
+    if (flush(all ? -1 : 0) == CCB_OK)
+        nsent++;
+
+    CCB_TRACE(3, "Output IMD: frame %lld, %d atoms\n", (long long) frame, n);
+
+    return CCB_OK;
+#endif
+}
+
+#if !defined(_WIN32)
+
+int OutputIMD::open_socket() {
+
+    char str[BLEN];
+    const char *addr = host ? host : "127.0.0.1";
+
+    sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    if (inet_pton(AF_INET, addr, &sa.sin_addr) != 1) {
+        snprintf(str, BLEN, "Output imd: %s is not an IPv4 address", addr);
+        return error->one(FLERR, str);
+    }
+
+    int one = 1;
+    listenfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenfd < 0 ||
+        setsockopt(listenfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(listenfd, (sockaddr *) &sa, sizeof(sa)) != 0 ||
+        listen(listenfd, 1) != 0 ||
+        fcntl(listenfd, F_SETFL, O_NONBLOCK) != 0) {
+        snprintf(str, BLEN, "Output imd: can't listen on %s:%d: %s", addr, port, strerror(errno));
+        if (listenfd >= 0) close(listenfd);
+        listenfd = -1;
+        return error->one(FLERR, str);
+    }
+
+    CCB_TRACE(1, "Output IMD: listening on %s:%d\n", addr, port);
+
+    return CCB_OK;
+}
+
+/**
+ * @brief take a waiting client, send the handshake and wait for
+ * VMD to answer with go
+ *
+ * @param timeout_ms how long to wait for a client, -1 for ever
+ */
+
+int OutputIMD::accept_client(int timeout_ms) {
+
+    if (timeout_ms != 0)
+        CCB_TRACE(1, "Output IMD: waiting for VMD on port %d\n", port);
+
+    pollfd p = { listenfd, POLLIN, 0 };
+    if (poll(&p, 1, timeout_ms) <= 0)
+        return CCB_OK;
+
+    int fd = accept(listenfd, NULL, NULL);
+    if (fd < 0)
+        return CCB_OK;
+
+    // accept() may hand down O_NONBLOCK, the handshake blocks
+    fcntl(fd, F_SETFL, 0);
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if defined(SO_NOSIGPIPE)
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    char h[IMD_HEADER];
+    put_header(h, IMD_HANDSHAKE, 0);
+    int32_t version = IMD_VERSION;
+    memcpy(h + 4, &version, 4);
+
+    bool ok = send(fd, h, IMD_HEADER, IMD_SEND) == IMD_HEADER;
+
+    p.fd = fd;
+    ok = ok && poll(&p, 1, IMD_WAIT) == 1 && recv(fd, h, IMD_HEADER, MSG_WAITALL) == IMD_HEADER;
+
+    uint32_t type;
+    memcpy(&type, h, 4);
+    if (!ok || ntohl(type) != IMD_GO ||
+        fcntl(fd, F_SETFL, O_NONBLOCK) != 0) {
+        CCB_TRACE(1, "Output IMD: a client on port %d didn't answer as VMD\n", port);
+        close(fd);
+        return CCB_OK;
+    }
+
+    clientfd = fd;
+    paused = false;
+    rate = 1;
+    natom = -1;
+    nout = sent = nin = 0;
+
+    CCB_TRACE(1, "Output IMD: VMD connected on port %d\n", port);
+
+    return CCB_OK;
+}
+
+void OutputIMD::close_client(const char *why) {
+
+    close(clientfd);
+    clientfd = -1;
+    paused = false;
+
+    CCB_TRACE(1, "Output IMD: %s, %lld frames sent, %lld dropped\n", why,
+              (long long) nsent, (long long) ndrop);
+}
+
+/**
+ * @brief read what VMD sent and act on every complete message
+ *
+ * @param timeout_ms how long to wait for something, -1 for ever
+ */
+
+int OutputIMD::receive(int timeout_ms) {
+
+    pollfd p = { clientfd, POLLIN, 0 };
+    if (poll(&p, 1, timeout_ms) <= 0)
+        return CCB_OK;
+
+    if (nin == maxin) {
+        maxin += 4096;
+        in = (char *) memory->srealloc(in, maxin, "outputimd:in");
+    }
+
+    ssize_t m = recv(clientfd, in + nin, maxin - nin, 0);
+    if (m == 0 || (m < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        close_client("VMD disconnected");
+        return CCB_OK;
+    }
+    if (m > 0)
+        nin += m;
+
+    while (nin >= IMD_HEADER) {
+        uint32_t h[2];
+        memcpy(h, in, IMD_HEADER);
+        int32_t type = ntohl(h[0]);
+        int32_t length = ntohl(h[1]);
+
+        if (length < 0 || length > IMD_MAXLEN) {
+            close_client("bad message from VMD");
+            return CCB_OK;
+        }
+
+        // Bodies are skipped, there's nothing to do with forces
+        bigint body = 0;
+        if (type == IMD_ENERGIES) body = (bigint) length * IMD_ENERGIES_BYTES;
+        else if (type == IMD_FCOORDS) body = (bigint) length * 12;
+        else if (type == IMD_MDCOMM) body = (bigint) length * 16;
+
+        if (nin < IMD_HEADER + body) {
+            if (IMD_HEADER + body > maxin) {
+                maxin = IMD_HEADER + body;
+                in = (char *) memory->srealloc(in, maxin, "outputimd:in");
+            }
+            break;
+        }
+
+        if (type == IMD_DISCONNECT) {
+            close_client("VMD disconnected");
+            return CCB_OK;
+
+        } else if (type == IMD_KILL) {
+            killed = true;
+            close_client("VMD stopped the stream");
+            return CCB_OK;
+
+        } else if (type == IMD_PAUSE) {
+            paused = !paused;
+            CCB_TRACE(2, "Output IMD: %s\n", paused ? "paused" : "resumed");
+
+        } else if (type == IMD_TRATE) {
+            rate = length > 0 ? length : 1;
+            CCB_TRACE(2, "Output IMD: every %d frames\n", rate);
+        }
+
+        nin -= IMD_HEADER + body;
+        memmove(in, in + IMD_HEADER + body, nin);
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * @brief send what is left of out
+ *
+ * @param timeout_ms how long to wait for VMD to take more, 0 sends
+ * what fits and -1 waits until it's all gone
+ *
+ * @return CCB_ERROR if the client went away meanwhile
+ */
+
+int OutputIMD::flush(int timeout_ms) {
+
+    while (sent < nout) {
+        ssize_t m = send(clientfd, out + sent, nout - sent, IMD_SEND);
+
+        if (m > 0) {
+            sent += m;
+
+        } else if (m < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (timeout_ms == 0)
+                return CCB_OK;
+
+            // Keep listening, VMD may pause or leave meanwhile
+            pollfd p = { clientfd, POLLOUT | POLLIN, 0 };
+            int ready = poll(&p, 1, timeout_ms);
+            if (ready == 0)
+                return CCB_OK;
+            if (ready > 0 && (p.revents & POLLIN))
+                receive(0);
+            if (clientfd < 0)
+                return CCB_ERROR;
+
+        } else if (m < 0 && errno == EINTR) {
+            continue;
+
+        } else {
+            close_client("can't send to VMD");
+            return CCB_ERROR;
+        }
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * @brief the frame number as energies, then the coordinates as
+ * floats, into out
+ */
+
+void OutputIMD::pack(Atom **list, int n) {
+
+    int bytes = 2 * IMD_HEADER + IMD_ENERGIES_BYTES + 12 * n;
+    if (bytes > maxout) {
+        memory->sfree(out);
+        out = (char *) memory->smalloc(bytes, "outputimd:out");
+        maxout = bytes;
+    }
+
+    char *p = out;
+
+    put_header(p, IMD_ENERGIES, 1);
+    p += IMD_HEADER;
+
+    int32_t step = (int32_t) (nframe - 1);
+    float energy[9] = { 0.0f };
+    memcpy(p, &step, 4);
+    memcpy(p + 4, energy, sizeof(energy));
+    p += IMD_ENERGIES_BYTES;
+
+    put_header(p, IMD_FCOORDS, n);
+    p += IMD_HEADER;
+
+    float *x = (float *) p;
+    for (int i = 0; i < n; i++) {
+        x[3 * i] = list[i]->x;
+        x[3 * i + 1] = list[i]->y;
+        x[3 * i + 2] = list[i]->z;
+    }
+
+    nout = bytes;
+    sent = 0;
+}
+
+#endif
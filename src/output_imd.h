@@ -0,0 +1,111 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   output_imd.h
+ * @date   Mon Oct 19 19:43:27 2026
+ *
+ * @brief  imd output style header
+ *
+ * output imd id port [-host addr] [-wait] [-all] [group | selection ...]
+ *
+ * Streams every write to VMD as a frame of its Interactive
+ * Molecular Dynamics protocol, so a CCB process running a fit or
+ * a sampler can be watched live from a VMD session:
+ *
+ *     mol new first.pdb
+ *     imd connect localhost port
+ *
+ * The molecule in VMD must have the atoms written, in order. The
+ * style listens on port of host, 127.0.0.1 unless -host says
+ * otherwise, and takes one client at a time. -wait holds the first
+ * write until a client is there.
+ *
+ * A frame VMD isn't ready for is dropped, unless -all is given,
+ * then the write waits. The pause button of VMD holds the writes,
+ * the transfer rate sends every Nth frame and kill stops the
+ * stream for good. Forces sent back from VMD are ignored.
+ */
+
+
+#ifdef OUTPUT_CLASS
+
+OutputStyle(imd,OutputIMD)
+
+#else
+
+#ifndef CCB_OUTPUT_IMD_H
+#define CCB_OUTPUT_IMD_H
+
+#include "output.h"
+
+namespace CCB_NS {
+
+     class OutputIMD : public Output {
+
+     public:
+          OutputIMD(class CCB *, int, const char **);
+          ~OutputIMD();
+
+     private:
+          int port;                   /**< TCP port listened on */
+          char *host;                 /**< address listened on */
+          bool wait;                  /**< -wait for a client before the first frame */
+          bool all;                   /**< -all, wait rather than drop frames */
+          const char *bad;            /**< why the arguments were refused, NULL if they weren't */
+
+          int listenfd;               /**< listening socket, -1 before init */
+          int clientfd;               /**< VMD, -1 without a client */
+          bool killed;                /**< VMD sent kill, nothing more is sent */
+          bool paused;                /**< VMD paused the stream */
+          int rate;                   /**< send every rate-th frame */
+          int natom;                  /**< atoms in the last frame sent */
+
+          bigint nframe;              /**< frames written */
+          bigint nsent;               /**< frames sent */
+          bigint ndrop;               /**< frames dropped while VMD was busy */
+
+          char *out;                  /**< the frame being sent */
+          int nout, maxout;           /**< bytes in out and allocated */
+          int sent;                   /**< bytes of out already sent */
+
+          char *in;                   /**< bytes received, not yet handled */
+          int nin, maxin;
+
+          int init_style();          /**< Initialize the style */
+          int write_style();         /**< send a frame */
+
+          int open_socket();
+          int accept_client(int timeout_ms); /**< take a client and shake hands */
+          void close_client(const char *why);
+          int receive(int timeout_ms); /**< read and act on what VMD sent */
+          int flush(int timeout_ms);   /**< send the rest of out */
+          void pack(class Atom **list, int n); /**< energies and coordinates into out */
+     };
+}
+
+#endif
+#endif
@@ -0,0 +1,535 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   output_npy.cpp
+ * @date   Mon Oct 19 21:06:52 2026
+ *
+ * @brief  npy output style routine.
+ *
+ * The files are mapped and every write copies the atoms straight
+ * into the row of its frame, so frames can come in any order and
+ * from several processes at once. A new file is built under a
+ * temporary name and only then renamed, or with -shared linked,
+ * into place, so nobody opens a file without its header.
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "stdlib.h"
+#include "errno.h"
+#include "math.h"
+#include "output_npy.h"
+#include "error.h"
+#include "universe.h"
+#include "memory.h"
+#include "atom.h"
+#include "bitmask.h"
+#include "backbone.h"
+#include "backbonehandler.h"
+#include "trace.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+/**
+ * @def BLEN
+ *
+ * Length of path name or genaric buffer
+ */
+
+#define BLEN 200
+
+/**
+ * @def NPY_HEADER
+ *
+ * Bytes of the .npy header, room for any shape and a multiple of
+ * 64 so the rows are aligned
+ */
+
+#define NPY_HEADER 128
+
+/**
+ * @def NPY_FRAMES
+ *
+ * Frames a file starts with when it grows
+ */
+
+#define NPY_FRAMES 64
+
+using namespace CCB_NS;
+
+/**
+ * The OutputNPY Constructor, the arguments are checked by
+ * init_style()
+ *
+ * @param ccb The ccb pointer
+ * @param narg number of arguments passed
+ * @param arg the arguments passed
+ */
+
+OutputNPY::OutputNPY(CCB *ccb, int narg, const char **arg) :
+        Output(ccb, narg, arg) {
+
+    frame = 0;
+    bytes = 4;
+    nframe = 0;
+    shared = false;
+    bad = narg < 4 ? "Illegal output npy command" : NULL;
+
+    top = 0;
+    values = NULL;
+    maxvalue = 0;
+
+    // fname.npy keeps its parameters in fname_params.npy
+    int n = strlen(filename);
+    if (n > 4 && strcmp(filename + n - 4, ".npy") == 0) n -= 4;
+
+    coords.name = new char[strlen(filename) + 1];
+    strcpy(coords.name, filename);
+    params.name = new char[n + 12];
+    sprintf(params.name, "%.*s_params.npy", n, filename);
+
+    // Arrays are written in the byte order of the host
+    const unsigned short one = 1;
+    char order = *(const char *) &one ? '<' : '>';
+
+    Array *a[2] = { &coords, &params };
+    for (int i = 0; i < 2; i++) {
+        a[i]->fd = -1;
+        a[i]->map = NULL;
+        a[i]->size = a[i]->nrow = a[i]->row = 0;
+        a[i]->ncol = 0;
+        sprintf(a[i]->descr, "%cf8", order);
+    }
+    coords.dim = 3;
+    params.dim = 2;
+
+    int iarg = 4;
+    while (iarg < narg) {
+        if (strcmp(arg[iarg], "-shared") == 0) {
+            shared = true;
+            iarg++;
+
+        } else if (strcmp(arg[iarg], "-dtype") == 0 && iarg + 1 < narg) {
+            if (strcmp(arg[iarg + 1], "f4") == 0) bytes = 4;
+            else if (strcmp(arg[iarg + 1], "f8") == 0) bytes = 8;
+            else bad = "Output npy -dtype is f4 or f8";
+            iarg += 2;
+
+        } else if (strcmp(arg[iarg], "-frames") == 0 && iarg + 1 < narg) {
+            char *end;
+            nframe = strtoll(arg[iarg + 1], &end, 10);
+            if (*end != '\0' || nframe < 1)
+                bad = "Output npy -frames needs a positive integer";
+            iarg += 2;
+
+        } else {
+            break;
+        }
+    }
+
+    coords.descr[2] = '0' + bytes;
+
+    if (shared && nframe == 0)
+        bad = "Output npy -shared needs -frames";
+    if (strcmp(filename, "-") == 0)
+        bad = "Output npy can't write to stdout";
+
+    // Set the bitmask for atoms to output
+    set_atoms(narg, arg, iarg);
+}
+
+/**
+ * The OutputNPY deconstructor, a file that grew is cut to the
+ * frames written
+ */
+
+OutputNPY::~OutputNPY() {
+
+#if !defined(_WIN32)
+    release(coords);
+    release(params);
+#endif
+
+    memory->sfree(values);
+    delete [] coords.name;
+    delete [] params.name;
+}
+
+int OutputNPY::init_style() {
+
+    if (bad)
+        return error->one(FLERR, bad);
+
+#if defined(_WIN32)
+    return error->one(FLERR, "Output npy is not supported on this platform");
+#else
+    return CCB_OK;
+#endif
+}
+
+/**
+ * Writes the atoms and the parameters to the row of frame, the
+ * files are made by the first write, sized for its atoms
+ */
+
+int OutputNPY::write_style() {
+
+    if (bad)
+        return error->one(FLERR, bad);
+
+    if (select_atoms() != CCB_OK)
+        return CCB_ERROR;
+
+    if (universe->me != 0)
+        return CCB_OK;
+
+#if defined(_WIN32)
+    return error->one(FLERR, "Output npy is not supported on this platform");
+#else
+
+    char str[BLEN];
+
+    int natom = 0;
+    Atom **list = bitmask->list(mask, natom);
+
+    int nvalue = pack_values();
+    if (nvalue < 0)
+        return CCB_ERROR;
+
+    if (coords.map == NULL) {
+        bigint n = nframe;
+        if (n == 0) n = frame < NPY_FRAMES ? NPY_FRAMES : frame + 1;
+
+        coords.ncol = natom;
+        coords.row = (bigint) natom * 3 * bytes;
+        params.ncol = nvalue;
+        params.row = (bigint) nvalue * sizeof(double);
+
+        if (create(coords, n) != CCB_OK || create(params, n) != CCB_OK)
+            return CCB_ERROR;
+    }
+
+    // Every frame of an array has the same shape
+    if (natom != coords.ncol || nvalue != params.ncol) {
+        snprintf(str, BLEN, "Output npy: %s holds %d atoms and %d parameters, not %d and %d",
+                 coords.name, coords.ncol, params.ncol, natom, nvalue);
+        return error->one(FLERR, str);
+    }
+
+    if (frame < 0 || (nframe > 0 && frame >= nframe)) {
+        snprintf(str, BLEN, "Output npy: frame %lld is outside the %lld frames of %s",
+                 (long long) frame, (long long) coords.nrow, coords.name);
+        return error->one(FLERR, str);
+    }
+
+    if (frame >= coords.nrow) {
+        bigint n = 2 * coords.nrow > frame ? 2 * coords.nrow : frame + 1;
+        if (grow(coords, n) != CCB_OK || grow(params, n) != CCB_OK)
+            return CCB_ERROR;
+    }
+
+    char *row = coords.map + NPY_HEADER + frame * coords.row;
+    if (bytes == 4) {
+        float *x = (float *) row;
+        for (int i = 0; i < natom; i++) {
+            x[3 * i] = list[i]->x;
+            x[3 * i + 1] = list[i]->y;
+            x[3 * i + 2] = list[i]->z;
+        }
+    } else {
+        double *x = (double *) row;
+        for (int i = 0; i < natom; i++) {
+            x[3 * i] = list[i]->x;
+            x[3 * i + 1] = list[i]->y;
+            x[3 * i + 2] = list[i]->z;
+        }
+    }
+
+    if (nvalue > 0)
+        memcpy(params.map + NPY_HEADER + frame * params.row, values, params.row);
+
+    CCB_TRACE(3, "Output NPY: %d atoms, frame %lld written to %s\n", natom,
+              (long long) frame, coords.name);
+
+    if (frame >= top) top = frame + 1;
+    frame++;
+
+    return CCB_OK;
+#endif
+}
+
+/**
+ * @brief the parameters of every backbone, one after the other
+ *
+ * @return the number of values, -1 if out of memory
+ */
+
+int OutputNPY::pack_values() {
+
+    int n = 0;
+
+    for (int i = 0; i < backbone->nbackbone; i++) {
+        Backbone *bb = backbone->backbone[i];
+
+        int m = bb->pack_values(values + n, maxvalue - n);
+        if (n + m > maxvalue) {
+            maxvalue = n + m;
+            values = (double *) memory->srealloc(values, maxvalue * sizeof(double), "output_npy:values");
+            if (values == NULL) return -1;
+            bb->pack_values(values + n, maxvalue - n);
+        }
+
+        n += m;
+    }
+
+    return n;
+}
+
+#if !defined(_WIN32)
+
+/**
+ * @brief the .npy header of a, version 1.0, for nrow frames
+ */
+
+void OutputNPY::header(char *head, const Array &a, bigint nrow) {
+
+    char dict[NPY_HEADER];
+
+    if (a.dim == 3)
+        snprintf(dict, NPY_HEADER, "{'descr': '%s', 'fortran_order': False, 'shape': (%lld, %d, 3), }",
+                 a.descr, (long long) nrow, a.ncol);
+    else
+        snprintf(dict, NPY_HEADER, "{'descr': '%s', 'fortran_order': False, 'shape': (%lld, %d), }",
+                 a.descr, (long long) nrow, a.ncol);
+
+    // Padded with spaces and ended by a newline
+    memset(head, ' ', NPY_HEADER);
+    memcpy(head, "\x93NUMPY\x01\x00", 8);
+    head[8] = (NPY_HEADER - 10) & 0xff;
+    head[9] = (NPY_HEADER - 10) >> 8;
+    memcpy(head + 10, dict, strlen(dict));
+    head[NPY_HEADER - 1] = '\n';
+}
+
+/**
+ * @brief no parameters yet for rows lo to hi-1, the coordinates
+ * are already zero
+ */
+
+void OutputNPY::blank(Array &a, bigint lo, bigint hi) {
+
+    if (&a != &params)
+        return;
+
+    double *v = (double *) (a.map + NPY_HEADER);
+    for (bigint i = lo * a.ncol; i < hi * a.ncol; i++)
+        v[i] = NAN;
+}
+
+/**
+ * @brief make the file of a with room for nrow frames and map it
+ *
+ * The file is written under a temporary name first. It then
+ * replaces any file of the same name, or with -shared is linked
+ * in unless another process got there first, whose file is used.
+ */
+
+int OutputNPY::create(Array &a, bigint nrow) {
+
+    char str[BLEN];
+    char head[NPY_HEADER];
+    header(head, a, nrow);
+
+    char *tmp = new char[strlen(a.name) + 8];
+    sprintf(tmp, "%s.XXXXXX", a.name);
+
+    int fd = mkstemp(tmp);
+    if (fd < 0) {
+        delete [] tmp;
+        snprintf(str, BLEN, "Can't create output file %s", a.name);
+        return error->one(FLERR, str);
+    }
+    fchmod(fd, 0644);
+
+    // Reserve the blocks, a full disk fails here rather than in a write
+    bigint n = NPY_HEADER + nrow * a.row;
+#if defined(__linux__)
+    int fail = posix_fallocate(fd, 0, n);
+#else
+    int fail = ftruncate(fd, n);
+#endif
+
+    void *map = MAP_FAILED;
+    if (fail == 0)
+        map = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED) {
+        close(fd);
+        unlink(tmp);
+        delete [] tmp;
+        snprintf(str, BLEN, "Can't make %lld bytes of %s", (long long) n, a.name);
+        return error->one(FLERR, str);
+    }
+
+    a.fd = fd;
+    a.map = (char *) map;
+    a.size = n;
+    a.nrow = nrow;
+
+    memcpy(a.map, head, NPY_HEADER);
+    blank(a, 0, nrow);
+
+    int fail_link = shared ? link(tmp, a.name) : rename(tmp, a.name);
+    bool taken = fail_link != 0 && shared && errno == EEXIST;
+    if (shared || fail_link != 0)
+        unlink(tmp);
+    delete [] tmp;
+
+    if (taken) {
+        release(a);
+        return join(a, head);
+    }
+
+    if (fail_link != 0) {
+        release(a);
+        snprintf(str, BLEN, "Can't create output file %s", a.name);
+        return error->one(FLERR, str);
+    }
+
+    CCB_TRACE(2, "Output NPY: %s holds %lld frames of %d, %lld bytes\n",
+              a.name, (long long) nrow, a.ncol, (long long) n);
+
+    return CCB_OK;
+}
+
+/**
+ * @brief map the file another process made, it must have the
+ * header this output would write
+ */
+
+int OutputNPY::join(Array &a, const char *head) {
+
+    char str[BLEN];
+    char have[NPY_HEADER];
+    struct stat st;
+
+    bigint n = NPY_HEADER + nframe * a.row;
+
+    int fd = open(a.name, O_RDWR);
+    if (fd < 0) {
+        snprintf(str, BLEN, "Can't open output file %s", a.name);
+        return error->one(FLERR, str);
+    }
+
+    if (fstat(fd, &st) != 0 || st.st_size != n ||
+        pread(fd, have, NPY_HEADER, 0) != NPY_HEADER ||
+        memcmp(have, head, NPY_HEADER) != 0) {
+        close(fd);
+        snprintf(str, BLEN, "Output npy: %s has another shape, remove it to start over", a.name);
+        return error->one(FLERR, str);
+    }
+
+    void *map = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        snprintf(str, BLEN, "Can't map output file %s", a.name);
+        return error->one(FLERR, str);
+    }
+
+    a.fd = fd;
+    a.map = (char *) map;
+    a.size = n;
+    a.nrow = nframe;
+
+    CCB_TRACE(2, "Output NPY: joined %s\n", a.name);
+
+    return CCB_OK;
+}
+
+/**
+ * @brief make room for nrow frames, the header follows so the
+ * file stays readable
+ */
+
+int OutputNPY::grow(Array &a, bigint nrow) {
+
+    bigint n = NPY_HEADER + nrow * a.row;
+
+    munmap(a.map, a.size);
+    a.map = NULL;
+
+#if defined(__linux__)
+    int fail = posix_fallocate(a.fd, 0, n);
+#else
+    int fail = ftruncate(a.fd, n);
+#endif
+
+    void *map = MAP_FAILED;
+    if (fail == 0)
+        map = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_SHARED, a.fd, 0);
+
+    if (map == MAP_FAILED) {
+        char str[BLEN];
+        snprintf(str, BLEN, "Can't grow %s to %lld bytes", a.name, (long long) n);
+        return error->one(FLERR, str);
+    }
+
+    a.map = (char *) map;
+    a.size = n;
+    blank(a, a.nrow, nrow);
+    a.nrow = nrow;
+
+    header(a.map, a, nrow);
+
+    return CCB_OK;
+}
+
+void OutputNPY::release(Array &a) {
+
+    if (a.map && nframe == 0) {
+        header(a.map, a, top);
+        munmap(a.map, a.size);
+        if (ftruncate(a.fd, NPY_HEADER + top * a.row) != 0)
+            error->warning(FLERR, "Output npy: can't cut the file to the frames written");
+    } else if (a.map) {
+        munmap(a.map, a.size);
+    }
+
+    if (a.fd >= 0)
+        close(a.fd);
+
+    a.fd = -1;
+    a.map = NULL;
+    a.size = 0;
+}
+
+#endif
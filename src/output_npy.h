@@ -0,0 +1,114 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   output_npy.h
+ * @date   Mon Oct 19 21:06:52 2026
+ *
+ * @brief  npy output style header
+ *
+ * output npy id fname [-dtype f4|f8] [-frames N [-shared]] [group | selection ...]
+ *
+ * Writes the frames of an ensemble into fname as a NumPy array of
+ * shape (frames, atoms, 3), float32 (f4, the default) or float64,
+ * and the parameters of each frame, from Backbone::pack_values(),
+ * into fname_params.npy as float64 of shape (frames, values).
+ * Both load with numpy.load, mmap_mode="r" reads them in place.
+ *
+ * Each write goes to the row in frame, counting from 0, which
+ * then moves on by one. -frames N sizes the files for N frames up
+ * front, otherwise they grow as needed and are cut to the last
+ * frame written when the output is deleted. Rows not written are
+ * zero, with NaN parameters.
+ *
+ * With -shared an existing file of the same shape is opened
+ * rather than replaced, so processes writing different frames of
+ * one ensemble, each setting frame, fill the same files.
+ */
+
+
+#ifdef OUTPUT_CLASS
+
+OutputStyle(npy,OutputNPY)
+
+#else
+
+#ifndef CCB_OUTPUT_NPY_H
+#define CCB_OUTPUT_NPY_H
+
+#include "output.h"
+
+namespace CCB_NS {
+
+     class OutputNPY : public Output {
+
+     public:
+          OutputNPY(class CCB *, int, const char **);
+          ~OutputNPY();
+
+          bigint frame;               /**< row the next write goes to */
+
+     private:
+          int bytes;                  /**< 4 for float32, 8 for float64 */
+          bigint nframe;              /**< -frames, 0 to grow */
+          bool shared;                /**< -shared, open a matching file rather than replace it */
+          const char *bad;            /**< why the arguments were refused, NULL if they weren't */
+
+          /// One mapped .npy file
+          struct Array {
+               char *name;            /**< file name */
+               char descr[4];         /**< NumPy type, e.g. <f4 */
+               int dim;               /**< 3 for coordinates, 2 for parameters */
+               int fd;                /**< the open file, -1 until created */
+               char *map;             /**< the mapped file, NULL until created */
+               bigint size;           /**< bytes mapped */
+               bigint nrow;           /**< frames the file holds */
+               bigint row;            /**< bytes per frame */
+               int ncol;              /**< atoms, or values per frame */
+          };
+
+          Array coords;               /**< (frames, atoms, 3) */
+          Array params;               /**< (frames, values) */
+          bigint top;                 /**< one past the last frame written */
+
+          double *values;             /**< parameters of the frame being written */
+          int maxvalue;
+
+          int init_style();          /**< Initialize the style */
+          int write_style();         /**< write a frame */
+
+          int create(Array &a, bigint nrow); /**< make, or with -shared join, the file */
+          int join(Array &a, const char *head); /**< open a matching file another process made */
+          int grow(Array &a, bigint nrow);
+          void release(Array &a);    /**< cut a grown file down to top, unmap and close it */
+          void header(char *head, const Array &a, bigint nrow);
+          void blank(Array &a, bigint lo, bigint hi); /**< NaN the parameters of rows lo to hi-1 */
+          int pack_values();          /**< parameters of every backbone into values */
+     };
+}
+
+#endif
+#endif
@@ -59,6 +59,11 @@
  *     12345678901234567890123456789012345678901234567890123456789012345678901234567890
  *     ATOM    145  N   VAL A  25      32.433  16.336  57.540  1.00 11.92      A1   N
  *     ATOM    146  CA  VAL A  25      31.132  16.439  58.160  1.00 11.85      A1   C
+ *
+ * output pdb id fname [group | selection ...]
+ *
+ * The atoms written are a bitmask group, or the atoms matching a
+ * selection (see select.h), which is applied before every write.
  */
 
 #include "stdio.h"
@@ -72,14 +77,7 @@
 #include "site.h"
 #include "domain.h"
 #include "bitmask.h"
-
-/**
- * @def BLEN
- *
- * Length of path name or genaric buffer
- */
-
-#define BLEN 200
+#include "trace.h"
 
 using namespace CCB_NS;
 
@@ -97,19 +95,11 @@ OutputPDB::OutputPDB(CCB *ccb, int narg, const char **arg) :
     if (strcmp(style, "PDB") != 0 && narg < 4)
         error->one(FLERR, "Illegal output PDB command");
 
-    // Set the bitmask for atoms to output
-    if (narg > 4) {
-        int imask = bitmask->find(arg[4]);
-
-        if (imask < 0)
-            error->one(FLERR, "output_pdb: bitmask doesn't exist");
-
-        mask = bitmask->mask[imask];
+    // Set the bitmask for atoms to output, all by default
+    set_atoms(narg, arg, 4);
+}
 
-    } else {
-        // By default, output all atoms
-        mask = 1;
-    }
+OutputPDB::~OutputPDB() {
 }
 
 /**
@@ -133,6 +123,9 @@ int OutputPDB::write_style() {
     int serial = 1;
     Atom *atom = NULL;
 
+    if (select_atoms() != CCB_OK)
+        return CCB_ERROR;
+
     if (universe->me == 0) {
         // Open output file
         openfile();
@@ -144,36 +137,34 @@ int OutputPDB::write_style() {
             char *seg = new char[10];
             char *chain = new char[10];
 
-            // Loop over all sites
-            for (int i = 0; i < domain->nsite; i++) {
-
-                for (int j = 0; j < domain->site[i]->fixed_atoms->natom; j++) {
-                    atom = domain->site[i]->fixed_atoms->atom[j];
+            // Loop over the atoms in the group, in domain order
+            int natom = 0;
+            Atom **list = bitmask->list(mask, natom);
 
-                    // Copy stings
-                    strcpy(name, atom->name);
-                    strcpy(type, atom->group->type);
-                    strcpy(seg, atom->site->seg);
-                    strcpy(chain, atom->site->chain);
+            for (int k = 0; k < natom; k++) {
+                atom = list[k];
 
-                    // Shorten the strings
-                    chomp(name, 5);
-                    chomp(type, 3);
-                    chomp(seg, 4);
-                    chomp(chain, 1);
+                // Copy stings
+                strcpy(name, atom->name);
+                strcpy(type, atom->group->type);
+                strcpy(seg, atom->site->seg);
+                strcpy(chain, atom->site->chain);
 
-                    // Check mask and write out atoms
-                    if (atom->mask & mask)
-                        fprintf(fp, "ATOM  %5d  %-4s%-3s %1s%4d    %8.3lf%8.3lf%8.3lf%6.2lf%6.2lf      %-4s%2s\n", serial++, name, type, chain,
-                                atom->site->resid, atom->x, atom->y, atom->z, atom->o, atom->b, seg, atom->element);
-                }
+                // Shorten the strings
+                chomp(name, 5);
+                chomp(type, 3);
+                chomp(seg, 4);
+                chomp(chain, 1);
 
+                // Write out atoms
+                fprintf(fp, "ATOM  %5d  %-4s%-3s %1s%4d    %8.3lf%8.3lf%8.3lf%6.2lf%6.2lf      %-4s%2s\n", serial++, name, type, chain,
+                        atom->site->resid, atom->x, atom->y, atom->z, atom->o, atom->b, seg, atom->element);
             }
 
             fprintf(fp, "END\n");
 
-            if (universe->me == 0 && error->verbosity_level >= 3)
-                fprintf(screen, "Output PDB: %d atoms, written to %s\n", serial - 1, filename);
+            if (universe->me == 0)
+                CCB_TRACE(3, "Output PDB: %d atoms, written to %s\n", serial - 1, filename);
 
             delete[] name;
             delete[] type;
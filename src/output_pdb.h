@@ -52,10 +52,9 @@ namespace CCB_NS {
      
      public:
           OutputPDB(class CCB *, int, const char **);
-          ~OutputPDB() {}
+          ~OutputPDB();
      
      private:
-          int mask;                   /**< bitmask for atoms to output */
           int init_style();          /**< Initialize the style */
           int write_style();         /**< read the file based on style */
           void chomp(char *s, int n); /**< Shorten string to n characters */
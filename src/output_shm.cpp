@@ -0,0 +1,457 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   output_shm.cpp
+ * @date   Mon Oct 19 16:20:41 2026
+ *
+ * @brief  shm output style routine.
+ *
+ * Each write fills the next slot of the ring in place from the
+ * atom list, there is no file, no formatting and no system call.
+ * The atom table is only written again when the atoms differ
+ * from the last one published, so a batch that rebuilds the same
+ * topology every set publishes it once.
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "stdlib.h"
+#include "errno.h"
+#include "output_shm.h"
+#include "error.h"
+#include "universe.h"
+#include "memory.h"
+#include "atom.h"
+#include "group.h"
+#include "site.h"
+#include "bitmask.h"
+#include "trace.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#endif
+
+/**
+ * @def BLEN
+ *
+ * Length of path name or genaric buffer
+ */
+
+#define BLEN 200
+
+/**
+ * @def SHM_SLOTS
+ *
+ * Frames in the ring unless -slots says otherwise
+ */
+
+#define SHM_SLOTS 64
+
+using namespace CCB_NS;
+
+/// Round n up to a whole number of cache lines
+static inline bigint line_up(bigint n) {
+    return (n + 63) & ~(bigint) 63;
+}
+
+/**
+ * The OutputSHM Constructor, the arguments are checked by
+ * init_style()
+ *
+ * @param ccb The ccb pointer
+ * @param narg number of arguments passed
+ * @param arg the arguments passed
+ */
+
+OutputSHM::OutputSHM(CCB *ccb, int narg, const char **arg) :
+        Output(ccb, narg, arg) {
+
+    nslot = SHM_SLOTS;
+    maxatom = 0;
+    bad = narg < 4 ? "Illegal output shm command" : NULL;
+
+    h = NULL;
+    size = 0;
+    topology = 0;
+    first[0] = first[1] = 0;
+    tick = -1;
+
+    rows = scratch = NULL;
+    nrow = maxrow = 0;
+
+    // POSIX names start with a slash
+    name = new char[strlen(filename) + 2];
+    sprintf(name, "%s%s", filename[0] == '/' ? "" : "/", filename);
+
+    int iarg = 4;
+    while (iarg + 1 < narg && (strcmp(arg[iarg], "-slots") == 0 || strcmp(arg[iarg], "-atoms") == 0)) {
+        char *end;
+        long n = strtol(arg[iarg + 1], &end, 10);
+
+        if (*end != '\0' || n < 1 || n > (1L << 24)) {
+            bad = "Output shm -slots and -atoms need a positive integer";
+        } else if (arg[iarg][1] == 's') {
+            // A power of two, so the slot is a mask of the frame
+            nslot = 1;
+            while (nslot < n) nslot <<= 1;
+        } else {
+            maxatom = n;
+        }
+
+        iarg += 2;
+    }
+
+    // Set the bitmask for atoms to output
+    set_atoms(narg, arg, iarg);
+}
+
+/**
+ * The OutputSHM deconstructor, readers see the ring done
+ */
+
+OutputSHM::~OutputSHM() {
+
+    release(CCB_RING_DONE);
+
+    memory->sfree(rows);
+    memory->sfree(scratch);
+    delete [] name;
+}
+
+/**
+ * Creates the ring at once when -atoms sized it, so readers can
+ * open it before the first frame
+ */
+
+int OutputSHM::init_style() {
+
+    if (bad)
+        return error->one(FLERR, bad);
+
+#if defined(_WIN32)
+    return error->one(FLERR, "Output shm is not supported on this platform");
+#else
+    if (h == NULL && maxatom > 0 && universe->me == 0)
+        return create(maxatom);
+
+    return CCB_OK;
+#endif
+}
+
+/**
+ * Publishes the atoms as the next frame of the ring
+ */
+
+int OutputSHM::write_style() {
+
+    if (bad)
+        return error->one(FLERR, bad);
+
+    if (select_atoms() != CCB_OK)
+        return CCB_ERROR;
+
+    if (universe->me != 0)
+        return CCB_OK;
+
+#if defined(_WIN32)
+    return error->one(FLERR, "Output shm is not supported on this platform");
+#else
+
+    int natom = 0;
+    Atom **list = bitmask->list(mask, natom);
+
+    // Grow by doubling, readers move to the new ring
+    if (h == NULL || (uint32_t) natom > h->maxatom) {
+        int n = natom > 0 ? natom : 1;
+        int32_t follower[CCB_RING_READERS] = { 0 };
+        if (h) {
+            if (n < 2 * (int) h->maxatom) n = 2 * h->maxatom;
+            for (int i = 0; i < CCB_RING_READERS; i++) {
+                int32_t pid = __atomic_load_n(&h->reader[i].pid, __ATOMIC_ACQUIRE);
+                follower[i] = pid > 0 ? -pid : pid;
+            }
+            release(CCB_RING_REPLACED);
+        }
+        if (n < maxatom) n = maxatom;
+        if (create(n, follower) != CCB_OK)
+            return CCB_ERROR;
+    }
+
+    // Compare the atoms only when the group or the atoms changed
+    bigint now = bitmask->changed(mask);
+    if (topology == 0 || now != tick) {
+        fill_rows(list, natom);
+        if (topology == 0 || natom != nrow ||
+            memcmp(scratch, rows, natom * sizeof(ccb_ring_atom_t)) != 0)
+            publish_rows(natom);
+        tick = now;
+    }
+
+    uint64_t seq = h->head;
+    if (seq >= (uint64_t) nslot)
+        wait_readers(seq - nslot + 1);
+
+    ccb_ring_slot_t *s = (ccb_ring_slot_t *) ((char *) h + h->slot_offset +
+                                              (seq & (nslot - 1)) * h->slot_bytes);
+
+    __atomic_store_n(&s->seq, 2 * seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    s->topology = topology;
+    s->natom = natom;
+
+    double *x = (double *) (s + 1);
+    for (int i = 0; i < natom; i++) {
+        x[3 * i] = list[i]->x;
+        x[3 * i + 1] = list[i]->y;
+        x[3 * i + 2] = list[i]->z;
+    }
+
+    __atomic_store_n(&s->seq, 2 * seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&h->head, seq + 1, __ATOMIC_RELEASE);
+
+    CCB_TRACE(3, "Output SHM: %d atoms, frame %llu written to %s\n", natom,
+              (unsigned long long) seq, name);
+
+    return CCB_OK;
+#endif
+}
+
+#if !defined(_WIN32)
+
+/**
+ * @brief create the ring under name, replacing any left behind
+ *
+ * The object comes zeroed, so no slot or table is complete and
+ * no cursor is in use but those kept for the followers of the
+ * ring replaced. magic is set last, readers wait for it.
+ *
+ * @param follower pids to keep a cursor for, NULL for none
+ */
+
+int OutputSHM::create(int natom, const int32_t *follower) {
+
+    char str[BLEN];
+
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        snprintf(str, BLEN, "Can't create shared memory %s", name);
+        return error->one(FLERR, str);
+    }
+
+    bigint table_bytes = line_up(sizeof(ccb_ring_table_t) + (bigint) natom * sizeof(ccb_ring_atom_t));
+    bigint slot_bytes = line_up(sizeof(ccb_ring_slot_t) + (bigint) natom * 3 * sizeof(double));
+    bigint table_offset = line_up(sizeof(ccb_ring_header_t));
+    bigint slot_offset = table_offset + 2 * table_bytes;
+    bigint n = slot_offset + nslot * slot_bytes;
+
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, n) == 0)
+        map = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        shm_unlink(name);
+        snprintf(str, BLEN, "Can't map %lld bytes of shared memory %s", (long long) n, name);
+        return error->one(FLERR, str);
+    }
+
+    h = (ccb_ring_header_t *) map;
+    size = n;
+
+    h->version = CCB_RING_VERSION;
+    h->nslot = nslot;
+    h->maxatom = natom;
+    h->pid = getpid();
+    h->size = n;
+    h->table_offset = table_offset;
+    h->table_bytes = table_bytes;
+    h->slot_offset = slot_offset;
+    h->slot_bytes = slot_bytes;
+    h->state = CCB_RING_LIVE;
+
+    for (int i = 0; follower && i < CCB_RING_READERS; i++)
+        h->reader[i].pid = follower[i];
+
+    // Frames and topologies start over in a new ring
+    topology = 0;
+    first[0] = first[1] = 0;
+
+    __atomic_store_n(&h->magic, CCB_RING_MAGIC, __ATOMIC_RELEASE);
+
+    CCB_TRACE(2, "Output SHM: %s holds %d frames of %d atoms, %lld bytes\n",
+              name, nslot, natom, (long long) n);
+
+    return CCB_OK;
+}
+
+/**
+ * @brief hand the ring over to its readers, who keep their mapping
+ *
+ * A ring that is done first waits for the followers to read every
+ * frame, including those yet to reopen it after a replacement.
+ */
+
+void OutputSHM::release(uint32_t state) {
+
+    if (h == NULL)
+        return;
+
+    if (state == CCB_RING_DONE)
+        wait_readers(h->head);
+
+    __atomic_store_n(&h->state, state, __ATOMIC_RELEASE);
+    shm_unlink(name);
+    munmap(h, size);
+
+    h = NULL;
+    size = 0;
+}
+
+/**
+ * @brief wait until every follower holds seq or a later frame
+ *
+ * The cursors of readers that died are freed.
+ */
+
+void OutputSHM::wait_readers(uint64_t seq) {
+
+    int nap = 1;
+    bool waited = false;
+
+    for (int i = 0; i < CCB_RING_READERS; i++) {
+        ccb_ring_cursor_t &c = h->reader[i];
+
+        while (true) {
+            int32_t pid = __atomic_load_n(&c.pid, __ATOMIC_ACQUIRE);
+            if (pid == 0 || __atomic_load_n(&c.seq, __ATOMIC_SEQ_CST) >= seq)
+                break;
+
+            // Kept cursors are held under minus the pid
+            if (kill(pid > 0 ? pid : -pid, 0) != 0 && errno == ESRCH) {
+                __atomic_store_n(&c.seq, (uint64_t) 0, __ATOMIC_RELAXED);
+                __atomic_compare_exchange_n(&c.pid, &pid, (int32_t) 0, false,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+                continue;
+            }
+
+            if (!waited)
+                CCB_TRACE(3, "Output SHM: waiting on reader %d for frame %llu\n",
+                          (int) (pid > 0 ? pid : -pid), (unsigned long long) seq);
+            waited = true;
+
+            if (nap == 1) {
+                sched_yield();
+                nap = 2;
+            } else {
+                struct timespec ts = { 0, 1000L * nap };
+                nanosleep(&ts, NULL);
+                if (nap < 1000) nap *= 2;
+            }
+        }
+    }
+}
+
+/**
+ * @brief the table rows of the atoms in list, zero padded so two
+ * tables compare with memcmp
+ */
+
+void OutputSHM::fill_rows(Atom **list, int natom) {
+
+    if (natom > maxrow) {
+        memory->sfree(rows);
+        memory->sfree(scratch);
+        rows = (ccb_ring_atom_t *) memory->smalloc(natom * sizeof(ccb_ring_atom_t), "outputshm:rows");
+        scratch = (ccb_ring_atom_t *) memory->smalloc(natom * sizeof(ccb_ring_atom_t), "outputshm:scratch");
+        maxrow = natom;
+        nrow = -1;
+    }
+
+    memset(scratch, 0, natom * sizeof(ccb_ring_atom_t));
+
+    for (int i = 0; i < natom; i++) {
+        ccb_ring_atom_t &a = scratch[i];
+        Atom *atom = list[i];
+
+        a.serial = i + 1;
+        a.resid = atom->site->resid;
+        strcpy(a.name, atom->name);
+        strcpy(a.resname, atom->group->type);
+        strcpy(a.chain, atom->site->chain);
+        strcpy(a.seg, atom->site->seg);
+        strcpy(a.element, atom->element);
+
+        // Generated atoms have no element, the name starts with it
+        if (a.element[0] == '\0')
+            a.element[0] = atom->name[0];
+    }
+}
+
+/**
+ * @brief write scratch as the next topology, used from the next
+ * frame on
+ *
+ * The table is the one before last, so every follower must have
+ * moved past the frames that used it.
+ */
+
+void OutputSHM::publish_rows(int natom) {
+
+    uint64_t t = topology + 1;
+    int k = t & 1;
+
+    wait_readers(first[k ^ 1]);
+
+    ccb_ring_table_t *table = (ccb_ring_table_t *) ((char *) h + h->table_offset + k * h->table_bytes);
+
+    __atomic_store_n(&table->seq, 2 * t + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    table->topology = t;
+    table->natom = natom;
+    memcpy(table + 1, scratch, natom * sizeof(ccb_ring_atom_t));
+
+    __atomic_store_n(&table->seq, 2 * t + 2, __ATOMIC_RELEASE);
+
+    // The rows just published are the ones to compare against
+    ccb_ring_atom_t *tmp = rows;
+    rows = scratch;
+    scratch = tmp;
+    nrow = natom;
+
+    topology = t;
+    first[k] = h->head;
+}
+
+#endif
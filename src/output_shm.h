@@ -0,0 +1,93 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   output_shm.h
+ * @date   Mon Oct 19 16:20:41 2026
+ *
+ * @brief  shm output style header
+ *
+ * output shm id name [-slots N] [-atoms N] [group | selection ...]
+ *
+ * Publishes every write as a frame of a POSIX shared memory ring,
+ * see ring.h for the layout and the reader. The ring holds the
+ * last -slots frames, 64 by default, each with room for -atoms
+ * atoms, by default as many as the first frame has. Readers that
+ * follow the ring hold up the writes, and deleting the output,
+ * until they have read every frame.
+ */
+
+
+#ifdef OUTPUT_CLASS
+
+OutputStyle(shm,OutputSHM)
+
+#else
+
+#ifndef CCB_OUTPUT_SHM_H
+#define CCB_OUTPUT_SHM_H
+
+#include "output.h"
+#include "ring.h"
+
+namespace CCB_NS {
+
+     class OutputSHM : public Output {
+
+     public:
+          OutputSHM(class CCB *, int, const char **);
+          ~OutputSHM();
+
+     private:
+          char *name;                 /**< the shared memory object, with a leading / */
+          int nslot;                  /**< frames the ring holds */
+          int maxatom;                /**< -atoms, 0 to size from the first frame */
+          const char *bad;            /**< why the arguments were refused, NULL if they weren't */
+
+          ccb_ring_header_t *h;       /**< the mapped ring, NULL until created */
+          bigint size;                /**< bytes mapped */
+
+          uint64_t topology;          /**< the last atom table published */
+          uint64_t first[2];          /**< first frame to use each table */
+          bigint tick;                /**< bitmask tick the atoms were last compared at */
+
+          ccb_ring_atom_t *rows;      /**< atoms of the last table published */
+          ccb_ring_atom_t *scratch;   /**< atoms of the frame being written */
+          int nrow, maxrow;
+
+          int init_style();          /**< Initialize the style */
+          int write_style();         /**< publish a frame */
+
+          int create(int natom, const int32_t *follower = NULL); /**< a new ring with room for natom */
+          void release(uint32_t state); /**< mark the ring, unlink and unmap it */
+          void wait_readers(uint64_t seq); /**< until every follower has moved to seq */
+          void fill_rows(class Atom **list, int natom);
+          void publish_rows(int natom);
+     };
+}
+
+#endif
+#endif
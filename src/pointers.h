@@ -77,6 +77,8 @@ namespace CCB_NS {
             error(ptr->error),
             universe(ptr->universe),
             ccbio(ptr->ccbio),
+            timer(ptr->timer),
+            trace(ptr->trace),
             domain(ptr->domain),
             bitmask(ptr->bitmask),
             backbone(ptr->backbone),
@@ -94,6 +96,8 @@ namespace CCB_NS {
         Error *&error;
         Universe *&universe;
         Ccbio *&ccbio;
+        Timer *&timer;
+        Trace *&trace;
 
         Domain *&domain;
         Bitmask *&bitmask;
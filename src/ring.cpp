@@ -0,0 +1,370 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   ring.cpp
+ * @date   Mon Oct 19 16:20:41 2026
+ *
+ * @brief  Reader of the shared-memory ring, see ring.h
+ *
+ * Only needs the C library, so a consumer can build it in with
+ * ring.h rather than link all of CCB.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "ring.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * @def RING_SPIN
+ *
+ * Polls of head before a waiting reader starts to sleep
+ */
+
+#define RING_SPIN 1000
+
+/**
+ * @def RING_NAP
+ *
+ * Longest sleep between polls, in microseconds
+ */
+
+#define RING_NAP 1000
+
+struct ccb_ring {
+    ccb_ring_header_t *h;
+    size_t size;                /**< bytes mapped */
+    int cursor;                 /**< index in h->reader, -1 when not following */
+    uint64_t next;              /**< frame the next call returns */
+    uint64_t lost;              /**< frames overtaken */
+};
+
+#if !defined(_WIN32)
+
+static inline uint64_t acquire(const uint64_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline const ccb_ring_slot_t *slot_at(const ccb_ring_t *r, uint64_t seq) {
+    const ccb_ring_header_t *h = r->h;
+    return (const ccb_ring_slot_t *) ((const char *) h + h->slot_offset +
+                                      (seq & (h->nslot - 1)) * h->slot_bytes);
+}
+
+static inline const ccb_ring_table_t *table_at(const ccb_ring_t *r, uint64_t topology) {
+    const ccb_ring_header_t *h = r->h;
+    return (const ccb_ring_table_t *) ((const char *) h + h->table_offset +
+                                       (topology & 1) * h->table_bytes);
+}
+
+/// The oldest frame still in the ring
+static inline uint64_t oldest(const ccb_ring_header_t *h) {
+    uint64_t head = acquire(&h->head);
+    return head > h->nslot ? head - h->nslot : 0;
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+/**
+ * @brief map the ring published under name
+ *
+ * @param name the shared memory object, as given to the output
+ * @param follow hold a cursor so no frame is overwritten unread
+ * @param r the reader, NULL unless CCB_RING_OK is returned
+ *
+ * @return CCB_RING_AGAIN while there is no ring by that name or
+ * the producer is still setting it up
+ */
+
+int ccb_ring_open(const char *name, int follow, ccb_ring_t **r) {
+
+    *r = NULL;
+
+    int fd = shm_open(name, follow ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0)
+        return errno == ENOENT ? CCB_RING_AGAIN : CCB_RING_ERROR;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return CCB_RING_ERROR;
+    }
+
+    // Not sized yet
+    if ((size_t) st.st_size < sizeof(ccb_ring_header_t)) {
+        close(fd);
+        return CCB_RING_AGAIN;
+    }
+
+    void *map = mmap(NULL, st.st_size, follow ? PROT_READ | PROT_WRITE : PROT_READ,
+                     MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return CCB_RING_ERROR;
+
+    ccb_ring_header_t *h = (ccb_ring_header_t *) map;
+    uint64_t magic = acquire(&h->magic);
+
+    int status = CCB_RING_OK;
+    if (magic == 0)
+        status = CCB_RING_AGAIN;
+    else if (magic != CCB_RING_MAGIC || h->version != CCB_RING_VERSION ||
+             h->size != (uint64_t) st.st_size || h->nslot == 0 ||
+             (h->nslot & (h->nslot - 1)) != 0)
+        status = CCB_RING_ERROR;
+
+    ccb_ring_t *ring = status == CCB_RING_OK ? (ccb_ring_t *) malloc(sizeof(ccb_ring_t)) : NULL;
+    if (ring == NULL) {
+        munmap(map, st.st_size);
+        return status == CCB_RING_OK ? CCB_RING_ERROR : status;
+    }
+
+    ring->h = h;
+    ring->size = st.st_size;
+    ring->cursor = -1;
+    ring->lost = 0;
+
+    ring->next = oldest(h);
+
+    // Take back the cursor kept from the ring this one replaced,
+    // else a free one. A free cursor has seq 0, which holds back the
+    // producer until the cursor is moved up to where we start.
+    if (follow) {
+        int32_t pid = getpid();
+
+        for (int i = 0; i < CCB_RING_READERS && ring->cursor < 0; i++) {
+            int32_t kept = -pid;
+            if (__atomic_compare_exchange_n(&h->reader[i].pid, &kept, pid, false,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                ring->cursor = i;
+                ring->next = 0;
+            }
+        }
+
+        for (int i = 0; i < CCB_RING_READERS && ring->cursor < 0; i++) {
+            int32_t none = 0;
+            if (__atomic_compare_exchange_n(&h->reader[i].pid, &none, pid, false,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                ring->cursor = i;
+                ring->next = oldest(h);
+                __atomic_store_n(&h->reader[i].seq, ring->next, __ATOMIC_SEQ_CST);
+            }
+        }
+
+        if (ring->cursor < 0) {
+            munmap(map, st.st_size);
+            free(ring);
+            return CCB_RING_ERROR;
+        }
+    }
+
+    *r = ring;
+    return CCB_RING_OK;
+}
+
+void ccb_ring_close(ccb_ring_t *r) {
+
+    if (r == NULL)
+        return;
+
+    if (r->cursor >= 0) {
+        ccb_ring_cursor_t &c = r->h->reader[r->cursor];
+        __atomic_store_n(&c.seq, (uint64_t) 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&c.pid, (int32_t) 0, __ATOMIC_RELEASE);
+    }
+
+    munmap(r->h, r->size);
+    free(r);
+}
+
+/**
+ * @brief the frame after the one last returned, in place
+ *
+ * A follower holds the frame until the next call. Anyone else
+ * should check it with ccb_ring_valid() once done with it, and
+ * frames the producer overtook are skipped.
+ *
+ * @param timeout_ms how long to wait for a new frame, 0 returns
+ * at once and -1 waits until there is one or the producer stops
+ *
+ * @return CCB_RING_OK with f filled in, CCB_RING_AGAIN if the wait
+ * timed out, CCB_RING_MOVED or CCB_RING_CLOSED once every frame
+ * published has been returned
+ */
+
+int ccb_ring_next(ccb_ring_t *r, ccb_ring_frame_t *f, int timeout_ms) {
+
+    ccb_ring_header_t *h = r->h;
+    double start = timeout_ms > 0 ? now() : 0.0;
+    int polls = 0;
+    int nap = 1;
+
+    while (true) {
+
+        if (r->next < acquire(&h->head)) {
+
+            // Hold the frame before looking at it
+            if (r->cursor >= 0)
+                __atomic_store_n(&h->reader[r->cursor].seq, r->next, __ATOMIC_SEQ_CST);
+
+            const ccb_ring_slot_t *s = slot_at(r, r->next);
+            uint64_t seq = acquire(&s->seq);
+
+            f->seq = r->next;
+            f->topology = s->topology;
+            f->natom = s->natom;
+            f->x = (const double *) (s + 1);
+
+            const ccb_ring_table_t *t = table_at(r, f->topology);
+            uint64_t tseq = acquire(&t->seq);
+            f->atoms = (const ccb_ring_atom_t *) (t + 1);
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            if (seq == 2 * f->seq + 2 && tseq == 2 * f->topology + 2 &&
+                __atomic_load_n(&s->seq, __ATOMIC_RELAXED) == seq &&
+                f->natom >= 0 && (uint32_t) f->natom <= h->maxatom) {
+                r->next++;
+                return CCB_RING_OK;
+            }
+
+            // Overtaken, move up to the oldest frame left
+            uint64_t first = oldest(h);
+            uint64_t skip = first > r->next + 1 ? first : r->next + 1;
+            r->lost += skip - r->next;
+            r->next = skip;
+            continue;
+        }
+
+        // Let the last frame go, the producer may be waiting on it
+        if (r->cursor >= 0 && polls == 0)
+            __atomic_store_n(&h->reader[r->cursor].seq, r->next, __ATOMIC_SEQ_CST);
+
+        // Every frame is out, the state is set after the last one
+        uint32_t state = __atomic_load_n(&h->state, __ATOMIC_ACQUIRE);
+        if (state != CCB_RING_LIVE && r->next >= acquire(&h->head))
+            return state == CCB_RING_REPLACED ? CCB_RING_MOVED : CCB_RING_CLOSED;
+
+        if (timeout_ms == 0)
+            return CCB_RING_AGAIN;
+
+        if (polls < RING_SPIN) {
+            polls++;
+            sched_yield();
+            continue;
+        }
+
+        // A producer that died never marks the ring done
+        if (kill(h->pid, 0) != 0 && errno == ESRCH)
+            return CCB_RING_CLOSED;
+
+        if (timeout_ms > 0 && now() - start > 1.0e-3 * timeout_ms)
+            return CCB_RING_AGAIN;
+
+        struct timespec ts = { 0, 1000L * nap };
+        nanosleep(&ts, NULL);
+        if (nap < RING_NAP) nap *= 2;
+    }
+}
+
+/**
+ * @return 1 if neither the coordinates nor the atoms of f have
+ * been overwritten since ccb_ring_next() returned it
+ */
+
+int ccb_ring_valid(const ccb_ring_t *r, const ccb_ring_frame_t *f) {
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    return __atomic_load_n(&slot_at(r, f->seq)->seq, __ATOMIC_RELAXED) == 2 * f->seq + 2 &&
+           __atomic_load_n(&table_at(r, f->topology)->seq, __ATOMIC_RELAXED) == 2 * f->topology + 2;
+}
+
+/**
+ * @brief copy the coordinates of f to x, 3 * f->natom doubles
+ *
+ * @return CCB_RING_ERROR if the frame was overwritten meanwhile
+ */
+
+int ccb_ring_copy(const ccb_ring_t *r, const ccb_ring_frame_t *f, double *x) {
+
+    memcpy(x, f->x, 3 * f->natom * sizeof(double));
+    return ccb_ring_valid(r, f) ? CCB_RING_OK : CCB_RING_ERROR;
+}
+
+uint64_t ccb_ring_head(const ccb_ring_t *r) {
+    return acquire(&r->h->head);
+}
+
+uint64_t ccb_ring_lost(const ccb_ring_t *r) {
+    return r->lost;
+}
+
+#else
+
+int ccb_ring_open(const char *, int, ccb_ring_t **r) {
+    *r = NULL;
+    return CCB_RING_ERROR;
+}
+
+void ccb_ring_close(ccb_ring_t *) {}
+
+int ccb_ring_next(ccb_ring_t *, ccb_ring_frame_t *, int) {
+    return CCB_RING_ERROR;
+}
+
+int ccb_ring_valid(const ccb_ring_t *, const ccb_ring_frame_t *) {
+    return 0;
+}
+
+int ccb_ring_copy(const ccb_ring_t *, const ccb_ring_frame_t *, double *) {
+    return CCB_RING_ERROR;
+}
+
+uint64_t ccb_ring_head(const ccb_ring_t *) {
+    return 0;
+}
+
+uint64_t ccb_ring_lost(const ccb_ring_t *) {
+    return 0;
+}
+
+#endif
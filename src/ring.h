@@ -0,0 +1,213 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   ring.h
+ * @date   Mon Oct 19 16:20:41 2026
+ *
+ * @brief  Frames in a POSIX shared-memory ring, layout and reader
+ *
+ * The shm output style (output_shm.h) publishes every structure
+ * it writes into a ring of nslot frames in a shared memory object,
+ * for programs on the same node to read in place with no copies
+ * and no system calls. This header is all a reader needs with
+ * ring.cpp, neither depends on the rest of CCB:
+ *
+ *     ccb_ring_t *r;
+ *     ccb_ring_open("/ccb", 1, &r);
+ *     ccb_ring_frame_t f;
+ *     while (ccb_ring_next(r, &f, -1) == CCB_RING_OK)
+ *         score(f.natom, f.x, f.atoms);   // 3 * natom, natom rows
+ *     ccb_ring_close(r);
+ *
+ * The object starts with a header, then two atom tables and the
+ * slots. Frame seq goes in slot seq % nslot. There is one writer,
+ * the producer, and any number of readers, none takes a lock:
+ *
+ * - a slot's seq is 2 * frame + 1 while the producer fills it and
+ *   2 * frame + 2 once it is complete, then head moves to frame + 1.
+ *   A reader checks seq before and after it reads, as a seqlock.
+ * - the atoms are written once per topology, numbered from 1, in
+ *   table topology % 2 with the same scheme. Every slot names the
+ *   topology of its frame, a reader keeps the table as long as
+ *   the topology doesn't change.
+ *
+ * A reader that opens with follow holds a cursor in the header,
+ * and the producer waits rather than overwrite a frame, or the
+ * atoms of a frame, the cursor hasn't moved past. A follower sees
+ * every frame published after it opened and may keep the last one
+ * returned until it asks for the next. Other readers never write
+ * to the object, they may be overtaken and check their frames with
+ * ccb_ring_valid() after reading them, the frames skipped are
+ * counted in ccb_ring_lost().
+ *
+ * A producer that needs more atoms than a slot holds marks the
+ * object moved and replaces it with a larger one under the same
+ * name, and marks it done when the output is deleted. Readers see
+ * the frames already published either way, then CCB_RING_MOVED,
+ * reopen to follow on, or CCB_RING_CLOSED. A follower that reopens
+ * starts from the first frame of the new ring.
+ */
+
+#ifndef CCB_RING_H
+#define CCB_RING_H
+
+#include <stdint.h>
+
+/// "CCBRING1" read as a little-endian word
+#define CCB_RING_MAGIC 0x31474e4952424343ULL
+
+/**
+ * @def CCB_RING_VERSION
+ *
+ * @brief Version of the layout below, readers refuse any other
+ */
+
+#define CCB_RING_VERSION 1
+
+/// Followers one object can have
+#define CCB_RING_READERS 16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Return codes of the reader, 0 and 1 match CCB_OK and CCB_ERROR
+enum {
+  CCB_RING_OK = 0,
+  CCB_RING_ERROR = 1,   /**< not a ring, the wrong version or no room for a follower */
+  CCB_RING_AGAIN = 2,   /**< nothing yet, or no object by that name yet */
+  CCB_RING_MOVED = 3,   /**< replaced by a larger object, reopen by name */
+  CCB_RING_CLOSED = 4   /**< the producer is done or gone */
+};
+
+/// ccb_ring_header_t.state
+enum {
+  CCB_RING_LIVE = 1,
+  CCB_RING_DONE = 2,
+  CCB_RING_REPLACED = 3
+};
+
+/**
+ * One row of an atom table, laid out as ccb_atom_t of library.h
+ */
+typedef struct ccb_ring_atom {
+  int32_t serial;               /**< serial number, counting from 1 */
+  int32_t resid;                /**< residue number */
+  char name[10];                /**< atom name */
+  char resname[15];             /**< residue name */
+  char chain[10];               /**< chain */
+  char seg[10];                 /**< segment */
+  char element[3];              /**< element symbol */
+} ccb_ring_atom_t;
+
+/**
+ * A follower's position, the oldest frame it may still be reading.
+ * A ring that replaces another keeps a cursor, at frame 0, for each
+ * follower of the old one under minus its pid, for it to take back
+ * when it reopens.
+ */
+typedef struct ccb_ring_cursor {
+  uint64_t seq;                 /**< frame held */
+  int32_t pid;                  /**< the reader's process, 0 for a free cursor */
+  uint32_t pad;
+  char pad1[48];
+} ccb_ring_cursor_t;
+
+/**
+ * Start of the object. Everything before head is written once,
+ * before magic, and offsets are from the start of the object.
+ */
+typedef struct ccb_ring_header {
+  uint64_t magic;               /**< CCB_RING_MAGIC once the object is ready */
+  uint32_t version;             /**< CCB_RING_VERSION */
+  uint32_t nslot;               /**< frames held, a power of two */
+  uint32_t maxatom;             /**< atoms a slot or a table holds */
+  int32_t pid;                  /**< the producer's process */
+  uint64_t size;                /**< bytes in the object */
+  uint64_t table_offset;        /**< the two atom tables */
+  uint64_t table_bytes;
+  uint64_t slot_offset;         /**< slot 0 */
+  uint64_t slot_bytes;
+
+  uint64_t head;                /**< frames published, the newest is head - 1 */
+  uint32_t state;               /**< CCB_RING_LIVE, DONE or REPLACED */
+  uint32_t pad;
+  char pad1[48];
+
+  ccb_ring_cursor_t reader[CCB_RING_READERS];
+} ccb_ring_header_t;
+
+/**
+ * Start of an atom table, natom ccb_ring_atom_t follow
+ */
+typedef struct ccb_ring_table {
+  uint64_t seq;                 /**< 2 * topology + 2 when complete */
+  uint64_t topology;
+  int32_t natom;
+  uint32_t pad;
+  char pad1[40];
+} ccb_ring_table_t;
+
+/**
+ * Start of a slot, 3 * natom doubles x y z follow
+ */
+typedef struct ccb_ring_slot {
+  uint64_t seq;                 /**< 2 * frame + 2 when complete */
+  uint64_t topology;            /**< atoms of the frame */
+  int32_t natom;
+  uint32_t pad;
+  char pad1[40];
+} ccb_ring_slot_t;
+
+/**
+ * A frame returned to a reader, the pointers are into the object
+ */
+typedef struct ccb_ring_frame {
+  uint64_t seq;                 /**< frame number, counting from 0 */
+  uint64_t topology;            /**< changes whenever the atoms do */
+  int natom;
+  const double *x;              /**< x y z of every atom, contiguous */
+  const ccb_ring_atom_t *atoms; /**< natom rows */
+} ccb_ring_frame_t;
+
+typedef struct ccb_ring ccb_ring_t;
+
+int ccb_ring_open(const char *name, int follow, ccb_ring_t **r); /**< map the ring name */
+void ccb_ring_close(ccb_ring_t *r);  /**< unmap it and free the cursor */
+
+int ccb_ring_next(ccb_ring_t *r, ccb_ring_frame_t *f, int timeout_ms); /**< the frame after the last one, -1 waits for ever */
+int ccb_ring_valid(const ccb_ring_t *r, const ccb_ring_frame_t *f); /**< 1 while f hasn't been overwritten */
+int ccb_ring_copy(const ccb_ring_t *r, const ccb_ring_frame_t *f, double *x); /**< x y z out of the ring, checked */
+
+uint64_t ccb_ring_head(const ccb_ring_t *r); /**< frames published */
+uint64_t ccb_ring_lost(const ccb_ring_t *r); /**< frames overtaken before they were read */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
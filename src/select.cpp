@@ -0,0 +1,865 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   select.cpp
+ * @date   Mon Oct 19 23:05:12 2026
+ *
+ * @brief  Atom selection language
+ *
+ */
+
+#include "ctype.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "select.h"
+#include "memory.h"
+#include "error.h"
+#include "domain.h"
+#include "site.h"
+#include "group.h"
+#include "atom.h"
+#include "bitmask.h"
+
+/**
+ * @def BIN_PER_ATOM
+ *
+ * Most bins per atom of a within grid before the bins are grown
+ */
+
+#define BIN_PER_ATOM 8
+
+/**
+ * @def MAX_TOKEN
+ *
+ * Longest word of a selection
+ */
+
+#define MAX_TOKEN 256
+
+using namespace CCB_NS;
+
+// Instructions
+enum {
+    OP_TRUE, OP_FALSE, OP_STR, OP_RANGE, OP_CMP, OP_GROUP, OP_WITHIN,
+    OP_AND, OP_OR, OP_NOT
+};
+
+// Atom fields, strings first
+enum {
+    F_NAME, F_TYPE, F_ELEMENT, F_RESNAME, F_CHAIN, F_SEG, NSTRFIELD,
+    F_RESID = NSTRFIELD, F_SERIAL, F_INDEX, F_X, F_Y, F_Z, F_OCC, F_BETA,
+    NFIELD
+};
+
+// Comparisons of OP_CMP, kept in the n of the instruction
+enum { CMP_LT, CMP_LE, CMP_GT, CMP_GE, CMP_EQ, CMP_NE };
+
+static const char *fieldname[] = {
+    "name", "type", "element", "resname", "chain", "seg",
+    "resid", "serial", "index", "x", "y", "z", "occupancy", "beta"
+};
+
+static const char *cmpname[] = { "<", "<=", ">", ">=", "==", "!=" };
+
+/**
+ * field of a keyword, -1 if it isn't one
+ */
+
+static int find_field(const char *s) {
+
+    if (strcmp(s, "segname") == 0) return F_SEG;
+    for (int i = 0; i < NFIELD; i++)
+        if (strcmp(s, fieldname[i]) == 0) return i;
+
+    return -1;
+}
+
+/**
+ * shell style match of s against p, * matches any run and ? one character
+ */
+
+static bool glob(const char *p, const char *s) {
+
+    for (; *p; p++, s++) {
+        if (*p == '*') {
+            while (p[1] == '*') p++;
+            if (p[1] == '\0') return true;
+            for (; *s; s++)
+                if (glob(p + 1, s)) return true;
+            return false;
+        }
+        if (*s == '\0' || (*p != '?' && *p != *s)) return false;
+    }
+
+    return *s == '\0';
+}
+
+/**
+ * @brief compile a selection
+ *
+ * @param text the selection, NULL for an empty program that
+ * is filled by the parser of another selection (within)
+ */
+
+Select::Select(CCB *ccb, const char *text) :
+        Pointers(ccb),
+        text(NULL),
+        status(CCB_OK),
+        geometric(false),
+        nselect(0),
+        op(NULL), nop(0), maxop(0),
+        depth(0), maxdepth(0),
+        wordwise(true),
+        str(NULL), nstr(0), maxstr(0),
+        num(NULL), nnum(0), maxnum(0),
+        gmask(NULL), gtick(NULL),
+        lastmask(-1), applied(0),
+        grid(NULL), ngrid(0),
+        stack(NULL), wstack(NULL)
+{
+
+    if (text == NULL)
+        return;
+
+    int n = strlen(text) + 1;
+    this->text = new char[n];
+    strcpy(this->text, text);
+
+    Parser p;
+    status = tokenize(p, text);
+
+    if (status == CCB_OK) {
+        if (p.ntok == 0)
+            status = emit(OP_TRUE);
+        else if ((status = parse_or(p)) == CCB_OK && p.pos < p.ntok)
+            status = error_at(p, "unexpected");
+    }
+
+    for (int i = 0; i < p.ntok; i++)
+        delete [] p.tok[i];
+    delete [] p.tok;
+    delete [] p.quoted;
+}
+
+Select::~Select() {
+
+    for (int i = 0; i < nstr; i++)
+        delete [] str[i];
+
+    for (int k = 0; k < ngrid; k++) {
+        delete grid[k].sel;
+        memory->destroy(grid[k].x);
+        memory->destroy(grid[k].next);
+        memory->destroy(grid[k].binhead);
+    }
+
+    delete [] text;
+    memory->sfree(op);
+    memory->sfree(str);
+    memory->sfree(grid);
+    memory->destroy(num);
+    memory->destroy(gmask);
+    memory->destroy(gtick);
+    memory->destroy(stack);
+    memory->destroy(wstack);
+}
+
+/* ----------------------------------------------------------------------
+   Parsing
+   ---------------------------------------------------------------------- */
+
+/**
+ * @brief split the text into words
+ *
+ * Parentheses and comparisons are words of their own, quotes
+ * group a word and keep it from being read as a keyword.
+ */
+
+int Select::tokenize(Parser &p, const char *s) {
+
+    int len = strlen(s);
+
+    // no more words than characters
+    p.tok = new char*[len + 1];
+    p.quoted = new bool[len + 1];
+    p.ntok = p.pos = 0;
+
+    char word[MAX_TOKEN];
+
+    while (*s) {
+
+        if (isspace(*s)) {
+            s++;
+            continue;
+        }
+
+        int n = 0;
+        bool quoted = false;
+
+        if (*s == '(' || *s == ')') {
+            word[n++] = *s++;
+
+        } else if (strchr("<>=!", *s)) {
+            word[n++] = *s++;
+            if (*s == '=') word[n++] = *s++;
+
+        } else if (*s == '"' || *s == '\'') {
+            char q = *s++;
+            while (*s && *s != q && n < MAX_TOKEN - 1) word[n++] = *s++;
+            if (*s != q)
+                return error->one(FLERR, "select: unterminated or too long quoted string");
+            s++;
+            quoted = true;
+
+        } else {
+            while (*s && !isspace(*s) && !strchr("()<>=!\"'", *s) && n < MAX_TOKEN - 1)
+                word[n++] = *s++;
+        }
+
+        word[n] = '\0';
+        p.tok[p.ntok] = new char[n + 1];
+        strcpy(p.tok[p.ntok], word);
+        p.quoted[p.ntok] = quoted;
+        p.ntok++;
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * true if the current word is the unquoted keyword k
+ */
+
+static bool is_word(const char *k, char **tok, bool *quoted, int ntok, int pos) {
+    return pos < ntok && !quoted[pos] && strcmp(tok[pos], k) == 0;
+}
+
+#define IS(k) is_word(k, p.tok, p.quoted, p.ntok, p.pos)
+
+int Select::parse_or(Parser &p) {
+
+    if (parse_and(p) != CCB_OK) return CCB_ERROR;
+
+    while (IS("or")) {
+        p.pos++;
+        if (parse_and(p) != CCB_OK) return CCB_ERROR;
+        if (emit(OP_OR) != CCB_OK) return CCB_ERROR;
+    }
+
+    return CCB_OK;
+}
+
+int Select::parse_and(Parser &p) {
+
+    if (parse_not(p) != CCB_OK) return CCB_ERROR;
+
+    while (IS("and")) {
+        p.pos++;
+        if (parse_not(p) != CCB_OK) return CCB_ERROR;
+        if (emit(OP_AND) != CCB_OK) return CCB_ERROR;
+    }
+
+    return CCB_OK;
+}
+
+int Select::parse_not(Parser &p) {
+
+    if (IS("not")) {
+        p.pos++;
+        if (parse_not(p) != CCB_OK) return CCB_ERROR;
+        return emit(OP_NOT);
+    }
+
+    return parse_primary(p);
+}
+
+int Select::parse_primary(Parser &p) {
+
+    if (p.pos == p.ntok)
+        return error_at(p, "selection ends early");
+
+    if (IS("(")) {
+        p.pos++;
+        if (parse_or(p) != CCB_OK) return CCB_ERROR;
+        if (!IS(")")) return error_at(p, "missing ) at");
+        p.pos++;
+        return CCB_OK;
+    }
+
+    if (IS("all") || IS("none")) {
+        bool all = IS("all");
+        p.pos++;
+        return emit(all ? OP_TRUE : OP_FALSE);
+    }
+
+    if (IS("backbone")) {
+        p.pos++;
+        int first = nstr;
+        const char *bb[] = { "N", "CA", "C", "O" };
+        for (int i = 0; i < 4; i++)
+            if (add_str(bb[i]) != CCB_OK) return CCB_ERROR;
+        wordwise = false;
+        return emit(OP_STR, F_NAME, first, 4);
+    }
+
+    // within R of ..., the rest of the enclosing parentheses
+    if (IS("within")) {
+        p.pos++;
+
+        char *end = NULL;
+        double cutoff = p.pos < p.ntok ? strtod(p.tok[p.pos], &end) : 0.0;
+        if (end == NULL || *end != '\0' || cutoff <= 0.0)
+            return error_at(p, "within needs a positive distance, not");
+        p.pos++;
+
+        if (!IS("of")) return error_at(p, "within R needs of, not");
+        p.pos++;
+
+        Grid *g = (Grid *) memory->srealloc(grid, (ngrid + 1) * sizeof(Grid), "select:grid");
+        if (g == NULL) return CCB_ERROR;
+        grid = g;
+
+        Grid &w = grid[ngrid++];
+        memset(&w, 0, sizeof(Grid));
+        w.cutoff = cutoff;
+        w.sel = new Select(ccb, NULL);
+        if (w.sel->parse_or(p) != CCB_OK) return CCB_ERROR;
+
+        geometric = true;
+        wordwise = false;
+        return emit(OP_WITHIN, 0, ngrid - 1);
+    }
+
+    // groups, by keyword or by a bare name
+    if (IS("group") || (!p.quoted[p.pos] && find_field(p.tok[p.pos]) < 0 &&
+                        bitmask->find(p.tok[p.pos]) >= 0)) {
+        int first = nstr;
+        if (IS("group")) {
+            p.pos++;
+            while (p.pos < p.ntok && !IS("and") && !IS("or") && !IS(")") && !IS("("))
+                if (add_str(p.tok[p.pos++]) != CCB_OK) return CCB_ERROR;
+            if (nstr == first) return error_at(p, "group needs a name, not");
+        } else {
+            if (add_str(p.tok[p.pos++]) != CCB_OK) return CCB_ERROR;
+        }
+        return emit(OP_GROUP, 0, first, nstr - first);
+    }
+
+    int field = p.quoted[p.pos] ? -1 : find_field(p.tok[p.pos]);
+    if (field < 0)
+        return error_at(p, "unknown keyword or group");
+
+    p.pos++;
+    wordwise = false;
+    return parse_values(p, field);
+}
+
+/**
+ * @brief values of a field up to the next and, or or parenthesis
+ */
+
+int Select::parse_values(Parser &p, int field) {
+
+    bool stop;
+#define STOP (p.pos == p.ntok || IS("and") || IS("or") || IS(")") || IS("("))
+
+    // Strings, any of the values
+    if (field < NSTRFIELD) {
+        int first = nstr;
+        while (!(stop = STOP))
+            if (add_str(p.tok[p.pos++]) != CCB_OK) return CCB_ERROR;
+        if (nstr == first) return error_at(p, "missing values at");
+        return emit(OP_STR, field, first, nstr - first);
+    }
+
+    char *end;
+
+    // A comparison with a single number
+    for (int c = 0; c < 6; c++)
+        if (IS(cmpname[c])) {
+            p.pos++;
+            double v = p.pos < p.ntok ? strtod(p.tok[p.pos], &end) : 0.0;
+            if (p.pos == p.ntok || *end != '\0')
+                return error_at(p, "comparison needs a number, not");
+            p.pos++;
+            int first = nnum;
+            if (add_num(v) != CCB_OK) return CCB_ERROR;
+            return emit(OP_CMP, field, first, c);
+        }
+
+    // Numbers and ranges, any of them
+    int first = nnum;
+    while (!(stop = STOP)) {
+        double lo = strtod(p.tok[p.pos], &end);
+        if (*end != '\0') return error_at(p, "expected a number, not");
+        p.pos++;
+
+        double hi = lo;
+        if (IS("to")) {
+            p.pos++;
+            hi = p.pos < p.ntok ? strtod(p.tok[p.pos], &end) : 0.0;
+            if (p.pos == p.ntok || *end != '\0')
+                return error_at(p, "range needs a number after to, not");
+            p.pos++;
+        }
+
+        if (add_num(lo) != CCB_OK || add_num(hi) != CCB_OK) return CCB_ERROR;
+    }
+#undef STOP
+
+    if (nnum == first) return error_at(p, "missing values at");
+    return emit(OP_RANGE, field, first, (nnum - first) / 2);
+}
+
+#undef IS
+
+/**
+ * append an instruction and track the depth of the stack it needs
+ */
+
+int Select::emit(int code, int field, int arg, int n) {
+
+    if (nop == maxop) {
+        maxop += 16;
+        op = (Op *) memory->srealloc(op, maxop * sizeof(Op), "select:op");
+        if (op == NULL) return CCB_ERROR;
+    }
+
+    Op &o = op[nop++];
+    o.code = code;
+    o.field = field;
+    o.arg = arg;
+    o.n = n;
+
+    if (code == OP_AND || code == OP_OR) depth--;
+    else if (code != OP_NOT) depth++;
+    if (depth > maxdepth) maxdepth = depth;
+
+    return CCB_OK;
+}
+
+int Select::add_str(const char *s) {
+
+    if (nstr == maxstr) {
+        maxstr += 16;
+        str = (char **) memory->srealloc(str, maxstr * sizeof(char *), "select:str");
+        if (str == NULL) return CCB_ERROR;
+    }
+
+    str[nstr] = new char[strlen(s) + 1];
+    strcpy(str[nstr++], s);
+
+    return CCB_OK;
+}
+
+int Select::add_num(double v) {
+
+    if (nnum == maxnum) {
+        maxnum += 16;
+        memory->grow(num, maxnum, "select:num");
+        if (num == NULL) return CCB_ERROR;
+    }
+
+    num[nnum++] = v;
+
+    return CCB_OK;
+}
+
+int Select::error_at(Parser &p, const char *msg) {
+
+    char str[MAX_TOKEN + 128];
+    sprintf(str, "select: %s %s%s%s", msg,
+            p.pos < p.ntok ? "\"" : "",
+            p.pos < p.ntok ? p.tok[p.pos] : "the end",
+            p.pos < p.ntok ? "\"" : "");
+
+    return error->one(FLERR, str);
+}
+
+/* ----------------------------------------------------------------------
+   Evaluation
+   ---------------------------------------------------------------------- */
+
+/**
+ * @brief set the group mask to the atoms the selection matches
+ *
+ * The previous members of the group are dropped, the group may
+ * be read by the selection itself.
+ */
+
+int Select::apply(int mask) {
+
+    if (status != CCB_OK)
+        return error->one(FLERR, "select: the selection didn't compile");
+
+    if (prepare() != CCB_OK)
+        return CCB_ERROR;
+
+    int nword = bitmask->words();
+
+    if (wordwise) {
+
+        // Result words go to the stack, the target may be an operand
+        uint64_t *r = NULL;
+        memory->create_aligned(r, nword, "select:row");
+        if (r == NULL) return CCB_ERROR;
+
+        const uint64_t *all = bitmask->peek(0);
+
+        for (int w = 0; w < nword; w++) {
+            int top = 0;
+            for (int i = 0; i < nop; i++) {
+                const Op &o = op[i];
+                switch (o.code) {
+                case OP_TRUE: wstack[top++] = all[w]; break;
+                case OP_FALSE: wstack[top++] = 0; break;
+                case OP_GROUP: {
+                    uint64_t v = 0;
+                    for (int k = 0; k < o.n; k++)
+                        if (gmask[o.arg + k] >= 0)
+                            v |= bitmask->peek(gmask[o.arg + k])[w];
+                    wstack[top++] = v;
+                    break;
+                }
+                case OP_AND: top--; wstack[top - 1] &= wstack[top]; break;
+                case OP_OR: top--; wstack[top - 1] |= wstack[top]; break;
+                case OP_NOT: wstack[top - 1] = all[w] & ~wstack[top - 1]; break;
+                }
+            }
+            r[w] = wstack[0];
+        }
+
+        memcpy(bitmask->row(mask), r, nword * sizeof(uint64_t));
+        memory->destroy(r);
+
+    } else {
+
+        uint64_t *r = bitmask->row(mask);
+
+        // Another group the selection reads may be the target,
+        // so the result is built before the row is cleared
+        uint64_t *t = NULL;
+        memory->create_aligned(t, nword, "select:row");
+        if (t == NULL) return CCB_ERROR;
+        memset(t, 0, nword * sizeof(uint64_t));
+
+        bigint index = 0;
+        for (int i = 0; i < domain->nsite; i++) {
+            Site *s = domain->site[i];
+            for (int j = -1; j < s->nrotamer; j++) {
+                Group *g = j < 0 ? s->fixed_atoms : s->rotamer[j];
+                for (int k = 0; k < g->natom; k++, index++) {
+                    int col = g->atom[k]->index;
+                    if (match(g->atom[k], index))
+                        t[col >> 6] |= (uint64_t) 1 << (col & 63);
+                }
+            }
+        }
+
+        memcpy(r, t, nword * sizeof(uint64_t));
+        memory->destroy(t);
+    }
+
+    nselect = bitmask->count(mask);
+    lastmask = mask;
+    applied = bitmask->changed(mask);
+
+    return CCB_OK;
+}
+
+/**
+ * @brief true if applying again into mask would change nothing
+ *
+ * Coordinates aren't tracked, so selections with a within clause
+ * are never current. Atom names and the like are taken to change
+ * only with the atoms themselves.
+ */
+
+bool Select::current(int mask) {
+
+    if (geometric || status != CCB_OK || mask != lastmask ||
+        bitmask->changed(mask) != applied)
+        return false;
+
+    for (int i = 0; i < nop; i++) {
+        if (op[i].code != OP_GROUP) continue;
+        for (int k = op[i].arg; k < op[i].arg + op[i].n; k++) {
+            int g = bitmask->find(str[k]);
+            if (g != gmask[k] || g == mask || (g >= 0 && bitmask->changed(g) > gtick[k]))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief resolve group names, size the stacks and fill the grids
+ */
+
+int Select::prepare() {
+
+    if (stack == NULL && maxdepth > 0) {
+        memory->create(stack, maxdepth, "select:stack");
+        memory->create(wstack, maxdepth, "select:stack");
+        if (stack == NULL || wstack == NULL) return CCB_ERROR;
+    }
+
+    if (gmask == NULL && nstr > 0) {
+        memory->create(gmask, nstr, "select:gmask");
+        memory->create(gtick, nstr, "select:gmask");
+        if (gmask == NULL || gtick == NULL) return CCB_ERROR;
+    }
+
+    for (int i = 0; i < nop; i++) {
+        if (op[i].code != OP_GROUP) continue;
+        for (int k = op[i].arg; k < op[i].arg + op[i].n; k++) {
+            gmask[k] = bitmask->find(str[k]);
+            gtick[k] = gmask[k] >= 0 ? bitmask->changed(gmask[k]) : 0;
+        }
+    }
+
+    for (int k = 0; k < ngrid; k++)
+        if (grid[k].sel->prepare() != CCB_OK || fill_grid(grid[k]) != CCB_OK)
+            return CCB_ERROR;
+
+    return CCB_OK;
+}
+
+/**
+ * @brief run the program on one atom
+ *
+ * @param index position of the atom in the domain
+ */
+
+bool Select::match(Atom *a, bigint index) {
+
+    int top = 0;
+
+    for (int i = 0; i < nop; i++) {
+        const Op &o = op[i];
+        bool r = false;
+
+        switch (o.code) {
+        case OP_TRUE: r = true; break;
+        case OP_FALSE: r = false; break;
+
+        case OP_STR: {
+            const char *v = "";
+            switch (o.field) {
+            case F_NAME: v = a->name; break;
+            case F_TYPE: v = a->type; break;
+            case F_ELEMENT: v = a->element; break;
+            case F_RESNAME: if (a->group) v = a->group->type; break;
+            case F_CHAIN: if (a->site) v = a->site->chain; break;
+            case F_SEG: if (a->site) v = a->site->seg; break;
+            }
+            for (int k = o.arg; k < o.arg + o.n && !r; k++)
+                r = glob(str[k], v);
+            break;
+        }
+
+        case OP_RANGE:
+        case OP_CMP: {
+            double v = 0.0;
+            switch (o.field) {
+            case F_RESID: if (a->site) v = a->site->resid; break;
+            case F_SERIAL: v = a->serial; break;
+            case F_INDEX: v = index; break;
+            case F_X: v = a->x; break;
+            case F_Y: v = a->y; break;
+            case F_Z: v = a->z; break;
+            case F_OCC: v = a->o; break;
+            case F_BETA: v = a->b; break;
+            }
+            if (o.code == OP_RANGE) {
+                for (int k = o.arg; k < o.arg + 2 * o.n && !r; k += 2)
+                    r = v >= num[k] && v <= num[k + 1];
+            } else {
+                double c = num[o.arg];
+                switch (o.n) {
+                case CMP_LT: r = v < c; break;
+                case CMP_LE: r = v <= c; break;
+                case CMP_GT: r = v > c; break;
+                case CMP_GE: r = v >= c; break;
+                case CMP_EQ: r = v == c; break;
+                case CMP_NE: r = v != c; break;
+                }
+            }
+            break;
+        }
+
+        case OP_GROUP:
+            for (int k = o.arg; k < o.arg + o.n && !r; k++)
+                r = gmask[k] >= 0 && bitmask->test(gmask[k], a->index);
+            break;
+
+        case OP_WITHIN: r = near(grid[o.arg], a); break;
+
+        case OP_AND: top--; stack[top - 1] = stack[top - 1] && stack[top]; continue;
+        case OP_OR: top--; stack[top - 1] = stack[top - 1] || stack[top]; continue;
+        case OP_NOT: stack[top - 1] = !stack[top - 1]; continue;
+        }
+
+        stack[top++] = r;
+    }
+
+    return stack[0];
+}
+
+/**
+ * @brief bin the atoms of a within clause
+ */
+
+int Select::fill_grid(Grid &g) {
+
+    // Gather the coordinates
+    g.natom = 0;
+    bigint index = 0;
+    for (int i = 0; i < domain->nsite; i++) {
+        Site *s = domain->site[i];
+        for (int j = -1; j < s->nrotamer; j++) {
+            Group *gr = j < 0 ? s->fixed_atoms : s->rotamer[j];
+            for (int k = 0; k < gr->natom; k++, index++) {
+                Atom *a = gr->atom[k];
+                if (!g.sel->match(a, index)) continue;
+                if (g.natom == g.maxatom) {
+                    g.maxatom += 1024;
+                    memory->grow(g.x, g.maxatom, 3, "select:x");
+                    memory->grow(g.next, g.maxatom, "select:next");
+                    if (g.x == NULL || g.next == NULL) return CCB_ERROR;
+                }
+                g.x[g.natom][0] = a->x;
+                g.x[g.natom][1] = a->y;
+                g.x[g.natom][2] = a->z;
+                g.natom++;
+            }
+        }
+    }
+
+    if (g.natom == 0)
+        return CCB_OK;
+
+    // Size the grid to the bounding box, bins no smaller than the cutoff
+    double hi[3];
+    for (int d = 0; d < 3; d++)
+        g.lo[d] = hi[d] = g.x[0][d];
+
+    for (int i = 1; i < g.natom; i++)
+        for (int d = 0; d < 3; d++) {
+            if (g.x[i][d] < g.lo[d]) g.lo[d] = g.x[i][d];
+            if (g.x[i][d] > hi[d]) hi[d] = g.x[i][d];
+        }
+
+    double binsize = g.cutoff;
+    bigint ntotal;
+    while (true) {
+        ntotal = 1;
+        for (int d = 0; d < 3; d++) {
+            g.nbin[d] = static_cast<int> ((hi[d] - g.lo[d]) / binsize) + 1;
+            ntotal *= g.nbin[d];
+        }
+        if (ntotal <= (bigint) BIN_PER_ATOM * g.natom + 27) break;
+        binsize *= 2.0;
+    }
+    g.inv = 1.0 / binsize;
+
+    if (ntotal > g.maxbin) {
+        g.maxbin = ntotal;
+        memory->grow(g.binhead, g.maxbin, "select:binhead");
+        if (g.binhead == NULL) return CCB_ERROR;
+    }
+
+    for (int b = 0; b < ntotal; b++)
+        g.binhead[b] = -1;
+
+    for (int i = g.natom - 1; i >= 0; i--) {
+        int ix = static_cast<int> ((g.x[i][0] - g.lo[0]) * g.inv);
+        int iy = static_cast<int> ((g.x[i][1] - g.lo[1]) * g.inv);
+        int iz = static_cast<int> ((g.x[i][2] - g.lo[2]) * g.inv);
+        int b = (iz * g.nbin[1] + iy) * g.nbin[0] + ix;
+        g.next[i] = g.binhead[b];
+        g.binhead[b] = i;
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * @brief true if an atom of the grid is within the cutoff of a
+ */
+
+bool Select::near(Grid &g, Atom *a) {
+
+    if (g.natom == 0)
+        return false;
+
+    double p[3] = { a->x, a->y, a->z };
+    int lo[3], hi[3];
+
+    // Bins are at least the cutoff wide, so only the neighbors count
+    for (int d = 0; d < 3; d++) {
+        double f = (p[d] - g.lo[d]) * g.inv;
+        if (f < -1.0 || f >= g.nbin[d] + 1.0) return false;
+        int c = static_cast<int> (f + 1.0) - 1;
+        lo[d] = c > 0 ? c - 1 : 0;
+        hi[d] = c + 1 < g.nbin[d] - 1 ? c + 1 : g.nbin[d] - 1;
+    }
+
+    double cutsq = g.cutoff * g.cutoff;
+
+    for (int iz = lo[2]; iz <= hi[2]; iz++)
+        for (int iy = lo[1]; iy <= hi[1]; iy++)
+            for (int ix = lo[0]; ix <= hi[0]; ix++)
+                for (int i = g.binhead[(iz * g.nbin[1] + iy) * g.nbin[0] + ix]; i >= 0; i = g.next[i]) {
+                    double dx = g.x[i][0] - p[0];
+                    double dy = g.x[i][1] - p[1];
+                    double dz = g.x[i][2] - p[2];
+                    if (dx * dx + dy * dy + dz * dz <= cutsq) return true;
+                }
+
+    return false;
+}
+
+double Select::memory_usage() {
+
+    double bytes = sizeof(Select);
+
+    bytes += maxop * sizeof(Op);
+    bytes += maxstr * sizeof(char *) + maxnum * sizeof(double);
+    bytes += nstr * (sizeof(int) + sizeof(bigint));
+    bytes += maxdepth * (sizeof(char) + sizeof(uint64_t));
+
+    for (int k = 0; k < ngrid; k++) {
+        bytes += sizeof(Grid) + grid[k].sel->memory_usage();
+        bytes += grid[k].maxatom * (3 * sizeof(double) + sizeof(double *) + sizeof(int));
+        bytes += grid[k].maxbin * sizeof(int);
+    }
+
+    return bytes;
+}
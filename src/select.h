@@ -0,0 +1,154 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   select.h
+ * @date   Mon Oct 19 23:05:12 2026
+ *
+ * @brief  Atom selection language
+ *
+ * Compiles VMD style selection text into a postfix program that
+ * is run once per atom in a single pass over the domain, setting
+ * the atoms it matches in a Bitmask row. A selection is built from
+ *
+ *   name type element resname chain seg segname   strings, * and ? glob
+ *   resid serial index x y z occupancy beta        numbers and "lo to hi"
+ *                                                  ranges, or < <= > >= == !=
+ *                                                  and a number
+ *   group g1 g2 ...   atoms in the bitmask groups, a bare group name also works
+ *   all none backbone
+ *   within R of ...   atoms within R of the rest of the enclosing parentheses
+ *   and or not ( )
+ *
+ * e.g. "name N C CA and chain A and resid >= 5" or
+ * "backbone and within 6.0 of (chain B and name CA)". index counts
+ * atoms from 0 in domain order, like VMD.
+ *
+ * Programs made only of groups, all, none and logic run a word at a
+ * time over the rows of the groups instead of atom by atom. Each
+ * within clause is evaluated before the pass and its atoms put on a
+ * grid, so the pass only looks at neighboring bins.
+ *
+ * Compiled selections are kept by Bitmask::select(), which skips the
+ * pass altogether while the groups and atoms it read are unchanged.
+ */
+
+#ifndef CCB_SELECT_H
+#define CCB_SELECT_H
+
+#include "stdint.h"
+#include "pointers.h"
+
+namespace CCB_NS {
+class Select: protected Pointers {
+
+  public:
+
+    // Constructor and Destructor
+    Select(class CCB *, const char *text); /**< compile text, check status */
+    ~Select();
+
+    char *text; /**< the selection text */
+    int status; /**< CCB_OK if the text compiled */
+    bool geometric; /**< reads coordinates, the result is never reused */
+
+    int apply(int mask); /**< set group mask to the selected atoms */
+    bool current(int mask); /**< the last apply into mask still holds */
+    bigint nselect; /**< atoms selected by the last apply */
+
+    double memory_usage();
+
+  private:
+
+    /// One instruction, leaves push a truth value, logic pops
+    struct Op {
+        int code; /**< what to do */
+        int field; /**< atom field read by a leaf */
+        int arg; /**< first value in str/num, or the grid */
+        int n; /**< number of values */
+    };
+
+    Op *op;
+    int nop, maxop;
+    int depth, maxdepth; /**< stack depth while compiling, most needed */
+    bool wordwise; /**< only groups and logic, run on whole words */
+
+    char **str; /**< string values and group names */
+    int nstr, maxstr;
+    double *num; /**< numbers, a range takes two */
+    int nnum, maxnum;
+
+    int *gmask; /**< group of each str entry, resolved by prepare() */
+    bigint *gtick; /**< change tick of the group when it was read */
+    int lastmask; /**< group written by the last apply */
+    bigint applied; /**< change tick of lastmask after the last apply */
+
+    /// Atoms of a within clause, binned with bins no smaller than the cutoff
+    struct Grid {
+        Select *sel; /**< the atoms to be near */
+        double cutoff;
+        int natom, maxatom;
+        double **x;
+        int *next; /**< next atom in the same bin, -1 terminates */
+        int nbin[3], maxbin;
+        int *binhead; /**< first atom in each bin, -1 if empty */
+        double lo[3], inv;
+    };
+
+    Grid *grid;
+    int ngrid;
+
+    char *stack; /**< truth values while running a program */
+    uint64_t *wstack; /**< words while running a program wordwise */
+
+    // Parsing
+    struct Parser {
+        char **tok;
+        bool *quoted;
+        int ntok, pos;
+    };
+
+    int tokenize(Parser &p, const char *s);
+    int parse_or(Parser &p);
+    int parse_and(Parser &p);
+    int parse_not(Parser &p);
+    int parse_primary(Parser &p);
+    int parse_values(Parser &p, int field);
+
+    int emit(int code, int field = 0, int arg = 0, int n = 0);
+    int add_str(const char *s);
+    int add_num(double v);
+    int error_at(Parser &p, const char *msg);
+
+    // Evaluation
+    int prepare(); /**< resolve groups and fill the grids */
+    bool match(class Atom *a, bigint index);
+    bool near(Grid &g, class Atom *a);
+    int fill_grid(Grid &g);
+};
+}
+
+#endif
@@ -0,0 +1,637 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   server.cpp
+ * @date   Tue Oct 20 14:02:51 2026
+ *
+ * @brief  Service mode of the ccb executable
+ *
+ * The main thread polls stdin or the socket and its connections,
+ * splits what arrives into lines and queues them. Workers take the
+ * requests off the queue, build into their own CCB instance, format
+ * the payload in memory and write the response under the lock of
+ * the connection. A connection is closed by the main thread once
+ * the client is done and its last response is out.
+ */
+
+#include "errno.h"
+#include "signal.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "server.h"
+#include "ccb.h"
+#include "batch.h"
+#include "bitmask.h"
+#include "error.h"
+#include "timer.h"
+#include "trace.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+/**
+ * @def SERVER_READ
+ *
+ * Bytes read from a connection at a time
+ */
+
+#define SERVER_READ 65536
+
+/**
+ * @def SERVER_QUEUE
+ *
+ * Requests queued per worker before the connections stop being read
+ */
+
+#define SERVER_QUEUE 64
+
+using namespace CCB_NS;
+
+/**
+ * @brief set by SIGINT and SIGTERM, the requests already read are
+ * still answered
+ */
+
+static volatile sig_atomic_t stop_signal = 0;
+
+static void handle_stop(int) {
+    stop_signal = 1;
+}
+
+Server::Server(CCB *ccb, Batch *batch, int narg, const char **arg) :
+        Pointers(ccb),
+        nrequest(0),
+        nerror(0),
+        narg(narg),
+        arg(arg),
+        path(batch->serve),
+        nworker(batch->nworker),
+        conn(NULL), nconn(0), maxconn(0),
+        worker(NULL),
+        queue(NULL),
+        listenfd(-1),
+        quit(false)
+{
+}
+
+#ifdef _WIN32
+
+Server::~Server() {}
+
+int Server::run() {
+    return error->one(FLERR, "server: -serve isn't available on this platform");
+}
+
+#else
+
+/// A client, stdin and stdout or one socket
+struct Server::Conn {
+    int in, out;
+    char *buf; /**< bytes read but not yet a whole line */
+    int nbuf, maxbuf;
+    bool eof; /**< nothing more will be read */
+    int pending; /**< requests queued or running, guarded by lock */
+    bool broken; /**< a response couldn't be written, guarded by lock */
+    pthread_mutex_t lock; /**< one response is written at a time */
+};
+
+/// A request waiting for a worker
+struct Server::Job {
+    Conn *conn;
+    char *line;
+    Job *next;
+};
+
+struct Server::Queue {
+    Job *head, *tail;
+    int njob;
+    bool done; /**< no more jobs, the workers exit */
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+};
+
+struct Server::Worker {
+    Server *server;
+    pthread_t thread;
+    bool started;
+    CCB *ccb; /**< the warm instance of this worker */
+    Batch *batch;
+};
+
+Server::~Server() {
+
+    for (int i = nconn - 1; i >= 0; i--)
+        close_conn(i);
+
+    delete [] conn;
+}
+
+/**
+ * @brief serve until stdin ends, a quit request or a signal
+ */
+
+int Server::run() {
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, handle_stop);
+    signal(SIGTERM, handle_stop);
+
+    if (nworker == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nworker = n > 0 ? n : 1;
+    }
+
+    if (start_workers() != CCB_OK) {
+        stop_workers();
+        return CCB_ERROR;
+    }
+
+    if (strcmp(path, "-") == 0) {
+        add_conn(0, 1);
+    } else if (open_socket() != CCB_OK) {
+        stop_workers();
+        return CCB_ERROR;
+    }
+
+    CCB_TRACE(1, "Server: %d workers, listening on %s\n", nworker,
+              listenfd < 0 ? "stdin" : path);
+    trace->flush();
+
+    pollfd *fds = NULL;
+    int maxfds = 0;
+
+    while (true) {
+
+        bool stopping = quit || stop_signal;
+
+        // Close the connections that are done
+        for (int i = nconn - 1; i >= 0; i--) {
+            Conn *c = conn[i];
+            pthread_mutex_lock(&c->lock);
+            bool idle = c->pending == 0;
+            pthread_mutex_unlock(&c->lock);
+            if ((c->eof || stopping) && idle)
+                close_conn(i);
+        }
+
+        // stdin is the only connection, or the server was stopped
+        if (nconn == 0 && (listenfd < 0 || stopping))
+            break;
+
+        if (nconn + 1 > maxfds) {
+            maxfds = nconn + 16;
+            delete [] fds;
+            fds = new pollfd[maxfds];
+        }
+
+        pthread_mutex_lock(&queue->lock);
+        bool full = queue->njob >= SERVER_QUEUE * nworker;
+        pthread_mutex_unlock(&queue->lock);
+
+        int nfds = 0;
+        if (listenfd >= 0 && !stopping) {
+            fds[nfds].fd = listenfd;
+            fds[nfds].events = POLLIN;
+            nfds++;
+        }
+
+        // Leave the clients waiting while the workers catch up
+        for (int i = 0; i < nconn; i++) {
+            fds[nfds].fd = conn[i]->eof || full || stopping ? -1 : conn[i]->in;
+            fds[nfds].events = POLLIN;
+            nfds++;
+        }
+
+        // Wake up now and then to close finished connections
+        int n = poll(fds, nfds, 20);
+        if (n < 0 && errno != EINTR) {
+            error->warning(FLERR, "server: poll failed, stopping");
+            quit = true;
+            continue;
+        }
+        if (n <= 0) continue;
+
+        int k = 0;
+        if (listenfd >= 0 && !stopping) {
+            if (fds[k].revents & POLLIN) {
+                int fd = accept(listenfd, NULL, NULL);
+                if (fd >= 0) add_conn(fd, fd);
+            }
+            k++;
+        }
+
+        // New connections went to the end, past the ones polled
+        for (int i = 0; i < nfds - k; i++)
+            if (fds[k + i].revents & (POLLIN | POLLHUP | POLLERR))
+                read_conn(conn[i]);
+    }
+
+    delete [] fds;
+
+    stop_workers();
+
+    if (listenfd >= 0) {
+        close(listenfd);
+        unlink(path);
+    }
+
+    CCB_TRACE(1, "Server: %lld requests, %lld failed\n",
+              (long long) nrequest, (long long) nerror);
+    trace->flush();
+
+    return CCB_OK;
+}
+
+/**
+ * @brief give every worker its own CCB instance set up like a batch
+ * and start its thread
+ */
+
+int Server::start_workers() {
+
+    queue = new Queue;
+    queue->head = queue->tail = NULL;
+    queue->njob = 0;
+    queue->done = false;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->ready, NULL);
+
+    worker = new Worker[nworker];
+
+    for (int i = 0; i < nworker; i++) {
+        Worker &w = worker[i];
+        w.server = this;
+        w.started = false;
+        w.ccb = new CCB(0, NULL);
+        w.ccb->error->verbosity_level = error->verbosity_level;
+        w.batch = new Batch(w.ccb);
+        if (w.batch->settings(narg, arg) != CCB_OK)
+            return CCB_ERROR;
+    }
+
+    for (int i = 0; i < nworker; i++) {
+        if (pthread_create(&worker[i].thread, NULL, work, &worker[i]) != 0)
+            return error->one(FLERR, "server: can't start the worker threads");
+        worker[i].started = true;
+    }
+
+    return CCB_OK;
+}
+
+/**
+ * @brief let the workers finish the queue and join them
+ */
+
+void Server::stop_workers() {
+
+    if (queue == NULL)
+        return;
+
+    pthread_mutex_lock(&queue->lock);
+    queue->done = true;
+    pthread_cond_broadcast(&queue->ready);
+    pthread_mutex_unlock(&queue->lock);
+
+    for (int i = 0; i < nworker; i++) {
+        Worker &w = worker[i];
+        if (w.started)
+            pthread_join(w.thread, NULL);
+
+        if (w.ccb && w.ccb->timer->enabled) {
+            fprintf(screen, "Worker %d\n", i);
+            w.ccb->timer->print_stats();
+        }
+
+        delete w.batch;
+        delete w.ccb;
+    }
+
+    delete [] worker;
+    worker = NULL;
+
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->ready);
+    delete queue;
+    queue = NULL;
+}
+
+int Server::open_socket() {
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return error->one(FLERR, "server: socket path is too long");
+    strcpy(addr.sun_path, path);
+
+    // A socket left by an earlier run is replaced
+    unlink(path);
+
+    listenfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenfd < 0 ||
+        bind(listenfd, (sockaddr *) &addr, sizeof(addr)) != 0 ||
+        listen(listenfd, SOMAXCONN) != 0) {
+        char str[512];
+        snprintf(str, 512, "server: can't listen on %s: %s", path, strerror(errno));
+        if (listenfd >= 0) close(listenfd);
+        listenfd = -1;
+        return error->one(FLERR, str);
+    }
+
+    return CCB_OK;
+}
+
+Server::Conn *Server::add_conn(int in, int out) {
+
+    if (nconn == maxconn) {
+        maxconn += 16;
+        Conn **c = new Conn*[maxconn];
+        for (int i = 0; i < nconn; i++)
+            c[i] = conn[i];
+        delete [] conn;
+        conn = c;
+    }
+
+    Conn *c = new Conn;
+    c->in = in;
+    c->out = out;
+    c->buf = NULL;
+    c->nbuf = c->maxbuf = 0;
+    c->eof = false;
+    c->pending = 0;
+    c->broken = false;
+    pthread_mutex_init(&c->lock, NULL);
+
+    conn[nconn++] = c;
+
+    return c;
+}
+
+/**
+ * close connection i, which has nothing pending
+ */
+
+void Server::close_conn(int i) {
+
+    Conn *c = conn[i];
+
+    // stdin and stdout stay open
+    if (c->in > 1) close(c->in);
+
+    pthread_mutex_destroy(&c->lock);
+    delete [] c->buf;
+    delete c;
+
+    conn[i] = conn[--nconn];
+}
+
+/**
+ * @brief read what the connection has and queue the whole lines
+ */
+
+int Server::read_conn(Conn *c) {
+
+    if (c->maxbuf - c->nbuf < SERVER_READ) {
+        c->maxbuf = c->nbuf + 2 * SERVER_READ;
+        char *b = new char[c->maxbuf];
+        if (c->nbuf) memcpy(b, c->buf, c->nbuf);
+        delete [] c->buf;
+        c->buf = b;
+    }
+
+    ssize_t n = read(c->in, c->buf + c->nbuf, SERVER_READ);
+
+    if (n < 0 && errno == EINTR)
+        return CCB_OK;
+
+    if (n <= 0) {
+        // A last line without a newline still counts
+        if (c->nbuf > 0) push(c, c->buf, c->nbuf);
+        c->nbuf = 0;
+        c->eof = true;
+        return CCB_OK;
+    }
+
+    c->nbuf += n;
+
+    int start = 0;
+    for (int i = c->nbuf - n; i < c->nbuf; i++)
+        if (c->buf[i] == '\n') {
+            push(c, c->buf + start, i - start);
+            start = i + 1;
+        }
+
+    c->nbuf -= start;
+    memmove(c->buf, c->buf + start, c->nbuf);
+
+    return CCB_OK;
+}
+
+/**
+ * @brief queue one line of a connection
+ */
+
+void Server::push(Conn *c, const char *line, int n) {
+
+    while (n > 0 && (line[n - 1] == '\r' || line[n - 1] == ' ')) n--;
+
+    int k = 0;
+    while (k < n && (line[k] == ' ' || line[k] == '\t')) k++;
+
+    // Blank lines and comments
+    if (k == n || line[k] == '#')
+        return;
+
+    if (n - k == 4 && strncmp(line + k, "quit", 4) == 0) {
+        quit = true;
+        return;
+    }
+
+    Job *j = new Job;
+    j->conn = c;
+    j->line = new char[n + 1];
+    memcpy(j->line, line, n);
+    j->line[n] = '\0';
+    j->next = NULL;
+
+    pthread_mutex_lock(&c->lock);
+    c->pending++;
+    pthread_mutex_unlock(&c->lock);
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->tail) queue->tail->next = j;
+    else queue->head = j;
+    queue->tail = j;
+    queue->njob++;
+    pthread_cond_signal(&queue->ready);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+void *Server::work(void *ptr) {
+
+    Worker *w = (Worker *) ptr;
+    Queue *q = w->server->queue;
+
+    while (true) {
+        pthread_mutex_lock(&q->lock);
+        while (q->head == NULL && !q->done)
+            pthread_cond_wait(&q->ready, &q->lock);
+
+        Job *j = q->head;
+        if (j) {
+            q->head = j->next;
+            if (q->head == NULL) q->tail = NULL;
+            q->njob--;
+        }
+        pthread_mutex_unlock(&q->lock);
+
+        if (j == NULL)
+            return NULL;
+
+        int code = w->server->respond(*w, j);
+
+        pthread_mutex_lock(&q->lock);
+        w->server->nrequest++;
+        if (code != CCB_OK) w->server->nerror++;
+        pthread_mutex_unlock(&q->lock);
+
+        pthread_mutex_lock(&j->conn->lock);
+        j->conn->pending--;
+        pthread_mutex_unlock(&j->conn->lock);
+
+        delete [] j->line;
+        delete j;
+    }
+}
+
+/**
+ * next word of p, terminated in place, "" at the end
+ */
+
+static char *next_word(char *&p) {
+
+    while (*p == ' ' || *p == '\t') p++;
+    char *w = p;
+    while (*p && *p != ' ' && *p != '\t') p++;
+    if (*p) *p++ = '\0';
+
+    return w;
+}
+
+/**
+ * @brief build a request in the worker and send the response
+ *
+ * @return CCB_OK if the set was built, clashing or not
+ */
+
+int Server::respond(Worker &w, Job *j) {
+
+    Batch *batch = w.batch;
+
+    char *p = j->line;
+    char *id = next_word(p);
+    char *format = next_word(p);
+
+    char *payload = NULL;
+    size_t npayload = 0;
+    FILE *fp = open_memstream(&payload, &npayload);
+
+    const char *status = "ok";
+    bigint natom = 0;
+    int code = CCB_ERROR;
+
+    int n = batch->split(p);
+
+    if (fp == NULL || n < 0) {
+        w.ccb->error->one(FLERR, "server: out of memory");
+
+    } else if (strcmp(format, "pdb") != 0 && strcmp(format, "xyz") != 0 &&
+               strcmp(format, "f4") != 0 && strcmp(format, "f8") != 0 &&
+               strcmp(format, "none") != 0) {
+        char str[128];
+        snprintf(str, 128, "server: unknown format \"%.32s\" of request %.32s", format, id);
+        w.ccb->error->one(FLERR, str);
+
+    } else if ((code = batch->build_set(n, batch->args)) == CCB_OK && !batch->clashing) {
+
+        natom = w.ccb->bitmask->count(batch->mask);
+
+        if (strcmp(format, "pdb") == 0)
+            code = batch->write_pdb(fp);
+        else if (strcmp(format, "xyz") == 0)
+            code = batch->write_xyz(fp, id, n - batch->nbase, batch->args + batch->nbase);
+        else if (format[0] == 'f')
+            code = batch->write_raw(fp, format[1] == '4' ? 4 : 8);
+    }
+
+    if (fp) fclose(fp);
+
+    if (code != CCB_OK) status = "error";
+    else if (batch->clashing) status = "clash";
+
+    // Only a whole set is sent
+    if (code != CCB_OK || batch->clashing) {
+        natom = 0;
+        npayload = 0;
+    }
+
+    char header[128];
+    int nheader = snprintf(header, 128, "%.64s %s %lld %lld\n", id, status,
+                           (long long) natom, (long long) npayload);
+
+    Conn *c = j->conn;
+    pthread_mutex_lock(&c->lock);
+
+    const char *buf[2] = { header, payload };
+    size_t len[2] = { (size_t) nheader, npayload };
+
+    for (int k = 0; k < 2 && !c->broken; k++)
+        for (size_t done = 0; done < len[k]; ) {
+            ssize_t m = write(c->out, buf[k] + done, len[k] - done);
+            if (m < 0 && errno == EINTR) continue;
+            if (m <= 0) {
+                c->broken = true;
+                break;
+            }
+            done += m;
+        }
+
+    pthread_mutex_unlock(&c->lock);
+
+    free(payload);
+
+    return code;
+}
+
+#endif
@@ -0,0 +1,112 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   server.h
+ * @date   Tue Oct 20 14:02:51 2026
+ *
+ * @brief  Service mode of the ccb executable
+ *
+ * ccb -serve [path] [-workers N] [batch options] keeps N worker
+ * threads, each with its own CCB instance, and runs the coiled-coils
+ * requested on stdin, or on any connection to the unix domain socket
+ * at path, until stdin ends, a quit request or SIGINT/SIGTERM. The
+ * options of the command line are common to every request, as in
+ * a batch (see batch.h). Requests are one per line
+ *
+ *   id format [style options]
+ *
+ * where id is any word, echoed in the response, and format is one of
+ *
+ *   pdb    pdb records
+ *   xyz    an xyz frame
+ *   f4     x y z of every atom as native floats
+ *   f8     x y z of every atom as native doubles
+ *   none   no coordinates, the number of atoms only
+ *
+ * Every request is answered with a header line and a payload
+ *
+ *   id status natom nbytes\n<nbytes of payload>
+ *
+ * where status is ok, clash (rejected by -clash, no payload) or
+ * error. Responses on one connection come back as the workers finish
+ * them, not in the order sent, so clients match them up by id.
+ *
+ * Only the executable serves, the libraries are built without it.
+ */
+
+#ifndef CCB_SERVER_H
+#define CCB_SERVER_H
+
+#include "pointers.h"
+
+namespace CCB_NS {
+class Server: protected Pointers {
+
+  public:
+
+    // Constructor and Destructor
+    Server(class CCB *, class Batch *, int narg, const char **arg);
+    ~Server();
+
+    int run(); /**< serve until the input ends or quit */
+
+    bigint nrequest; /**< requests answered */
+    bigint nerror; /**< requests answered with an error */
+
+  private:
+
+    int narg; /**< command line handed to the batch of each worker */
+    const char **arg;
+    const char *path; /**< socket path, "-" for stdin */
+    int nworker;
+
+    struct Conn;
+    struct Job;
+    struct Worker;
+    struct Queue;
+
+    Conn **conn; /**< open connections, stdin is one */
+    int nconn, maxconn;
+    Worker *worker;
+    Queue *queue; /**< requests waiting for a worker */
+    int listenfd; /**< -1 when serving stdin */
+    bool quit; /**< a quit request was read */
+
+    int start_workers();
+    void stop_workers();
+    int open_socket();
+    Conn *add_conn(int in, int out);
+    void close_conn(int i);
+    int read_conn(Conn *c);
+    void push(Conn *c, const char *line, int n);
+
+    static void *work(void *ptr); /**< thread body of a worker */
+    int respond(Worker &w, Job *j);
+};
+}
+
+#endif
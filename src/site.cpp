@@ -72,7 +72,6 @@ Site::Site(CCB *ccb, int myid) :
         rotamer(),
         most_probable(),
         nrotamer(0),
-        mask(1),
         ngroup_iter(0),
         maxrotamer(0)
 {
@@ -111,7 +110,6 @@ Site::Site(const Site &s) : Pointers(s) {
     maxrotamer = s.maxrotamer;
     strcpy(chain, s.chain);
     strcpy(seg, s.seg);
-    mask = s.mask;
     ngroup_iter = s.ngroup_iter;
 
     // Copy instance of fixed-atoms;
@@ -157,7 +155,6 @@ Site& Site::operator= (Site const& s) {
     maxrotamer = s.maxrotamer;
     strcpy(chain, s.chain);
     strcpy(seg, s.seg);
-    mask = s.mask;
     ngroup_iter = s.ngroup_iter;
 
     // Copy instance of fixed_atoms
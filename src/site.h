@@ -73,8 +73,6 @@ namespace CCB_NS {
         int find_rotamer(int id);
         void delete_all_rotamers();
 
-        int mask;           /** < The site mask, used for build specifications. All atoms in this site inherit the site mask */
-
         double memory_usage();
 
     private:
@@ -0,0 +1,2 @@
+#include "input_cif.h"
+#include "input_pdb.h"
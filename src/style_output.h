@@ -1 +1,4 @@
+#include "output_imd.h"
+#include "output_npy.h"
 #include "output_pdb.h"
+#include "output_shm.h"
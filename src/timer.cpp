@@ -0,0 +1,161 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   timer.cpp
+ * @date   Mon Oct 19 21:46:31 2026
+ *
+ * @brief  Per-phase timers and counters for the hot paths
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+#include "timer.h"
+#include "memory.h"
+#include "error.h"
+#include "trace.h"
+
+using namespace CCB_NS;
+
+/**
+ * Phase names, in the order of the enum
+ */
+
+static const char *phase_name[] = {
+    "build_plane",
+    "helix_axis",
+    "residues",
+    "symmetry",
+    "symmetry_axis",
+    "terminate",
+    "update_domain",
+    "domain_reset",
+    "output"
+};
+
+Timer::Timer(CCB *ccb) :
+          Pointers(ccb),
+          enabled(false),
+          json(NULL)
+{
+    reset();
+
+    const char *env = getenv("CCB_STATS");
+    if (env && env[0]) {
+        set_json(env);
+        enabled = true;
+    }
+}
+
+Timer::~Timer() {
+
+    if (enabled && CCB_TRACE_ON(3))
+        print_stats();
+
+    if (json && write_json(json) != CCB_OK)
+        fprintf(stderr, "CCB: Can't write stats to %s\n", json);
+
+    memory->sfree(json);
+}
+
+void Timer::reset() {
+
+    for (int i = 0; i < NPHASE; i++) {
+        count[i] = 0;
+        items[i] = 0;
+        seconds[i] = 0.0;
+    }
+}
+
+const char *Timer::name(int phase) {
+    return phase >= 0 && phase < NPHASE ? phase_name[phase] : "unknown";
+}
+
+double Timer::wall() {
+
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+#else
+    return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+int Timer::set_json(const char *fname) {
+
+    memory->sfree(json);
+    json = NULL;
+
+    if (fname == NULL) return CCB_OK;
+
+    int n = strlen(fname) + 1;
+    json = (char *) memory->smalloc(n, "timer:json");
+    if (json == NULL) return CCB_ERROR;
+    strcpy(json, fname);
+
+    return CCB_OK;
+}
+
+/**
+ * Writes one object per phase, e.g.
+ *
+ * {"phases": [{"name": "build_plane", "calls": 4, "items": 0, "seconds": 1.2e-06}, ...]}
+ *
+ * @param fname the file to write, "-" for screen
+ */
+
+int Timer::write_json(const char *fname) {
+
+    FILE *fp = strcmp(fname, "-") == 0 ? screen : fopen(fname, "w");
+    if (fp == NULL) return CCB_ERROR;
+
+    fprintf(fp, "{\n  \"enabled\": %s,\n  \"phases\": [\n", enabled ? "true" : "false");
+    for (int i = 0; i < NPHASE; i++)
+        fprintf(fp, "    {\"name\": \"%s\", \"calls\": " BIGINT_FORMAT ", \"items\": "
+                BIGINT_FORMAT ", \"seconds\": %.9g}%s\n", phase_name[i], count[i],
+                items[i], seconds[i], i < NPHASE - 1 ? "," : "");
+    fprintf(fp, "  ]\n}\n");
+
+    if (fp != screen) fclose(fp);
+
+    return CCB_OK;
+}
+
+void Timer::print_stats() {
+
+    if (screen == NULL) return;
+
+    fprintf(screen, "%-16s %12s %12s %14s %12s\n", "phase", "calls", "items",
+            "seconds", "us/call");
+
+    for (int i = 0; i < NPHASE; i++)
+        fprintf(screen, "%-16s %12lld %12lld %14.6f %12.3f\n", phase_name[i],
+                (long long) count[i], (long long) items[i], seconds[i],
+                count[i] ? 1.0e6 * seconds[i] / count[i] : 0.0);
+}
@@ -0,0 +1,129 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   timer.h
+ * @date   Mon Oct 19 21:40:08 2026
+ *
+ * @brief  Per-phase timers and counters for the hot paths
+ *
+ * Every instrumented phase keeps the number of calls, the number
+ * of items it handled (residues, atoms, sites) and the wall time
+ * spent in it, summed over the life of the CCB instance. Phases
+ * are timed with a Timer::Scope on the stack, which does nothing
+ * but test a flag while timing is off. Defining CCB_NO_TIMER at
+ * compile time removes the scopes altogether.
+ *
+ * Phases can nest, e.g. RESIDUES includes the BUILD_PLANE of the
+ * asymmetric build, so their times don't add up to the total.
+ *
+ * If the environment variable CCB_STATS names a file, timing is
+ * switched on at startup and the stats are written there as JSON
+ * when the instance is destroyed.
+ */
+
+#ifndef CCB_TIMER_H
+#define CCB_TIMER_H
+
+#include "pointers.h"
+
+/**
+ * @def CCB_TIMER
+ *
+ * @brief Time the rest of the enclosing block as phase,
+ * n items are counted against it
+ */
+
+#ifdef CCB_NO_TIMER
+#define CCB_TIMER(phase, n)
+#else
+#define CCB_TIMER(phase, n) Timer::Scope timer_scope(timer, Timer::phase, n)
+#endif
+
+namespace CCB_NS {
+class Timer: protected Pointers {
+
+  public:
+
+    enum {
+        BUILD_PLANE,
+        HELIX_AXIS,
+        RESIDUES,
+        SYMMETRY,
+        SYMMETRY_AXIS,
+        TERMINATE,
+        UPDATE_DOMAIN,
+        DOMAIN_RESET,
+        OUTPUT,
+        NPHASE
+    };
+
+    // Constructor and Destructor
+    Timer(class CCB *); /**< Timer constructor */
+    ~Timer(); /**< Timer deconstructor, writes the JSON stats if set */
+
+    bool enabled; /**< collect timings */
+
+    bigint count[NPHASE]; /**< calls of each phase */
+    bigint items[NPHASE]; /**< items handled by each phase */
+    double seconds[NPHASE]; /**< wall time spent in each phase */
+
+    void reset(); /**< zero the timers and counters */
+    int set_json(const char *); /**< file written at destruction, NULL for none */
+    int write_json(const char *); /**< write the stats as JSON */
+    void print_stats(); /**< print the stats to screen */
+
+    static const char *name(int); /**< name of a phase */
+    static double wall(); /**< monotonic wall time in seconds */
+
+    /**
+     * Times its own lifetime as one call of a phase
+     */
+
+    class Scope {
+      public:
+        Scope(Timer *t, int p, bigint n) : timer(t->enabled ? t : NULL), phase(p), nitem(n),
+                                           start(timer ? wall() : 0.0) {}
+        ~Scope() {
+            if (timer == NULL) return;
+            timer->count[phase]++;
+            timer->items[phase] += nitem;
+            timer->seconds[phase] += wall() - start;
+        }
+      private:
+        Timer *timer;
+        int phase;
+        bigint nitem;
+        double start;
+    };
+
+  private:
+
+    char *json; /**< file the stats are written to at destruction */
+};
+}
+
+#endif
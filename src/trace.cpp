@@ -0,0 +1,101 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   trace.cpp
+ * @date   Mon Oct 19 22:40:17 2026
+ *
+ * @brief  Leveled trace messages for diagnostics
+ *
+ * head and tail only grow, a byte recorded as number n lives at
+ * ring[n % TRACE_RING].
+ */
+
+#include "stdio.h"
+#include "stdarg.h"
+#include "string.h"
+#include "trace.h"
+#include "memory.h"
+
+using namespace CCB_NS;
+
+Trace::Trace(CCB *ccb) :
+          Pointers(ccb),
+          ring(NULL),
+          head(0),
+          tail(0)
+{
+}
+
+Trace::~Trace() {
+    flush();
+    memory->sfree(ring);
+}
+
+void Trace::record(const char *format, ...) {
+
+    char line[TRACE_LINE];
+
+    va_list ap;
+    va_start(ap, format);
+    int n = vsnprintf(line, TRACE_LINE, format, ap);
+    va_end(ap);
+
+    if (n < 0) return;
+    if (n >= TRACE_LINE) n = TRACE_LINE - 1;
+
+    if (ring == NULL) {
+        ring = (char *) memory->smalloc(TRACE_RING, "trace:ring");
+        if (ring == NULL) return;
+    }
+
+    if (head - tail + n > TRACE_RING)
+        flush();
+
+    // Copy in at most two pieces around the end of the ring
+    int at = head % TRACE_RING;
+    int first = n < TRACE_RING - at ? n : TRACE_RING - at;
+    memcpy(ring + at, line, first);
+    memcpy(ring, line + first, n - first);
+
+    head += n;
+}
+
+void Trace::flush() {
+
+    if (head == tail) return;
+
+    if (screen) {
+        int at = tail % TRACE_RING;
+        bigint n = head - tail;
+        int first = n < TRACE_RING - at ? n : TRACE_RING - at;
+        fwrite(ring + at, 1, first, screen);
+        fwrite(ring, 1, n - first, screen);
+        fflush(screen);
+    }
+
+    tail = head;
+}
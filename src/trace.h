@@ -0,0 +1,119 @@
+// -*-c++-*-
+
+// *hd +------------------------------------------------------------------------------------+
+// *hd |  This file is part of Coiled-Coil Builder.                                         |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is free software: you can redistribute it and/or modify       |
+// *hd |  it under the terms of the GNU General Public License as published by              |
+// *hd |  the Free Software Foundation, either version 3 of the License, or                 |
+// *hd |  (at your option) any later version.                                               |
+// *hd |                                                                                    |
+// *hd |  Coiled-Coil Builder is distributed in the hope that it will be useful,            |
+// *hd |  but WITHOUT ANY WARRANTY without even the implied warranty of                     |
+// *hd |  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                     |
+// *hd |  GNU General Public License for more details.                                      |
+// *hd |                                                                                    |
+// *hd |  You should have received a copy of the GNU General Public License                 |
+// *hd |  along with Coiled-Coil Builder.  If not, see <http:www.gnu.org/licenses/>.        |
+// *hd +------------------------------------------------------------------------------------+
+
+// *hd | If you intend to use this software for your research, please cite:
+// *hd | and inform Chris MacDermaid <chris.macdermaid@gmail.com> of any pending publications.
+
+// *hd | Copyright (c) 2012,2013,2014 by Chris M. MacDermaid <chris.macdermaid@gmail.com>
+// *hd | and Jeffery G. Saven <saven@sas.upenn.edu>
+
+
+/**
+ * @file   trace.h
+ * @date   Mon Oct 19 22:31:55 2026
+ *
+ * @brief  Leveled trace messages for diagnostics
+ *
+ * CCB_TRACE(level, fmt, ...) records a message when the verbosity
+ * is at least level. Levels above CCB_TRACE_MAX are removed at
+ * compile time, the default of 7 drops the debugging levels 8-10
+ * from release builds, add -DCCB_TRACE_MAX=10 to CCFLAGS to keep
+ * them. Enabled messages are formatted into a ring buffer and
+ * written to screen by flush(), which is called once a backbone
+ * is generated or a file read or written, before any error or
+ * warning so the order is kept, and when the ring fills.
+ *
+ * The ring takes no locks, every CCB instance is only used from
+ * one thread at a time.
+ */
+
+#ifndef CCB_TRACE_H
+#define CCB_TRACE_H
+
+#include "pointers.h"
+
+/**
+ * @def CCB_TRACE_MAX
+ *
+ * @brief Highest verbosity level compiled in
+ */
+
+#ifndef CCB_TRACE_MAX
+#define CCB_TRACE_MAX 7
+#endif
+
+/**
+ * @def CCB_TRACE_ON
+ *
+ * @brief True if messages of level are compiled in and enabled,
+ * for guarding blocks that do more than one CCB_TRACE
+ */
+
+#define CCB_TRACE_ON(level) \
+    ((level) <= CCB_TRACE_MAX && error->verbosity_level >= (level))
+
+/**
+ * @def CCB_TRACE
+ *
+ * @brief Record a printf style message at level
+ */
+
+#define CCB_TRACE(level, ...) \
+    do { if (CCB_TRACE_ON(level)) trace->record(__VA_ARGS__); } while (0)
+
+/**
+ * @def TRACE_RING
+ * @brief Bytes held by the ring before it is flushed
+ */
+
+#define TRACE_RING 65536
+
+/**
+ * @def TRACE_LINE
+ * @brief Longest single message, longer ones are truncated
+ */
+
+#define TRACE_LINE 2048
+
+namespace CCB_NS {
+class Trace: protected Pointers {
+
+  public:
+
+    // Constructor and Destructor
+    Trace(class CCB *); /**< Trace constructor */
+    ~Trace(); /**< Trace deconstructor, flushes the ring */
+
+    void record(const char *, ...)
+#ifdef __GNUC__
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ; /**< format a message into the ring */
+
+    void flush(); /**< write the ring to screen */
+
+  private:
+
+    char *ring; /**< message bytes, allocated on the first record */
+    bigint head; /**< total bytes recorded */
+    bigint tail; /**< total bytes flushed */
+};
+}
+
+#endif